@@ -0,0 +1,274 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Numerics;
+using System.Text;
+using System.Threading.Tasks;
+
+namespace Tesseract.Box2D.NET {
+
+	/// <summary>
+	/// Enumeration of the standard benchmark scenes.
+	/// </summary>
+	public enum BenchmarkScene {
+		/// <summary>
+		/// A pyramid of stacked boxes resting on the ground, which stresses stacking stability and sleeping.
+		/// </summary>
+		Pyramid,
+		/// <summary>
+		/// A kinematic box container rotating continuously with small boxes tumbling inside it, which keeps every body awake.
+		/// </summary>
+		Tumbler,
+		/// <summary>
+		/// A large grid of boxes and circles dropped onto the ground, which stresses the broad-phase and contact creation.
+		/// </summary>
+		ManyBodies
+	}
+
+	/// <summary>
+	/// The timing results of running a benchmark scene.
+	/// </summary>
+	public readonly record struct BenchmarkResult {
+
+		/// <summary>
+		/// The scene which was run.
+		/// </summary>
+		public BenchmarkScene Scene { get; init; }
+
+		/// <summary>
+		/// If the scene was stepped in <see cref="World.Deterministic"/> mode.
+		/// </summary>
+		public bool Deterministic { get; init; }
+
+		/// <summary>
+		/// The number of bodies in the scene.
+		/// </summary>
+		public int BodyCount { get; init; }
+
+		/// <summary>
+		/// The number of steps which were taken.
+		/// </summary>
+		public int StepCount { get; init; }
+
+		/// <summary>
+		/// The total time spent stepping the world, in milliseconds.
+		/// </summary>
+		public double TotalMilliseconds { get; init; }
+
+		/// <summary>
+		/// The average time of a step, in milliseconds.
+		/// </summary>
+		public double AverageMilliseconds => StepCount > 0 ? TotalMilliseconds / StepCount : 0;
+
+		/// <summary>
+		/// The time of the slowest step, in milliseconds.
+		/// </summary>
+		public double MaxMilliseconds { get; init; }
+
+		/// <summary>
+		/// The checksum of the world state after the last step, see <see cref="World.ComputeChecksum"/>.
+		/// </summary>
+		public ulong Checksum { get; init; }
+
+	}
+
+	/// <summary>
+	/// <para>
+	/// A suite of standard scenes for tracking the performance of the world step. Scenes are built identically every time
+	/// and by default stepped in <see cref="World.Deterministic"/> mode, so the checksum of each result also verifies that
+	/// a change has not altered the simulation.
+	/// </para>
+	/// <para>
+	/// Scenes may also be run in non-deterministic mode to measure the parallel contact solver.
+	/// </para>
+	/// </summary>
+	public static class Benchmarks {
+
+		/// <summary>
+		/// The default number of steps taken when running a scene.
+		/// </summary>
+		public const int DefaultStepCount = 600;
+
+		/// <summary>
+		/// The time step used when running a scene.
+		/// </summary>
+		public const float TimeStep = 1.0f / 60.0f;
+
+		/// <summary>
+		/// The number of velocity iterations used when running a scene.
+		/// </summary>
+		public const int VelocityIterations = 8;
+
+		/// <summary>
+		/// The number of position iterations used when running a scene.
+		/// </summary>
+		public const int PositionIterations = 3;
+
+		/// <summary>
+		/// Creates a new world containing a benchmark scene.
+		/// </summary>
+		/// <param name="scene">The scene to create</param>
+		/// <param name="deterministic">If the world steps in deterministic mode</param>
+		/// <returns>The world containing the scene</returns>
+		public static World CreateScene(BenchmarkScene scene, bool deterministic = true) {
+			World world = new(new Vector2(0, -10)) { Deterministic = deterministic };
+			switch (scene) {
+				case BenchmarkScene.Pyramid:
+					CreatePyramid(world);
+					break;
+				case BenchmarkScene.Tumbler:
+					CreateTumbler(world);
+					break;
+				case BenchmarkScene.ManyBodies:
+					CreateManyBodies(world);
+					break;
+				default:
+					throw new ArgumentException("Unknown benchmark scene", nameof(scene));
+			}
+			return world;
+		}
+
+		// Creates a static box spanning the bottom of a scene
+		private static Body CreateGround(World world, float halfWidth) {
+			Body ground = world.CreateBody(new BodyDef() { Position = new Vector2(0, -1) });
+			PolygonShape shape = new();
+			shape.SetAsBox(halfWidth, 1);
+			ground.CreateFixture(shape, 0);
+			return ground;
+		}
+
+		private static void CreatePyramid(World world) {
+			const int baseCount = 20;
+			const float a = 0.5f;
+
+			CreateGround(world, 40);
+
+			PolygonShape shape = new();
+			shape.SetAsBox(a, a);
+
+			Vector2 x = new(-7.0f, 0.75f);
+			Vector2 deltaX = new(0.5625f, 1.25f);
+			Vector2 deltaY = new(1.125f, 0.0f);
+
+			for (int i = 0; i < baseCount; i++) {
+				Vector2 y = x;
+				for (int j = i; j < baseCount; j++) {
+					Body body = world.CreateBody(new BodyDef() { Type = BodyType.Dynamic, Position = y });
+					body.CreateFixture(shape, 5);
+					y += deltaY;
+				}
+				x += deltaX;
+			}
+		}
+
+		private static void CreateTumbler(World world) {
+			const int gridSize = 20;
+			const float boxHalfSize = 0.125f;
+			const float spacing = 0.5f;
+
+			Body container = world.CreateBody(new BodyDef() {
+				Type = BodyType.Kinematic,
+				Position = new Vector2(0, 10),
+				AngularVelocity = 0.05f * MathF.PI,
+				AllowSleep = false
+			});
+
+			PolygonShape wall = new();
+			wall.SetAsBox(0.5f, 10, new Vector2(10, 0), 0);
+			container.CreateFixture(wall, 5);
+			wall.SetAsBox(0.5f, 10, new Vector2(-10, 0), 0);
+			container.CreateFixture(wall, 5);
+			wall.SetAsBox(10, 0.5f, new Vector2(0, 10), 0);
+			container.CreateFixture(wall, 5);
+			wall.SetAsBox(10, 0.5f, new Vector2(0, -10), 0);
+			container.CreateFixture(wall, 5);
+
+			PolygonShape shape = new();
+			shape.SetAsBox(boxHalfSize, boxHalfSize);
+
+			float offset = -0.5f * spacing * (gridSize - 1);
+			for (int i = 0; i < gridSize; i++) {
+				for (int j = 0; j < gridSize; j++) {
+					Body body = world.CreateBody(new BodyDef() {
+						Type = BodyType.Dynamic,
+						Position = new Vector2(offset + i * spacing, 10 + offset + j * spacing)
+					});
+					body.CreateFixture(shape, 1);
+				}
+			}
+		}
+
+		private static void CreateManyBodies(World world) {
+			const int columns = 40;
+			const int rows = 25;
+			const float halfSize = 0.4f;
+			const float spacing = 1.0f;
+
+			// Walls keep rolling circles from leaving the ground
+			Body ground = CreateGround(world, 30);
+			PolygonShape wall = new();
+			wall.SetAsBox(1, 20, new Vector2(-29, 20), 0);
+			ground.CreateFixture(wall, 0);
+			wall.SetAsBox(1, 20, new Vector2(29, 20), 0);
+			ground.CreateFixture(wall, 0);
+
+			PolygonShape box = new();
+			box.SetAsBox(halfSize, halfSize);
+			CircleShape circle = new() { Radius = halfSize };
+
+			float offset = -0.5f * spacing * (columns - 1);
+			for (int i = 0; i < columns; i++) {
+				for (int j = 0; j < rows; j++) {
+					Body body = world.CreateBody(new BodyDef() {
+						Type = BodyType.Dynamic,
+						Position = new Vector2(offset + i * spacing, 1 + j * spacing)
+					});
+					body.CreateFixture(((i + j) & 1) == 0 ? box : circle, 1);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Creates and runs a benchmark scene.
+		/// </summary>
+		/// <param name="scene">The scene to run</param>
+		/// <param name="stepCount">The number of steps to take</param>
+		/// <param name="deterministic">If the world steps in deterministic mode</param>
+		/// <returns>The timing results</returns>
+		public static BenchmarkResult Run(BenchmarkScene scene, int stepCount = DefaultStepCount, bool deterministic = true) {
+			World world = CreateScene(scene, deterministic);
+
+			double total = 0, max = 0;
+			double milliFactor = 1000.0 / Stopwatch.Frequency;
+			for (int i = 0; i < stepCount; i++) {
+				long start = Stopwatch.GetTimestamp();
+				world.Step(TimeStep, VelocityIterations, PositionIterations);
+				double elapsed = (Stopwatch.GetTimestamp() - start) * milliFactor;
+				total += elapsed;
+				max = Math.Max(max, elapsed);
+			}
+
+			return new BenchmarkResult() {
+				Scene = scene,
+				Deterministic = deterministic,
+				BodyCount = world.Bodies.Count,
+				StepCount = stepCount,
+				TotalMilliseconds = total,
+				MaxMilliseconds = max,
+				Checksum = world.ComputeChecksum()
+			};
+		}
+
+		/// <summary>
+		/// Runs every benchmark scene.
+		/// </summary>
+		/// <param name="stepCount">The number of steps to take in each scene</param>
+		/// <param name="deterministic">If the worlds step in deterministic mode</param>
+		/// <returns>The timing results of each scene</returns>
+		public static BenchmarkResult[] RunAll(int stepCount = DefaultStepCount, bool deterministic = true) =>
+			Enum.GetValues<BenchmarkScene>().Select(scene => Run(scene, stepCount, deterministic)).ToArray();
+
+	}
+
+}
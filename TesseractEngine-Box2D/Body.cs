@@ -5,6 +5,7 @@ using System.Linq;
 using System.Numerics;
 using System.Text;
 using System.Threading.Tasks;
+using Tesseract.Core.Numerics;
 
 namespace Tesseract.Box2D.NET {
 
@@ -30,130 +31,534 @@ namespace Tesseract.Box2D.NET {
 
 		public float AngularDampening { get; init; }
 
-		public bool AllowSleep { get; init; }
+		public bool AllowSleep { get; init; } = true;
 
-		public bool Awake { get; init; }
+		public bool Awake { get; init; } = true;
 
 		public bool FixedRotation { get; init; }
 
 		public bool Bullet { get; init; }
 
-		public bool Enabled { get; init; }
+		public bool Enabled { get; init; } = true;
 
-		public float GravityScale { get; init; }
+		public float GravityScale { get; init; } = 1;
 
 	}
 
 	public class Body {
 
-		public Fixture CreateFixture(FixtureDef def);
+		/// <summary>
+		/// Creates a fixture and attaches it to this body. If the density is non-zero this automatically updates the mass of the body.
+		/// </summary>
+		/// <param name="def">The fixture definition</param>
+		/// <returns>The created fixture</returns>
+		public Fixture CreateFixture(FixtureDef def) {
+			World.CheckUnlocked();
+
+			Fixture fixture = new(this, def);
+			if (IsEnabled) {
+				fixture.CreateProxies(World.ContactManager.BroadPhase, Transform);
+			}
 
-		public Fixture CreateFixture(IShape shape, float density);
+			fixture.Next = FixtureList;
+			FixtureList = fixture;
+			FixtureCount++;
 
-		public Transform Transform { get; set; }
+			if (fixture.Density > 0) ResetMassData();
 
-		public Vector2 Position { get; }
+			// Let the world know we have a new fixture. This will cause new contacts to be created at the beginning of the next time step.
+			World.NewContacts = true;
 
-		public float Angle { get; }
+			return fixture;
+		}
 
-		public Vector2 WorldCenter { get; }
+		/// <summary>
+		/// Creates a fixture from a shape and attaches it to this body.
+		/// </summary>
+		/// <param name="shape">The shape of the fixture</param>
+		/// <param name="density">The density of the shape</param>
+		/// <returns>The created fixture</returns>
+		public Fixture CreateFixture(IShape shape, float density) => CreateFixture(new FixtureDef() { Shape = shape, Density = density });
+
+		/// <summary>
+		/// Destroys a fixture attached to this body, removing it from the broad-phase and destroying any contacts associated with it.
+		/// This automatically updates the mass of the body if it has a non-zero density.
+		/// </summary>
+		/// <param name="fixture">The fixture to destroy</param>
+		public void DestroyFixture(Fixture fixture) {
+			World.CheckUnlocked();
+			if (fixture.Body != this || fixture.IsDestroyed) throw new ArgumentException("Fixture is not attached to this body", nameof(fixture));
+
+			// Remove the fixture from this body's singly linked list
+			Fixture? prev = null;
+			for (Fixture? f = FixtureList; f != null; f = f.Next) {
+				if (f == fixture) {
+					if (prev == null) FixtureList = f.Next;
+					else prev.Next = f.Next;
+					break;
+				}
+				prev = f;
+			}
 
-		public Vector2 LocalCenter { get; }
+			// Destroy any contacts associated with the fixture
+			ContactEdge? edge = ContactList;
+			while (edge != null) {
+				Contact c = edge.Contact;
+				edge = edge.Next;
 
-		public Vector2 LinearVelocity { get; set; }
+				if (fixture == c.FixtureA || fixture == c.FixtureB) {
+					// This destroys the contact and removes it from this body's contact list
+					World.ContactManager.Destroy(c);
+				}
+			}
 
-		public float AngularVelocity { get; set; }
+			if (IsEnabled) fixture.DestroyProxies(World.ContactManager.BroadPhase);
 
-		public void ApplyForce(Vector2 force, Vector2 point, bool wake) {
+			fixture.Next = null;
+			fixture.IsDestroyed = true;
+			FixtureCount--;
 
+			ResetMassData();
 		}
 
-		public void ApplyForceToCenter(Vector2 force, bool wake) {
-
+		/// <summary>
+		/// The transform of the body's origin. Setting the transform moves the body without affecting its velocity, and
+		/// contacts are updated on the next step.
+		/// </summary>
+		public Transform Transform {
+			get => World.Store.Transforms[StoreIndex];
+			set => SetTransform(value.Position, value.Rotation.Angle);
 		}
 
-		public void ApplyTorque(float torque, bool wake) {
+		/// <summary>
+		/// Sets the position of the body's origin and its rotation.
+		/// </summary>
+		/// <param name="position">The world position of the body's origin</param>
+		/// <param name="angle">The world rotation in radians</param>
+		public void SetTransform(Vector2 position, float angle) {
+			World.CheckUnlocked();
+
+			ref Transform xf = ref World.Store.Transforms[StoreIndex];
+			xf = new Transform(position, angle);
+
+			ref Sweep sweep = ref Sweep;
+			sweep.EndCenter = xf * sweep.LocalCenter;
+			sweep.EndAngle = angle;
+			sweep.StartCenter = sweep.EndCenter;
+			sweep.StartAngle = angle;
+
+			BroadPhase broadPhase = World.ContactManager.BroadPhase;
+			for (Fixture? f = FixtureList; f != null; f = f.Next) f.Synchronize(broadPhase, xf, xf);
 
+			// Check for new contacts the next step
+			World.NewContacts = true;
 		}
 
-		public void ApplyLinearImpulse(Vector2 impulse, Vector2 point, bool wake) {
+		/// <summary>
+		/// The world position of the body's origin.
+		/// </summary>
+		public Vector2 Position => Transform.Position;
+
+		/// <summary>
+		/// The current world rotation angle in radians.
+		/// </summary>
+		public float Angle => Sweep.EndAngle;
+
+		/// <summary>
+		/// The world position of the center of mass.
+		/// </summary>
+		public Vector2 WorldCenter => Sweep.EndCenter;
+
+		/// <summary>
+		/// The local position of the center of mass.
+		/// </summary>
+		public Vector2 LocalCenter => Sweep.LocalCenter;
+
+		/// <summary>
+		/// The linear velocity of the center of mass.
+		/// </summary>
+		public Vector2 LinearVelocity {
+			get => World.Store.Velocities[StoreIndex].V;
+			set {
+				if (type == BodyType.Static) return;
+				if (value.Dot(value) > 0) IsAwake = true;
+				World.Store.Velocities[StoreIndex].V = value;
+			}
+		}
 
+		/// <summary>
+		/// The angular velocity in radians per second.
+		/// </summary>
+		public float AngularVelocity {
+			get => World.Store.Velocities[StoreIndex].W;
+			set {
+				if (type == BodyType.Static) return;
+				if (value * value > 0) IsAwake = true;
+				World.Store.Velocities[StoreIndex].W = value;
+			}
 		}
 
-		public void ApplyLinearImpulseToCenter(Vector2 impulse, bool wake) {
+		// Wakes the body if requested, returning if forces and impulses should be applied to it
+		private bool PrepareApply(bool wake) {
+			if (type != BodyType.Dynamic) return false;
+			if (wake && (Flags & BodyFlags.Awake) == 0) IsAwake = true;
+			// Don't accumulate forces or impulses on a sleeping body
+			return (Flags & BodyFlags.Awake) != 0;
+		}
 
+		/// <summary>
+		/// Applies a force at a world point. If the force is not applied at the center of mass it will generate a torque and affect the angular velocity.
+		/// </summary>
+		/// <param name="force">The world force vector, usually in Newtons</param>
+		/// <param name="point">The world position of the point of application</param>
+		/// <param name="wake">If the body should be woken</param>
+		public void ApplyForce(Vector2 force, Vector2 point, bool wake) {
+			if (!PrepareApply(wake)) return;
+			BodyStore store = World.Store;
+			store.Forces[StoreIndex] += force;
+			store.Torques[StoreIndex] += (point - store.Sweeps[StoreIndex].EndCenter).Cross(force);
 		}
 
-		public void ApplyAngularImpulse(float impulse, bool wake) {
+		/// <summary>
+		/// Applies a force to the center of mass.
+		/// </summary>
+		/// <param name="force">The world force vector, usually in Newtons</param>
+		/// <param name="wake">If the body should be woken</param>
+		public void ApplyForceToCenter(Vector2 force, bool wake) {
+			if (!PrepareApply(wake)) return;
+			World.Store.Forces[StoreIndex] += force;
+		}
 
+		/// <summary>
+		/// Applies a torque, affecting the angular velocity without affecting the linear velocity of the center of mass.
+		/// </summary>
+		/// <param name="torque">The torque about the z-axis, usually in N-m</param>
+		/// <param name="wake">If the body should be woken</param>
+		public void ApplyTorque(float torque, bool wake) {
+			if (!PrepareApply(wake)) return;
+			World.Store.Torques[StoreIndex] += torque;
 		}
 
-		public float Mass { get; }
+		/// <summary>
+		/// Applies an impulse at a point, immediately modifying the velocity. This also modifies the angular velocity if the
+		/// point of application is not at the center of mass.
+		/// </summary>
+		/// <param name="impulse">The world impulse vector, usually in N-seconds or kg-m/s</param>
+		/// <param name="point">The world position of the point of application</param>
+		/// <param name="wake">If the body should be woken</param>
+		public void ApplyLinearImpulse(Vector2 impulse, Vector2 point, bool wake) {
+			if (!PrepareApply(wake)) return;
+			BodyStore store = World.Store;
+			ref Velocity v = ref store.Velocities[StoreIndex];
+			v.V += store.InvMasses[StoreIndex] * impulse;
+			v.W += store.InvInertias[StoreIndex] * (point - store.Sweeps[StoreIndex].EndCenter).Cross(impulse);
+		}
 
-		public float Inertia { get; }
+		/// <summary>
+		/// Applies an impulse to the center of mass, immediately modifying the velocity.
+		/// </summary>
+		/// <param name="impulse">The world impulse vector, usually in N-seconds or kg-m/s</param>
+		/// <param name="wake">If the body should be woken</param>
+		public void ApplyLinearImpulseToCenter(Vector2 impulse, bool wake) {
+			if (!PrepareApply(wake)) return;
+			BodyStore store = World.Store;
+			store.Velocities[StoreIndex].V += store.InvMasses[StoreIndex] * impulse;
+		}
 
-		public MassData MassData { get; set; }
+		/// <summary>
+		/// Applies an angular impulse.
+		/// </summary>
+		/// <param name="impulse">The angular impulse in units of kg*m*m/s</param>
+		/// <param name="wake">If the body should be woken</param>
+		public void ApplyAngularImpulse(float impulse, bool wake) {
+			if (!PrepareApply(wake)) return;
+			BodyStore store = World.Store;
+			store.Velocities[StoreIndex].W += store.InvInertias[StoreIndex] * impulse;
+		}
+
+		/// <summary>
+		/// The total mass of the body, usually in kilograms.
+		/// </summary>
+		public float Mass { get; private set; }
+
+		/// <summary>
+		/// The rotational inertia of the body about its local origin, usually in kg-m^2.
+		/// </summary>
+		public float Inertia => rotationalInertia + Mass * Sweep.LocalCenter.Dot(Sweep.LocalCenter);
+
+		/// <summary>
+		/// The mass data of the body. Setting the mass data overrides the mass properties computed from the fixtures, and
+		/// only affects dynamic bodies.
+		/// </summary>
+		public MassData MassData {
+			get => new() {
+				Mass = Mass,
+				Inertia = Inertia,
+				Center = Sweep.LocalCenter
+			};
+			set {
+				World.CheckUnlocked();
+				if (type != BodyType.Dynamic) return;
+
+				float mass = value.Mass > 0 ? value.Mass : 1;
+				float invMass = 1 / mass;
+				float I = 0, invI = 0;
+				if (value.Inertia > 0 && (Flags & BodyFlags.FixedRotation) == 0) {
+					I = value.Inertia - mass * value.Center.Dot(value.Center);
+					Debug.Assert(I > 0);
+					invI = 1 / I;
+				}
+				SetMass(mass, invMass, I, invI, value.Center);
+			}
+		}
 
+		/// <summary>
+		/// Resets the mass properties of the body to the sum of the mass properties of its fixtures. This normally does not
+		/// need to be called unless the mass data was overridden.
+		/// </summary>
 		public void ResetMassData() {
+			if (type != BodyType.Dynamic) {
+				// Static and kinematic bodies have zero mass
+				ref Sweep sweep = ref Sweep;
+				Mass = 0;
+				rotationalInertia = 0;
+				World.Store.InvMasses[StoreIndex] = 0;
+				World.Store.InvInertias[StoreIndex] = 0;
+				sweep.LocalCenter = Vector2.Zero;
+				sweep.StartCenter = sweep.EndCenter = Transform.Position;
+				sweep.StartAngle = sweep.EndAngle;
+				return;
+			}
 
-		}
+			// Accumulate mass over all fixtures
+			float mass = 0, I = 0;
+			Vector2 localCenter = Vector2.Zero;
+			for (Fixture? f = FixtureList; f != null; f = f.Next) {
+				if (f.Density == 0) continue;
+				MassData massData = f.GetMassData();
+				mass += massData.Mass;
+				localCenter += massData.Mass * massData.Center;
+				I += massData.Inertia;
+			}
 
-		public Vector2 GetWorldPoint(Vector2 localPoint) {
+			float invMass = 0, invI = 0;
+			if (mass > 0) {
+				invMass = 1 / mass;
+				localCenter *= invMass;
+			}
 
-		}
+			if (I > 0 && (Flags & BodyFlags.FixedRotation) == 0) {
+				// Center the inertia about the center of mass
+				I -= mass * localCenter.Dot(localCenter);
+				Debug.Assert(I > 0);
+				invI = 1 / I;
+			} else {
+				I = 0;
+				invI = 0;
+			}
 
-		public Vector2 GetWorldVector(Vector2 localVector) {
+			SetMass(mass, invMass, I, invI, localCenter);
+		}
 
+		// Applies new mass properties, moving the center of mass and updating the velocity of the new center of mass
+		private void SetMass(float mass, float invMass, float I, float invI, Vector2 localCenter) {
+			BodyStore store = World.Store;
+			Mass = mass;
+			rotationalInertia = I;
+			store.InvMasses[StoreIndex] = invMass;
+			store.InvInertias[StoreIndex] = invI;
+
+			ref Sweep sweep = ref store.Sweeps[StoreIndex];
+			Vector2 oldCenter = sweep.EndCenter;
+			sweep.LocalCenter = localCenter;
+			sweep.StartCenter = sweep.EndCenter = store.Transforms[StoreIndex] * localCenter;
+
+			ref Velocity v = ref store.Velocities[StoreIndex];
+			v.V += (sweep.EndCenter - oldCenter).CrossT(v.W);
 		}
 
-		public Vector2 GetLocalPoint(Vector2 worldPoint) {
+		public Vector2 GetWorldPoint(Vector2 localPoint) => Transform * localPoint;
 
-		}
+		public Vector2 GetWorldVector(Vector2 localVector) => Transform.Rotation * localVector;
 
-		public Vector2 GetLocalVector(Vector2 worldVector) {
+		public Vector2 GetLocalPoint(Vector2 worldPoint) => Transform.MulT(worldPoint);
 
-		}
+		public Vector2 GetLocalVector(Vector2 worldVector) => Transform.Rotation.MulT(worldVector);
 
 		public Vector2 GetLinearVelocityFromWorldPoint(Vector2 worldPoint) {
-
+			Velocity v = World.Store.Velocities[StoreIndex];
+			return v.V + (worldPoint - Sweep.EndCenter).CrossT(v.W);
 		}
 
-		public Vector2 GetLinearVelocityFromLocalPoint(Vector2 localPoint) {
+		public Vector2 GetLinearVelocityFromLocalPoint(Vector2 localPoint) => GetLinearVelocityFromWorldPoint(GetWorldPoint(localPoint));
 
+		public float LinearDampening {
+			get => World.Store.LinearDampings[StoreIndex];
+			set => World.Store.LinearDampings[StoreIndex] = value;
 		}
 
-		public float LinearDampening { get; set; }
-
-		public float AngularDampening { get; set; }
+		public float AngularDampening {
+			get => World.Store.AngularDampings[StoreIndex];
+			set => World.Store.AngularDampings[StoreIndex] = value;
+		}
 
-		public float GravityScale { get; set; }
+		public float GravityScale {
+			get => World.Store.GravityScales[StoreIndex];
+			set => World.Store.GravityScales[StoreIndex] = value;
+		}
 
 		private BodyType type;
+		/// <summary>
+		/// The type of this body. Changing the type resets the mass and destroys any attached contacts.
+		/// </summary>
 		public BodyType Type {
 			get => type;
 			set {
-				if (world)
+				World.CheckUnlocked();
+				if (type == value) return;
+				type = value;
+
+				ResetMassData();
+
+				BodyStore store = World.Store;
+				if (type == BodyType.Static) {
+					store.Velocities[StoreIndex] = default;
+					ref Sweep sweep = ref store.Sweeps[StoreIndex];
+					sweep.StartAngle = sweep.EndAngle;
+					sweep.StartCenter = sweep.EndCenter;
+					Flags &= ~BodyFlags.Awake;
+					SynchronizeFixtures();
+				}
+
+				IsAwake = true;
+
+				store.Forces[StoreIndex] = Vector2.Zero;
+				store.Torques[StoreIndex] = 0;
+
+				// Delete the attached contacts
+				DestroyContacts();
+
+				// Touch the proxies so that new contacts will be created (when appropriate)
+				BroadPhase broadPhase = World.ContactManager.BroadPhase;
+				for (Fixture? f = FixtureList; f != null; f = f.Next) {
+					for (int i = 0; i < f.ProxyCount; i++) broadPhase.TouchProxy(f.Proxies[i].ProxyID);
+				}
 			}
 		}
 
-		public bool IsBullet { get; set; }
-
-		public bool IsSleepingAllowed { get; set; }
-
-		public bool IsAwake { get; set; }
-
-		public bool IsEnabled { get; set; }
+		/// <summary>
+		/// If this body should be treated like a bullet for continuous collision detection against other dynamic bodies.
+		/// </summary>
+		public bool IsBullet {
+			get => (Flags & BodyFlags.Bullet) != 0;
+			set {
+				if (value) Flags |= BodyFlags.Bullet;
+				else Flags &= ~BodyFlags.Bullet;
+			}
+		}
 
-		public bool IsFixedRotation { get; set; }
+		/// <summary>
+		/// If this body is allowed to sleep. Disallowing sleep wakes the body.
+		/// </summary>
+		public bool IsSleepingAllowed {
+			get => (Flags & BodyFlags.AutoSleep) != 0;
+			set {
+				if (value) Flags |= BodyFlags.AutoSleep;
+				else {
+					Flags &= ~BodyFlags.AutoSleep;
+					IsAwake = true;
+				}
+			}
+		}
 
-		public Fixture? FixtureList { get; }
+		/// <summary>
+		/// If this body is awake. A sleeping body has very little CPU cost, and putting a body to sleep clears its velocity
+		/// and accumulated forces.
+		/// </summary>
+		public bool IsAwake {
+			get => (Flags & BodyFlags.Awake) != 0;
+			set {
+				if (type == BodyType.Static) return;
+				BodyStore store = World.Store;
+				if (value) {
+					Flags |= BodyFlags.Awake;
+					store.SleepTimes[StoreIndex] = 0;
+				} else {
+					Flags &= ~BodyFlags.Awake;
+					store.SleepTimes[StoreIndex] = 0;
+					store.Velocities[StoreIndex] = default;
+					store.Forces[StoreIndex] = Vector2.Zero;
+					store.Torques[StoreIndex] = 0;
+				}
+			}
+		}
 
-		public JointEdge? JointList { get; } = null;
+		/// <summary>
+		/// If this body is enabled. A disabled body is not simulated and cannot be collided with or woken up, and its fixtures
+		/// are removed from the broad-phase.
+		/// </summary>
+		public bool IsEnabled {
+			get => (Flags & BodyFlags.Enabled) != 0;
+			set {
+				World.CheckUnlocked();
+				if (value == IsEnabled) return;
+
+				BroadPhase broadPhase = World.ContactManager.BroadPhase;
+				if (value) {
+					Flags |= BodyFlags.Enabled;
+
+					// Create all proxies, contacts are created the next time step
+					Transform xf = Transform;
+					for (Fixture? f = FixtureList; f != null; f = f.Next) f.CreateProxies(broadPhase, xf);
+					World.NewContacts = true;
+				} else {
+					Flags &= ~BodyFlags.Enabled;
+
+					// Destroy all proxies and contacts
+					for (Fixture? f = FixtureList; f != null; f = f.Next) f.DestroyProxies(broadPhase);
+					DestroyContacts();
+				}
+			}
+		}
 
-		public ContactEdge? ContactList { get; } = null;
+		/// <summary>
+		/// If this body has fixed rotation. Setting this causes the mass to be reset.
+		/// </summary>
+		public bool IsFixedRotation {
+			get => (Flags & BodyFlags.FixedRotation) != 0;
+			set {
+				if (value == IsFixedRotation) return;
+				if (value) Flags |= BodyFlags.FixedRotation;
+				else Flags &= ~BodyFlags.FixedRotation;
 
-		public Body? Next { get; } = null;
+				World.Store.Velocities[StoreIndex].W = 0;
+				ResetMassData();
+			}
+		}
 
+		/// <summary>
+		/// The first fixture in the list of fixtures attached to this body.
+		/// </summary>
+		public Fixture? FixtureList { get; private set; }
+
+		/// <summary>
+		/// The number of fixtures attached to this body.
+		/// </summary>
+		public int FixtureCount { get; private set; }
+
+		/// <summary>
+		/// The first edge in the list of joints attached to this body.
+		/// </summary>
+		public JointEdge? JointList { get; internal set; } = null;
+
+		/// <summary>
+		/// The first edge in the list of contacts involving this body.
+		/// </summary>
+		public ContactEdge? ContactList { get; internal set; } = null;
+
+		/// <summary>
+		/// The world this body belongs to.
+		/// </summary>
 		public World World { get; }
 
 		[Flags]
@@ -168,10 +573,27 @@ namespace Tesseract.Box2D.NET {
 		}
 
 		internal BodyFlags Flags = 0;
-		internal Sweep Sweep = default;
-		internal Body? Prev = null;
 
-		internal Body(BodyDef def, World world) {
+		/// <summary>
+		/// The index of this body's slot in the world's body store.
+		/// </summary>
+		internal int StoreIndex;
+
+		/// <summary>
+		/// The swept motion of this body for the current step.
+		/// </summary>
+		internal ref Sweep Sweep => ref World.Store.Sweeps[StoreIndex];
+
+		internal float InvMass => World.Store.InvMasses[StoreIndex];
+
+		internal float InvI => World.Store.InvInertias[StoreIndex];
+
+		internal int IslandIndex;
+
+		// Rotational inertia about the center of mass
+		private float rotationalInertia;
+
+		internal Body(BodyDef def, World world, int storeIndex) {
 			Debug.Assert(def.Position.IsValid());
 			Debug.Assert(def.LinearVelocity.IsValid());
 			Debug.Assert(Box2D.IsValid(def.Angle));
@@ -186,39 +608,89 @@ namespace Tesseract.Box2D.NET {
 			if (def.Enabled) Flags |= BodyFlags.Enabled;
 
 			World = world;
+			StoreIndex = storeIndex;
+			type = def.Type;
 
-			Transform = new Transform(def.Position, def.Angle);
-			Sweep = new() { 
+			BodyStore store = world.Store;
+			Transform xf = new(def.Position, def.Angle);
+			store.Transforms[storeIndex] = xf;
+			store.Sweeps[storeIndex] = new() {
 				LocalCenter = Vector2.Zero,
-				StartCenter = Transform.Position,
-				EndCenter = Transform.Position,
-				StartAngle = Transform.Rotation.Angle,
-				EndAngle = Transform.Rotation.Angle,
+				StartCenter = xf.Position,
+				EndCenter = xf.Position,
+				StartAngle = def.Angle,
+				EndAngle = def.Angle,
 				StartAlpha = 0
 			};
-			
+			store.Velocities[storeIndex] = new() { V = def.LinearVelocity, W = def.AngularVelocity };
+			store.LinearDampings[storeIndex] = def.LinearDampening;
+			store.AngularDampings[storeIndex] = def.AngularDampening;
+			store.GravityScales[storeIndex] = def.GravityScale;
+
+			if (type == BodyType.Dynamic) {
+				Mass = 1;
+				store.InvMasses[storeIndex] = 1;
+			}
 		}
 
-		internal void SynchronizeFixtures() {
+		// Destroys every contact involving this body
+		internal void DestroyContacts() {
+			ContactEdge? edge = ContactList;
+			while (edge != null) {
+				ContactEdge edge0 = edge;
+				edge = edge.Next;
+				World.ContactManager.Destroy(edge0.Contact);
+			}
+			ContactList = null;
+		}
 
+		internal void SynchronizeFixtures() {
+			BodyStore store = World.Store;
+			ref Transform xf = ref store.Transforms[StoreIndex];
+			BroadPhase broadPhase = World.ContactManager.BroadPhase;
+
+			if ((Flags & BodyFlags.Awake) != 0) {
+				ref Sweep sweep = ref store.Sweeps[StoreIndex];
+				Transform xf1 = new() { Rotation = sweep.StartAngle };
+				xf1.Position = sweep.StartCenter - xf1.Rotation * sweep.LocalCenter;
+
+				for (Fixture? f = FixtureList; f != null; f = f.Next) f.Synchronize(broadPhase, xf1, xf);
+			} else {
+				for (Fixture? f = FixtureList; f != null; f = f.Next) f.Synchronize(broadPhase, xf, xf);
+			}
 		}
 
 		internal void SynchronizeTransform() {
-
+			BodyStore store = World.Store;
+			ref Sweep sweep = ref store.Sweeps[StoreIndex];
+			Rotation q = sweep.EndAngle;
+			store.Transforms[StoreIndex] = new Transform() {
+				Rotation = q,
+				Position = sweep.EndCenter - q * sweep.LocalCenter
+			};
 		}
 
+		// This is used to prevent connected bodies from colliding. It may lie, depending on the collideConnected flag.
 		internal bool ShouldCollide(Body other) {
+			// At least one body should be dynamic
+			if (type != BodyType.Dynamic && other.type != BodyType.Dynamic) return false;
 
-		}
-
-		internal void Advance(float t) {
+			// Does a joint prevent collision?
+			for (JointEdge? jn = JointList; jn != null; jn = jn.Next) {
+				if (jn.Other == other && !jn.Joint.IsCollideConnected) return false;
+			}
 
+			return true;
 		}
 
-		internal int IslandIndex;
-
-		internal float InvMass;
-		internal float InvI;
+		// Advances to the new safe time, without synchronizing the broad-phase
+		internal void Advance(float alpha) {
+			ref Sweep sweep = ref Sweep;
+			sweep.Advance(alpha);
+			sweep.EndCenter = sweep.StartCenter;
+			sweep.EndAngle = sweep.StartAngle;
+			SynchronizeTransform();
+		}
 
 	}
 
@@ -0,0 +1,111 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Numerics;
+using System.Text;
+using System.Threading.Tasks;
+
+namespace Tesseract.Box2D.NET {
+
+	/// <summary>
+	/// <para>
+	/// Contiguous storage for the per-body state read and written while stepping a world. Each body owns one slot, given
+	/// by <see cref="Body.StoreIndex"/>, in a set of parallel arrays, so the solver walks flat arrays of structs instead
+	/// of following references between body objects.
+	/// </para>
+	/// <para>
+	/// Slots are kept dense; removing a body moves the last slot into its place, and the owner is responsible for updating
+	/// the store index of the moved body.
+	/// </para>
+	/// </summary>
+	internal sealed class BodyStore {
+
+		private const int InitialCapacity = 16;
+
+		public Transform[] Transforms = new Transform[InitialCapacity];
+		public Sweep[] Sweeps = new Sweep[InitialCapacity];
+		public Velocity[] Velocities = new Velocity[InitialCapacity];
+		public Vector2[] Forces = new Vector2[InitialCapacity];
+		public float[] Torques = new float[InitialCapacity];
+		public float[] SleepTimes = new float[InitialCapacity];
+
+		public float[] InvMasses = new float[InitialCapacity];
+		public float[] InvInertias = new float[InitialCapacity];
+		public float[] LinearDampings = new float[InitialCapacity];
+		public float[] AngularDampings = new float[InitialCapacity];
+		public float[] GravityScales = new float[InitialCapacity];
+
+		/// <summary>
+		/// The number of occupied slots.
+		/// </summary>
+		public int Count { get; private set; }
+
+		/// <summary>
+		/// Allocates a new zeroed slot at the end of the store.
+		/// </summary>
+		/// <returns>The index of the new slot</returns>
+		public int Add() {
+			if (Count == Transforms.Length) Resize(Count * 2);
+			int index = Count++;
+			Transforms[index] = new Transform();
+			Sweeps[index] = default;
+			Velocities[index] = default;
+			Forces[index] = Vector2.Zero;
+			Torques[index] = 0;
+			SleepTimes[index] = 0;
+			InvMasses[index] = 0;
+			InvInertias[index] = 0;
+			LinearDampings[index] = 0;
+			AngularDampings[index] = 0;
+			GravityScales[index] = 1;
+			return index;
+		}
+
+		/// <summary>
+		/// Removes a slot, moving the last slot into its place.
+		/// </summary>
+		/// <param name="index">The index of the slot to remove</param>
+		/// <returns>The previous index of the slot moved into the removed slot, or the removed index if it was the last slot</returns>
+		public int RemoveAt(int index) {
+			int last = --Count;
+			if (index != last) {
+				Transforms[index] = Transforms[last];
+				Sweeps[index] = Sweeps[last];
+				Velocities[index] = Velocities[last];
+				Forces[index] = Forces[last];
+				Torques[index] = Torques[last];
+				SleepTimes[index] = SleepTimes[last];
+				InvMasses[index] = InvMasses[last];
+				InvInertias[index] = InvInertias[last];
+				LinearDampings[index] = LinearDampings[last];
+				AngularDampings[index] = AngularDampings[last];
+				GravityScales[index] = GravityScales[last];
+			}
+			return last;
+		}
+
+		/// <summary>
+		/// Clears the accumulated forces and torques of every body.
+		/// </summary>
+		public void ClearForces() {
+			Array.Clear(Forces, 0, Count);
+			Array.Clear(Torques, 0, Count);
+		}
+
+		private void Resize(int capacity) {
+			Array.Resize(ref Transforms, capacity);
+			Array.Resize(ref Sweeps, capacity);
+			Array.Resize(ref Velocities, capacity);
+			Array.Resize(ref Forces, capacity);
+			Array.Resize(ref Torques, capacity);
+			Array.Resize(ref SleepTimes, capacity);
+			Array.Resize(ref InvMasses, capacity);
+			Array.Resize(ref InvInertias, capacity);
+			Array.Resize(ref LinearDampings, capacity);
+			Array.Resize(ref AngularDampings, capacity);
+			Array.Resize(ref GravityScales, capacity);
+		}
+
+	}
+
+}
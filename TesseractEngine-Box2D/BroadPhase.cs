@@ -1,15 +1,278 @@
 ﻿using System;
 using System.Collections.Generic;
 using System.Linq;
+using System.Numerics;
 using System.Text;
 using System.Threading.Tasks;
 
 namespace Tesseract.Box2D.NET {
-	
+
+	/// <summary>
+	/// Callback receiving the new pairs found by <see cref="BroadPhase.UpdatePairs{TCallback}(ref TCallback)"/>.
+	/// </summary>
+	public interface IPairCallback {
+
+		/// <summary>
+		/// Called for a pair of proxies which may have started overlapping.
+		/// </summary>
+		/// <param name="proxyA">The first proxy</param>
+		/// <param name="proxyB">The second proxy</param>
+		public void AddPair(in FixtureProxy proxyA, in FixtureProxy proxyB);
+
+	}
+
+	// Adapts a delegate to a pair callback
+	internal struct DelegatePairCallback : IPairCallback {
+
+		public Action<FixtureProxy, FixtureProxy> Callback;
+
+		public void AddPair(in FixtureProxy proxyA, in FixtureProxy proxyB) => Callback(proxyA, proxyB);
+
+	}
+
+	/// <summary>
+	/// <para>
+	/// The broad-phase is used for computing pairs and performing volume queries and ray casts. It does not persist pairs,
+	/// instead it reports potentially new pairs for proxies which have moved since the last update.
+	/// </para>
+	/// <para>
+	/// Updating pairs does not allocate once its buffers have grown to fit the scene. Pairs are gathered into a buffer which
+	/// is sorted and deduplicated before being reported, and all queries use struct callbacks so they are specialized by
+	/// the JIT instead of invoking a delegate per leaf.
+	/// </para>
+	/// </summary>
 	public class BroadPhase {
 
 		internal const int NullProxy = -1;
 
+		private readonly DynamicTree<FixtureProxy> tree = new();
+
+		// Proxies which have moved or been created since the last pair update
+		private readonly List<int> moveBuffer = new();
+
+		// A pair of proxy IDs, ordered so the lower ID is first
+		private readonly struct ProxyPair : IComparable<ProxyPair>, IEquatable<ProxyPair> {
+
+			public readonly int ProxyA;
+			public readonly int ProxyB;
+
+			public ProxyPair(int proxyA, int proxyB) {
+				ProxyA = Math.Min(proxyA, proxyB);
+				ProxyB = Math.Max(proxyA, proxyB);
+			}
+
+			public int CompareTo(ProxyPair other) {
+				int cmp = ProxyA.CompareTo(other.ProxyA);
+				return cmp != 0 ? cmp : ProxyB.CompareTo(other.ProxyB);
+			}
+
+			public bool Equals(ProxyPair other) => ProxyA == other.ProxyA && ProxyB == other.ProxyB;
+
+		}
+
+		// Pairs of overlapping proxies found during the current pair update
+		private ProxyPair[] pairBuffer = new ProxyPair[16];
+		private int pairCount = 0;
+
+		// Query callback gathering the pairs formed by a moved proxy
+		private struct PairQueryCallback : IQueryCallback {
+
+			public BroadPhase BroadPhase;
+			public int QueryProxyId;
+
+			public bool QueryCallback(int proxyId) {
+				// A proxy cannot form a pair with itself
+				if (proxyId == QueryProxyId) return true;
+
+				// Both proxies are moving, avoid duplicate pairs by only adding the pair from the proxy with the lower ID
+				if (proxyId > QueryProxyId && BroadPhase.tree.WasMoved(proxyId)) return true;
+
+				BroadPhase.AddPair(new ProxyPair(proxyId, QueryProxyId));
+				return true;
+			}
+
+		}
+
+		private void AddPair(ProxyPair pair) {
+			if (pairCount == pairBuffer.Length) Array.Resize(ref pairBuffer, pairBuffer.Length * 2);
+			pairBuffer[pairCount++] = pair;
+		}
+
+		/// <summary>
+		/// The number of proxies in the broad-phase.
+		/// </summary>
+		public int ProxyCount { get; private set; }
+
+		/// <summary>
+		/// The height of the embedded tree.
+		/// </summary>
+		public int TreeHeight => tree.Height;
+
+		/// <summary>
+		/// The balance of the embedded tree.
+		/// </summary>
+		public int TreeBalance => tree.MaxBalance;
+
+		/// <summary>
+		/// The quality metric of the embedded tree.
+		/// </summary>
+		public float TreeQuality => tree.AreaRatio;
+
+		/// <summary>
+		/// Creates a proxy with an initial AABB. Pairs are not reported until <see cref="UpdatePairs{TCallback}(ref TCallback)"/> is called.
+		/// </summary>
+		/// <param name="aabb">The initial bounds of the proxy</param>
+		/// <param name="userData">The fixture proxy the proxy represents</param>
+		/// <returns>The ID of the new proxy</returns>
+		public int CreateProxy(AABB aabb, FixtureProxy userData) {
+			int proxyId = tree.CreateProxy(aabb, userData);
+			ProxyCount++;
+			BufferMove(proxyId);
+			return proxyId;
+		}
+
+		/// <summary>
+		/// Destroys a proxy. It is up to the client to remove any pairs.
+		/// </summary>
+		/// <param name="proxyId">The ID of the proxy to destroy</param>
+		public void DestroyProxy(int proxyId) {
+			UnBufferMove(proxyId);
+			ProxyCount--;
+			tree.DestroyProxy(proxyId);
+		}
+
+		/// <summary>
+		/// Moves a proxy. Any number of moves may be made between pair updates.
+		/// </summary>
+		/// <param name="proxyId">The ID of the proxy to move</param>
+		/// <param name="aabb">The new bounds of the proxy</param>
+		/// <param name="displacement">The displacement of the proxy, used to predict its future bounds</param>
+		public void MoveProxy(int proxyId, AABB aabb, Vector2 displacement) {
+			if (tree.MoveProxy(proxyId, aabb, displacement)) BufferMove(proxyId);
+		}
+
+		/// <summary>
+		/// Forces a proxy to be checked for new pairs on the next update.
+		/// </summary>
+		/// <param name="proxyId">The ID of the proxy</param>
+		public void TouchProxy(int proxyId) => BufferMove(proxyId);
+
+		/// <summary>
+		/// Gets the fattened AABB stored for a proxy.
+		/// </summary>
+		/// <param name="proxyId">The ID of the proxy</param>
+		/// <returns>The fattened bounds of the proxy</returns>
+		public AABB GetFatAABB(int proxyId) => tree.GetFatAABB(proxyId);
+
+		/// <summary>
+		/// Gets the fixture proxy associated with a proxy.
+		/// </summary>
+		/// <param name="proxyId">The ID of the proxy</param>
+		/// <returns>The associated fixture proxy</returns>
+		public FixtureProxy GetUserData(int proxyId) => tree.GetUserData(proxyId);
+
+		/// <summary>
+		/// Tests if the fattened AABBs of two proxies overlap.
+		/// </summary>
+		/// <param name="proxyIdA">The first proxy</param>
+		/// <param name="proxyIdB">The second proxy</param>
+		/// <returns>If the proxies overlap</returns>
+		public bool TestOverlap(int proxyIdA, int proxyIdB) => Box2D.TestOverlap(tree.GetFatAABB(proxyIdA), tree.GetFatAABB(proxyIdB));
+
+		private void BufferMove(int proxyId) => moveBuffer.Add(proxyId);
+
+		private void UnBufferMove(int proxyId) {
+			for (int i = 0; i < moveBuffer.Count; i++) {
+				if (moveBuffer[i] == proxyId) moveBuffer[i] = NullProxy;
+			}
+		}
+
+		/// <summary>
+		/// Finds the pairs of overlapping proxies involving proxies which have moved since the last update, and reports
+		/// each pair once to the given callback. Pairs are reported in order of their proxy IDs.
+		/// </summary>
+		/// <param name="callback">The callback to report each new pair to</param>
+		public void UpdatePairs(Action<FixtureProxy, FixtureProxy> callback) {
+			DelegatePairCallback wrapper = new() { Callback = callback };
+			UpdatePairs(ref wrapper);
+		}
+
+		/// <summary>
+		/// Finds the pairs of overlapping proxies involving proxies which have moved since the last update, and reports
+		/// each pair once to the given callback. Pairs are reported in order of their proxy IDs.
+		/// </summary>
+		/// <typeparam name="TCallback">The callback type</typeparam>
+		/// <param name="callback">The callback to report each new pair to</param>
+		public void UpdatePairs<TCallback>(ref TCallback callback) where TCallback : struct, IPairCallback {
+			pairCount = 0;
+
+			// Perform tree queries for all moving proxies
+			PairQueryCallback query = new() { BroadPhase = this };
+			foreach (int proxyId in moveBuffer) {
+				if (proxyId == NullProxy) continue;
+				query.QueryProxyId = proxyId;
+
+				// We have to query the tree with the fat AABB so that we don't fail to create a pair that may touch later
+				tree.Query(ref query, tree.GetFatAABB(proxyId));
+			}
+
+			// Sort the pairs so duplicates are adjacent, a proxy may be buffered more than once between updates
+			Span<ProxyPair> pairs = pairBuffer.AsSpan(0, pairCount);
+			pairs.Sort();
+
+			// Send unique pairs to the caller
+			for (int i = 0; i < pairs.Length; i++) {
+				ProxyPair pair = pairs[i];
+				if (i > 0 && pair.Equals(pairs[i - 1])) continue;
+				callback.AddPair(tree.GetUserData(pair.ProxyA), tree.GetUserData(pair.ProxyB));
+			}
+
+			// Clear move flags
+			foreach (int proxyId in moveBuffer) {
+				if (proxyId != NullProxy) tree.ClearMoved(proxyId);
+			}
+
+			// Reset move buffer
+			moveBuffer.Clear();
+		}
+
+		/// <summary>
+		/// Queries the proxies overlapping an AABB.
+		/// </summary>
+		/// <param name="callback">Callback invoked with each overlapping proxy ID, returning false to terminate the query</param>
+		/// <param name="aabb">The bounds to query</param>
+		public void Query(Func<int, bool> callback, AABB aabb) => tree.Query(callback, aabb);
+
+		/// <summary>
+		/// Queries the proxies overlapping an AABB using a struct callback.
+		/// </summary>
+		/// <typeparam name="TCallback">The callback type</typeparam>
+		/// <param name="callback">The callback invoked with each overlapping proxy ID</param>
+		/// <param name="aabb">The bounds to query</param>
+		public void Query<TCallback>(ref TCallback callback, in AABB aabb) where TCallback : struct, IQueryCallback => tree.Query(ref callback, aabb);
+
+		/// <summary>
+		/// Casts a ray against the proxies in the broad-phase.
+		/// </summary>
+		/// <param name="callback">Callback invoked with each proxy ID the ray may hit, returning the new maximum fraction
+		/// of the ray, 0 to terminate the cast, or -1 to ignore the proxy</param>
+		/// <param name="input">The ray to cast</param>
+		public void RayCast(Func<RayCastInput, int, float> callback, in RayCastInput input) => tree.RayCast(callback, input);
+
+		/// <summary>
+		/// Casts a ray against the proxies in the broad-phase using a struct callback.
+		/// </summary>
+		/// <typeparam name="TCallback">The callback type</typeparam>
+		/// <param name="callback">The callback invoked with each proxy ID the ray may hit</param>
+		/// <param name="input">The ray to cast</param>
+		public void RayCast<TCallback>(ref TCallback callback, in RayCastInput input) where TCallback : struct, IRayCastCallback => tree.RayCast(ref callback, input);
+
+		/// <summary>
+		/// Shifts the world origin of every proxy.
+		/// </summary>
+		/// <param name="newOrigin">The new origin relative to the old origin</param>
+		public void ShiftOrigin(Vector2 newOrigin) => tree.ShiftOrigin(newOrigin);
+
 	}
 
 }
@@ -29,7 +29,10 @@ namespace Tesseract.Box2D.NET {
 
 		public ContactFeature Feature { get; init; }
 
-		public uint Key { get; init; }
+		/// <summary>
+		/// The contact feature packed into a single value, used to match contact points between steps.
+		/// </summary>
+		public uint Key => (uint)(Feature.IndexA | (Feature.IndexB << 8) | ((int)Feature.TypeA << 16) | ((int)Feature.TypeB << 24));
 
 	}
 
@@ -270,12 +273,12 @@ namespace Tesseract.Box2D.NET {
 				}
 			}
 
-			for (int i = 0; i < manifold1.PointCount; i++) {
+			for (int i = 0; i < manifold2.PointCount; i++) {
 				ContactID id = manifold2.Points[i].ID;
 				state2[i] = PointState.Add;
 				for (int j = 0; j < manifold1.PointCount; j++) {
 					if (manifold1.Points[j].ID.Key == id.Key) {
-						state1[i] = PointState.Persist;
+						state2[i] = PointState.Persist;
 						break;
 					}
 				}
@@ -600,7 +603,7 @@ namespace Tesseract.Box2D.NET {
 			float u = e.Dot(B - Q);
 			float v = e.Dot(Q - A);
 
-			float radius = edgeA.Radius - circleB.Radius;
+			float radius = edgeA.Radius + circleB.Radius;
 
 			ContactFeature cf = new() { IndexB = 0, TypeB = ContactFeatureType.Vertex };
 
@@ -631,10 +634,39 @@ namespace Tesseract.Box2D.NET {
 					LocalPoint = P,
 					Points = new ManifoldPoint[] {
 						new() {
-							ID = new() {
-								Key = 0,
-								Feature = cf
-							},
+							ID = new() { Feature = cf },
+							LocalPoint = circleB.Position
+						}
+					}
+				};
+			}
+
+			if (u <= 0) {
+				P = B;
+				d = Q - P;
+				dd = d.Dot(d);
+				if (dd > radius * radius) return default;
+
+				if (edgeA.OneSided) {
+					Vector2 B2 = edgeA.Vertex3;
+					Vector2 A2 = B;
+					Vector2 e2 = B2 - A2;
+					float v2 = e2.Dot(Q - A2);
+					if (v2 > 0) return default;
+				}
+
+				cf = cf with {
+					IndexA = 1,
+					TypeA = ContactFeatureType.Vertex
+				};
+				return new Manifold() {
+					PointCount = 1,
+					Type = ManifoldType.Circles,
+					LocalNormal = Vector2.Zero,
+					LocalPoint = P,
+					Points = new ManifoldPoint[] {
+						new() {
+							ID = new() { Feature = cf },
 							LocalPoint = circleB.Position
 						}
 					}
@@ -661,10 +693,7 @@ namespace Tesseract.Box2D.NET {
 				LocalPoint = A,
 				Points = new ManifoldPoint[] {
 					new() {
-						ID = new() {
-							Key = 0,
-							Feature = cf
-						},
+						ID = new() { Feature = cf },
 						LocalPoint = circleB.Position
 					}
 				}
@@ -778,11 +807,16 @@ namespace Tesseract.Box2D.NET {
 			bool oneSided = edgeA.OneSided;
 			if (oneSided && offset1 < 0) return default;
 
+			int countB = polygonB.Vertices.Length;
 			TempPolygon tempPolygonB = new() {
-				Count = polygonB.Vertices.Length,
-				Vertices = polygonB.Vertices,
-				Normals = polygonB.Normals
+				Count = countB,
+				Vertices = stackalloc Vector2[countB],
+				Normals = stackalloc Vector2[countB]
 			};
+			for (int i = 0; i < countB; i++) {
+				tempPolygonB.Vertices[i] = xf * polygonB.Vertices[i];
+				tempPolygonB.Normals[i] = xf.Rotation * polygonB.Normals[i];
+			}
 
 			float radius = polygonB.Radius + edgeA.Radius;
 
@@ -814,12 +848,11 @@ namespace Tesseract.Box2D.NET {
 				if (side1) {
 					if (convex1) {
 						if (primaryAxis.Normal.Cross(normal0) > SinTol) return default;
-						else primaryAxis = edgeAxis;
-					} else {
-						if (convex2) {
-							if (normal2.Cross(primaryAxis.Normal) > SinTol) return default;
-						} else primaryAxis = edgeAxis;
-					}
+					} else primaryAxis = edgeAxis;
+				} else {
+					if (convex2) {
+						if (normal2.Cross(primaryAxis.Normal) > SinTol) return default;
+					} else primaryAxis = edgeAxis;
 				}
 			}
 
@@ -955,6 +988,7 @@ namespace Tesseract.Box2D.NET {
 							ID = clipPoints2[i].ID
 						};
 					}
+					pointCount++;
 				}
 			}
 
@@ -5,6 +5,7 @@ using System.Numerics;
 using System.Text;
 using System.Threading.Tasks;
 using System.Runtime.InteropServices;
+using Tesseract.Core.Collections;
 using Tesseract.Core.Numerics;
 using Tesseract.Core.Utilities;
 
@@ -58,11 +59,12 @@ namespace Tesseract.Box2D.NET {
 					break;
 				case ShapeType.Edge:
 					EdgeShape edge = (EdgeShape)shape;
-					if (buffer.Length < 1) buffer = new Vector2[] { edge.Vertex1, edge.Vertex2 };
+					if (buffer.Length < 2) buffer = new Vector2[] { edge.Vertex1, edge.Vertex2 };
 					else {
 						buffer[0] = edge.Vertex1;
 						buffer[1] = edge.Vertex2;
 					}
+					Vertices = buffer;
 					Count = 2;
 					Radius = edge.Radius;
 					break;
@@ -259,7 +261,7 @@ namespace Tesseract.Box2D.NET {
 				V1.A * V1.WA + V2.A * V2.WA,
 				V1.A * V1.WB + V2.A * V2.WB
 			),
-			3 => Collections.TupleDup2(V1.A * V1.WA + V2.A * V2.WA + V3.A * V3.WA),
+			3 => Collection.TupleDup2(V1.A * V1.WA + V2.A * V2.WA + V3.A * V3.WA),
 			_ => throw new InvalidOperationException("Cannot get witness points for simplex with count <1 or >3"),
 		};
 
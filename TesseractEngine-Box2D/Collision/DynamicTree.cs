@@ -1,8 +1,11 @@
 ﻿using System;
+using System.Buffers;
 using System.Collections.Generic;
 using System.Diagnostics;
 using System.Linq;
 using System.Numerics;
+using System.Runtime.CompilerServices;
+using System.Runtime.Intrinsics;
 using System.Text;
 using System.Threading.Tasks;
 using Tesseract.Core.Numerics;
@@ -53,11 +56,58 @@ namespace Tesseract.Box2D.NET {
 
 	}
 
+	/// <summary>
+	/// Callback invoked for each leaf found by a <see cref="DynamicTree{T}"/> query.
+	/// </summary>
+	public interface IQueryCallback {
+
+		/// <summary>
+		/// Called for a leaf whose AABB overlaps the query.
+		/// </summary>
+		/// <param name="proxyId">The ID of the leaf</param>
+		/// <returns>If the query should continue</returns>
+		public bool QueryCallback(int proxyId);
+
+	}
+
+	/// <summary>
+	/// Callback invoked for each leaf a ray cast against a <see cref="DynamicTree{T}"/> may hit.
+	/// </summary>
+	public interface IRayCastCallback {
+
+		/// <summary>
+		/// Called for a leaf whose AABB the ray may intersect.
+		/// </summary>
+		/// <param name="input">The ray, clipped to the current maximum fraction</param>
+		/// <param name="proxyId">The ID of the leaf</param>
+		/// <returns>The new maximum fraction of the ray, 0 to terminate the cast, or -1 to ignore the leaf</returns>
+		public float RayCastCallback(in RayCastInput input, int proxyId);
+
+	}
+
+	// Adapts a delegate to a query callback
+	internal struct DelegateQueryCallback : IQueryCallback {
+
+		public Func<int, bool> Callback;
+
+		public bool QueryCallback(int proxyId) => Callback(proxyId);
+
+	}
+
+	// Adapts a delegate to a ray cast callback
+	internal struct DelegateRayCastCallback : IRayCastCallback {
+
+		public Func<RayCastInput, int, float> Callback;
+
+		public float RayCastCallback(in RayCastInput input, int proxyId) => Callback(input, proxyId);
+
+	}
+
 	public class DynamicTree<T> {
 
 		public DynamicTree() {
 			root = Box2D.NullNode;
-			nodeCount = 16;
+			nodeCount = 0;
 			nodes = new TreeNode<T>[16];
 			for (int i = 0; i < nodes.Length - 1; i++) nodes[i] = new TreeNode<T>() { ParentOrNext = i + 1, Height = -1 };
 			nodes[^1] = new TreeNode<T>() { ParentOrNext = Box2D.NullNode, Height = -1 };
@@ -114,39 +164,69 @@ namespace Tesseract.Box2D.NET {
 
 		public AABB GetFatAABB(int proxyId) => nodes[proxyId].AABB;
 
-		public void Query(Func<int,bool> callback, AABB aabb) {
-			Stack<int> stack = new(256);
-			stack.Push(root);
-
-			while(stack.Count > 0) {
-				int nodeId = stack.Pop();
-				if (nodeId == Box2D.NullNode) continue;
+		/// <summary>
+		/// Queries the tree for every leaf whose AABB overlaps the given AABB. The callback is a struct so the query is
+		/// specialized for it and its calls can be inlined, and it is passed by reference so any state it accumulates is kept.
+		/// </summary>
+		/// <typeparam name="TCallback">The callback type</typeparam>
+		/// <param name="callback">The callback invoked for each overlapping leaf</param>
+		/// <param name="aabb">The bounds to query</param>
+		public void Query<TCallback>(ref TCallback callback, in AABB aabb) where TCallback : struct, IQueryCallback {
+			if (root == Box2D.NullNode || !Box2D.TestOverlap(nodes[root].AABB, aabb)) return;
+
+			Vector128<float> query = MakeOverlapQuery(aabb);
+			TraversalStack stack = new(stackalloc int[TraversalStackSize]);
+			try {
+				stack.Push(root);
+				while (stack.Count > 0) {
+					int nodeId = stack.Pop();
+					ref TreeNode<T> node = ref nodes[nodeId];
 
-				ref TreeNode<T> node = ref nodes[nodeId];
-				if (Box2D.TestOverlap(node.AABB, aabb)) {
 					if (node.IsLeaf) {
-						bool processed = callback(nodeId);
-						if (!processed) return;
+						if (!callback.QueryCallback(nodeId)) return;
 					} else {
-						stack.Push(node.Child1);
-						stack.Push(node.Child2);
+						// Children are tested before being pushed, so every node popped is known to overlap
+						int overlap = TestChildOverlap(node, query);
+						if ((overlap & 1) != 0) stack.Push(node.Child1);
+						if ((overlap & 2) != 0) stack.Push(node.Child2);
 					}
 				}
+			} finally {
+				stack.Dispose();
 			}
 		}
 
-		public void RayCast(Func<RayCastInput, int, float> callback, in RayCastInput input) {
+		/// <summary>
+		/// Queries the tree for every leaf whose AABB overlaps the given AABB.
+		/// </summary>
+		/// <param name="callback">The callback invoked for each overlapping leaf, returning false to terminate the query</param>
+		/// <param name="aabb">The bounds to query</param>
+		public void Query(Func<int,bool> callback, AABB aabb) {
+			DelegateQueryCallback wrapper = new() { Callback = callback };
+			Query(ref wrapper, aabb);
+		}
+
+		/// <summary>
+		/// Casts a ray against the leaves of the tree. The callback is a struct so the cast is specialized for it and its
+		/// calls can be inlined, and it is passed by reference so any state it accumulates is kept.
+		/// </summary>
+		/// <typeparam name="TCallback">The callback type</typeparam>
+		/// <param name="callback">The callback invoked for each leaf the ray may hit</param>
+		/// <param name="input">The ray to cast</param>
+		public void RayCast<TCallback>(ref TCallback callback, in RayCastInput input) where TCallback : struct, IRayCastCallback {
 			Vector2 p1 = input.P1;
 			Vector2 p2 = input.P2;
 			Vector2 r = p2 - p1;
 			if (r.LengthSquared() == 0) throw new ArgumentException("Cannot cast ray of zero length", nameof(input));
 			r = r.Normalize();
 
+			// v is perpendicular to the segment
 			Vector2 v = r.CrossT(1);
 			Vector2 abs_v = v.Abs();
 
 			float maxFraction = input.MaxFraction;
-			
+
+			// Build a bounding box for the segment
 			AABB segmentAABB;
 			{
 				Vector2 t = p1 + maxFraction * (p2 - p1);
@@ -156,40 +236,127 @@ namespace Tesseract.Box2D.NET {
 				};
 			}
 
-			Stack<int> stack = new(256);
-			stack.Push(root);
-
-			while(stack.Count > 0) {
-				int nodeId = stack.Pop();
-				if (nodeId == Box2D.NullNode) continue;
-
-				ref TreeNode<T> node = ref nodes[nodeId];
-				if (!Box2D.TestOverlap(node.AABB, segmentAABB)) continue;
-
-				Vector2 c = node.AABB.Center;
-				Vector2 h = node.AABB.Extents;
-				float separation = Math.Abs(v.Dot(p1 - c)) - abs_v.Dot(h);
-				if (separation > 0) continue;
-
-				if (node.IsLeaf) {
-					RayCastInput subInput = new() {
-						P1 = input.P1,
-						P2 = input.P2,
-						MaxFraction = maxFraction
-					};
-
-					float value = callback(subInput, nodeId);
-					if (value == 0) return;
-					if (value > 0) {
-						maxFraction = value;
-						Vector2 t = p1 + maxFraction * (p2 - p1);
-						segmentAABB.LowerBound = p1.Min(t);
-						segmentAABB.UpperBound = p1.Max(t);
+			if (root == Box2D.NullNode || !Box2D.TestOverlap(nodes[root].AABB, segmentAABB)) return;
+
+			Vector128<float> query = MakeOverlapQuery(segmentAABB);
+			TraversalStack stack = new(stackalloc int[TraversalStackSize]);
+			try {
+				stack.Push(root);
+				while (stack.Count > 0) {
+					int nodeId = stack.Pop();
+					ref TreeNode<T> node = ref nodes[nodeId];
+
+					// Separating axis for segment, |dot(v, p1 - c)| > dot(|v|, h)
+					Vector2 c = node.AABB.Center;
+					Vector2 h = node.AABB.Extents;
+					float separation = Math.Abs(v.Dot(p1 - c)) - abs_v.Dot(h);
+					if (separation > 0) continue;
+
+					if (node.IsLeaf) {
+						RayCastInput subInput = new() {
+							P1 = input.P1,
+							P2 = input.P2,
+							MaxFraction = maxFraction
+						};
+
+						float value = callback.RayCastCallback(subInput, nodeId);
+						// The client has terminated the ray cast
+						if (value == 0) return;
+						if (value > 0) {
+							// Update the segment bounding box
+							maxFraction = value;
+							Vector2 t = p1 + maxFraction * (p2 - p1);
+							segmentAABB.LowerBound = p1.Min(t);
+							segmentAABB.UpperBound = p1.Max(t);
+							query = MakeOverlapQuery(segmentAABB);
+						}
+					} else {
+						int overlap = TestChildOverlap(node, query);
+						if ((overlap & 1) != 0) stack.Push(node.Child1);
+						if ((overlap & 2) != 0) stack.Push(node.Child2);
 					}
-				} else {
-					stack.Push(node.Child1);
-					stack.Push(node.Child2);
 				}
+			} finally {
+				stack.Dispose();
+			}
+		}
+
+		/// <summary>
+		/// Casts a ray against the leaves of the tree.
+		/// </summary>
+		/// <param name="callback">The callback invoked for each leaf the ray may hit, returning the new maximum fraction
+		/// of the ray, 0 to terminate the cast, or -1 to ignore the leaf</param>
+		/// <param name="input">The ray to cast</param>
+		public void RayCast(Func<RayCastInput, int, float> callback, in RayCastInput input) {
+			DelegateRayCastCallback wrapper = new() { Callback = callback };
+			RayCast(ref wrapper, input);
+		}
+
+		// The number of entries in the stack allocated traversal stack, deeper trees spill to a pooled array
+		private const int TraversalStackSize = 256;
+
+		// Stack of node indices used to traverse the tree, starting in stack memory and growing into pooled arrays
+		private ref struct TraversalStack {
+
+			private Span<int> items;
+			private int[]? rented;
+
+			public int Count;
+
+			public TraversalStack(Span<int> initial) {
+				items = initial;
+				rented = null;
+				Count = 0;
+			}
+
+			[MethodImpl(MethodImplOptions.AggressiveInlining)]
+			public void Push(int nodeId) {
+				if (Count == items.Length) Grow();
+				items[Count++] = nodeId;
+			}
+
+			[MethodImpl(MethodImplOptions.AggressiveInlining)]
+			public int Pop() => items[--Count];
+
+			private void Grow() {
+				int[] array = ArrayPool<int>.Shared.Rent(items.Length * 2);
+				items.CopyTo(array);
+				if (rented != null) ArrayPool<int>.Shared.Return(rented);
+				rented = array;
+				items = array;
+			}
+
+			public void Dispose() {
+				if (rented != null) {
+					ArrayPool<int>.Shared.Return(rented);
+					rented = null;
+				}
+			}
+
+		}
+
+		// Sign mask negating the upper bound of an AABB loaded as (lower.X, lower.Y, upper.X, upper.Y)
+		private static readonly Vector128<float> upperSignMask = Vector128.Create(0.0f, 0.0f, -0.0f, -0.0f);
+
+		// Packs a query AABB as (upper.X, upper.Y, -lower.X, -lower.Y). A node AABB with its upper bound negated overlaps
+		// the query exactly when every lane is less than or equal to the corresponding lane of this vector.
+		private static Vector128<float> MakeOverlapQuery(in AABB aabb) =>
+			Vector128.Create(aabb.UpperBound.X, aabb.UpperBound.Y, -aabb.LowerBound.X, -aabb.LowerBound.Y);
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static Vector128<float> LoadAABB(ref AABB aabb) => Unsafe.As<AABB, Vector128<float>>(ref aabb) ^ upperSignMask;
+
+		// Tests the AABBs of both children of an internal node against a query at once, returning a mask with bit 0 set
+		// if the first child overlaps and bit 1 set if the second child overlaps
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private int TestChildOverlap(in TreeNode<T> node, Vector128<float> query) {
+			Vector128<float> child1 = LoadAABB(ref nodes[node.Child1].AABB);
+			Vector128<float> child2 = LoadAABB(ref nodes[node.Child2].AABB);
+			if (Vector256.IsHardwareAccelerated) {
+				uint mask = Vector256.LessThanOrEqual(Vector256.Create(child1, child2), Vector256.Create(query, query)).ExtractMostSignificantBits();
+				return ((mask & 0x0F) == 0x0F ? 1 : 0) | ((mask & 0xF0) == 0xF0 ? 2 : 0);
+			} else {
+				return (Vector128.LessThanOrEqualAll(child1, query) ? 1 : 0) | (Vector128.LessThanOrEqualAll(child2, query) ? 2 : 0);
 			}
 		}
 
@@ -252,7 +419,7 @@ namespace Tesseract.Box2D.NET {
 				if (this.nodes[i].Height < 0) continue;
 				if (this.nodes[i].IsLeaf) {
 					this.nodes[i].ParentOrNext = Box2D.NullNode;
-					nodes[i] = count++;
+					nodes[count++] = i;
 				} else FreeNode(i);
 			}
 
@@ -534,7 +701,7 @@ namespace Tesseract.Box2D.NET {
 
 				if (B.ParentOrNext != Box2D.NullNode) {
 					if (nodes[B.ParentOrNext].Child1 == iA) {
-
+						nodes[B.ParentOrNext].Child1 = iB;
 					} else {
 						Debug.Assert(nodes[B.ParentOrNext].Child2 == iA);
 						nodes[B.ParentOrNext].Child2 = iB;
@@ -624,7 +791,7 @@ namespace Tesseract.Box2D.NET {
 			Debug.Assert(0 <= child1 && child1 < nodes.Length);
 			Debug.Assert(0 <= child2 && child2 < nodes.Length);
 
-			Debug.Assert(Height == 1 + Math.Max(nodes[child1].Height, nodes[child2].Height));
+			Debug.Assert(node.Height == 1 + Math.Max(nodes[child1].Height, nodes[child2].Height));
 
 			AABB aabb = new();
 			aabb.Combine(nodes[child1].AABB, nodes[child2].AABB);
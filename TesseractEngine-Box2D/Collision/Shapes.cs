@@ -74,7 +74,7 @@ namespace Tesseract.Box2D.NET {
 			return new() {
 				Mass = mass,
 				Center = Position,
-				Inertia = mass * (0.5f * Radius * Radius * Position.Dot(Position))
+				Inertia = mass * (0.5f * Radius * Radius + Position.Dot(Position))
 			};
 		}
 
@@ -107,7 +107,7 @@ namespace Tesseract.Box2D.NET {
 		}
 
 		public bool TestPoint(in Transform xf, Vector2 p) {
-			Vector2 d = p - (xf * p);
+			Vector2 d = p - (xf * Position);
 			return d.Dot(d) <= Radius * Radius;
 		}
 
@@ -180,7 +180,7 @@ namespace Tesseract.Box2D.NET {
 			Vector2 v2 = xf * Vertex2;
 
 			Vector2 lower = v1.Min(v2);
-			Vector2 upper = v1.Min(v2);
+			Vector2 upper = v1.Max(v2);
 
 			Vector2 r = new(Radius);
 			return new() {
@@ -227,7 +227,7 @@ namespace Tesseract.Box2D.NET {
 
 		public void SetAsBox(float hx, float hy) {
 			RawVertices = new Vector2[] {
-				new Vector2(-hx, hy),
+				new Vector2(-hx, -hy),
 				new Vector2(hx, -hy),
 				new Vector2(hx, hy),
 				new Vector2(-hx, hy)
@@ -348,7 +348,7 @@ namespace Tesseract.Box2D.NET {
 				int i1 = i;
 				int i2 = (i + 1 < m) ? i + 1 : 0;
 				Vector2 edge = this.RawVertices[i2] - this.RawVertices[i1];
-				if (edge.LengthSquared() > Box2D.EpsilonSquared) throw new ArgumentException("Invalid polygon shape, ecountered zero-length edge", nameof(vertices));
+				if (edge.LengthSquared() <= Box2D.EpsilonSquared) throw new ArgumentException("Invalid polygon shape, ecountered zero-length edge", nameof(vertices));
 				Normals[i] = edge.Cross(1).Normalize();
 			}
 
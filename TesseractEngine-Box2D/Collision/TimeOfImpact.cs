@@ -120,8 +120,8 @@ namespace Tesseract.Box2D.NET {
 				switch(type) {
 					case SeparationType.Points:
 						{
-							Vector2 axisA = xfA.Rotation * axis;
-							Vector2 axisB = xfB.Rotation * -axis;
+							Vector2 axisA = xfA.Rotation.MulT(axis);
+							Vector2 axisB = xfB.Rotation.MulT(-axis);
 
 							indexA = proxyA.GetSupport(axisA);
 							indexB = proxyB.GetSupport(axisB);
@@ -139,7 +139,7 @@ namespace Tesseract.Box2D.NET {
 							Vector2 normal = xfA.Rotation * axis;
 							Vector2 pointA = xfA * localPoint;
 
-							Vector2 axisB = xfB.Rotation * -normal;
+							Vector2 axisB = xfB.Rotation.MulT(-normal);
 
 							indexA = -1;
 							indexB = proxyB.GetSupport(axisB);
@@ -154,7 +154,7 @@ namespace Tesseract.Box2D.NET {
 							Vector2 normal = xfB.Rotation * axis;
 							Vector2 pointB = xfB * localPoint;
 
-							Vector2 axisA = xfA.Rotation * -normal;
+							Vector2 axisA = xfA.Rotation.MulT(-normal);
 
 							indexB = -1;
 							indexA = proxyA.GetSupport(axisA);
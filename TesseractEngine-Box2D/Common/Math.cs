@@ -35,7 +35,7 @@ namespace Tesseract.Box2D.NET {
 		public static implicit operator Rotation(float angle) => new(angle);
 
 		public static Rotation operator *(in Rotation r1, in Rotation r2) => new(
-			r1.Sine * r1.Cosine + r1.Cosine * r2.Sine,
+			r1.Sine * r2.Cosine + r1.Cosine * r2.Sine,
 			r1.Cosine * r2.Cosine - r1.Sine * r2.Sine
 		);
 
@@ -62,7 +62,7 @@ namespace Tesseract.Box2D.NET {
 
 		public Vector2 Position = Vector2.Zero;
 
-		public Rotation Rotation = default;
+		public Rotation Rotation = Rotation.Identity;
 
 		public Transform() { }
 
@@ -73,7 +73,7 @@ namespace Tesseract.Box2D.NET {
 
 		public static Transform operator *(Transform xf1, Transform xf2) => new() {
 			Rotation = xf1.Rotation * xf2.Rotation,
-			Position = xf1.Rotation * xf1.Position + xf1.Position
+			Position = xf1.Rotation * xf2.Position + xf1.Position
 		};
 
 		public Transform MulT(Transform xf2) => new() {
@@ -99,13 +99,16 @@ namespace Tesseract.Box2D.NET {
 
 		public float StartAlpha;
 
-		public Transform GetTransform(float beta) => new() {
-			Position = (1 - beta) * StartCenter + beta * EndCenter,
-			Rotation = (1 - beta) * StartAngle + beta * EndAngle
-		};
+		public Transform GetTransform(float beta) {
+			Rotation q = (1 - beta) * StartAngle + beta * EndAngle;
+			return new() {
+				Position = (1 - beta) * StartCenter + beta * EndCenter - q * LocalCenter,
+				Rotation = q
+			};
+		}
 
 		public void Advance(float alpha) {
-			if (StartAlpha < 1) throw new InvalidOperationException("Sweep start alpha must be <1");
+			if (StartAlpha >= 1) throw new InvalidOperationException("Sweep start alpha must be <1");
 			float beta = (alpha - StartAlpha) / (1 - StartAlpha);
 			StartCenter += beta * (EndCenter - StartCenter);
 			StartAngle += beta * (EndAngle - StartAngle);
@@ -21,9 +21,9 @@ namespace Tesseract.Box2D.NET {
 
 	public class ContactEdge {
 
-		public Body? Other;
+		public Body Other = null!;
 
-		public Contact? Proxy;
+		public Contact Contact = null!;
 
 		public ContactEdge? Prev;
 
@@ -65,10 +65,6 @@ namespace Tesseract.Box2D.NET {
 			}
 		}
 
-		protected Contact? Prev;
-
-		public Contact? Next { get; }
-
 		public Fixture FixtureA { get; }
 
 		public int ChildIndexA { get; }
@@ -113,7 +109,7 @@ namespace Tesseract.Box2D.NET {
 
 
 		[Flags]
-		protected enum ContactFlags {
+		internal enum ContactFlags {
 			Island = 0x0001,
 			Touching = 0x0002,
 			Enabled = 0x0004,
@@ -122,15 +118,25 @@ namespace Tesseract.Box2D.NET {
 			TOI = 0x0020
 		}
 
-		protected ContactFlags Flags = ContactFlags.Enabled;
+		internal ContactFlags Flags = ContactFlags.Enabled;
+
+		internal ContactEdge NodeA = new();
+		internal ContactEdge NodeB = new();
+
+		internal int TOICount = 0;
+		internal float TOI;
 
-		protected ContactEdge NodeA = new();
-		protected ContactEdge NodeB = new();
+		/// <summary>
+		/// The index of this contact in the world's contact list.
+		/// </summary>
+		internal int Index;
 
-		protected int TOICount = 0;
-		protected float TOI;
+		/// <summary>
+		/// Flags this contact for filtering. Filtering will occur the next time step.
+		/// </summary>
+		internal void FlagForFiltering() => Flags |= ContactFlags.Filter;
 
-		internal void Update(IContactListener listener) {
+		internal void Update(IContactListener? listener) {
 			Manifold oldManifold = Manifold;
 
 			Flags |= ContactFlags.Enabled;
@@ -156,18 +162,21 @@ namespace Tesseract.Box2D.NET {
 				Evaluate(ref manifold, xfA, xfB);
 				touching = manifold.PointCount > 0;
 
-				for(int i = 0; i < manifold.PointCount; i++) {
-					ManifoldPoint mp2 = manifold.Points[i];
+				// Match old contact ids to new contact ids and copy the stored impulses to warm start the solver
+				Span<ManifoldPoint> points = manifold.Points;
+				for(int i = 0; i < points.Length; i++) {
+					ref ManifoldPoint mp2 = ref points[i];
 					mp2.NormalImpulse = 0;
 					mp2.TangentImpulse = 0;
-					ContactID id2 = mp2.ID;
+					uint key2 = mp2.ID.Key;
 
 					for(int j = 0; j < oldManifold.PointCount; j++) {
-						ManifoldPoint mp1 = oldManifold.Points[j];
+						ref ManifoldPoint mp1 = ref oldManifold.Points[j];
 
-						if (mp1.ID.Key == id2.Key) {
+						if (mp1.ID.Key == key2) {
 							mp2.NormalImpulse = mp1.NormalImpulse;
 							mp2.TangentImpulse = mp1.TangentImpulse;
+							break;
 						}
 					}
 				}
@@ -0,0 +1,207 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Numerics;
+using System.Text;
+using System.Threading.Tasks;
+
+namespace Tesseract.Box2D.NET {
+
+	/// <summary>
+	/// Manages the broad-phase and the set of contacts in a world, creating contacts for new broad-phase pairs and
+	/// destroying them when their fixtures stop overlapping.
+	/// </summary>
+	internal class ContactManager {
+
+		/// <summary>
+		/// The broad-phase holding the proxies of every enabled fixture.
+		/// </summary>
+		public BroadPhase BroadPhase { get; } = new();
+
+		/// <summary>
+		/// The contacts in the world. Each contact stores its position in this list in <see cref="Contact.Index"/>.
+		/// </summary>
+		public List<Contact> Contacts { get; } = new();
+
+		private readonly World world;
+
+		public ContactManager(World world) {
+			this.world = world;
+		}
+
+		// Broad-phase callback forwarding new pairs to the contact manager
+		private struct AddPairCallback : IPairCallback {
+
+			public ContactManager Manager;
+
+			public void AddPair(in FixtureProxy proxyA, in FixtureProxy proxyB) => Manager.AddPair(proxyA, proxyB);
+
+		}
+
+		// Creates a contact for a new pair if one does not already exist
+		private void AddPair(in FixtureProxy proxyA, in FixtureProxy proxyB) {
+			Fixture fixtureA = proxyA.Fixture!;
+			Fixture fixtureB = proxyB.Fixture!;
+
+			int indexA = proxyA.ChildIndex;
+			int indexB = proxyB.ChildIndex;
+
+			Body bodyA = fixtureA.Body;
+			Body bodyB = fixtureB.Body;
+
+			// Are the fixtures on the same body?
+			if (bodyA == bodyB) return;
+
+			// Does a contact already exist?
+			for (ContactEdge? edge = bodyB.ContactList; edge != null; edge = edge.Next) {
+				if (edge.Other == bodyA) {
+					Contact c = edge.Contact;
+					Fixture fA = c.FixtureA, fB = c.FixtureB;
+					int iA = c.ChildIndexA, iB = c.ChildIndexB;
+
+					if (fA == fixtureA && fB == fixtureB && iA == indexA && iB == indexB) return;
+					if (fA == fixtureB && fB == fixtureA && iA == indexB && iB == indexA) return;
+				}
+			}
+
+			// Does a joint override collision? Is at least one body dynamic?
+			if (!bodyB.ShouldCollide(bodyA)) return;
+
+			// Check user filtering
+			if (!(world.ContactFilter ?? Box2D.ShouldCollide)(fixtureA, fixtureB)) return;
+
+			// Call the factory, which may swap the fixtures
+			Contact? contact = Contact.Create(fixtureA, indexA, fixtureB, indexB);
+			if (contact == null) return;
+
+			fixtureA = contact.FixtureA;
+			fixtureB = contact.FixtureB;
+			bodyA = fixtureA.Body;
+			bodyB = fixtureB.Body;
+
+			// Insert into the world
+			contact.Index = Contacts.Count;
+			Contacts.Add(contact);
+
+			// Connect to body A
+			contact.NodeA.Contact = contact;
+			contact.NodeA.Other = bodyB;
+			contact.NodeA.Prev = null;
+			contact.NodeA.Next = bodyA.ContactList;
+			if (bodyA.ContactList != null) bodyA.ContactList.Prev = contact.NodeA;
+			bodyA.ContactList = contact.NodeA;
+
+			// Connect to body B
+			contact.NodeB.Contact = contact;
+			contact.NodeB.Other = bodyA;
+			contact.NodeB.Prev = null;
+			contact.NodeB.Next = bodyB.ContactList;
+			if (bodyB.ContactList != null) bodyB.ContactList.Prev = contact.NodeB;
+			bodyB.ContactList = contact.NodeB;
+		}
+
+		/// <summary>
+		/// Creates contacts for any new pairs of overlapping proxies in the broad-phase.
+		/// </summary>
+		public void FindNewContacts() {
+			AddPairCallback callback = new() { Manager = this };
+			BroadPhase.UpdatePairs(ref callback);
+		}
+
+		/// <summary>
+		/// Destroys a contact, notifying the contact listener if it was touching and removing it from its bodies.
+		/// </summary>
+		/// <param name="c">The contact to destroy</param>
+		public void Destroy(Contact c) {
+			Fixture fixtureA = c.FixtureA;
+			Fixture fixtureB = c.FixtureB;
+			Body bodyA = fixtureA.Body;
+			Body bodyB = fixtureB.Body;
+
+			if (c.IsTouching) world.ContactListener?.EndContact(c);
+
+			// Wake up touching bodies
+			if (c.Manifold.PointCount > 0 && !fixtureA.IsSensor && !fixtureB.IsSensor) {
+				bodyA.IsAwake = true;
+				bodyB.IsAwake = true;
+			}
+
+			// Remove from body A
+			if (c.NodeA.Prev != null) c.NodeA.Prev.Next = c.NodeA.Next;
+			if (c.NodeA.Next != null) c.NodeA.Next.Prev = c.NodeA.Prev;
+			if (c.NodeA == bodyA.ContactList) bodyA.ContactList = c.NodeA.Next;
+
+			// Remove from body B
+			if (c.NodeB.Prev != null) c.NodeB.Prev.Next = c.NodeB.Next;
+			if (c.NodeB.Next != null) c.NodeB.Next.Prev = c.NodeB.Prev;
+			if (c.NodeB == bodyB.ContactList) bodyB.ContactList = c.NodeB.Next;
+
+			// Remove from the world, moving the last contact into its place
+			int last = Contacts.Count - 1;
+			if (c.Index != last) {
+				Contact moved = Contacts[last];
+				moved.Index = c.Index;
+				Contacts[c.Index] = moved;
+			}
+			Contacts.RemoveAt(last);
+			c.Index = -1;
+		}
+
+		/// <summary>
+		/// Updates the manifolds of every contact, destroying contacts whose fixtures no longer overlap in the broad-phase
+		/// or which have been filtered out.
+		/// </summary>
+		public void Collide() {
+			IContactListener? listener = world.ContactListener;
+			ContactFilter filter = world.ContactFilter ?? Box2D.ShouldCollide;
+
+			int i = 0;
+			while (i < Contacts.Count) {
+				Contact c = Contacts[i];
+				Fixture fixtureA = c.FixtureA;
+				Fixture fixtureB = c.FixtureB;
+				int indexA = c.ChildIndexA;
+				int indexB = c.ChildIndexB;
+				Body bodyA = fixtureA.Body;
+				Body bodyB = fixtureB.Body;
+
+				// Is this contact flagged for filtering?
+				if ((c.Flags & Contact.ContactFlags.Filter) != 0) {
+					// Should these bodies collide?
+					if (!bodyB.ShouldCollide(bodyA) || !filter(fixtureA, fixtureB)) {
+						// Destroying moves the last contact into this slot, so don't advance
+						Destroy(c);
+						continue;
+					}
+
+					// Clear the filtering flag
+					c.Flags &= ~Contact.ContactFlags.Filter;
+				}
+
+				bool activeA = bodyA.IsAwake && bodyA.Type != BodyType.Static;
+				bool activeB = bodyB.IsAwake && bodyB.Type != BodyType.Static;
+
+				// At least one body must be awake and it must be dynamic or kinematic
+				if (!activeA && !activeB) {
+					i++;
+					continue;
+				}
+
+				int proxyIdA = fixtureA.Proxies[indexA].ProxyID;
+				int proxyIdB = fixtureB.Proxies[indexB].ProxyID;
+
+				// Here we destroy contacts that cease to overlap in the broad-phase
+				if (!BroadPhase.TestOverlap(proxyIdA, proxyIdB)) {
+					Destroy(c);
+					continue;
+				}
+
+				// The contact persists
+				c.Update(listener);
+				i++;
+			}
+		}
+
+	}
+
+}
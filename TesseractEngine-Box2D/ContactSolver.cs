@@ -1,8 +1,11 @@
 ﻿using System;
 using System.Collections.Generic;
 using System.Diagnostics;
+using System.Diagnostics.CodeAnalysis;
 using System.Linq;
 using System.Numerics;
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
 using System.Text;
 using System.Threading.Tasks;
 using Tesseract.Core.Numerics;
@@ -11,20 +14,22 @@ namespace Tesseract.Box2D.NET {
 
 	internal struct ContactPositionConstraint {
 
-		public readonly Vector2[] LocalPoints = new Vector2[Box2D.MaxManifoldPoints];
-		public Vector2 LocalNormal = default;
-		public Vector2 LocalPoint = default;
-		public int IndexA = default;
-		public int IndexB = default;
-		public float InvMassA = default;
-		public float InvMassB = default;
-		public Vector2 LocalCenterA = default, LocalCenterB = default;
-		public float InvIA = default, InvIB = default;
-		public ManifoldType Type = default;
-		public float RadiusA = default, RadiusB = default;
-		public int PointCount = default;
-
-		public ContactPositionConstraint() { }
+		// Local points of the manifold, stored inline so constraints are contiguous in memory
+		public Vector2 LocalPoint1, LocalPoint2;
+		[UnscopedRef]
+		public Span<Vector2> LocalPoints => MemoryMarshal.CreateSpan(ref LocalPoint1, Box2D.MaxManifoldPoints);
+
+		public Vector2 LocalNormal;
+		public Vector2 LocalPoint;
+		public int IndexA;
+		public int IndexB;
+		public float InvMassA;
+		public float InvMassB;
+		public Vector2 LocalCenterA, LocalCenterB;
+		public float InvIA, InvIB;
+		public ManifoldType Type;
+		public float RadiusA, RadiusB;
+		public int PointCount;
 
 	}
 
@@ -43,23 +48,24 @@ namespace Tesseract.Box2D.NET {
 
 	internal struct ContactVelocityConstraint {
 
-		public readonly VelocityConstraintPoint[] Points = new VelocityConstraintPoint[Box2D.MaxManifoldPoints];
-
-		public Vector2 Normal = default;
-		public Matrix2x2 NormalMass = default;
-		public Matrix2x2 K = default;
-		public int IndexA = default;
-		public int IndexB = default;
-		public float InvMassA = default, InvMassB = default;
-		public float InvIA = default, InvIB = default;
-		public float Friction = default;
-		public float Restitution = default;
-		public float Threshold = default;
-		public float TangentSpeed = default;
-		public int PointCount = 0;
-		public int ContactIndex = default;
-
-		public ContactVelocityConstraint() { }
+		// Constraint points, stored inline so constraints are contiguous in memory
+		public VelocityConstraintPoint Point1, Point2;
+		[UnscopedRef]
+		public Span<VelocityConstraintPoint> Points => MemoryMarshal.CreateSpan(ref Point1, Box2D.MaxManifoldPoints);
+
+		public Vector2 Normal;
+		public Matrix2x2 NormalMass;
+		public Matrix2x2 K;
+		public int IndexA;
+		public int IndexB;
+		public float InvMassA, InvMassB;
+		public float InvIA, InvIB;
+		public float Friction;
+		public float Restitution;
+		public float Threshold;
+		public float TangentSpeed;
+		public int PointCount;
+		public int ContactIndex;
 
 	}
 
@@ -70,31 +76,147 @@ namespace Tesseract.Box2D.NET {
 		public int Count = 0;
 		public Position[] Positions = Array.Empty<Position>();
 		public Velocity[] Velocities = Array.Empty<Velocity>();
+		public int BodyCount = 0;
+		// If contacts must be solved sequentially in a fixed order
+		public bool Deterministic = true;
+		// The maximum number of threads used by the colored solver
+		public int MaxParallelism = 1;
 
 		public ContactSolverDef() { }
 
 	}
 
+	// A contact constraint point for a bundle of contacts, with one contact per SIMD lane
+	internal struct WideConstraintPoint {
+
+		public Vector<float> RAX, RAY, RBX, RBY;
+		public Vector<float> NormalImpulse, TangentImpulse;
+		public Vector<float> NormalMass, TangentMass;
+		public Vector<float> VelocityBias;
+
+	}
+
+	// A structure-of-arrays bundle of velocity constraints, with one contact per SIMD lane
+	internal struct WideVelocityConstraint {
+
+		public WideConstraintPoint Point1, Point2;
+
+		public Vector<float> NormalX, NormalY;
+		public Vector<float> K11, K12, K22;
+		public Vector<float> NormalMass11, NormalMass12, NormalMass22;
+		public Vector<float> InvMassA, InvMassB;
+		public Vector<float> InvIA, InvIB;
+		public Vector<float> Friction;
+		public Vector<float> TangentSpeed;
+
+		// Lanes solved with the block solver
+		public Vector<int> BlockMask;
+		public bool AnyBlock, AllBlock;
+
+		// Lanes whose bodies have finite mass, and so have their velocities written back
+		public int WriteMaskA, WriteMaskB;
+
+	}
+
+	// The velocities of the bodies in a bundle, with one body per SIMD lane
+	internal struct WideVelocity {
+
+		public Vector<float> VX, VY, W;
+
+	}
+
+	/// <summary>
+	/// <para>
+	/// Solves the contact constraints of an island.
+	/// </para>
+	/// <para>
+	/// In deterministic mode contacts are solved one at a time in a fixed order, exactly as Box2D does. Otherwise large
+	/// islands are graph colored so no two contacts of the same color share a dynamic body. The contacts of each color are
+	/// packed into structure-of-arrays bundles with one contact per <see cref="Vector{T}"/> lane, and the bundles of each
+	/// color are solved in parallel. Contacts which cannot be colored are solved sequentially after the colored contacts.
+	/// </para>
+	/// <para>
+	/// A solver is reused between islands, so its buffers only grow when a larger island is encountered.
+	/// </para>
+	/// </summary>
 	internal class ContactSolver {
 
-		private static bool blockSolve = true;
+		private static readonly bool blockSolve = true;
+
+		// The minimum number of contacts in an island for it to be colored
+		private const int MinColoredContacts = 64;
+		// The maximum number of colors, contacts which cannot be colored are solved sequentially
+		private const int MaxColors = 64;
+		// The number of bundles solved by each parallel work item
+		private const int BundlesPerTask = 8;
 
 		private TimeStep step;
-		private Position[] positions;
-		private Velocity[] velocities;
-		private ContactPositionConstraint[] positionConstraints;
-		private ContactVelocityConstraint[] velocityConstraints;
-		private Contact[] contacts;
+		private Position[] positions = Array.Empty<Position>();
+		private Velocity[] velocities = Array.Empty<Velocity>();
+		private ContactPositionConstraint[] positionConstraints = Array.Empty<ContactPositionConstraint>();
+		private ContactVelocityConstraint[] velocityConstraints = Array.Empty<ContactVelocityConstraint>();
+		private Contact[] contacts = Array.Empty<Contact>();
 		private int count;
+		private int bodyCount;
+
+		/// <summary>
+		/// The velocity constraints of each contact, used to report the impulses applied by the solver.
+		/// </summary>
+		internal ReadOnlySpan<ContactVelocityConstraint> VelocityConstraints => velocityConstraints.AsSpan(0, count);
+
+		// If the island is solved with the colored solver
+		private bool colored;
+		private int maxParallelism;
+		private readonly ParallelOptions parallelOptions = new();
+		private readonly Action<int> solveBundleRange;
+
+		// The color masks used by each body while coloring
+		private ulong[] bodyColors = Array.Empty<ulong>();
+		// The color of each constraint, or -1 if it could not be colored
+		private int[] constraintColors = Array.Empty<int>();
+		// Constraints sorted by color, then by whether they use the block solver
+		private int[] colorOrder = Array.Empty<int>();
+		// The first bundle of each color, with an extra entry for the end of the last color
+		private readonly int[] colorBundleStarts = new int[MaxColors + 1];
+		private int colorCount;
+
+		// Bundles of colored constraints
+		private WideVelocityConstraint[] bundles = Array.Empty<WideVelocityConstraint>();
+		private int bundleCount;
+		// The constraint in each lane of each bundle, or -1 for an empty lane
+		private int[] laneConstraints = Array.Empty<int>();
+		// The bodies in each lane of each bundle, or -1 for an empty lane
+		private int[] laneBodiesA = Array.Empty<int>(), laneBodiesB = Array.Empty<int>();
+		// Constraints which could not be colored
+		private int[] overflowConstraints = Array.Empty<int>();
+		private int overflowCount;
+
+		// The range of bundles solved by parallel work items
+		private int parallelStart, parallelEnd;
+
+		public ContactSolver() {
+			solveBundleRange = SolveBundleRange;
+		}
 
-		public ContactSolver(ContactSolverDef def) {
+		/// <summary>
+		/// Prepares the solver for the contacts of an island.
+		/// </summary>
+		/// <param name="def">The solver definition</param>
+		public void Initialize(in ContactSolverDef def) {
 			step = def.Step;
 			count = def.Count;
-			positionConstraints = new ContactPositionConstraint[count];
-			velocityConstraints = new ContactVelocityConstraint[count];
+			bodyCount = def.BodyCount;
 			positions = def.Positions;
 			velocities = def.Velocities;
 			contacts = def.Contacts;
+			colored = !def.Deterministic && count >= MinColoredContacts;
+			maxParallelism = Math.Max(def.MaxParallelism, 1);
+			parallelOptions.MaxDegreeOfParallelism = maxParallelism;
+
+			if (velocityConstraints.Length < count) {
+				positionConstraints = new ContactPositionConstraint[count];
+				velocityConstraints = new ContactVelocityConstraint[count];
+			}
 
 			for(int i = 0; i < count; i++) {
 				Contact contact = contacts[i];
@@ -112,56 +234,54 @@ namespace Tesseract.Box2D.NET {
 				Debug.Assert(pointCount > 0);
 
 				ref ContactVelocityConstraint vc = ref velocityConstraints[i];
-				vc.Friction = contact.Friction;
-				vc.Restitution = contact.Restitution;
-				vc.Threshold = contact.RestitutionThreshold;
-				vc.TangentSpeed = contact.TangentSpeed;
-				vc.IndexA = bodyA.IslandIndex;
-				vc.IndexB = bodyB.IslandIndex;
-				vc.InvMassA = bodyA.InvMass;
-				vc.InvMassB = bodyB.InvMass;
-				vc.InvIA = bodyA.InvI;
-				vc.InvIB = bodyB.InvI;
-				vc.ContactIndex = i;
-				vc.PointCount = pointCount;
-				vc.K = Matrix2x2.Zero;
-				vc.NormalMass = Matrix2x2.Zero;
+				vc = new() {
+					Friction = contact.Friction,
+					Restitution = contact.Restitution,
+					Threshold = contact.RestitutionThreshold,
+					TangentSpeed = contact.TangentSpeed,
+					IndexA = bodyA.IslandIndex,
+					IndexB = bodyB.IslandIndex,
+					InvMassA = bodyA.InvMass,
+					InvMassB = bodyB.InvMass,
+					InvIA = bodyA.InvI,
+					InvIB = bodyB.InvI,
+					ContactIndex = i,
+					PointCount = pointCount,
+					K = Matrix2x2.Zero,
+					NormalMass = Matrix2x2.Zero
+				};
 
 				ref ContactPositionConstraint pc = ref positionConstraints[i];
-				pc.IndexA = bodyA.IslandIndex;
-				pc.IndexB = bodyB.IslandIndex;
-				pc.InvMassA = bodyA.InvMass;
-				pc.InvMassB = bodyB.InvMass;
-				pc.LocalCenterA = bodyA.Sweep.LocalCenter;
-				pc.LocalCenterB = bodyB.Sweep.LocalCenter;
-				pc.InvIA = bodyA.InvI;
-				pc.InvIB = bodyB.InvI;
-				pc.LocalNormal = manifold.LocalNormal;
-				pc.LocalPoint = manifold.LocalPoint;
-				pc.PointCount = pointCount;
-				pc.RadiusA = radiusA;
-				pc.RadiusB = radiusB;
-				pc.Type = manifold.Type;
+				pc = new() {
+					IndexA = bodyA.IslandIndex,
+					IndexB = bodyB.IslandIndex,
+					InvMassA = bodyA.InvMass,
+					InvMassB = bodyB.InvMass,
+					LocalCenterA = bodyA.Sweep.LocalCenter,
+					LocalCenterB = bodyB.Sweep.LocalCenter,
+					InvIA = bodyA.InvI,
+					InvIB = bodyB.InvI,
+					LocalNormal = manifold.LocalNormal,
+					LocalPoint = manifold.LocalPoint,
+					PointCount = pointCount,
+					RadiusA = radiusA,
+					RadiusB = radiusB,
+					Type = manifold.Type
+				};
 
+				Span<ManifoldPoint> manifoldPoints = manifold.Points;
+				Span<VelocityConstraintPoint> points = vc.Points;
+				Span<Vector2> localPoints = pc.LocalPoints;
 				for(int j = 0; j < pointCount; j++) {
-					ref ManifoldPoint cp = ref manifold.Points[j];
-					ref VelocityConstraintPoint vcp = ref vc.Points[j];
+					ref ManifoldPoint cp = ref manifoldPoints[j];
+					ref VelocityConstraintPoint vcp = ref points[j];
 
 					if (step.WarmStarting) {
 						vcp.NormalImpulse = step.DTRatio * cp.NormalImpulse;
 						vcp.TangentImpulse = step.DTRatio * cp.TangentImpulse;
-					} else {
-						vcp.NormalImpulse = 0;
-						vcp.TangentImpulse = 0;
 					}
 
-					vcp.RA = Vector2.Zero;
-					vcp.RB = Vector2.Zero;
-					vcp.NormalMass = 0;
-					vcp.TangentMass = 0;
-					vcp.VelocityBias = 0;
-
-					pc.LocalPoints[j] = pc.LocalPoint;
+					localPoints[j] = cp.LocalPoint;
 				}
 			}
 		}
@@ -173,15 +293,15 @@ namespace Tesseract.Box2D.NET {
 
 				float radiusA = pc.RadiusA;
 				float radiusB = pc.RadiusB;
-				Manifold manifold = contacts[i].Manifold;
+				Manifold manifold = contacts[vc.ContactIndex].Manifold;
 
 				int indexA = vc.IndexA;
 				int indexB = vc.IndexB;
 
 				float mA = vc.InvMassA;
-				float mB = vc.InvMassA;
+				float mB = vc.InvMassB;
 				float iA = vc.InvIA;
-				float iB = vc.InvIA;
+				float iB = vc.InvIB;
 				Vector2 localCenterA = pc.LocalCenterA;
 				Vector2 localCenterB = pc.LocalCenterB;
 
@@ -251,22 +371,26 @@ namespace Tesseract.Box2D.NET {
 
 					float k11 = mA + mB + iA * rn1A * rn1A + iB * rn1B * rn1B;
 					float k22 = mA + mB + iA * rn2A * rn2A + iB * rn2B * rn2B;
-					float k12 = mA + mB + iA * rn1A * rn1A + iB * rn2B * rn2B;
+					float k12 = mA + mB + iA * rn1A * rn2A + iB * rn1B * rn2B;
 
+					// Ensure a reasonable condition number for the block solver
 					const float MaxConditionNumber = 1000;
 					if (k11 * k11 < MaxConditionNumber * (k11 * k22 - k12 * k12)) {
 						vc.K = new Matrix2x2(k11, k12, k12, k22);
 						vc.NormalMass = vc.K.Inverse;
 					} else {
+						// The constraints are redundant, just use one
 						vc.PointCount = 1;
 					}
 				}
 			}
+
+			if (colored) BuildBundles();
 		}
 
 		internal void WarmStart() {
 			for(int i = 0; i < count; i++) {
-				ContactVelocityConstraint vc = velocityConstraints[i];
+				ref ContactVelocityConstraint vc = ref velocityConstraints[i];
 
 				int indexA = vc.IndexA;
 				int indexB = vc.IndexB;
@@ -285,26 +409,660 @@ namespace Tesseract.Box2D.NET {
 				Vector2 tangent = normal.Cross(1);
 
 				for(int j = 0; j < pointCount; j++) {
-					VelocityConstraintPoint vcp = vc.Points[j];
+					ref VelocityConstraintPoint vcp = ref vc.Points[j];
+					Vector2 P = vcp.NormalImpulse * normal + vcp.TangentImpulse * tangent;
+					wA -= iA * vcp.RA.Cross(P);
+					vA -= mA * P;
+					wB += iB * vcp.RB.Cross(P);
+					vB += mB * P;
 				}
+
+				velocities[indexA].V = vA;
+				velocities[indexA].W = wA;
+				velocities[indexB].V = vB;
+				velocities[indexB].W = wB;
 			}
 		}
 
 		internal void SolveVelocityConstraints() {
+			if (colored) {
+				SolveColoredVelocityConstraints();
+				return;
+			}
+
+			for(int i = 0; i < count; i++) SolveVelocityConstraint(ref velocityConstraints[i]);
+		}
+
+		// Solves the velocity constraint of a single contact
+		private void SolveVelocityConstraint(ref ContactVelocityConstraint vc) {
+			int indexA = vc.IndexA;
+			int indexB = vc.IndexB;
+			float mA = vc.InvMassA;
+			float iA = vc.InvIA;
+			float mB = vc.InvMassB;
+			float iB = vc.InvIB;
+			int pointCount = vc.PointCount;
+
+			Vector2 vA = velocities[indexA].V;
+			float wA = velocities[indexA].W;
+			Vector2 vB = velocities[indexB].V;
+			float wB = velocities[indexB].W;
+
+			Vector2 normal = vc.Normal;
+			Vector2 tangent = normal.Cross(1);
+			float friction = vc.Friction;
+
+			Debug.Assert(pointCount == 1 || pointCount == 2);
+
+			// Solve tangent constraints first because non-penetration is more important than friction
+			for(int j = 0; j < pointCount; j++) {
+				ref VelocityConstraintPoint vcp = ref vc.Points[j];
+
+				// Relative velocity at contact
+				Vector2 dv = vB + vcp.RB.CrossT(wB) - vA - vcp.RA.CrossT(wA);
 
+				// Compute tangent force
+				float vt = dv.Dot(tangent) - vc.TangentSpeed;
+				float lambda = vcp.TangentMass * -vt;
+
+				// Clamp the accumulated force
+				float maxFriction = friction * vcp.NormalImpulse;
+				float newImpulse = Math.Clamp(vcp.TangentImpulse + lambda, -maxFriction, maxFriction);
+				lambda = newImpulse - vcp.TangentImpulse;
+				vcp.TangentImpulse = newImpulse;
+
+				// Apply contact impulse
+				Vector2 P = lambda * tangent;
+
+				vA -= mA * P;
+				wA -= iA * vcp.RA.Cross(P);
+
+				vB += mB * P;
+				wB += iB * vcp.RB.Cross(P);
+			}
+
+			if (pointCount == 1 || !blockSolve) {
+				for(int j = 0; j < pointCount; j++) {
+					ref VelocityConstraintPoint vcp = ref vc.Points[j];
+
+					// Relative velocity at contact
+					Vector2 dv = vB + vcp.RB.CrossT(wB) - vA - vcp.RA.CrossT(wA);
+
+					// Compute normal impulse
+					float vn = dv.Dot(normal);
+					float lambda = -vcp.NormalMass * (vn - vcp.VelocityBias);
+
+					// Clamp the accumulated impulse
+					float newImpulse = Math.Max(vcp.NormalImpulse + lambda, 0);
+					lambda = newImpulse - vcp.NormalImpulse;
+					vcp.NormalImpulse = newImpulse;
+
+					// Apply contact impulse
+					Vector2 P = lambda * normal;
+					vA -= mA * P;
+					wA -= iA * vcp.RA.Cross(P);
+
+					vB += mB * P;
+					wB += iB * vcp.RB.Cross(P);
+				}
+			} else {
+				// Block solver, solving the total LCP for both contact points at once (see b2_contact_solver.cpp)
+				ref VelocityConstraintPoint cp1 = ref vc.Points[0];
+				ref VelocityConstraintPoint cp2 = ref vc.Points[1];
+
+				Vector2 a = new(cp1.NormalImpulse, cp2.NormalImpulse);
+				Debug.Assert(a.X >= 0 && a.Y >= 0);
+
+				// Relative velocity at contact
+				Vector2 dv1 = vB + cp1.RB.CrossT(wB) - vA - cp1.RA.CrossT(wA);
+				Vector2 dv2 = vB + cp2.RB.CrossT(wB) - vA - cp2.RA.CrossT(wA);
+
+				// Compute normal velocity
+				float vn1 = dv1.Dot(normal);
+				float vn2 = dv2.Dot(normal);
+
+				Vector2 b = new(vn1 - cp1.VelocityBias, vn2 - cp2.VelocityBias);
+
+				// Compute b'
+				b -= vc.K * a;
+
+				Vector2 x;
+				while(true) {
+					// Case 1: vn = 0
+					x = -(vc.NormalMass * b);
+					if (x.X >= 0 && x.Y >= 0) break;
+
+					// Case 2: vn1 = 0 and x2 = 0
+					x = new(-cp1.NormalMass * b.X, 0);
+					vn2 = vc.K.M21 * x.X + b.Y;
+					if (x.X >= 0 && vn2 >= 0) break;
+
+					// Case 3: vn2 = 0 and x1 = 0
+					x = new(0, -cp2.NormalMass * b.Y);
+					vn1 = vc.K.M12 * x.Y + b.X;
+					if (x.Y >= 0 && vn1 >= 0) break;
+
+					// Case 4: x1 = x2 = 0
+					x = Vector2.Zero;
+					vn1 = b.X;
+					vn2 = b.Y;
+					if (vn1 >= 0 && vn2 >= 0) break;
+
+					// No solution, give up. This is hit sometimes, but it doesn't seem to matter.
+					x = a;
+					break;
+				}
+
+				// Get the incremental impulse
+				Vector2 d = x - a;
+
+				// Apply incremental impulse
+				Vector2 P1 = d.X * normal;
+				Vector2 P2 = d.Y * normal;
+				vA -= mA * (P1 + P2);
+				wA -= iA * (cp1.RA.Cross(P1) + cp2.RA.Cross(P2));
+
+				vB += mB * (P1 + P2);
+				wB += iB * (cp1.RB.Cross(P1) + cp2.RB.Cross(P2));
+
+				// Accumulate
+				cp1.NormalImpulse = x.X;
+				cp2.NormalImpulse = x.Y;
+			}
+
+			velocities[indexA].V = vA;
+			velocities[indexA].W = wA;
+			velocities[indexB].V = vB;
+			velocities[indexB].W = wB;
 		}
 
 		internal void StoreImpulses() {
+			if (colored) UnpackImpulses();
 
+			for(int i = 0; i < count; i++) {
+				ref ContactVelocityConstraint vc = ref velocityConstraints[i];
+				Span<ManifoldPoint> points = contacts[vc.ContactIndex].Manifold.Points;
+
+				for(int j = 0; j < vc.PointCount; j++) {
+					points[j].NormalImpulse = vc.Points[j].NormalImpulse;
+					points[j].TangentImpulse = vc.Points[j].TangentImpulse;
+				}
+			}
 		}
 
-		internal bool SolvePositionConstraints() {
+		// If a constraint is solved with the block solver
+		private static bool IsBlock(in ContactVelocityConstraint vc) => vc.PointCount == 2 && blockSolve;
+
+		// Gets a reference to a single lane of a vector
+		private static ref T Lane<T>(ref Vector<T> v, int lane) where T : struct =>
+			ref Unsafe.Add(ref Unsafe.As<Vector<T>, T>(ref v), lane);
 
+		// Colors the constraints and packs them into bundles, must be called after the velocity constraints are initialized
+		private void BuildBundles() {
+			int width = Vector<float>.Count;
+
+			if (bodyColors.Length < bodyCount) bodyColors = new ulong[bodyCount];
+			else Array.Clear(bodyColors, 0, bodyCount);
+			if (constraintColors.Length < count) {
+				constraintColors = new int[count];
+				colorOrder = new int[count];
+				overflowConstraints = new int[count];
+			}
+
+			// Greedily assign each constraint the lowest color not used by either of its dynamic bodies. Static and
+			// kinematic bodies are never written by the solver so they may be shared between contacts of the same color.
+			// Colors are further split by whether the constraint uses the block solver so bundles are mostly uniform.
+			Span<int> keyCounts = stackalloc int[MaxColors * 2];
+			keyCounts.Clear();
+			colorCount = 0;
+			overflowCount = 0;
+			for (int i = 0; i < count; i++) {
+				ref ContactVelocityConstraint vc = ref velocityConstraints[i];
+				bool dynamicA = vc.InvMassA != 0 || vc.InvIA != 0;
+				bool dynamicB = vc.InvMassB != 0 || vc.InvIB != 0;
+
+				ulong used = 0;
+				if (dynamicA) used |= bodyColors[vc.IndexA];
+				if (dynamicB) used |= bodyColors[vc.IndexB];
+				if (used == ulong.MaxValue) {
+					constraintColors[i] = -1;
+					overflowConstraints[overflowCount++] = i;
+					continue;
+				}
+
+				int color = BitOperations.TrailingZeroCount(~used);
+				ulong bit = 1UL << color;
+				if (dynamicA) bodyColors[vc.IndexA] |= bit;
+				if (dynamicB) bodyColors[vc.IndexB] |= bit;
+
+				constraintColors[i] = color;
+				keyCounts[color * 2 + (IsBlock(vc) ? 0 : 1)]++;
+				colorCount = Math.Max(colorCount, color + 1);
+			}
+
+			// Sort the constraints by color and block solving, and find the bundles of each color
+			Span<int> keyOffsets = stackalloc int[MaxColors * 2];
+			int offset = 0;
+			bundleCount = 0;
+			for (int c = 0; c < colorCount; c++) {
+				colorBundleStarts[c] = bundleCount;
+				keyOffsets[c * 2] = offset;
+				keyOffsets[c * 2 + 1] = offset + keyCounts[c * 2];
+				int colorSize = keyCounts[c * 2] + keyCounts[c * 2 + 1];
+				offset += colorSize;
+				bundleCount += (colorSize + width - 1) / width;
+			}
+			colorBundleStarts[colorCount] = bundleCount;
+
+			for (int i = 0; i < count; i++) {
+				int color = constraintColors[i];
+				if (color < 0) continue;
+				colorOrder[keyOffsets[color * 2 + (IsBlock(velocityConstraints[i]) ? 0 : 1)]++] = i;
+			}
+
+			// Assign the constraints of each color to lanes, leaving the trailing lanes of a color's last bundle empty
+			int laneCount = bundleCount * width;
+			if (bundles.Length < bundleCount) bundles = new WideVelocityConstraint[bundleCount];
+			if (laneConstraints.Length < laneCount) {
+				laneConstraints = new int[laneCount];
+				laneBodiesA = new int[laneCount];
+				laneBodiesB = new int[laneCount];
+			}
+			laneConstraints.AsSpan(0, laneCount).Fill(-1);
+
+			offset = 0;
+			for (int c = 0; c < colorCount; c++) {
+				int colorSize = keyCounts[c * 2] + keyCounts[c * 2 + 1];
+				int laneStart = colorBundleStarts[c] * width;
+				colorOrder.AsSpan(offset, colorSize).CopyTo(laneConstraints.AsSpan(laneStart));
+				offset += colorSize;
+			}
+
+			for (int b = 0; b < bundleCount; b++) PackBundle(b);
+		}
+
+		// Packs the constraints assigned to the lanes of a bundle, empty lanes are left zeroed so they have no effect
+		private void PackBundle(int bundle) {
+			int width = Vector<float>.Count;
+			int laneBase = bundle * width;
+			ref WideVelocityConstraint c = ref bundles[bundle];
+			c = default;
+
+			int usedLanes = 0, blockLanes = 0;
+			for (int lane = 0; lane < width; lane++) {
+				int ci = laneConstraints[laneBase + lane];
+				if (ci < 0) {
+					laneBodiesA[laneBase + lane] = -1;
+					laneBodiesB[laneBase + lane] = -1;
+					continue;
+				}
+				ref ContactVelocityConstraint vc = ref velocityConstraints[ci];
+				usedLanes++;
+
+				laneBodiesA[laneBase + lane] = vc.IndexA;
+				laneBodiesB[laneBase + lane] = vc.IndexB;
+				if (vc.InvMassA != 0 || vc.InvIA != 0) c.WriteMaskA |= 1 << lane;
+				if (vc.InvMassB != 0 || vc.InvIB != 0) c.WriteMaskB |= 1 << lane;
+
+				Lane(ref c.NormalX, lane) = vc.Normal.X;
+				Lane(ref c.NormalY, lane) = vc.Normal.Y;
+				Lane(ref c.InvMassA, lane) = vc.InvMassA;
+				Lane(ref c.InvMassB, lane) = vc.InvMassB;
+				Lane(ref c.InvIA, lane) = vc.InvIA;
+				Lane(ref c.InvIB, lane) = vc.InvIB;
+				Lane(ref c.Friction, lane) = vc.Friction;
+				Lane(ref c.TangentSpeed, lane) = vc.TangentSpeed;
+
+				PackPoint(ref c.Point1, lane, vc.Point1);
+				if (vc.PointCount > 1) PackPoint(ref c.Point2, lane, vc.Point2);
+
+				if (IsBlock(vc)) {
+					blockLanes++;
+					Lane(ref c.BlockMask, lane) = -1;
+					Lane(ref c.K11, lane) = vc.K.M11;
+					Lane(ref c.K12, lane) = vc.K.M12;
+					Lane(ref c.K22, lane) = vc.K.M22;
+					Lane(ref c.NormalMass11, lane) = vc.NormalMass.M11;
+					Lane(ref c.NormalMass12, lane) = vc.NormalMass.M12;
+					Lane(ref c.NormalMass22, lane) = vc.NormalMass.M22;
+				}
+			}
+
+			c.AnyBlock = blockLanes > 0;
+			c.AllBlock = blockLanes == usedLanes;
+		}
+
+		private static void PackPoint(ref WideConstraintPoint p, int lane, in VelocityConstraintPoint vcp) {
+			Lane(ref p.RAX, lane) = vcp.RA.X;
+			Lane(ref p.RAY, lane) = vcp.RA.Y;
+			Lane(ref p.RBX, lane) = vcp.RB.X;
+			Lane(ref p.RBY, lane) = vcp.RB.Y;
+			Lane(ref p.NormalImpulse, lane) = vcp.NormalImpulse;
+			Lane(ref p.TangentImpulse, lane) = vcp.TangentImpulse;
+			Lane(ref p.NormalMass, lane) = vcp.NormalMass;
+			Lane(ref p.TangentMass, lane) = vcp.TangentMass;
+			Lane(ref p.VelocityBias, lane) = vcp.VelocityBias;
+		}
+
+		// Copies the accumulated impulses of the bundles back to the constraints
+		private void UnpackImpulses() {
+			int width = Vector<float>.Count;
+			for (int b = 0; b < bundleCount; b++) {
+				ref WideVelocityConstraint c = ref bundles[b];
+				for (int lane = 0; lane < width; lane++) {
+					int ci = laneConstraints[b * width + lane];
+					if (ci < 0) continue;
+					ref ContactVelocityConstraint vc = ref velocityConstraints[ci];
+
+					vc.Point1.NormalImpulse = Lane(ref c.Point1.NormalImpulse, lane);
+					vc.Point1.TangentImpulse = Lane(ref c.Point1.TangentImpulse, lane);
+					if (vc.PointCount > 1) {
+						vc.Point2.NormalImpulse = Lane(ref c.Point2.NormalImpulse, lane);
+						vc.Point2.TangentImpulse = Lane(ref c.Point2.TangentImpulse, lane);
+					}
+				}
+			}
+		}
+
+		// Solves the colored bundles one color at a time, then the constraints which could not be colored
+		private void SolveColoredVelocityConstraints() {
+			for (int c = 0; c < colorCount; c++) {
+				int start = colorBundleStarts[c], end = colorBundleStarts[c + 1];
+				int size = end - start;
+				if (maxParallelism > 1 && size > BundlesPerTask) {
+					// Bundles of the same color share no dynamic bodies so they can be solved in any order
+					parallelStart = start;
+					parallelEnd = end;
+					Parallel.For(0, (size + BundlesPerTask - 1) / BundlesPerTask, parallelOptions, solveBundleRange);
+				} else {
+					for (int b = start; b < end; b++) SolveBundle(b);
+				}
+			}
+
+			for (int i = 0; i < overflowCount; i++) SolveVelocityConstraint(ref velocityConstraints[overflowConstraints[i]]);
+		}
+
+		private void SolveBundleRange(int task) {
+			int start = parallelStart + task * BundlesPerTask;
+			int end = Math.Min(start + BundlesPerTask, parallelEnd);
+			for (int b = start; b < end; b++) SolveBundle(b);
 		}
 
-		internal bool SolveTOIPositionConstraints(int toiIndexA, int toiIndexB) {
+		// Solves the velocity constraints of every contact in a bundle, the same as SolveVelocityConstraint for each lane
+		private void SolveBundle(int bundle) {
+			int width = Vector<float>.Count;
+			int laneBase = bundle * width;
+			ref WideVelocityConstraint c = ref bundles[bundle];
+
+			// Gather body velocities
+			WideVelocity vA = default, vB = default;
+			for (int lane = 0; lane < width; lane++) {
+				int indexA = laneBodiesA[laneBase + lane];
+				if (indexA < 0) continue;
+				ref Velocity velA = ref velocities[indexA];
+				Lane(ref vA.VX, lane) = velA.V.X;
+				Lane(ref vA.VY, lane) = velA.V.Y;
+				Lane(ref vA.W, lane) = velA.W;
+				ref Velocity velB = ref velocities[laneBodiesB[laneBase + lane]];
+				Lane(ref vB.VX, lane) = velB.V.X;
+				Lane(ref vB.VY, lane) = velB.V.Y;
+				Lane(ref vB.W, lane) = velB.W;
+			}
+
+			Vector<float> normalX = c.NormalX, normalY = c.NormalY;
+			Vector<float> tangentX = normalY, tangentY = -normalX;
+
+			// Solve tangent constraints first because non-penetration is more important than friction
+			SolveWideFriction(c, ref c.Point1, tangentX, tangentY, ref vA, ref vB);
+			SolveWideFriction(c, ref c.Point2, tangentX, tangentY, ref vA, ref vB);
+
+			if (c.AllBlock) {
+				SolveWideBlock(c, ref c.Point1, ref c.Point2, normalX, normalY, ref vA, ref vB);
+			} else if (!c.AnyBlock) {
+				SolveWideNormal(c, ref c.Point1, normalX, normalY, ref vA, ref vB);
+				SolveWideNormal(c, ref c.Point2, normalX, normalY, ref vA, ref vB);
+			} else {
+				// Mixed bundle, solve every lane both ways and select the result by the block mask
+				WideConstraintPoint blockPoint1 = c.Point1, blockPoint2 = c.Point2;
+				WideVelocity blockA = vA, blockB = vB;
+				SolveWideBlock(c, ref blockPoint1, ref blockPoint2, normalX, normalY, ref blockA, ref blockB);
+				SolveWideNormal(c, ref c.Point1, normalX, normalY, ref vA, ref vB);
+				SolveWideNormal(c, ref c.Point2, normalX, normalY, ref vA, ref vB);
+
+				Vector<int> mask = c.BlockMask;
+				c.Point1.NormalImpulse = Vector.ConditionalSelect(mask, blockPoint1.NormalImpulse, c.Point1.NormalImpulse);
+				c.Point2.NormalImpulse = Vector.ConditionalSelect(mask, blockPoint2.NormalImpulse, c.Point2.NormalImpulse);
+				vA.VX = Vector.ConditionalSelect(mask, blockA.VX, vA.VX);
+				vA.VY = Vector.ConditionalSelect(mask, blockA.VY, vA.VY);
+				vA.W = Vector.ConditionalSelect(mask, blockA.W, vA.W);
+				vB.VX = Vector.ConditionalSelect(mask, blockB.VX, vB.VX);
+				vB.VY = Vector.ConditionalSelect(mask, blockB.VY, vB.VY);
+				vB.W = Vector.ConditionalSelect(mask, blockB.W, vB.W);
+			}
+
+			// Scatter velocities of dynamic bodies
+			for (int lane = 0; lane < width; lane++) {
+				if ((c.WriteMaskA & (1 << lane)) != 0) {
+					ref Velocity velA = ref velocities[laneBodiesA[laneBase + lane]];
+					velA.V = new Vector2(Lane(ref vA.VX, lane), Lane(ref vA.VY, lane));
+					velA.W = Lane(ref vA.W, lane);
+				}
+				if ((c.WriteMaskB & (1 << lane)) != 0) {
+					ref Velocity velB = ref velocities[laneBodiesB[laneBase + lane]];
+					velB.V = new Vector2(Lane(ref vB.VX, lane), Lane(ref vB.VY, lane));
+					velB.W = Lane(ref vB.W, lane);
+				}
+			}
+		}
+
+		// Computes the relative velocity of a contact point along a direction
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static Vector<float> WideRelativeVelocity(in WideConstraintPoint p, Vector<float> dirX, Vector<float> dirY, in WideVelocity vA, in WideVelocity vB) {
+			Vector<float> dvX = vB.VX - vB.W * p.RBY - vA.VX + vA.W * p.RAY;
+			Vector<float> dvY = vB.VY + vB.W * p.RBX - vA.VY - vA.W * p.RAX;
+			return dvX * dirX + dvY * dirY;
+		}
+
+		// Applies an impulse at a contact point to both bodies
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static void ApplyWideImpulse(in WideVelocityConstraint c, in WideConstraintPoint p, Vector<float> px, Vector<float> py, ref WideVelocity vA, ref WideVelocity vB) {
+			vA.VX -= c.InvMassA * px;
+			vA.VY -= c.InvMassA * py;
+			vA.W -= c.InvIA * (p.RAX * py - p.RAY * px);
+
+			vB.VX += c.InvMassB * px;
+			vB.VY += c.InvMassB * py;
+			vB.W += c.InvIB * (p.RBX * py - p.RBY * px);
+		}
+
+		private static void SolveWideFriction(in WideVelocityConstraint c, ref WideConstraintPoint p, Vector<float> tangentX, Vector<float> tangentY, ref WideVelocity vA, ref WideVelocity vB) {
+			// Compute tangent force
+			Vector<float> vt = WideRelativeVelocity(p, tangentX, tangentY, vA, vB) - c.TangentSpeed;
+			Vector<float> lambda = p.TangentMass * -vt;
+
+			// Clamp the accumulated force
+			Vector<float> maxFriction = c.Friction * p.NormalImpulse;
+			Vector<float> newImpulse = Vector.Min(Vector.Max(p.TangentImpulse + lambda, -maxFriction), maxFriction);
+			lambda = newImpulse - p.TangentImpulse;
+			p.TangentImpulse = newImpulse;
+
+			ApplyWideImpulse(c, p, lambda * tangentX, lambda * tangentY, ref vA, ref vB);
+		}
+
+		private static void SolveWideNormal(in WideVelocityConstraint c, ref WideConstraintPoint p, Vector<float> normalX, Vector<float> normalY, ref WideVelocity vA, ref WideVelocity vB) {
+			// Compute normal impulse
+			Vector<float> vn = WideRelativeVelocity(p, normalX, normalY, vA, vB);
+			Vector<float> lambda = -p.NormalMass * (vn - p.VelocityBias);
+
+			// Clamp the accumulated impulse
+			Vector<float> newImpulse = Vector.Max(p.NormalImpulse + lambda, Vector<float>.Zero);
+			lambda = newImpulse - p.NormalImpulse;
+			p.NormalImpulse = newImpulse;
+
+			ApplyWideImpulse(c, p, lambda * normalX, lambda * normalY, ref vA, ref vB);
+		}
 
+		// Block solver for both points of every lane, evaluating each case of the scalar solver and keeping the first valid one
+		private static void SolveWideBlock(in WideVelocityConstraint c, ref WideConstraintPoint p1, ref WideConstraintPoint p2, Vector<float> normalX, Vector<float> normalY, ref WideVelocity vA, ref WideVelocity vB) {
+			Vector<float> zero = Vector<float>.Zero;
+			Vector<float> aX = p1.NormalImpulse, aY = p2.NormalImpulse;
+
+			// Compute b' = vn - bias - K * a
+			Vector<float> vn1 = WideRelativeVelocity(p1, normalX, normalY, vA, vB);
+			Vector<float> vn2 = WideRelativeVelocity(p2, normalX, normalY, vA, vB);
+			Vector<float> bX = vn1 - p1.VelocityBias - (c.K11 * aX + c.K12 * aY);
+			Vector<float> bY = vn2 - p2.VelocityBias - (c.K12 * aX + c.K22 * aY);
+
+			// Case 1: vn = 0
+			Vector<float> x1X = -(c.NormalMass11 * bX + c.NormalMass12 * bY);
+			Vector<float> x1Y = -(c.NormalMass12 * bX + c.NormalMass22 * bY);
+			Vector<int> case1 = Vector.GreaterThanOrEqual(x1X, zero) & Vector.GreaterThanOrEqual(x1Y, zero);
+
+			// Case 2: vn1 = 0 and x2 = 0
+			Vector<float> x2X = -p1.NormalMass * bX;
+			Vector<int> case2 = Vector.GreaterThanOrEqual(x2X, zero) & Vector.GreaterThanOrEqual(c.K12 * x2X + bY, zero);
+
+			// Case 3: vn2 = 0 and x1 = 0
+			Vector<float> x3Y = -p2.NormalMass * bY;
+			Vector<int> case3 = Vector.GreaterThanOrEqual(x3Y, zero) & Vector.GreaterThanOrEqual(c.K12 * x3Y + bX, zero);
+
+			// Case 4: x1 = x2 = 0
+			Vector<int> case4 = Vector.GreaterThanOrEqual(bX, zero) & Vector.GreaterThanOrEqual(bY, zero);
+
+			// Select the first case which holds, otherwise keep the current impulse
+			Vector<float> xX = Vector.ConditionalSelect(case1, x1X, Vector.ConditionalSelect(case2, x2X, Vector.ConditionalSelect(case3 | case4, zero, aX)));
+			Vector<float> xY = Vector.ConditionalSelect(case1, x1Y, Vector.ConditionalSelect(case2, zero, Vector.ConditionalSelect(case3, x3Y, Vector.ConditionalSelect(case4, zero, aY))));
+
+			// Apply incremental impulse
+			Vector<float> dX = xX - aX, dY = xY - aY;
+			ApplyWideImpulse(c, p1, dX * normalX, dX * normalY, ref vA, ref vB);
+			ApplyWideImpulse(c, p2, dY * normalX, dY * normalY, ref vA, ref vB);
+
+			// Accumulate
+			p1.NormalImpulse = xX;
+			p2.NormalImpulse = xY;
 		}
 
+		// Computes the world normal, point and separation of a contact point for position correction
+		private static void GetPositionSolverPoint(in ContactPositionConstraint pc, in Transform xfA, in Transform xfB, int index, out Vector2 normal, out Vector2 point, out float separation) {
+			Debug.Assert(pc.PointCount > 0);
+
+			switch (pc.Type) {
+				case ManifoldType.Circles: {
+						Vector2 pointA = xfA * pc.LocalPoint;
+						Vector2 pointB = xfB * pc.LocalPoint1;
+						Vector2 d = pointB - pointA;
+						float length = d.Length();
+						normal = length < Box2D.Epsilon ? Vector2.Zero : d / length;
+						point = 0.5f * (pointA + pointB);
+						separation = d.Dot(normal) - pc.RadiusA - pc.RadiusB;
+					}
+					break;
+				case ManifoldType.FaceA: {
+						normal = xfA.Rotation * pc.LocalNormal;
+						Vector2 planePoint = xfA * pc.LocalPoint;
+
+						Vector2 clipPoint = xfB * (index == 0 ? pc.LocalPoint1 : pc.LocalPoint2);
+						separation = (clipPoint - planePoint).Dot(normal) - pc.RadiusA - pc.RadiusB;
+						point = clipPoint;
+					}
+					break;
+				case ManifoldType.FaceB: {
+						normal = xfB.Rotation * pc.LocalNormal;
+						Vector2 planePoint = xfB * pc.LocalPoint;
+
+						Vector2 clipPoint = xfA * (index == 0 ? pc.LocalPoint1 : pc.LocalPoint2);
+						separation = (clipPoint - planePoint).Dot(normal) - pc.RadiusA - pc.RadiusB;
+						point = clipPoint;
+
+						// Ensure normal points from A to B
+						normal = -normal;
+					}
+					break;
+				default:
+					throw new InvalidOperationException("Invalid manifold type");
+			}
+		}
+
+		// Solves the position constraints of all contacts, moving bodies apart by at most the given fraction of their
+		// separation. If TOI indices are given only the two TOI bodies are moved.
+		private bool SolvePositionConstraints(float baumgarte, bool toi, int toiIndexA, int toiIndexB) {
+			float minSeparation = 0;
+
+			for(int i = 0; i < count; i++) {
+				ref ContactPositionConstraint pc = ref positionConstraints[i];
+
+				int indexA = pc.IndexA;
+				int indexB = pc.IndexB;
+				Vector2 localCenterA = pc.LocalCenterA;
+				Vector2 localCenterB = pc.LocalCenterB;
+				int pointCount = pc.PointCount;
+
+				float mA = pc.InvMassA, iA = pc.InvIA;
+				float mB = pc.InvMassB, iB = pc.InvIB;
+				if (toi) {
+					if (indexA != toiIndexA && indexA != toiIndexB) {
+						mA = 0;
+						iA = 0;
+					}
+					if (indexB != toiIndexA && indexB != toiIndexB) {
+						mB = 0;
+						iB = 0;
+					}
+				}
+
+				Vector2 cA = positions[indexA].C;
+				float aA = positions[indexA].A;
+				Vector2 cB = positions[indexB].C;
+				float aB = positions[indexB].A;
+
+				// Solve normal constraints
+				for(int j = 0; j < pointCount; j++) {
+					Transform xfA = new() { Rotation = aA }, xfB = new() { Rotation = aB };
+					xfA.Position = cA - xfA.Rotation * localCenterA;
+					xfB.Position = cB - xfB.Rotation * localCenterB;
+
+					GetPositionSolverPoint(pc, xfA, xfB, j, out Vector2 normal, out Vector2 point, out float separation);
+
+					Vector2 rA = point - cA;
+					Vector2 rB = point - cB;
+
+					// Track max constraint error
+					minSeparation = Math.Min(minSeparation, separation);
+
+					// Prevent large corrections and allow slop
+					float C = Math.Clamp(baumgarte * (separation + Box2D.LinearSlop), -Box2D.MaxLinearCorrection, 0);
+
+					// Compute the effective mass
+					float rnA = rA.Cross(normal);
+					float rnB = rB.Cross(normal);
+					float K = mA + mB + iA * rnA * rnA + iB * rnB * rnB;
+
+					// Compute normal impulse
+					float impulse = K > 0 ? -C / K : 0;
+
+					Vector2 P = impulse * normal;
+
+					cA -= mA * P;
+					aA -= iA * rA.Cross(P);
+
+					cB += mB * P;
+					aB += iB * rB.Cross(P);
+				}
+
+				positions[indexA].C = cA;
+				positions[indexA].A = aA;
+				positions[indexB].C = cB;
+				positions[indexB].A = aB;
+			}
+
+			// We can't expect minSpeparation >= -linearSlop because we don't push the separation above -linearSlop
+			return minSeparation >= (toi ? -1.5f : -3.0f) * Box2D.LinearSlop;
+		}
+
+		internal bool SolvePositionConstraints() => SolvePositionConstraints(Box2D.Baumgarte, false, -1, -1);
+
+		internal bool SolveTOIPositionConstraints(int toiIndexA, int toiIndexB) => SolvePositionConstraints(Box2D.TOIBaumgarte, true, toiIndexA, toiIndexB);
+
 	}
 }
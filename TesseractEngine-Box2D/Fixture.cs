@@ -1,5 +1,6 @@
 ﻿using System;
 using System.Collections.Generic;
+using System.Diagnostics;
 using System.Linq;
 using System.Numerics;
 using System.Text;
@@ -23,17 +24,17 @@ namespace Tesseract.Box2D.NET {
 
 		public IShape Shape { get; init; } = default!;
 
-		public float Friction { get; init; }
+		public float Friction { get; init; } = 0.2f;
 
 		public float Restitution { get; init; }
 
-		public float RestitutionThreshold { get; init; }
+		public float RestitutionThreshold { get; init; } = 1.0f * Box2D.LengthUnitsPerMeter;
 
 		public float Density { get; init; }
 
 		public bool IsSensor { get; init; }
 
-		public Filter Filter { get; init; }
+		public Filter Filter { get; init; } = new();
 
 	}
 
@@ -75,13 +76,25 @@ namespace Tesseract.Box2D.NET {
 			}
 		}
 
+		/// <summary>
+		/// Flags the contacts of this fixture to be filtered again on the next step. This should be called if the result of
+		/// a custom <see cref="World.ContactFilter"/> for this fixture changes.
+		/// </summary>
 		public void Refilter() {
+			// Flag associated contacts for filtering
+			for (ContactEdge? edge = Body.ContactList; edge != null; edge = edge.Next) {
+				Contact contact = edge.Contact;
+				if (contact.FixtureA == this || contact.FixtureB == this) contact.FlagForFiltering();
+			}
 
+			// Touch each proxy so that new pairs may be created
+			BroadPhase broadPhase = Body.World.ContactManager.BroadPhase;
+			for (int i = 0; i < ProxyCount; i++) broadPhase.TouchProxy(Proxies[i].ProxyID);
 		}
 
 		public Body Body { get; }
 
-		public Fixture? Next { get; }
+		public Fixture? Next { get; internal set; }
 
 		public bool TestPoint(Vector2 p) => Shape.TestPoint(Body.Transform, p);
 
@@ -109,6 +122,7 @@ namespace Tesseract.Box2D.NET {
 
 		internal FixtureProxy[] Proxies = Array.Empty<FixtureProxy>();
 		internal int ProxyCount = 0;
+		internal bool IsDestroyed = false;
 
 		internal Fixture(Body body, FixtureDef def) {
 			Friction = def.Friction;
@@ -118,9 +132,9 @@ namespace Tesseract.Box2D.NET {
 			Body = body;
 			Next = null;
 
-			Filter = def.Filter;
+			filter = def.Filter;
 
-			IsSensor = def.IsSensor;
+			isSensor = def.IsSensor;
 
 			Shape = def.Shape.Clone();
 
@@ -138,9 +152,50 @@ namespace Tesseract.Box2D.NET {
 			Density = def.Density;
 		}
 
+		// Creates the broad-phase proxies for each child of the shape
+		internal void CreateProxies(BroadPhase broadPhase, in Transform xf) {
+			Debug.Assert(ProxyCount == 0);
+
+			ProxyCount = Shape.ChildCount;
+			for (int i = 0; i < ProxyCount; i++) {
+				ref FixtureProxy proxy = ref Proxies[i];
+				proxy.AABB = Shape.ComputeAABB(xf, i);
+				proxy.Fixture = this;
+				proxy.ChildIndex = i;
+				proxy.ProxyID = broadPhase.CreateProxy(proxy.AABB, proxy);
+			}
+		}
+
+		internal void DestroyProxies(BroadPhase broadPhase) {
+			for (int i = 0; i < ProxyCount; i++) {
+				ref FixtureProxy proxy = ref Proxies[i];
+				broadPhase.DestroyProxy(proxy.ProxyID);
+				proxy.ProxyID = BroadPhase.NullProxy;
+			}
+			ProxyCount = 0;
+		}
+
+		// Moves the proxies to cover the swept bounds of the shape between two transforms
+		internal void Synchronize(BroadPhase broadPhase, in Transform xf1, in Transform xf2) {
+			for (int i = 0; i < ProxyCount; i++) {
+				ref FixtureProxy proxy = ref Proxies[i];
+
+				// Compute an AABB that covers the swept shape (may miss some rotation effect)
+				AABB aabb1 = Shape.ComputeAABB(xf1, proxy.ChildIndex);
+				AABB aabb2 = Shape.ComputeAABB(xf2, proxy.ChildIndex);
+				proxy.AABB.Combine(aabb1, aabb2);
+
+				Vector2 displacement = aabb2.Center - aabb1.Center;
+				broadPhase.MoveProxy(proxy.ProxyID, proxy.AABB, displacement);
+			}
+		}
+
+		/// <summary>
+		/// Destroys this fixture, detaching it from its body.
+		/// </summary>
 		public void Dispose() {
 			GC.SuppressFinalize(this);
-			// TODO
+			if (!IsDestroyed) Body.DestroyFixture(this);
 		}
 
 	}
@@ -0,0 +1,349 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Numerics;
+using System.Text;
+using System.Threading.Tasks;
+using Tesseract.Core.Numerics;
+
+namespace Tesseract.Box2D.NET {
+
+	/// <summary>
+	/// <para>
+	/// A set of bodies connected by touching contacts and joints which is solved as a unit. The state of each body is
+	/// gathered from the world's <see cref="BodyStore"/> into contiguous position and velocity arrays indexed by
+	/// <see cref="Body.IslandIndex"/>, solved, and then written back.
+	/// </para>
+	/// <para>
+	/// An island and its contact solver are reused between solves, so their arrays only grow when a larger island is encountered.
+	/// </para>
+	/// </summary>
+	internal class Island {
+
+		public Body[] Bodies = Array.Empty<Body>();
+		public int BodyCount;
+		public int BodyCapacity { get; private set; }
+
+		public Contact[] Contacts = Array.Empty<Contact>();
+		public int ContactCount;
+		public int ContactCapacity { get; private set; }
+
+		public Joint[] Joints = Array.Empty<Joint>();
+		public int JointCount;
+
+		private Position[] positions = Array.Empty<Position>();
+		private Velocity[] velocities = Array.Empty<Velocity>();
+
+		private readonly World world;
+		private ContactImpulse impulse = new();
+		private readonly ContactSolver contactSolver = new();
+
+		public Island(World world) {
+			this.world = world;
+		}
+
+		/// <summary>
+		/// Clears the island and ensures it can hold at least the given number of bodies, contacts, and joints.
+		/// </summary>
+		/// <param name="bodyCapacity">The maximum number of bodies</param>
+		/// <param name="contactCapacity">The maximum number of contacts</param>
+		/// <param name="jointCapacity">The maximum number of joints</param>
+		public void Reset(int bodyCapacity, int contactCapacity, int jointCapacity) {
+			if (Bodies.Length < bodyCapacity) {
+				Bodies = new Body[bodyCapacity];
+				positions = new Position[bodyCapacity];
+				velocities = new Velocity[bodyCapacity];
+			}
+			if (Contacts.Length < contactCapacity) Contacts = new Contact[contactCapacity];
+			if (Joints.Length < jointCapacity) Joints = new Joint[jointCapacity];
+			BodyCapacity = bodyCapacity;
+			ContactCapacity = contactCapacity;
+			Clear();
+		}
+
+		/// <summary>
+		/// Removes every body, contact, and joint from the island.
+		/// </summary>
+		public void Clear() {
+			Array.Clear(Bodies, 0, BodyCount);
+			Array.Clear(Contacts, 0, ContactCount);
+			Array.Clear(Joints, 0, JointCount);
+			BodyCount = 0;
+			ContactCount = 0;
+			JointCount = 0;
+		}
+
+		public void Add(Body body) {
+			body.IslandIndex = BodyCount;
+			Bodies[BodyCount++] = body;
+		}
+
+		public void Add(Contact contact) => Contacts[ContactCount++] = contact;
+
+		public void Add(Joint joint) => Joints[JointCount++] = joint;
+
+		/// <summary>
+		/// Integrates the velocities and positions of the bodies in the island, solves its constraints, and puts the bodies
+		/// to sleep if they have all been resting for long enough.
+		/// </summary>
+		/// <param name="profile">The profile to add timing information to</param>
+		/// <param name="step">The time step</param>
+		/// <param name="gravity">The world gravity</param>
+		/// <param name="allowSleep">If bodies are allowed to sleep</param>
+		public void Solve(ref Profile profile, in TimeStep step, Vector2 gravity, bool allowSleep) {
+			Timer timer = new();
+			BodyStore store = world.Store;
+			float h = step.DT;
+
+			// Integrate velocities and apply damping. Initialize the body state.
+			for (int i = 0; i < BodyCount; i++) {
+				Body b = Bodies[i];
+				int si = b.StoreIndex;
+				ref Sweep sweep = ref store.Sweeps[si];
+
+				Vector2 c = sweep.EndCenter;
+				float a = sweep.EndAngle;
+				Velocity vel = store.Velocities[si];
+
+				// Store positions for continuous collision
+				sweep.StartCenter = sweep.EndCenter;
+				sweep.StartAngle = sweep.EndAngle;
+
+				if (b.Type == BodyType.Dynamic) {
+					// Integrate velocities
+					float invMass = store.InvMasses[si];
+					vel.V += h * invMass * (store.GravityScales[si] * b.Mass * gravity + store.Forces[si]);
+					vel.W += h * store.InvInertias[si] * store.Torques[si];
+
+					// Apply damping, using the Padé approximation of the exact solution of dv/dt + c * v = 0
+					vel.V *= 1.0f / (1.0f + h * store.LinearDampings[si]);
+					vel.W *= 1.0f / (1.0f + h * store.AngularDampings[si]);
+				}
+
+				positions[i] = new Position() { C = c, A = a };
+				velocities[i] = vel;
+			}
+
+			timer.Reset();
+
+			// Solver data
+			SolverData solverData = new() {
+				Step = step,
+				Positions = positions.AsSpan(0, BodyCount),
+				Velocities = velocities.AsSpan(0, BodyCount)
+			};
+
+			// Initialize velocity constraints
+			contactSolver.Initialize(new ContactSolverDef() {
+				Step = step,
+				Contacts = Contacts,
+				Count = ContactCount,
+				Positions = positions,
+				Velocities = velocities,
+				BodyCount = BodyCount,
+				Deterministic = world.Deterministic,
+				MaxParallelism = world.MaxSolverParallelism
+			});
+			contactSolver.InitializeVelocityConstraints();
+
+			if (step.WarmStarting) contactSolver.WarmStart();
+
+			for (int i = 0; i < JointCount; i++) Joints[i].InitVelocityConstraints(solverData);
+
+			profile.SolveInit += timer.Milliseconds;
+
+			// Solve velocity constraints
+			timer.Reset();
+			for (int i = 0; i < step.VelocityIterations; i++) {
+				for (int j = 0; j < JointCount; j++) Joints[j].SolveVelocityConstraints(solverData);
+				contactSolver.SolveVelocityConstraints();
+			}
+
+			// Store impulses for warm starting
+			contactSolver.StoreImpulses();
+			profile.SolveVelocity += timer.Milliseconds;
+
+			// Integrate positions
+			IntegratePositions(h);
+
+			// Solve position constraints
+			timer.Reset();
+			bool positionSolved = false;
+			for (int i = 0; i < step.PositionIterations; i++) {
+				bool contactsOkay = contactSolver.SolvePositionConstraints();
+
+				bool jointsOkay = true;
+				for (int j = 0; j < JointCount; j++) {
+					bool jointOkay = Joints[j].SolvePositionConstraints(solverData);
+					jointsOkay = jointsOkay && jointOkay;
+				}
+
+				if (contactsOkay && jointsOkay) {
+					// Exit early if the position errors are small
+					positionSolved = true;
+					break;
+				}
+			}
+
+			// Copy state buffers back to the bodies
+			for (int i = 0; i < BodyCount; i++) {
+				Body body = Bodies[i];
+				int si = body.StoreIndex;
+				ref Sweep sweep = ref store.Sweeps[si];
+				sweep.EndCenter = positions[i].C;
+				sweep.EndAngle = positions[i].A;
+				store.Velocities[si] = velocities[i];
+				body.SynchronizeTransform();
+			}
+
+			profile.SolvePosition += timer.Milliseconds;
+
+			Report(contactSolver.VelocityConstraints);
+
+			if (allowSleep) {
+				float minSleepTime = Box2D.MaxFloat;
+
+				const float linTolSqr = Box2D.LinearSleepTolerance * Box2D.LinearSleepTolerance;
+				const float angTolSqr = Box2D.AngularSleepTolerance * Box2D.AngularSleepTolerance;
+
+				for (int i = 0; i < BodyCount; i++) {
+					Body b = Bodies[i];
+					if (b.Type == BodyType.Static) continue;
+
+					int si = b.StoreIndex;
+					Velocity vel = store.Velocities[si];
+					if ((b.Flags & Body.BodyFlags.AutoSleep) == 0 || vel.W * vel.W > angTolSqr || vel.V.Dot(vel.V) > linTolSqr) {
+						store.SleepTimes[si] = 0;
+						minSleepTime = 0;
+					} else {
+						store.SleepTimes[si] += h;
+						minSleepTime = Math.Min(minSleepTime, store.SleepTimes[si]);
+					}
+				}
+
+				if (minSleepTime >= Box2D.TimeToSleep && positionSolved) {
+					for (int i = 0; i < BodyCount; i++) Bodies[i].IsAwake = false;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Solves the island built around a time of impact event between two bodies, advancing them to a safe position and
+		/// solving velocities for the remainder of the step.
+		/// </summary>
+		/// <param name="subStep">The sub-step covering the remainder of the step</param>
+		/// <param name="toiIndexA">The island index of the first body of the event</param>
+		/// <param name="toiIndexB">The island index of the second body of the event</param>
+		public void SolveTOI(in TimeStep subStep, int toiIndexA, int toiIndexB) {
+			BodyStore store = world.Store;
+
+			// Initialize the body state
+			for (int i = 0; i < BodyCount; i++) {
+				int si = Bodies[i].StoreIndex;
+				ref Sweep sweep = ref store.Sweeps[si];
+				positions[i] = new Position() { C = sweep.EndCenter, A = sweep.EndAngle };
+				velocities[i] = store.Velocities[si];
+			}
+
+			// TOI islands are small, so they always use the sequential solver
+			contactSolver.Initialize(new ContactSolverDef() {
+				Step = subStep,
+				Contacts = Contacts,
+				Count = ContactCount,
+				Positions = positions,
+				Velocities = velocities,
+				BodyCount = BodyCount
+			});
+
+			// Solve position constraints
+			for (int i = 0; i < subStep.PositionIterations; i++) {
+				if (contactSolver.SolveTOIPositionConstraints(toiIndexA, toiIndexB)) break;
+			}
+
+			// Leap of faith to new safe state
+			ref Sweep sweepA = ref Bodies[toiIndexA].Sweep;
+			sweepA.StartCenter = positions[toiIndexA].C;
+			sweepA.StartAngle = positions[toiIndexA].A;
+			ref Sweep sweepB = ref Bodies[toiIndexB].Sweep;
+			sweepB.StartCenter = positions[toiIndexB].C;
+			sweepB.StartAngle = positions[toiIndexB].A;
+
+			// No warm starting is needed for TOI events because warm starting impulses were applied in the discrete solver
+			contactSolver.InitializeVelocityConstraints();
+
+			// Solve velocity constraints
+			for (int i = 0; i < subStep.VelocityIterations; i++) contactSolver.SolveVelocityConstraints();
+
+			// Don't store the TOI contact forces for warm starting because they can be quite large
+
+			// Integrate positions
+			IntegratePositions(subStep.DT);
+
+			// Sync bodies
+			for (int i = 0; i < BodyCount; i++) {
+				Body body = Bodies[i];
+				int si = body.StoreIndex;
+				ref Sweep sweep = ref store.Sweeps[si];
+				sweep.EndCenter = positions[i].C;
+				sweep.EndAngle = positions[i].A;
+				store.Velocities[si] = velocities[i];
+				body.SynchronizeTransform();
+			}
+
+			Report(contactSolver.VelocityConstraints);
+		}
+
+		// Integrates the island positions over a time step, clamping large velocities
+		private void IntegratePositions(float h) {
+			for (int i = 0; i < BodyCount; i++) {
+				Vector2 c = positions[i].C;
+				float a = positions[i].A;
+				Vector2 v = velocities[i].V;
+				float w = velocities[i].W;
+
+				// Check for large velocities
+				Vector2 translation = h * v;
+				if (translation.Dot(translation) > Box2D.MaxTranslationSquared) {
+					float ratio = Box2D.MaxTranslation / translation.Length();
+					v *= ratio;
+				}
+
+				float rotation = h * w;
+				if (rotation * rotation > Box2D.MaxRotationSquared) {
+					float ratio = Box2D.MaxRotation / MathF.Abs(rotation);
+					w *= ratio;
+				}
+
+				// Integrate
+				c += h * v;
+				a += h * w;
+
+				positions[i] = new Position() { C = c, A = a };
+				velocities[i] = new Velocity() { V = v, W = w };
+			}
+		}
+
+		// Reports the impulses applied to each contact to the contact listener
+		private void Report(ReadOnlySpan<ContactVelocityConstraint> constraints) {
+			IContactListener? listener = world.ContactListener;
+			if (listener == null) return;
+
+			for (int i = 0; i < ContactCount; i++) {
+				ref readonly ContactVelocityConstraint vc = ref constraints[i];
+
+				impulse.Count = vc.PointCount;
+				Span<float> normalImpulses = impulse.NormalImpulses, tangentImpulses = impulse.TangentImpulses;
+				normalImpulses[0] = vc.Point1.NormalImpulse;
+				tangentImpulses[0] = vc.Point1.TangentImpulse;
+				if (vc.PointCount > 1) {
+					normalImpulses[1] = vc.Point2.NormalImpulse;
+					tangentImpulses[1] = vc.Point2.TangentImpulse;
+				}
+
+				listener.PostSolve(Contacts[i], impulse);
+			}
+		}
+
+	}
+
+}
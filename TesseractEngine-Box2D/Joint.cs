@@ -110,14 +110,13 @@ namespace Tesseract.Box2D.NET {
 
 		public abstract float GetReactionTorque(float invDt);
 
-		internal Joint? Prev;
-
-		public Joint? Next { get; }
-
 		public bool IsEnabled => BodyA.IsEnabled && BodyB.IsEnabled;
 
 		public bool IsCollideConnected { get; }
 
+		/// <summary>
+		/// The index of this joint in the world's joint list.
+		/// </summary>
 		internal int Index;
 
 		internal bool IslandFlag;
@@ -127,25 +126,16 @@ namespace Tesseract.Box2D.NET {
 		internal static Joint Create(JointDef def) {
 			switch (def.Type) {
 				case JointType.Revolute:
-					break;
 				case JointType.Prismatic:
-					break;
 				case JointType.Distance:
-					break;
 				case JointType.Pulley:
-					break;
 				case JointType.Mouse:
-					break;
 				case JointType.Gear:
-					break;
 				case JointType.Wheel:
-					break;
 				case JointType.Weld:
-					break;
 				case JointType.Friction:
-					break;
 				case JointType.Motor:
-					break;
+					throw new NotSupportedException($"Joint type {def.Type} is not implemented");
 				default:
 					throw new ArgumentException("Undefined joint type", nameof(def));
 			}
@@ -153,7 +143,6 @@ namespace Tesseract.Box2D.NET {
 
 		protected Joint(JointDef def) {
 			Type = def.Type;
-			Prev = Next = null;
 			BodyA = def.BodyA;
 			BodyB = def.BodyB;
 			Index = 0;
@@ -164,11 +153,11 @@ namespace Tesseract.Box2D.NET {
 			EdgeB = new();
 		}
 
-		public abstract void InitVelocityConstraints(SolverData data);
+		internal abstract void InitVelocityConstraints(SolverData data);
 
-		public abstract void SolveVelocityConstraints(SolverData data);
+		internal abstract void SolveVelocityConstraints(SolverData data);
 
-		public abstract void SolvePositionConstraints(SolverData data);
+		internal abstract bool SolvePositionConstraints(SolverData data);
 
 	}
 }
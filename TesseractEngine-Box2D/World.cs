@@ -7,41 +7,795 @@ using System.Threading.Tasks;
 
 namespace Tesseract.Box2D.NET {
 
+	/// <summary>
+	/// The world manages all physics entities, dynamic simulation, and asynchronous queries.
+	/// </summary>
 	public class World {
 
+		/// <summary>
+		/// Listener notified when joints and fixtures are implicitly destroyed because their body was destroyed.
+		/// </summary>
 		public IDestructionListener? DestructionListener { get; set; }
 
+		/// <summary>
+		/// Filter deciding which fixtures may collide. If null, <see cref="Box2D.ShouldCollide(Fixture, Fixture)"/> is used.
+		/// </summary>
 		public ContactFilter? ContactFilter { get; set; }
 
+		/// <summary>
+		/// Listener notified of contact events.
+		/// </summary>
 		public IContactListener? ContactListener { get; set; }
 
+		/// <summary>
+		/// The global gravity vector.
+		/// </summary>
+		public Vector2 Gravity { get; set; }
+
+		private bool allowSleeping = true;
+		/// <summary>
+		/// If bodies are allowed to sleep. Disabling sleeping wakes every body.
+		/// </summary>
+		public bool AllowSleeping {
+			get => allowSleeping;
+			set {
+				if (value == allowSleeping) return;
+				allowSleeping = value;
+				if (!value) {
+					foreach (Body b in bodies) b.IsAwake = true;
+				}
+			}
+		}
+
+		/// <summary>
+		/// If the solver is warm started using the impulses of the previous step.
+		/// </summary>
+		public bool WarmStarting { get; set; } = true;
+
+		/// <summary>
+		/// If continuous collision is performed to prevent fast moving bodies from tunnelling.
+		/// </summary>
+		public bool ContinuousPhysics { get; set; } = true;
+
+		/// <summary>
+		/// If time of impact events are solved one per step, used for debugging continuous collision.
+		/// </summary>
+		public bool SubStepping { get; set; } = false;
+
+		/// <summary>
+		/// If forces are automatically cleared after each step.
+		/// </summary>
+		public bool AutoClearForces { get; set; } = true;
+
+		/// <summary>
+		/// <para>
+		/// If the world must step deterministically, producing bit-identical results for the same sequence of inputs regardless
+		/// of thread scheduling or the number of available processors. This is required for lockstep networking and replays.
+		/// </para>
+		/// <para>
+		/// When set, any stage which may be executed in parallel uses its single-threaded path instead. In particular contacts
+		/// are solved one at a time in a fixed order, instead of large islands being solved by the graph colored SIMD solver
+		/// whose results depend on the vector width of the processor.
+		/// </para>
+		/// </summary>
+		public bool Deterministic { get; set; } = false;
+
+		/// <summary>
+		/// The maximum number of threads used to solve the contacts of a large island when the world is not
+		/// <see cref="Deterministic"/>. A value of 1 still uses the SIMD solver but on the stepping thread only.
+		/// </summary>
+		public int MaxSolverParallelism { get; set; } = Environment.ProcessorCount;
+
+		private Profile profile;
+		/// <summary>
+		/// Timing information for the last step, in milliseconds.
+		/// </summary>
+		public Profile Profile => profile;
+
+		/// <summary>
+		/// If the world is locked because it is in the middle of a time step.
+		/// </summary>
+		public bool IsLocked { get; private set; } = false;
+
+		private readonly List<Body> bodies = new();
+		/// <summary>
+		/// The bodies in the world. The order of bodies changes when a body is destroyed.
+		/// </summary>
+		public IReadOnlyList<Body> Bodies => bodies;
+
+		/// <summary>
+		/// The contacts in the world. The order of contacts changes when a contact is destroyed.
+		/// </summary>
+		public IReadOnlyList<Contact> Contacts => ContactManager.Contacts;
+
+		private readonly List<Joint> joints = new();
+		/// <summary>
+		/// The joints in the world. The order of joints changes when a joint is destroyed.
+		/// </summary>
+		public IReadOnlyList<Joint> Joints => joints;
+
+		/// <summary>
+		/// The per-body state, indexed by <see cref="Body.StoreIndex"/>.
+		/// </summary>
+		internal BodyStore Store { get; } = new();
+
+		internal ContactManager ContactManager { get; }
+
+		/// <summary>
+		/// If new fixtures have been created, so new contacts need to be found before the next step.
+		/// </summary>
+		internal bool NewContacts = false;
+
+		private readonly Island island;
+
+		// Stack used for the island depth first search
+		private Body[] islandStack = Array.Empty<Body>();
+
+		// Used to compute the time step ratio to support a variable time step
+		private float invDt0 = 0;
+
+		// If the last time of impact solve completed, false if it was interrupted for sub-stepping
+		private bool stepComplete = true;
+
+		public World(Vector2 gravity) {
+			Gravity = gravity;
+			ContactManager = new ContactManager(this);
+			island = new Island(this);
+		}
+
+		/// <summary>
+		/// Throws an exception if the world is locked.
+		/// </summary>
+		internal void CheckUnlocked() {
+			if (IsLocked) throw new InvalidOperationException("Cannot modify the world during a time step");
+		}
+
+		/// <summary>
+		/// Creates a rigid body. This cannot be called during callbacks.
+		/// </summary>
+		/// <param name="def">The body definition</param>
+		/// <returns>The created body</returns>
 		public Body CreateBody(BodyDef def) {
+			CheckUnlocked();
+			int storeIndex = Store.Add();
+			Body body = new(def, this, storeIndex);
+			bodies.Add(body);
+			return body;
+		}
+
+		/// <summary>
+		/// Destroys a rigid body, along with any joints, contacts, and fixtures attached to it. This cannot be called during callbacks.
+		/// </summary>
+		/// <param name="body">The body to destroy</param>
+		public void DestroyBody(Body body) {
+			CheckUnlocked();
+			if (body.World != this || body.StoreIndex < 0) throw new ArgumentException("Body does not belong to this world", nameof(body));
+
+			// Delete the attached joints
+			JointEdge? je = body.JointList;
+			while (je != null) {
+				JointEdge je0 = je;
+				je = je.Next;
+				DestructionListener?.SayGoodbye(je0.Joint);
+				DestroyJoint(je0.Joint);
+			}
+			body.JointList = null;
 
+			// Delete the attached contacts
+			body.DestroyContacts();
+
+			// Delete the attached fixtures, this destroys their broad-phase proxies
+			BroadPhase broadPhase = ContactManager.BroadPhase;
+			for (Fixture? f = body.FixtureList; f != null; f = f.Next) {
+				DestructionListener?.SayGoodbye(f);
+				f.DestroyProxies(broadPhase);
+				f.IsDestroyed = true;
+			}
+
+			// Remove the body from the store, moving the last body into its place
+			int index = body.StoreIndex;
+			int last = Store.RemoveAt(index);
+			if (index != last) {
+				Body moved = bodies[last];
+				moved.StoreIndex = index;
+				bodies[index] = moved;
+			}
+			bodies.RemoveAt(last);
+			body.StoreIndex = -1;
 		}
 
+		/// <summary>
+		/// Creates a joint to constrain bodies together. This may cause the connected bodies to stop colliding. This cannot
+		/// be called during callbacks.
+		/// </summary>
+		/// <param name="def">The joint definition</param>
+		/// <returns>The created joint</returns>
 		public Joint CreateJoint(JointDef def) {
+			CheckUnlocked();
+
+			Joint j = Joint.Create(def);
+
+			// Connect to the world list
+			j.Index = joints.Count;
+			joints.Add(j);
+
+			// Connect to the bodies' doubly linked lists
+			Body bodyA = j.BodyA, bodyB = j.BodyB;
+
+			j.EdgeA.Joint = j;
+			j.EdgeA.Other = bodyB;
+			j.EdgeA.Prev = null;
+			j.EdgeA.Next = bodyA.JointList;
+			if (bodyA.JointList != null) bodyA.JointList.Prev = j.EdgeA;
+			bodyA.JointList = j.EdgeA;
+
+			j.EdgeB.Joint = j;
+			j.EdgeB.Other = bodyA;
+			j.EdgeB.Prev = null;
+			j.EdgeB.Next = bodyB.JointList;
+			if (bodyB.JointList != null) bodyB.JointList.Prev = j.EdgeB;
+			bodyB.JointList = j.EdgeB;
+
+			// If the joint prevents collisions, then flag any contacts for filtering
+			if (!def.CollideConnected) FlagContactsForFiltering(bodyA, bodyB);
+
+			return j;
+		}
+
+		/// <summary>
+		/// Destroys a joint. This may cause the connected bodies to begin colliding. This cannot be called during callbacks.
+		/// </summary>
+		/// <param name="j">The joint to destroy</param>
+		public void DestroyJoint(Joint j) {
+			CheckUnlocked();
+
+			// Remove from the world list, moving the last joint into its place
+			int last = joints.Count - 1;
+			if (j.Index != last) {
+				Joint moved = joints[last];
+				moved.Index = j.Index;
+				joints[j.Index] = moved;
+			}
+			joints.RemoveAt(last);
+			j.Index = -1;
+
+			// Disconnect from the bodies
+			Body bodyA = j.BodyA, bodyB = j.BodyB;
+
+			// Wake up connected bodies
+			bodyA.IsAwake = true;
+			bodyB.IsAwake = true;
 
+			if (j.EdgeA.Prev != null) j.EdgeA.Prev.Next = j.EdgeA.Next;
+			if (j.EdgeA.Next != null) j.EdgeA.Next.Prev = j.EdgeA.Prev;
+			if (j.EdgeA == bodyA.JointList) bodyA.JointList = j.EdgeA.Next;
+			j.EdgeA.Prev = null;
+			j.EdgeA.Next = null;
+
+			if (j.EdgeB.Prev != null) j.EdgeB.Prev.Next = j.EdgeB.Next;
+			if (j.EdgeB.Next != null) j.EdgeB.Next.Prev = j.EdgeB.Prev;
+			if (j.EdgeB == bodyB.JointList) bodyB.JointList = j.EdgeB.Next;
+			j.EdgeB.Prev = null;
+			j.EdgeB.Next = null;
+
+			// If the joint prevented collisions, then flag any contacts for filtering
+			if (!j.IsCollideConnected) FlagContactsForFiltering(bodyA, bodyB);
 		}
 
+		private static void FlagContactsForFiltering(Body bodyA, Body bodyB) {
+			for (ContactEdge? edge = bodyB.ContactList; edge != null; edge = edge.Next) {
+				if (edge.Other == bodyA) edge.Contact.FlagForFiltering();
+			}
+		}
+
+		/// <summary>
+		/// Takes a time step. This performs collision detection, integration, and constraint solution.
+		/// </summary>
+		/// <param name="timeStep">The amount of time to simulate, this should not vary</param>
+		/// <param name="velocityIterations">The number of iterations for the velocity constraint solver</param>
+		/// <param name="positionIterations">The number of iterations for the position constraint solver</param>
 		public void Step(float timeStep, int velocityIterations, int positionIterations) {
+			Timer stepTimer = new();
+
+			// If new fixtures were added, we need to find the new contacts
+			if (NewContacts) {
+				ContactManager.FindNewContacts();
+				NewContacts = false;
+			}
 
+			IsLocked = true;
+			try {
+				TimeStep step = new() {
+					DT = timeStep,
+					VelocityIterations = velocityIterations,
+					PositionIterations = positionIterations,
+					InvDT = timeStep > 0 ? 1.0f / timeStep : 0,
+					WarmStarting = WarmStarting
+				};
+				step.DTRatio = invDt0 * timeStep;
+
+				profile = default;
+
+				// Update contacts. This is where some contacts are destroyed.
+				Timer timer = new();
+				ContactManager.Collide();
+				profile.Collide = timer.Milliseconds;
+
+				// Integrate velocities, solve velocity constraints, and integrate positions
+				if (stepComplete && step.DT > 0) {
+					timer.Reset();
+					Solve(step);
+					profile.Solve = timer.Milliseconds;
+				}
+
+				// Handle TOI events
+				if (ContinuousPhysics && step.DT > 0) {
+					timer.Reset();
+					SolveTOI(step);
+					profile.SolveTOI = timer.Milliseconds;
+				}
+
+				if (step.DT > 0) invDt0 = step.InvDT;
+
+				if (AutoClearForces) ClearForces();
+			} finally {
+				IsLocked = false;
+			}
+
+			profile.Step = stepTimer.Milliseconds;
 		}
 
-		public void ClearForces() {
+		/// <summary>
+		/// Manually clears the accumulated forces of every body. This is done automatically after each step if
+		/// <see cref="AutoClearForces"/> is set.
+		/// </summary>
+		public void ClearForces() => Store.ClearForces();
+
+		// Finds islands, integrates and solves constraints, and solves position constraints
+		private void Solve(in TimeStep step) {
+			// Size the island for the worst case
+			int bodyCount = bodies.Count;
+			List<Contact> contacts = ContactManager.Contacts;
+			island.Reset(bodyCount, contacts.Count, joints.Count);
+
+			// Clear all the island flags
+			foreach (Body b in bodies) b.Flags &= ~Body.BodyFlags.Island;
+			foreach (Contact c in contacts) c.Flags &= ~Contact.ContactFlags.Island;
+			foreach (Joint j in joints) j.IslandFlag = false;
+
+			// Build and simulate all awake islands
+			if (islandStack.Length < bodyCount) islandStack = new Body[bodyCount];
+			Body[] stack = islandStack;
+
+			foreach (Body seed in bodies) {
+				if ((seed.Flags & Body.BodyFlags.Island) != 0) continue;
+				if (!seed.IsAwake || !seed.IsEnabled) continue;
+
+				// The seed can be dynamic or kinematic
+				if (seed.Type == BodyType.Static) continue;
+
+				// Reset island and stack
+				island.Clear();
+				int stackCount = 0;
+				stack[stackCount++] = seed;
+				seed.Flags |= Body.BodyFlags.Island;
+
+				// Perform a depth first search on the constraint graph
+				while (stackCount > 0) {
+					// Grab the next body off the stack and add it to the island
+					Body b = stack[--stackCount];
+					island.Add(b);
+
+					// To keep islands as small as possible, we don't propagate islands across static bodies
+					if (b.Type == BodyType.Static) continue;
+
+					// Make sure the body is awake, without resetting the sleep timer
+					b.Flags |= Body.BodyFlags.Awake;
+
+					// Search all contacts connected to this body
+					for (ContactEdge? ce = b.ContactList; ce != null; ce = ce.Next) {
+						Contact contact = ce.Contact;
+
+						// Has this contact already been added to an island?
+						if ((contact.Flags & Contact.ContactFlags.Island) != 0) continue;
+
+						// Is this contact solid and touching?
+						if (!contact.IsEnabled || !contact.IsTouching) continue;
+
+						// Skip sensors
+						if (contact.FixtureA.IsSensor || contact.FixtureB.IsSensor) continue;
+
+						island.Add(contact);
+						contact.Flags |= Contact.ContactFlags.Island;
+
+						Body other = ce.Other;
+
+						// Was the other body already added to this island?
+						if ((other.Flags & Body.BodyFlags.Island) != 0) continue;
+
+						stack[stackCount++] = other;
+						other.Flags |= Body.BodyFlags.Island;
+					}
+
+					// Search all joints connected to this body
+					for (JointEdge? je = b.JointList; je != null; je = je.Next) {
+						if (je.Joint.IslandFlag) continue;
+
+						Body other = je.Other;
+
+						// Don't simulate joints connected to disabled bodies
+						if (!other.IsEnabled) continue;
 
+						island.Add(je.Joint);
+						je.Joint.IslandFlag = true;
+
+						if ((other.Flags & Body.BodyFlags.Island) != 0) continue;
+
+						stack[stackCount++] = other;
+						other.Flags |= Body.BodyFlags.Island;
+					}
+				}
+
+				island.Solve(ref profile, step, Gravity, allowSleeping);
+
+				// Post solve cleanup, allow static bodies to participate in other islands
+				for (int i = 0; i < island.BodyCount; i++) {
+					Body b = island.Bodies[i];
+					if (b.Type == BodyType.Static) b.Flags &= ~Body.BodyFlags.Island;
+				}
+			}
+
+			island.Clear();
+			Array.Clear(stack, 0, bodyCount);
+
+			{
+				Timer timer = new();
+
+				// Synchronize fixtures, check for out of range bodies
+				foreach (Body b in bodies) {
+					// If a body was not in an island then it did not move
+					if ((b.Flags & Body.BodyFlags.Island) == 0) continue;
+					if (b.Type == BodyType.Static) continue;
+
+					// Update fixtures (for broad-phase)
+					b.SynchronizeFixtures();
+				}
+
+				// Look for new contacts
+				ContactManager.FindNewContacts();
+				profile.Broadphase = timer.Milliseconds;
+			}
 		}
 
+		// Finds TOI contacts and solves them
+		private void SolveTOI(in TimeStep step) {
+			island.Reset(2 * Box2D.MaxTOIContacts, Box2D.MaxTOIContacts, 0);
+			List<Contact> contacts = ContactManager.Contacts;
+
+			if (stepComplete) {
+				foreach (Body b in bodies) {
+					b.Flags &= ~Body.BodyFlags.Island;
+					b.Sweep.StartAlpha = 0;
+				}
+
+				foreach (Contact c in contacts) {
+					// Invalidate TOI
+					c.Flags &= ~(Contact.ContactFlags.TOI | Contact.ContactFlags.Island);
+					c.TOICount = 0;
+					c.TOI = 1;
+				}
+			}
+
+			Span<Body> toiBodies = new Body[2];
+
+			// Find TOI events and solve them
+			for (;;) {
+				// Find the first TOI
+				Contact? minContact = null;
+				float minAlpha = 1;
+
+				foreach (Contact c in contacts) {
+					// Is this contact disabled?
+					if (!c.IsEnabled) continue;
+
+					// Prevent excessive sub-stepping
+					if (c.TOICount > Box2D.MaxSubSteps) continue;
+
+					float alpha;
+					if ((c.Flags & Contact.ContactFlags.TOI) != 0) {
+						// This contact has a valid cached TOI
+						alpha = c.TOI;
+					} else {
+						Fixture fA = c.FixtureA;
+						Fixture fB = c.FixtureB;
+
+						// Is there a sensor?
+						if (fA.IsSensor || fB.IsSensor) continue;
+
+						Body bA = fA.Body;
+						Body bB = fB.Body;
+
+						BodyType typeA = bA.Type;
+						BodyType typeB = bB.Type;
+
+						bool activeA = bA.IsAwake && typeA != BodyType.Static;
+						bool activeB = bB.IsAwake && typeB != BodyType.Static;
+
+						// Is at least one body active (awake and dynamic or kinematic)?
+						if (!activeA && !activeB) continue;
+
+						bool collideA = bA.IsBullet || typeA != BodyType.Dynamic;
+						bool collideB = bB.IsBullet || typeB != BodyType.Dynamic;
+
+						// Are these two non-bullet dynamic bodies?
+						if (!collideA && !collideB) continue;
+
+						// Compute the TOI for this contact, putting the sweeps onto the same time interval
+						ref Sweep sweepA = ref bA.Sweep;
+						ref Sweep sweepB = ref bB.Sweep;
+						float alpha0 = sweepA.StartAlpha;
+
+						if (sweepA.StartAlpha < sweepB.StartAlpha) {
+							alpha0 = sweepB.StartAlpha;
+							sweepA.Advance(alpha0);
+						} else if (sweepB.StartAlpha < sweepA.StartAlpha) {
+							alpha0 = sweepA.StartAlpha;
+							sweepB.Advance(alpha0);
+						}
+
+						int indexA = c.ChildIndexA;
+						int indexB = c.ChildIndexB;
+
+						// Compute the time of impact in interval [0, minTOI]
+						TOIInput input = new() {
+							ProxyA = new DistanceProxy(fA.Shape, indexA),
+							ProxyB = new DistanceProxy(fB.Shape, indexB),
+							SweepA = sweepA,
+							SweepB = sweepB,
+							TMax = 1
+						};
+
+						TOIState state = Box2D.TimeOfImpact(input, out float beta);
+
+						// Beta is the fraction of the remaining portion of the step
+						if (state == TOIState.Touching) alpha = Math.Min(alpha0 + (1 - alpha0) * beta, 1);
+						else alpha = 1;
+
+						c.TOI = alpha;
+						c.Flags |= Contact.ContactFlags.TOI;
+					}
+
+					if (alpha < minAlpha) {
+						// This is the minimum TOI found so far
+						minContact = c;
+						minAlpha = alpha;
+					}
+				}
+
+				if (minContact == null || 1 - 10 * Box2D.Epsilon < minAlpha) {
+					// No more TOI events, done!
+					stepComplete = true;
+					break;
+				}
+
+				{
+					// Advance the bodies to the TOI
+					Body bA = minContact.FixtureA.Body;
+					Body bB = minContact.FixtureB.Body;
+
+					Sweep backup1 = bA.Sweep;
+					Sweep backup2 = bB.Sweep;
+
+					bA.Advance(minAlpha);
+					bB.Advance(minAlpha);
+
+					// The TOI contact likely has some new contact points
+					minContact.Update(ContactListener);
+					minContact.Flags &= ~Contact.ContactFlags.TOI;
+					minContact.TOICount++;
+
+					// Is the contact solid?
+					if (!minContact.IsEnabled || !minContact.IsTouching) {
+						// Restore the sweeps
+						minContact.IsEnabled = false;
+						bA.Sweep = backup1;
+						bB.Sweep = backup2;
+						bA.SynchronizeTransform();
+						bB.SynchronizeTransform();
+						continue;
+					}
+
+					bA.IsAwake = true;
+					bB.IsAwake = true;
+
+					// Build the island
+					island.Clear();
+					island.Add(bA);
+					island.Add(bB);
+					island.Add(minContact);
+
+					bA.Flags |= Body.BodyFlags.Island;
+					bB.Flags |= Body.BodyFlags.Island;
+					minContact.Flags |= Contact.ContactFlags.Island;
+
+					// Get contacts on body A and body B
+					toiBodies[0] = bA;
+					toiBodies[1] = bB;
+					foreach (Body body in toiBodies) {
+						if (body.Type != BodyType.Dynamic) continue;
+
+						for (ContactEdge? ce = body.ContactList; ce != null; ce = ce.Next) {
+							if (island.BodyCount == island.BodyCapacity) break;
+							if (island.ContactCount == island.ContactCapacity) break;
+
+							Contact contact = ce.Contact;
+
+							// Has this contact already been added to the island?
+							if ((contact.Flags & Contact.ContactFlags.Island) != 0) continue;
+
+							// Only add static, kinematic, or bullet bodies
+							Body other = ce.Other;
+							if (other.Type == BodyType.Dynamic && !body.IsBullet && !other.IsBullet) continue;
+
+							// Skip sensors
+							if (contact.FixtureA.IsSensor || contact.FixtureB.IsSensor) continue;
+
+							// Tentatively advance the body to the TOI
+							Sweep backup = other.Sweep;
+							if ((other.Flags & Body.BodyFlags.Island) == 0) other.Advance(minAlpha);
+
+							// Update the contact points
+							contact.Update(ContactListener);
+
+							// Was the contact disabled by the user, or are there no contact points?
+							if (!contact.IsEnabled || !contact.IsTouching) {
+								other.Sweep = backup;
+								other.SynchronizeTransform();
+								continue;
+							}
+
+							// Add the contact to the island
+							contact.Flags |= Contact.ContactFlags.Island;
+							island.Add(contact);
+
+							// Has the other body already been added to the island?
+							if ((other.Flags & Body.BodyFlags.Island) != 0) continue;
+
+							// Add the other body to the island
+							other.Flags |= Body.BodyFlags.Island;
+							if (other.Type != BodyType.Static) other.IsAwake = true;
+							island.Add(other);
+						}
+					}
+
+					float dt = (1 - minAlpha) * step.DT;
+					TimeStep subStep = new() {
+						DT = dt,
+						InvDT = 1 / dt,
+						DTRatio = 1,
+						PositionIterations = 20,
+						VelocityIterations = step.VelocityIterations,
+						WarmStarting = false
+					};
+					island.SolveTOI(subStep, bA.IslandIndex, bB.IslandIndex);
+
+					// Reset island flags and synchronize broad-phase proxies
+					for (int i = 0; i < island.BodyCount; i++) {
+						Body body = island.Bodies[i];
+						body.Flags &= ~Body.BodyFlags.Island;
+
+						if (body.Type != BodyType.Dynamic) continue;
+
+						body.SynchronizeFixtures();
+
+						// Invalidate all contact TOIs on this displaced body
+						for (ContactEdge? ce = body.ContactList; ce != null; ce = ce.Next) {
+							ce.Contact.Flags &= ~(Contact.ContactFlags.TOI | Contact.ContactFlags.Island);
+						}
+					}
+
+					// Commit fixture proxy movements to the broad-phase so that new contacts are created. Also, some contacts can be destroyed.
+					ContactManager.FindNewContacts();
+
+					if (SubStepping) {
+						stepComplete = false;
+						break;
+					}
+				}
+			}
+
+			island.Clear();
+		}
+
+		// Broad-phase callback forwarding the fixtures found by an AABB query
+		private struct QueryWrapper : IQueryCallback {
+
+			public BroadPhase BroadPhase;
+			public QueryCallback Callback;
+
+			public bool QueryCallback(int proxyId) => Callback(BroadPhase.GetUserData(proxyId).Fixture!);
+
+		}
+
+		/// <summary>
+		/// Queries the world for all fixtures that potentially overlap the provided AABB.
+		/// </summary>
+		/// <param name="callback">Callback invoked for each fixture found, returning false to terminate the query</param>
+		/// <param name="aabb">The query box</param>
 		public void QueryAABB(QueryCallback callback, AABB aabb) {
+			QueryWrapper wrapper = new() { BroadPhase = ContactManager.BroadPhase, Callback = callback };
+			ContactManager.BroadPhase.Query(ref wrapper, aabb);
+		}
+
+		// Broad-phase callback ray casting against the fixtures of each proxy the ray may hit
+		private struct RayCastWrapper : IRayCastCallback {
+
+			public BroadPhase BroadPhase;
+			public RaycastCallback Callback;
+
+			public float RayCastCallback(in RayCastInput input, int proxyId) {
+				FixtureProxy proxy = BroadPhase.GetUserData(proxyId);
+				Fixture fixture = proxy.Fixture!;
+				if (fixture.RayCast(out RayCastOutput output, input, proxy.ChildIndex)) {
+					float fraction = output.Fraction;
+					Vector2 point = (1 - fraction) * input.P1 + fraction * input.P2;
+					return Callback(fixture, point, output.Normal, fraction);
+				}
+				return input.MaxFraction;
+			}
 
 		}
 
+		/// <summary>
+		/// Ray-casts the world for all fixtures in the path of the ray. The callback controls whether you get the closest
+		/// point, any point, or n points. The ray-cast ignores shapes that contain the starting point.
+		/// </summary>
+		/// <param name="callback">Callback invoked for each fixture hit, returning the new maximum fraction of the ray</param>
+		/// <param name="point1">The ray starting point</param>
+		/// <param name="point2">The ray ending point</param>
 		public void Raycast(RaycastCallback callback, Vector2 point1, Vector2 point2) {
-
+			RayCastWrapper wrapper = new() { BroadPhase = ContactManager.BroadPhase, Callback = callback };
+			ContactManager.BroadPhase.RayCast(ref wrapper, new RayCastInput() { P1 = point1, P2 = point2, MaxFraction = 1 });
 		}
 
-		public Body? BodyList { get; private set; }
+		/// <summary>
+		/// <para>
+		/// Computes a checksum of the transforms and velocities of every body in the world. Two worlds built and stepped with
+		/// the same inputs in <see cref="Deterministic"/> mode produce the same checksum, so this can be used to detect
+		/// desynchronization between replays or networked peers.
+		/// </para>
+		/// <para>
+		/// The checksum depends on the order of bodies, which is determined by the order they were created and destroyed in.
+		/// </para>
+		/// </summary>
+		/// <returns>64-bit FNV-1a hash of the world state</returns>
+		public ulong ComputeChecksum() {
+			const ulong offsetBasis = 14695981039346656037UL;
+			const ulong prime = 1099511628211UL;
 
+			ulong hash = offsetBasis;
+			void Mix(float value) {
+				uint bits = BitConverter.SingleToUInt32Bits(value);
+				for (int i = 0; i < 4; i++) {
+					hash ^= (bits >> (i * 8)) & 0xFF;
+					hash *= prime;
+				}
+			}
 
+			BodyStore store = Store;
+			for (int i = 0; i < store.Count; i++) {
+				Transform xf = store.Transforms[i];
+				Velocity vel = store.Velocities[i];
+				Mix(xf.Position.X);
+				Mix(xf.Position.Y);
+				Mix(xf.Rotation.Sine);
+				Mix(xf.Rotation.Cosine);
+				Mix(vel.V.X);
+				Mix(vel.V.Y);
+				Mix(vel.W);
+			}
+			return hash;
+		}
 
 	}
 
@@ -17,6 +17,27 @@ namespace Tesseract.Box2D.NET {
 
 	public delegate bool ContactFilter(Fixture fixtureA, Fixture fixtureB);
 
+	public static partial class Box2D {
+
+		/// <summary>
+		/// The default contact filter, used if a world has no <see cref="World.ContactFilter"/>. If the fixtures share a non-zero
+		/// group index they always collide if it is positive and never collide if it is negative, otherwise they collide if
+		/// the category of each fixture is included in the mask of the other.
+		/// </summary>
+		/// <param name="fixtureA">The first fixture</param>
+		/// <param name="fixtureB">The second fixture</param>
+		/// <returns>If contact calculations should be performed between the fixtures</returns>
+		public static bool ShouldCollide(Fixture fixtureA, Fixture fixtureB) {
+			Filter filterA = fixtureA.Filter;
+			Filter filterB = fixtureB.Filter;
+
+			if (filterA.GroupIndex == filterB.GroupIndex && filterA.GroupIndex != 0) return filterA.GroupIndex > 0;
+
+			return (filterA.MaskBits & filterB.CategoryBits) != 0 && (filterA.CategoryBits & filterB.MaskBits) != 0;
+		}
+
+	}
+
 	public struct ContactImpulse {
 
 		private readonly float[] normalImpulses = new float[Box2D.MaxManifoldPoints];
@@ -1,4 +1,5 @@
 ﻿using System;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.Diagnostics.CodeAnalysis;
 using System.Linq;
@@ -19,60 +20,353 @@ namespace Tesseract.Core.Collections {
 	/// 'major' coordinates, which are the coordinates of any particular entry for a chunk shifted right by
 	/// the <see cref="ChunkShift"/> value.
 	/// </para>
+	/// <para>
+	/// Chunks are flat arrays stored in row-major order, so each row of a chunk is contiguous and can be accessed
+	/// as a span (see <see cref="GetRegion(Recti, bool)"/>). The most recently accessed chunk is cached to skip the
+	/// hash lookup for successive accesses within the same chunk.
+	/// </para>
+	/// <para>
+	/// A grid may be created in concurrent mode, in which case reads are lock-free and chunks may be created
+	/// and written from multiple threads at once. Writes to the same entry from multiple threads are not
+	/// ordered, and entry types larger than a machine word may be observed partially written.
+	/// </para>
 	/// </summary>
 	/// <typeparam name="T">The type of entries stored in the grid</typeparam>
 	public class Grid2D<T> {
 
+		// A chunk paired with its major coordinates, so the pair can be cached atomically
+		private sealed class Chunk {
+
+			public readonly Vector2i Major;
+
+			public readonly T[] Entries;
+
+			public Chunk(Vector2i major, int size) {
+				Major = major;
+				Entries = new T[size];
+			}
+
+		}
+
 		private readonly Vector2i chunkSize;
 		private readonly Vector2i chunkMask, chunkShift;
-		private readonly Dictionary<Vector2i, T[,]> chunks;
+		private readonly Dictionary<Vector2i, Chunk>? chunks;
+		private readonly ConcurrentDictionary<Vector2i, Chunk>? concurrentChunks;
+		private readonly Func<Vector2i, Chunk> createChunk;
+		// The most recently accessed chunk
+		private Chunk? lastChunk = null;
 
 		/// <summary>
 		/// The size of each chunk of entries.
 		/// </summary>
 		public Vector2i ChunkSize => chunkSize;
 
+		/// <summary>
+		/// The mask applied to coordinates to get the minor coordinates within a chunk.
+		/// </summary>
 		public Vector2i ChunkMask => chunkMask;
 
+		/// <summary>
+		/// The shift applied to coordinates to get the major coordinates of a chunk.
+		/// </summary>
 		public Vector2i ChunkShift => chunkShift;
 
-		public Grid2D(Vector2i chunkSize = default) {
+		/// <summary>
+		/// If the grid supports concurrent reads and writes.
+		/// </summary>
+		public bool Concurrent => concurrentChunks != null;
+
+		/// <summary>
+		/// The number of chunks allocated in the grid.
+		/// </summary>
+		public int ChunkCount => concurrentChunks != null ? concurrentChunks.Count : chunks!.Count;
+
+		/// <summary>
+		/// Creates a new grid.
+		/// </summary>
+		/// <param name="chunkSize">The size of chunks, rounded up to a power of two, defaulting to 16x16</param>
+		/// <param name="concurrent">If the grid should support concurrent access</param>
+		public Grid2D(Vector2i chunkSize = default, bool concurrent = false) {
 			if (chunkSize == default) chunkSize = new(16);
 			this.chunkSize = new(
 				(int)BitOperations.RoundUpToPowerOf2((uint)chunkSize.X),
 				(int)BitOperations.RoundUpToPowerOf2((uint)chunkSize.Y)
 			);
-			chunkMask = chunkSize - 1;
+			chunkMask = this.chunkSize - 1;
 			chunkShift = new(
-				BitOperations.Log2((uint)chunkSize.X),
-				BitOperations.Log2((uint)chunkSize.Y)
+				BitOperations.Log2((uint)this.chunkSize.X),
+				BitOperations.Log2((uint)this.chunkSize.Y)
 			);
-			chunks = new Dictionary<Vector2i, T[,]>();
+			if (concurrent) concurrentChunks = new ConcurrentDictionary<Vector2i, Chunk>();
+			else chunks = new Dictionary<Vector2i, Chunk>();
+			int entryCount = this.chunkSize.X * this.chunkSize.Y;
+			createChunk = major => new Chunk(major, entryCount);
 		}
 
 		[MethodImpl(MethodImplOptions.AggressiveInlining)]
-		public bool TryGetChunk(Vector2i point, [MaybeNullWhen(false)] out T[,] chunk) => chunks.TryGetValue(point >> chunkShift, out chunk);
+		private int MinorIndex(Vector2i point) => ((point.Y & chunkMask.Y) << chunkShift.X) | (point.X & chunkMask.X);
 
-		public T[,] GetChunk(Vector2i point) {
-			if (TryGetChunk(point, out T[,]? chunk)) return chunk;
-			chunk = new T[chunkSize.X, chunkSize.Y];
-			chunks[point >> chunkShift] = chunk;
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private Chunk? FindChunk(Vector2i major) {
+			Chunk? chunk = lastChunk;
+			if (chunk != null && chunk.Major == major) return chunk;
+			if (concurrentChunks != null) concurrentChunks.TryGetValue(major, out chunk);
+			else chunks!.TryGetValue(major, out chunk);
+			if (chunk != null) lastChunk = chunk;
 			return chunk;
 		}
 
+		private Chunk FindOrCreateChunk(Vector2i major) {
+			Chunk? chunk = FindChunk(major);
+			if (chunk != null) return chunk;
+			if (concurrentChunks != null) {
+				chunk = concurrentChunks.GetOrAdd(major, createChunk);
+			} else {
+				chunk = createChunk(major);
+				chunks!.Add(major, chunk);
+			}
+			lastChunk = chunk;
+			return chunk;
+		}
+
+		/// <summary>
+		/// Gets the index of an entry within its chunk's array.
+		/// </summary>
+		/// <param name="point">The coordinates of the entry</param>
+		/// <returns>The index of the entry in its chunk</returns>
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		public int GetChunkIndex(Vector2i point) => MinorIndex(point);
+
+		/// <summary>
+		/// Attempts to get the chunk containing the given entry, without allocating it if it does not exist.
+		/// </summary>
+		/// <param name="point">The coordinates of the entry</param>
+		/// <param name="chunk">The chunk's entries in row-major order</param>
+		/// <returns>If the chunk exists</returns>
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		public bool TryGetChunk(Vector2i point, [MaybeNullWhen(false)] out T[] chunk) {
+			chunk = FindChunk(point >> chunkShift)?.Entries;
+			return chunk != null;
+		}
+
+		/// <summary>
+		/// Gets the chunk containing the given entry, allocating it if it does not exist.
+		/// </summary>
+		/// <param name="point">The coordinates of the entry</param>
+		/// <returns>The chunk's entries in row-major order</returns>
+		public T[] GetChunk(Vector2i point) => FindOrCreateChunk(point >> chunkShift).Entries;
+
+		/// <summary>
+		/// Removes the chunk containing the given entry.
+		/// </summary>
+		/// <param name="point">The coordinates of the entry</param>
+		/// <returns>If a chunk was removed</returns>
+		public bool RemoveChunk(Vector2i point) {
+			Vector2i major = point >> chunkShift;
+			bool removed = concurrentChunks != null ? concurrentChunks.TryRemove(major, out _) : chunks!.Remove(major);
+			if (removed) lastChunk = null;
+			return removed;
+		}
+
+		/// <summary>
+		/// Removes all chunks from the grid.
+		/// </summary>
+		public void Clear() {
+			if (concurrentChunks != null) concurrentChunks.Clear();
+			else chunks!.Clear();
+			lastChunk = null;
+		}
+
+		/// <summary>
+		/// Attempts to get an entry from the grid, without allocating any chunks.
+		/// </summary>
+		/// <param name="point">The coordinates of the entry</param>
+		/// <param name="item">The entry value</param>
+		/// <returns>If the chunk containing the entry exists</returns>
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		public bool TryGet(Vector2i point, [MaybeNullWhen(false)] out T item) {
+			Chunk? chunk = FindChunk(point >> chunkShift);
+			if (chunk == null) {
+				item = default;
+				return false;
+			}
+			item = chunk.Entries[MinorIndex(point)];
+			return true;
+		}
+
+		/// <summary>
+		/// Gets a reference to an entry in the grid, allocating its chunk if it does not exist.
+		/// </summary>
+		/// <param name="point">The coordinates of the entry</param>
+		/// <returns>Reference to the entry</returns>
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		public ref T GetRef(Vector2i point) => ref FindOrCreateChunk(point >> chunkShift).Entries[MinorIndex(point)];
+
 		public void Add(Vector2i point, T item) => this[point] = item;
 
+		/// <summary>
+		/// Gets or sets an entry in the grid. Getting an entry whose chunk does not exist returns the default
+		/// value without allocating the chunk.
+		/// </summary>
+		/// <param name="point">The coordinates of the entry</param>
+		/// <returns>The entry value</returns>
 		public T this[Vector2i point] {
+			[MethodImpl(MethodImplOptions.AggressiveInlining)]
 			get {
-				Vector2i minorpos = point & chunkMask;
-				return GetChunk(point)[minorpos.X, minorpos.Y];
+				Chunk? chunk = FindChunk(point >> chunkShift);
+				return chunk != null ? chunk.Entries[MinorIndex(point)] : default!;
+			}
+			[MethodImpl(MethodImplOptions.AggressiveInlining)]
+			set => FindOrCreateChunk(point >> chunkShift).Entries[MinorIndex(point)] = value;
+		}
+
+		/// <summary>
+		/// Gets an enumerator over the spans of entries covering a region of the grid. The region is
+		/// visited chunk by chunk, and each span is a row segment within a single chunk.
+		/// </summary>
+		/// <param name="area">The region of the grid to enumerate</param>
+		/// <param name="create">If chunks which do not exist should be allocated, otherwise they are skipped</param>
+		/// <returns>Region enumerator</returns>
+		public RegionEnumerator GetRegion(Recti area, bool create = false) => new(this, area, create);
+
+		/// <summary>
+		/// Sets every entry in a region of the grid to a value, allocating chunks as needed.
+		/// </summary>
+		/// <param name="area">The region to fill</param>
+		/// <param name="value">The value to fill with</param>
+		public void Fill(Recti area, T value) {
+			foreach (RegionSpan span in GetRegion(area, true)) span.Span.Fill(value);
+		}
+
+		/// <summary>
+		/// Copies a region of the grid to a row-major span of entries. Entries in chunks which do not exist are
+		/// set to the default value.
+		/// </summary>
+		/// <param name="area">The region to copy</param>
+		/// <param name="dst">The span to copy to, with a row stride of the region's width</param>
+		public void CopyTo(Recti area, Span<T> dst) {
+			if (dst.Length < area.Size.X * area.Size.Y) throw new ArgumentException("Destination span is too small for the region", nameof(dst));
+			dst[..(area.Size.X * area.Size.Y)].Clear();
+			foreach (RegionSpan span in GetRegion(area, false)) {
+				Vector2i offset = span.Position - area.Position;
+				span.Span.CopyTo(dst[(offset.Y * area.Size.X + offset.X)..]);
 			}
-			set {
-				Vector2i minorpos = point & chunkMask;
-				GetChunk(point)[minorpos.X, minorpos.Y] = value;
+		}
+
+		/// <summary>
+		/// Copies a row-major span of entries to a region of the grid, allocating chunks as needed.
+		/// </summary>
+		/// <param name="area">The region to copy to</param>
+		/// <param name="src">The span to copy from, with a row stride of the region's width</param>
+		public void CopyFrom(Recti area, ReadOnlySpan<T> src) {
+			if (src.Length < area.Size.X * area.Size.Y) throw new ArgumentException("Source span is too small for the region", nameof(src));
+			foreach (RegionSpan span in GetRegion(area, true)) {
+				Vector2i offset = span.Position - area.Position;
+				src.Slice(offset.Y * area.Size.X + offset.X, span.Span.Length).CopyTo(span.Span);
 			}
 		}
 
+		/// <summary>
+		/// A contiguous row segment of entries in the grid.
+		/// </summary>
+		public readonly ref struct RegionSpan {
+
+			/// <summary>
+			/// The grid coordinates of the first entry in the span.
+			/// </summary>
+			public Vector2i Position { get; }
+
+			/// <summary>
+			/// The entries in the span.
+			/// </summary>
+			public Span<T> Span { get; }
+
+			internal RegionSpan(Vector2i position, Span<T> span) {
+				Position = position;
+				Span = span;
+			}
+
+		}
+
+		/// <summary>
+		/// Enumerates the row segments covering a region of a grid, walking each chunk in turn.
+		/// </summary>
+		public ref struct RegionEnumerator {
+
+			private readonly Grid2D<T> grid;
+			private readonly bool create;
+			private readonly int minX, minY, maxX, maxY;
+			private readonly Vector2i minMajor, maxMajor;
+			// Current chunk state
+			private Vector2i major;
+			private T[]? chunk;
+			private int x0, x1, y, y1;
+			private bool started;
+
+			internal RegionEnumerator(Grid2D<T> grid, Recti area, bool create) {
+				this.grid = grid;
+				this.create = create;
+				minX = area.Position.X;
+				minY = area.Position.Y;
+				maxX = minX + area.Size.X;
+				maxY = minY + area.Size.Y;
+				minMajor = area.Position >> grid.chunkShift;
+				maxMajor = new Vector2i(maxX - 1, maxY - 1) >> grid.chunkShift;
+				major = minMajor;
+				chunk = null;
+				x0 = x1 = y = y1 = 0;
+				started = area.Size.X <= 0 || area.Size.Y <= 0;
+				if (started) major.Y = maxMajor.Y + 1;
+			}
+
+			public RegionEnumerator GetEnumerator() => this;
+
+			public RegionSpan Current {
+				get {
+					int row = y - 1;
+					int index = ((row & grid.chunkMask.Y) << grid.chunkShift.X) | (x0 & grid.chunkMask.X);
+					return new RegionSpan(new Vector2i(x0, row), chunk.AsSpan(index, x1 - x0));
+				}
+			}
+
+			public bool MoveNext() {
+				while (true) {
+					if (chunk != null && y < y1) {
+						y++;
+						return true;
+					}
+					if (!NextChunk()) return false;
+				}
+			}
+
+			// Advances to the next chunk intersecting the region
+			private bool NextChunk() {
+				while (true) {
+					if (started) {
+						if (++major.X > maxMajor.X) {
+							major.X = minMajor.X;
+							major.Y++;
+						}
+					} else started = true;
+					if (major.Y > maxMajor.Y) {
+						chunk = null;
+						return false;
+					}
+
+					chunk = create ? grid.FindOrCreateChunk(major).Entries : grid.FindChunk(major)?.Entries;
+					if (chunk == null) continue;
+
+					Vector2i origin = major << grid.chunkShift;
+					x0 = Math.Max(minX, origin.X);
+					x1 = Math.Min(maxX, origin.X + grid.chunkSize.X);
+					y = Math.Max(minY, origin.Y);
+					y1 = Math.Min(maxY, origin.Y + grid.chunkSize.Y);
+					return true;
+				}
+			}
+
+		}
+
 	}
 
 }
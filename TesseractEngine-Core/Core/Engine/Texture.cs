@@ -40,14 +40,30 @@ namespace Tesseract.Core.Engine {
 	}
 
 	/// <summary>
+	/// Callback for uploading the pixels of a sprite that was newly placed in an atlas.
+	/// </summary>
+	/// <param name="sprite">The sprite that was placed</param>
+	/// <param name="image">The image containing the sprite's pixels</param>
+	/// <param name="imageArea">The area within the image to copy to the sprite's position</param>
+	public delegate void AtlasTextureUploadHandler(AtlasTextureRef sprite, IImage image, Recti imageArea);
+
+	/// <summary>
+	/// <para>
 	/// An atlas contains a set of sprites on a single texture.
+	/// </para>
+	/// <para>
+	/// Sprites may be added after the atlas is built. Sprites are never moved once placed, so rebuilding
+	/// only places the new sprites and only their regions need to be uploaded. If the atlas has to grow
+	/// to fit new sprites the UV coordinates of every sprite are regenerated, and the existing texture
+	/// contents must be copied to the origin of the larger texture.
+	/// </para>
 	/// </summary>
 	public class AtlasTexture : IEngineObject, IDisposable {
 
 		public TesseractEngine Engine { get; }
 
 		/// <summary>
-		/// The size of the atlas in pixels.
+		/// The size of the atlas in pixels. This is only valid once the atlas has been built.
 		/// </summary>
 		public Vector2i Size { get; private set; }
 
@@ -67,8 +83,19 @@ namespace Tesseract.Core.Engine {
 		/// </summary>
 		public Vector2 WhitePixelUV { get; private set; }
 
+		/// <summary>
+		/// The ratio of the area used by sprites to the total area of the atlas, between 0 and 1.
+		/// </summary>
+		public float PackingEfficiency => packer.Efficiency;
+
 		// The list of all sprites in the atlas
 		private readonly List<AtlasTextureRef> sprites = new();
+		// The list of sprites which have not been placed yet
+		private readonly List<AtlasTextureRef> pendingSprites = new();
+		// The packer which assigns sprite positions
+		private readonly RectanglePacker packer = new(new Vector2i(256));
+		// The sprite used for the white pixel
+		private AtlasTextureRef? whitePixel = null;
 
 		/// <summary>
 		/// The sprite to use for 
@@ -91,6 +118,7 @@ namespace Tesseract.Core.Engine {
 			if (!image.Format.Equals(PixelFormat.R8G8B8A8UNorm)) throw new ArgumentException("Image must have RGBA8 pixel format", nameof(image));
 			AtlasTextureRef sprite = new(this, image, area ?? new Recti(image.Size.X, image.Size.Y));
 			sprites.Add(sprite);
+			pendingSprites.Add(sprite);
 			return sprite;
 		}
 
@@ -119,141 +147,55 @@ namespace Tesseract.Core.Engine {
 			return Add(image);
 		}
 
-		private void SortSprites() {
-			Vector2i size = default;
-
-			// Sort sprites in descending size (largest first)
-			sprites.Sort((a, b) => {
-				int sizeA = a.Size.X * a.Size.Y;
-				int sizeB = b.Size.X * b.Size.Y;
-				return -sizeA.CompareTo(sizeB);
-			});
-
-			// List of areas on the in-progress atlas that are free
-			List<Recti> freeAreas = new();
-
-			// Sorts the free area list
-			void SortFreeAreas() => freeAreas.Sort((a, b) => {
-				// Sort free areas in ascending order (smallest first)
-				int sizeA = a.Size.X * a.Size.Y;
-				int sizeB = b.Size.X * b.Size.Y;
-				return sizeA.CompareTo(sizeB);
-			});
-
-			foreach (AtlasTextureRef sprite in sprites) {
-				Vector2i spriteSize = sprite.Size;
-
-				// The first sprite always gets assigned at 0,0
-				if (size.X == 0) {
-					size = spriteSize;
-					sprite.Position = default;
-					continue;
-				}
-
-				// Try to find a free area that the sprite can be assigned to first
-				bool hasAssigned = false;
-				for (int i = 0; i < freeAreas.Count; i++) {
-					Recti area = freeAreas[i];
-					// If area is large enough to hold sprite
-					if (area.Size.X >= spriteSize.X && area.Size.Y >= spriteSize.Y) {
-						// Remove area and set sprite position to the origin of the area
-						freeAreas.RemoveAt(i);
-						sprite.Position = area.Position;
-						// Compute remaining space outside the sprite
-						Vector2i space = area.Size - sprite.Size;
-						if (space.X > 0 || space.Y > 0) {
-							// If free space is larger in width than height
-							if (space.X > space.Y) {
-								// Create free area to the right of the sprite
-								freeAreas.Add(new Recti(area.Position.X + sprite.Size.X, area.Position.Y, sprite.Size.X - area.Size.X, area.Size.Y));
-								// If sprite does not fill the whole height, add another free area below it
-								if (space.Y > 0)
-									freeAreas.Add(new Recti(area.Position.X, area.Position.Y + sprite.Size.Y, sprite.Size.X, area.Size.Y - sprite.Size.Y));
-							} else {
-								// Create free area below the sprite
-								freeAreas.Add(new Recti(area.Position.X, area.Position.Y + sprite.Size.Y, area.Size.X, area.Size.Y - sprite.Size.Y));
-								// If sprite does not fill the whole width, add another free area to its right
-								if (space.X > 0)
-									freeAreas.Add(new Recti(area.Position.X + sprite.Size.X, area.Position.Y, sprite.Size.X - area.Size.X, area.Size.Y));
-							}
-							SortFreeAreas();
-						}
-						hasAssigned = true;
-						break;
-					}
-				}
-				if (hasAssigned) continue;
-
-				if (size.Y >= size.X) {
-					// Expand in the X axis primarily
-					sprite.Position = new Vector2i(size.X, 0);
-					size.X += spriteSize.X;
-					size.Y = Math.Max(size.Y, spriteSize.Y);
-					// Add any free area created by expansion
-					if (sprite.Size.Y < size.Y) {
-						freeAreas.Add(new Recti(size.X, sprite.Size.Y, sprite.Size.X, size.Y - sprite.Size.Y));
-						SortFreeAreas();
-					} else if (sprite.Size.Y > size.Y) {
-						freeAreas.Add(new Recti(0, size.Y, size.X, sprite.Size.Y - size.Y));
-						SortFreeAreas();
-					}
-				} else {
-					// Expand in the Y axis primarily
-					sprite.Position = new Vector2i(0, size.Y);
-					size.X = Math.Max(size.X, spriteSize.X);
-					size.Y += spriteSize.Y;
-					// Add any free area created by expansion
-					if (sprite.Size.X < size.X) {
-						freeAreas.Add(new Recti(sprite.Size.X, size.Y, size.X - sprite.Size.X, sprite.Size.Y));
-						SortFreeAreas();
-					} else if (sprite.Size.X > size.X) {
-						freeAreas.Add(new Recti(size.X, 0, sprite.Size.X - size.X, size.Y));
-						SortFreeAreas();
-					}
-				}
-			}
-
-			// Set the size and pixel scale of the atlas
-			Size = size;
-			PixelScale = new Vector2(1) / (Vector2)Size;
-
-			// Generate the coordinates for all sprites
-			sprites.ForEach(sprite => sprite.OnBuild());
-		}
-
 		/// <summary>
-		/// Builds the atlas, updating all sprites with their locations and generating the atlas texture.
+		/// Builds the atlas, assigning locations to all sprites added since the last build and updating the
+		/// texture coordinates of sprites. The upload handler is invoked for each newly placed sprite so that
+		/// only those regions of the texture need to be written.
 		/// </summary>
-		/// <exception cref="InvalidOperationException">If the atlas has already been built</exception>
-		public void Build() {
-			// Add sprite for white pixel
-			AtlasTextureRef whitePixel = new(this, new Vector2i(2, 2));
-			sprites.Add(whitePixel);
-
-			// Sort sprites and assign positions
-			SortSprites();
-
-			// Assign white pixel
-			Span<uint> pixelSquare = stackalloc uint[4];
-			pixelSquare.Fill(0xFFFFFFFF);
+		/// <param name="upload">Callback to upload the pixels of newly placed sprites</param>
+		/// <returns>If the atlas was resized, requiring a new texture</returns>
+		/// <exception cref="InvalidOperationException">If the sprites cannot fit within the atlas</exception>
+		public bool Build(AtlasTextureUploadHandler? upload = null) {
+			// Add sprite for white pixel on the first build
+			if (whitePixel == null) {
+				ArrayImage pixelSquare = new(2, 2, PixelFormat.R8G8B8A8UNorm);
+				pixelSquare.Pixels.Fill(0xFF);
+				ownedImages.Add(pixelSquare);
+				whitePixel = Add(pixelSquare);
+			}
+
+			// Sort new sprites and assign positions
+			RectanglePacker.SortForPacking(pendingSprites, sprite => sprite.Size);
+			foreach (AtlasTextureRef sprite in pendingSprites) sprite.Position = packer.Pack(sprite.Size);
+
+			// Set the size and pixel scale of the atlas, regenerating all coordinates if it changed
+			bool resized = Size != packer.Size;
+			if (resized) {
+				Size = packer.Size;
+				PixelScale = new Vector2(1) / (Vector2)Size;
+				sprites.ForEach(sprite => sprite.OnBuild());
+			} else pendingSprites.ForEach(sprite => sprite.OnBuild());
 			WhitePixelUV = (whitePixel.MaxUV + whitePixel.MinUV) * 0.5f; // Coordinate is the center of the 2x2 square
 
-			// Add each sprite to the atlas
-			sprites.ForEach(sprite => {
+			// Upload each new sprite to the atlas
+			foreach (AtlasTextureRef sprite in pendingSprites) {
 				IImage? image = sprite.Image;
-				if (image != null) {
-					Recti area = sprite.ImageArea;
-				}
-			});
+				if (image != null) upload?.Invoke(sprite, image, sprite.ImageArea);
+				sprite.Image = null;
+			}
+			pendingSprites.Clear();
 
 			// Cleanup any owned images
 			foreach (IImage image in ownedImages) image.Dispose();
 			ownedImages.Clear();
+
+			return resized;
 		}
 
 		public void Dispose() {
 			GC.SuppressFinalize(this);
 			sprites.Clear();
+			pendingSprites.Clear();
 		}
 
 	}
@@ -305,12 +247,6 @@ namespace Tesseract.Core.Engine {
 			Size = area.Size;
 		}
 
-		internal AtlasTextureRef(AtlasTexture atlas, Vector2i size) {
-			Atlas = atlas;
-			Image = null;
-			Size = size;
-		}
-
 		internal void OnBuild() {
 			Vector2 scale = Atlas.PixelScale;
 			MinUV = (Vector2)Position * scale;
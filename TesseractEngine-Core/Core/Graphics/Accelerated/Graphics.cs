@@ -58,6 +58,12 @@ namespace Tesseract.Core.Graphics.Accelerated {
 		/// </summary>
 		public ThreadSafetyLevel APIThreadSafety { get; }
 
+		/// <summary>
+		/// A string identifying the implementation for the purposes of pipeline caching, including the device and driver version.
+		/// Pipeline cache data is only guaranteed to be valid when given to an implementation with the same identifier.
+		/// </summary>
+		public string PipelineCacheIdentifier { get; }
+
 
 		/// <summary>
 		/// The total amount of available video memory. Note that some of this may be in use by other software so not all of it will actually be available.
@@ -0,0 +1,594 @@
+﻿using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.IO;
+using System.Numerics;
+using System.Text;
+using System.Threading;
+using System.Threading.Tasks;
+using Tesseract.Core.Collections;
+using Tesseract.Core.Numerics;
+using Tesseract.Core.Utilities;
+
+namespace Tesseract.Core.Graphics.Accelerated {
+
+	/// <summary>
+	/// <para>
+	/// A pipeline cache which persists between runs of an application. The driver's pipeline cache data is saved to a
+	/// directory along with the <see cref="IGraphicsProperites.PipelineCacheIdentifier"/> of the implementation which created
+	/// it, and is only reloaded by an implementation with the same identifier (ie. the same device and driver version).
+	/// </para>
+	/// <para>
+	/// Pipelines created through the store are also recorded as permutations, which can be precompiled on worker threads
+	/// with <see cref="WarmupAsync(int, CancellationToken)"/> at the next launch before they are first needed. Because
+	/// pipelines reference other graphics objects, a permutation is only recorded if its layout, shader program, and render
+	/// pass have been given names with <c>Register</c>, and is only precompiled once objects with the same names have been
+	/// registered again. Base pipelines are only a creation hint and are not recorded.
+	/// </para>
+	/// </summary>
+	public sealed class PipelineCacheStore : IDisposable {
+
+		// File containing the driver pipeline cache data
+		private const string CacheFileName = "pipeline-cache.bin";
+		// File containing the recorded pipeline permutations
+		private const string PermutationFileName = "pipeline-permutations.bin";
+
+		private const uint CacheMagic = 0x43504C54; // "TLPC"
+		private const uint PermutationMagic = 0x50504C54; // "TLPP"
+		// Version of the file formats, which must be incremented if the encoding of either file changes
+		private const int FormatVersion = 1;
+
+		/// <summary>
+		/// The graphics the cache belongs to.
+		/// </summary>
+		public IGraphics Graphics { get; }
+
+		/// <summary>
+		/// The directory the cache is stored in.
+		/// </summary>
+		public string Directory { get; }
+
+		/// <summary>
+		/// The underlying pipeline cache, which is used by every pipeline created through the store.
+		/// </summary>
+		public IPipelineCache Cache { get; }
+
+		/// <summary>
+		/// If the pipeline cache was initialized with data saved by a previous run.
+		/// </summary>
+		public bool IsCacheDataLoaded { get; }
+
+		/// <summary>
+		/// The number of distinct pipeline permutations which have been recorded.
+		/// </summary>
+		public int PermutationCount {
+			get {
+				lock (permutations) return permutations.Count;
+			}
+		}
+
+		// Named objects which may be referenced by recorded pipelines
+		private readonly Dictionary<string, object> namedObjects = new();
+		private readonly Dictionary<object, string> objectNames = new(ReferenceEqualityComparer.Instance);
+
+		// Encoded permutations, keyed by their Base64 encoding for deduplication
+		private readonly Dictionary<string, byte[]> permutations = new();
+		// Precompiled pipelines waiting to be claimed by CreatePipeline
+		private readonly ConcurrentDictionary<string, IPipeline> warmPipelines = new();
+
+		private bool disposed = false;
+
+		/// <summary>
+		/// Creates a persistent pipeline cache, loading any data previously saved to the given directory.
+		/// </summary>
+		/// <param name="graphics">The graphics to create the cache for</param>
+		/// <param name="directory">The directory to store the cache in, which is created when the cache is saved</param>
+		public PipelineCacheStore(IGraphics graphics, string directory) {
+			Graphics = graphics;
+			Directory = directory;
+
+			byte[]? initialData = LoadCacheData();
+			IPipelineCache? cache = null;
+			if (initialData != null) {
+				try {
+					cache = graphics.CreatePipelineCache(new PipelineCacheCreateInfo() { InitialData = initialData });
+					IsCacheDataLoaded = true;
+				} catch (Exception) {
+					// Implementations may still reject data they did not create, in which case start from scratch
+				}
+			}
+			Cache = cache ?? graphics.CreatePipelineCache(new PipelineCacheCreateInfo());
+
+			LoadPermutations();
+		}
+
+		//=========//
+		// Storage //
+		//=========//
+
+		private byte[]? LoadCacheData() {
+			string path = Path.Combine(Directory, CacheFileName);
+			if (!File.Exists(path)) return null;
+			try {
+				using BinaryReader br = new(File.OpenRead(path), Encoding.UTF8);
+				if (br.ReadUInt32() != CacheMagic || br.ReadInt32() != FormatVersion) return null;
+				// Data from another device or driver version is not reused
+				if (br.ReadString() != Graphics.Properties.PipelineCacheIdentifier) return null;
+				int length = br.ReadInt32();
+				if (length < 0 || length > br.BaseStream.Length - br.BaseStream.Position) throw new InvalidDataException("Pipeline cache data length exceeds file");
+				return br.ReadBytes(length);
+			} catch (Exception) {
+				// Any failure to parse the file is a cache miss, and the corrupt file is discarded
+				DeleteFile(path);
+				return null;
+			}
+		}
+
+		private void LoadPermutations() {
+			string path = Path.Combine(Directory, PermutationFileName);
+			if (!File.Exists(path)) return;
+			try {
+				using BinaryReader br = new(File.OpenRead(path), Encoding.UTF8);
+				if (br.ReadUInt32() != PermutationMagic || br.ReadInt32() != FormatVersion) return;
+				long Remaining() => br.BaseStream.Length - br.BaseStream.Position;
+				int count = br.ReadInt32();
+				// Each permutation is stored with at least its length
+				if (count < 0 || count > Remaining() / sizeof(int)) throw new InvalidDataException("Pipeline permutation count exceeds file");
+				for (int i = 0; i < count; i++) {
+					int length = br.ReadInt32();
+					if (length < 0 || length > Remaining()) throw new InvalidDataException("Pipeline permutation length exceeds file");
+					byte[] data = br.ReadBytes(length);
+					permutations.TryAdd(Convert.ToBase64String(data), data);
+				}
+			} catch (Exception) {
+				// Permutations from a corrupt file cannot be trusted, so discard all of them along with the file
+				permutations.Clear();
+				DeleteFile(path);
+			}
+		}
+
+		// Deletes a file which could not be loaded, ignoring failure as it will be replaced on the next save anyway
+		private static void DeleteFile(string path) {
+			try {
+				File.Delete(path);
+			} catch (Exception e) when (e is IOException or UnauthorizedAccessException) { }
+		}
+
+		// Writes a file by replacing it with a fully written temporary file, so a crash cannot leave a truncated cache
+		private void WriteFile(string name, Action<BinaryWriter> write) {
+			System.IO.Directory.CreateDirectory(Directory);
+			string path = Path.Combine(Directory, name);
+			string tempPath = path + ".tmp";
+			using (BinaryWriter bw = new(File.Create(tempPath), Encoding.UTF8)) write(bw);
+			File.Move(tempPath, path, true);
+		}
+
+		/// <summary>
+		/// Saves the current pipeline cache data and the recorded permutations to the cache directory.
+		/// </summary>
+		public void Save() {
+			byte[] data = Cache.Data;
+			WriteFile(CacheFileName, bw => {
+				bw.Write(CacheMagic);
+				bw.Write(FormatVersion);
+				bw.Write(Graphics.Properties.PipelineCacheIdentifier);
+				bw.Write(data.Length);
+				bw.Write(data);
+			});
+
+			byte[][] recorded;
+			lock (permutations) {
+				recorded = new byte[permutations.Count][];
+				permutations.Values.CopyTo(recorded, 0);
+			}
+			WriteFile(PermutationFileName, bw => {
+				bw.Write(PermutationMagic);
+				bw.Write(FormatVersion);
+				bw.Write(recorded.Length);
+				foreach (byte[] permutation in recorded) {
+					bw.Write(permutation.Length);
+					bw.Write(permutation);
+				}
+			});
+		}
+
+		//===============//
+		// Named Objects //
+		//===============//
+
+		private void RegisterObject(string name, object obj) {
+			lock (namedObjects) {
+				if (namedObjects.Remove(name, out object? oldObj)) objectNames.Remove(oldObj);
+				namedObjects[name] = obj;
+				objectNames[obj] = name;
+			}
+		}
+
+		/// <summary>
+		/// Names a pipeline layout so pipelines using it can be recorded and precompiled.
+		/// </summary>
+		/// <param name="name">The name of the layout, which must be the same between runs</param>
+		/// <param name="layout">The pipeline layout</param>
+		public void Register(string name, IPipelineLayout layout) => RegisterObject(name, layout);
+
+		/// <summary>
+		/// Names a shader program so pipelines using it can be recorded and precompiled.
+		/// </summary>
+		/// <param name="name">The name of the shader program, which must be the same between runs</param>
+		/// <param name="program">The shader program</param>
+		public void Register(string name, IShaderProgram program) => RegisterObject(name, program);
+
+		/// <summary>
+		/// Names a render pass so pipelines using it can be recorded and precompiled.
+		/// </summary>
+		/// <param name="name">The name of the render pass, which must be the same between runs</param>
+		/// <param name="renderPass">The render pass</param>
+		public void Register(string name, IRenderPass renderPass) => RegisterObject(name, renderPass);
+
+		private string? GetName(object obj) {
+			lock (namedObjects) return objectNames.TryGetValue(obj, out string? name) ? name : null;
+		}
+
+		private T? GetObject<T>(string name) where T : class {
+			lock (namedObjects) return namedObjects.TryGetValue(name, out object? obj) ? obj as T : null;
+		}
+
+		//===========//
+		// Pipelines //
+		//===========//
+
+		/// <summary>
+		/// Creates a pipeline using the persistent cache, returning a pipeline precompiled by <see cref="WarmupAsync(int, CancellationToken)"/>
+		/// if one matches, and records its permutation if all of the objects it references are named.
+		/// </summary>
+		/// <param name="createInfo">Pipeline creation information</param>
+		/// <returns>The created pipeline</returns>
+		public IPipeline CreatePipeline(PipelineCreateInfo createInfo) {
+			ObjectDisposedException.ThrowIf(disposed, this);
+
+			byte[]? encoded = EncodePermutation(createInfo);
+			if (encoded != null) {
+				string key = Convert.ToBase64String(encoded);
+				if (warmPipelines.TryRemove(key, out IPipeline? pipeline)) return pipeline;
+				lock (permutations) permutations.TryAdd(key, encoded);
+			}
+
+			if (createInfo.Cache == null) createInfo = createInfo with { Cache = Cache };
+			return Graphics.CreatePipeline(createInfo);
+		}
+
+		/// <summary>
+		/// <para>
+		/// Precompiles every recorded permutation whose referenced objects have been registered, so the pipelines are ready
+		/// when they are requested through <see cref="CreatePipeline(PipelineCreateInfo)"/>. This should be called once all
+		/// of the objects have been registered and before the first frame is rendered.
+		/// </para>
+		/// <para>
+		/// Pipelines are created in parallel if the graphics API is thread-safe, and otherwise one at a time on the calling
+		/// thread. Permutations which fail to compile are skipped.
+		/// </para>
+		/// </summary>
+		/// <param name="maxParallelism">The maximum number of pipelines to compile at once, or 0 to use one per processor</param>
+		/// <param name="cancellationToken">Token to cancel warmup with</param>
+		/// <returns>A task which completes when all pipelines have been compiled</returns>
+		public async Task WarmupAsync(int maxParallelism = 0, CancellationToken cancellationToken = default) {
+			ObjectDisposedException.ThrowIf(disposed, this);
+
+			List<(string Key, PipelineCreateInfo CreateInfo)> pending = new();
+			lock (permutations) {
+				foreach (var (key, encoded) in permutations) {
+					if (warmPipelines.ContainsKey(key)) continue;
+					PipelineCreateInfo? createInfo = DecodePermutation(encoded);
+					if (createInfo != null) pending.Add((key, createInfo with { Cache = Cache }));
+				}
+			}
+
+			void Compile((string Key, PipelineCreateInfo CreateInfo) permutation) {
+				IPipeline pipeline;
+				try {
+					pipeline = Graphics.CreatePipeline(permutation.CreateInfo);
+				} catch (Exception) {
+					return;
+				}
+				if (!warmPipelines.TryAdd(permutation.Key, pipeline)) pipeline.Dispose();
+				// The store may have been disposed while compiling, after it released its precompiled pipelines
+				else if (disposed && warmPipelines.TryRemove(permutation.Key, out IPipeline? orphan)) orphan.Dispose();
+			}
+
+			if (Graphics.Properties.APIThreadSafety == ThreadSafetyLevel.Concurrent) {
+				ParallelOptions options = new() {
+					MaxDegreeOfParallelism = maxParallelism > 0 ? maxParallelism : Environment.ProcessorCount,
+					CancellationToken = cancellationToken
+				};
+				await Parallel.ForEachAsync(pending, options, (permutation, _) => {
+					Compile(permutation);
+					return ValueTask.CompletedTask;
+				});
+			} else {
+				foreach (var permutation in pending) {
+					cancellationToken.ThrowIfCancellationRequested();
+					Compile(permutation);
+				}
+			}
+		}
+
+		//==========//
+		// Encoding //
+		//==========//
+
+		// Encodes a pipeline permutation, returning null if it references unnamed objects
+		private byte[]? EncodePermutation(PipelineCreateInfo createInfo) {
+			string? layout = GetName(createInfo.Layout);
+			string? program = GetName(createInfo.ShaderProgram);
+			if (layout == null || program == null) return null;
+
+			using MemoryStream ms = new();
+			using BinaryWriter bw = new(ms, Encoding.UTF8);
+			bw.Write(layout);
+			bw.Write(program);
+			bw.Write(createInfo.ComputeInfo != null);
+
+			var gfxInfo = createInfo.GraphicsInfo;
+			bw.Write(gfxInfo != null);
+			if (gfxInfo != null) {
+				string? renderPass = GetName(gfxInfo.RenderPass);
+				if (renderPass == null) return null;
+				bw.Write(renderPass);
+				bw.Write(gfxInfo.Subpass);
+				bw.Write(gfxInfo.ViewportCount);
+				bw.Write(gfxInfo.ScissorCount);
+				bw.Write(gfxInfo.DepthClampEnable);
+				bw.Write((int)gfxInfo.PolygonMode);
+				bw.Write(gfxInfo.LogicOpEnable);
+				bw.Write(gfxInfo.Attachments.Count);
+				foreach (var attachment in gfxInfo.Attachments) {
+					bw.Write(attachment.BlendEnable);
+					var eqn = attachment.BlendEquation;
+					bw.Write((int)eqn.SrcRGB);
+					bw.Write((int)eqn.DstRGB);
+					bw.Write((int)eqn.RGBOp);
+					bw.Write((int)eqn.SrcAlpha);
+					bw.Write((int)eqn.DstAlpha);
+					bw.Write((int)eqn.AlphaOp);
+					bw.Write((int)attachment.ColorWriteMask);
+				}
+				bw.Write(gfxInfo.DynamicState.Count);
+				foreach (var state in gfxInfo.DynamicState) bw.Write((int)state);
+				if (!EncodeDynamicInfo(bw, gfxInfo.DynamicInfo)) return null;
+			}
+
+			bw.Flush();
+			return ms.ToArray();
+		}
+
+		private static bool EncodeDynamicInfo(BinaryWriter bw, PipelineDynamicCreateInfo info) {
+			bw.Write(info.VertexFormat.Attributes.Count);
+			foreach (var attrib in info.VertexFormat.Attributes) {
+				// Only standard formats can be identified between runs
+				if (attrib.Format.EnumValue is not PixelFormatEnum format) return false;
+				bw.Write(attrib.Location);
+				bw.Write(attrib.Binding);
+				bw.Write((int)format);
+				bw.Write(attrib.Offset);
+			}
+			bw.Write(info.VertexFormat.Bindings.Count);
+			foreach (var binding in info.VertexFormat.Bindings) {
+				bw.Write(binding.Binding);
+				bw.Write(binding.Stride);
+				bw.Write((int)binding.InputRate);
+			}
+
+			bw.Write((int)info.DrawMode);
+			bw.Write(info.PrimitiveRestartEnable);
+			bw.Write(info.PatchControlPoints);
+
+			bw.Write(info.Viewports.Count);
+			foreach (var viewport in info.Viewports) {
+				bw.Write(viewport.Area.Position.X);
+				bw.Write(viewport.Area.Position.Y);
+				bw.Write(viewport.Area.Size.X);
+				bw.Write(viewport.Area.Size.Y);
+				bw.Write(viewport.DepthBounds.Min);
+				bw.Write(viewport.DepthBounds.Max);
+			}
+			bw.Write(info.Scissors.Count);
+			foreach (var scissor in info.Scissors) {
+				bw.Write(scissor.Position.X);
+				bw.Write(scissor.Position.Y);
+				bw.Write(scissor.Size.X);
+				bw.Write(scissor.Size.Y);
+			}
+
+			bw.Write(info.RasterizerDiscardEnable);
+			bw.Write((int)info.CullMode);
+			bw.Write((int)info.FrontFace);
+			bw.Write(info.LineWidth);
+			bw.Write(info.DepthBiasEnable);
+			bw.Write(info.DepthBiasConstantFactor);
+			bw.Write(info.DepthBiasClamp);
+			bw.Write(info.DepthBiasSlopeFactor);
+
+			bw.Write(info.DepthTestEnable);
+			bw.Write(info.DepthWriteEnable);
+			bw.Write((int)info.DepthCompareOp);
+			bw.Write(info.DepthBoundsTestEnable);
+			bw.Write(info.StencilTestEnable);
+			EncodeStencilState(bw, info.FrontStencilState);
+			EncodeStencilState(bw, info.BackStencilState);
+			bw.Write(info.DepthBounds.Min);
+			bw.Write(info.DepthBounds.Max);
+
+			bw.Write((int)info.LogicOp);
+			bw.Write(info.BlendConstant.X);
+			bw.Write(info.BlendConstant.Y);
+			bw.Write(info.BlendConstant.Z);
+			bw.Write(info.BlendConstant.W);
+			bw.Write(info.ColorWriteEnable.Count);
+			foreach (bool enable in info.ColorWriteEnable) bw.Write(enable);
+			return true;
+		}
+
+		private static void EncodeStencilState(BinaryWriter bw, PipelineStencilState state) {
+			bw.Write((int)state.FailOp);
+			bw.Write((int)state.PassOp);
+			bw.Write((int)state.DepthFailOp);
+			bw.Write((int)state.CompareOp);
+			bw.Write(state.CompareMask);
+			bw.Write(state.WriteMask);
+			bw.Write(state.Reference);
+		}
+
+		// Decodes a pipeline permutation, returning null if it references objects which have not been registered
+		private PipelineCreateInfo? DecodePermutation(byte[] encoded) {
+			using BinaryReader br = new(new MemoryStream(encoded), Encoding.UTF8);
+			try {
+				var layout = GetObject<IPipelineLayout>(br.ReadString());
+				var program = GetObject<IShaderProgram>(br.ReadString());
+				if (layout == null || program == null) return null;
+				bool isCompute = br.ReadBoolean();
+
+				PipelineGraphicsCreateInfo? gfxInfo = null;
+				if (br.ReadBoolean()) {
+					var renderPass = GetObject<IRenderPass>(br.ReadString());
+					if (renderPass == null) return null;
+					uint subpass = br.ReadUInt32();
+					uint viewportCount = br.ReadUInt32();
+					uint scissorCount = br.ReadUInt32();
+					bool depthClampEnable = br.ReadBoolean();
+					var polygonMode = (PolygonMode)br.ReadInt32();
+					bool logicOpEnable = br.ReadBoolean();
+					var attachments = new PipelineColorAttachmentState[br.ReadInt32()];
+					for (int i = 0; i < attachments.Length; i++) {
+						attachments[i] = new PipelineColorAttachmentState() {
+							BlendEnable = br.ReadBoolean(),
+							BlendEquation = new BlendEquation() {
+								SrcRGB = (BlendFactor)br.ReadInt32(),
+								DstRGB = (BlendFactor)br.ReadInt32(),
+								RGBOp = (BlendOp)br.ReadInt32(),
+								SrcAlpha = (BlendFactor)br.ReadInt32(),
+								DstAlpha = (BlendFactor)br.ReadInt32(),
+								AlphaOp = (BlendOp)br.ReadInt32()
+							},
+							ColorWriteMask = (ColorComponent)br.ReadInt32()
+						};
+					}
+					var dynamicState = new PipelineDynamicState[br.ReadInt32()];
+					for (int i = 0; i < dynamicState.Length; i++) dynamicState[i] = (PipelineDynamicState)br.ReadInt32();
+
+					gfxInfo = new PipelineGraphicsCreateInfo() {
+						RenderPass = renderPass,
+						Subpass = subpass,
+						ViewportCount = viewportCount,
+						ScissorCount = scissorCount,
+						DepthClampEnable = depthClampEnable,
+						PolygonMode = polygonMode,
+						LogicOpEnable = logicOpEnable,
+						Attachments = attachments,
+						DynamicState = dynamicState,
+						DynamicInfo = DecodeDynamicInfo(br)
+					};
+				}
+
+				return new PipelineCreateInfo() {
+					Layout = layout,
+					ShaderProgram = program,
+					ComputeInfo = isCompute ? new PipelineComputeCreateInfo() : null,
+					GraphicsInfo = gfxInfo
+				};
+			} catch (Exception) {
+				// Treat malformed permutations (such as truncated data, negative counts, or unknown formats) as if they
+				// reference unknown objects
+				return null;
+			}
+		}
+
+		private static PipelineDynamicCreateInfo DecodeDynamicInfo(BinaryReader br) {
+			var attribs = new VertexAttrib[br.ReadInt32()];
+			for (int i = 0; i < attribs.Length; i++) {
+				attribs[i] = new VertexAttrib() {
+					Location = br.ReadUInt32(),
+					Binding = br.ReadUInt32(),
+					Format = PixelFormat.GetFromEnum((PixelFormatEnum)br.ReadInt32()),
+					Offset = br.ReadUInt32()
+				};
+			}
+			var bindings = new VertexBinding[br.ReadInt32()];
+			for (int i = 0; i < bindings.Length; i++) {
+				bindings[i] = new VertexBinding() {
+					Binding = br.ReadUInt32(),
+					Stride = br.ReadUInt32(),
+					InputRate = (VertexInputRate)br.ReadInt32()
+				};
+			}
+
+			var drawMode = (DrawMode)br.ReadInt32();
+			bool primitiveRestartEnable = br.ReadBoolean();
+			uint patchControlPoints = br.ReadUInt32();
+
+			var viewports = new Viewport[br.ReadInt32()];
+			for (int i = 0; i < viewports.Length; i++) {
+				viewports[i] = new Viewport() {
+					Area = new Rectf(br.ReadSingle(), br.ReadSingle(), br.ReadSingle(), br.ReadSingle()),
+					DepthBounds = (br.ReadSingle(), br.ReadSingle())
+				};
+			}
+			var scissors = new Recti[br.ReadInt32()];
+			for (int i = 0; i < scissors.Length; i++) scissors[i] = new Recti(br.ReadInt32(), br.ReadInt32(), br.ReadInt32(), br.ReadInt32());
+
+			return new PipelineDynamicCreateInfo() {
+				VertexFormat = new VertexFormat(attribs, bindings),
+				DrawMode = drawMode,
+				PrimitiveRestartEnable = primitiveRestartEnable,
+				PatchControlPoints = patchControlPoints,
+				Viewports = new EquatableList<Viewport>(viewports),
+				Scissors = new EquatableList<Recti>(scissors),
+				RasterizerDiscardEnable = br.ReadBoolean(),
+				CullMode = (CullFace)br.ReadInt32(),
+				FrontFace = (FrontFace)br.ReadInt32(),
+				LineWidth = br.ReadSingle(),
+				DepthBiasEnable = br.ReadBoolean(),
+				DepthBiasConstantFactor = br.ReadSingle(),
+				DepthBiasClamp = br.ReadSingle(),
+				DepthBiasSlopeFactor = br.ReadSingle(),
+				DepthTestEnable = br.ReadBoolean(),
+				DepthWriteEnable = br.ReadBoolean(),
+				DepthCompareOp = (CompareOp)br.ReadInt32(),
+				DepthBoundsTestEnable = br.ReadBoolean(),
+				StencilTestEnable = br.ReadBoolean(),
+				FrontStencilState = DecodeStencilState(br),
+				BackStencilState = DecodeStencilState(br),
+				DepthBounds = (br.ReadSingle(), br.ReadSingle()),
+				LogicOp = (LogicOp)br.ReadInt32(),
+				BlendConstant = new Vector4(br.ReadSingle(), br.ReadSingle(), br.ReadSingle(), br.ReadSingle()),
+				ColorWriteEnable = new EquatableList<bool>(DecodeBools(br))
+			};
+		}
+
+		private static bool[] DecodeBools(BinaryReader br) {
+			var values = new bool[br.ReadInt32()];
+			for (int i = 0; i < values.Length; i++) values[i] = br.ReadBoolean();
+			return values;
+		}
+
+		private static PipelineStencilState DecodeStencilState(BinaryReader br) => new() {
+			FailOp = (StencilOp)br.ReadInt32(),
+			PassOp = (StencilOp)br.ReadInt32(),
+			DepthFailOp = (StencilOp)br.ReadInt32(),
+			CompareOp = (CompareOp)br.ReadInt32(),
+			CompareMask = br.ReadUInt32(),
+			WriteMask = br.ReadUInt32(),
+			Reference = br.ReadUInt32()
+		};
+
+		public void Dispose() {
+			if (disposed) return;
+			disposed = true;
+			// Dispose any precompiled pipelines which were never claimed
+			foreach (IPipeline pipeline in warmPipelines.Values) pipeline.Dispose();
+			warmPipelines.Clear();
+			Cache.Dispose();
+		}
+
+	}
+
+}
@@ -3,6 +3,7 @@ using System.Buffers;
 using System.Collections.Generic;
 using System.IO;
 using System.Numerics;
+using System.Runtime.InteropServices;
 using Tesseract.Core.Numerics;
 using Tesseract.Core.Native;
 using Tesseract.Core.Resource;
@@ -141,60 +142,25 @@ namespace Tesseract.Core.Graphics {
 			UnmapPixels();
 		}
 
+		// Format used to convert depth and stencil pixels to and from vectors
+		private static readonly PixelFormat DepthStencilVectorFormat = PixelFormat.DefineUnpackedFormat(
+			new PixelChannel() { Type = ChannelType.Depth, Offset = 0, Size = 4, NumberFormat = ChannelNumberFormat.SignedFloat },
+			new PixelChannel() { Type = ChannelType.Stencil, Offset = 4, Size = 4, NumberFormat = ChannelNumberFormat.SignedFloat }
+		);
+
+		// Gets the format that pixels are converted to and from as vectors
+		private PixelFormat VectorFormat => Format.Type == PixelFormatType.Color ? PixelFormat.R32G32B32A32SFloat : DepthStencilVectorFormat;
+
 		public Vector4 this[int x, int y] {
 			get {
 				int offset = (y * Size.X + x) * Format.SizeOf;
 				Vector4 val = default;
-				Span<byte> pixel = Pixels[offset..(offset + Format.SizeOf)];
-				switch(Format.Type) {
-					case PixelFormatType.Color:
-						val.W = 1;
-						if (Format.HasChannel(ChannelType.Luminance)) {
-							val.X = val.Y = val.Z = (float)Format.ReadChannel(ChannelType.Luminance, pixel);
-						} else {
-							val.X = (float)Format.ReadChannel(ChannelType.Red, pixel);
-							if (Format.HasChannel(ChannelType.Green))
-								val.Y = (float)Format.ReadChannel(ChannelType.Green, pixel);
-							if (Format.HasChannel(ChannelType.Blue))
-								val.Y = (float)Format.ReadChannel(ChannelType.Blue, pixel);
-						}
-						if (Format.HasChannel(ChannelType.Alpha))
-							val.W = (float)Format.ReadChannel(ChannelType.Alpha, pixel);
-						break;
-					case PixelFormatType.Depth:
-					case PixelFormatType.Stencil:
-					case PixelFormatType.DepthStencil:
-						if (Format.HasChannel(ChannelType.Depth)) val.X = (float)Format.ReadChannel(ChannelType.Depth, pixel);
-						if (Format.HasChannel(ChannelType.Stencil)) val.Y = (float)Format.ReadChannel(ChannelType.Stencil, pixel);
-						break;
-				}
+				PixelConverter.Convert(Pixels.Slice(offset, Format.SizeOf), Format, MemoryMarshal.AsBytes(MemoryMarshal.CreateSpan(ref val, 1)), VectorFormat, 1);
 				return val;
 			}
 			set {
 				int offset = (y * Size.X + x) * Format.SizeOf;
-				Span<byte> pixel = Pixels[offset..(offset + Format.SizeOf)];
-				switch (Format.Type) {
-					case PixelFormatType.Color:
-						if (Format.HasChannel(ChannelType.Luminance)) {
-							byte luma = (byte)(0.299f * value.X + 0.587f * value.Y + 0.114f * value.Z);
-							Format.WriteChannel(ChannelType.Luminance, pixel, (decimal)luma);
-						} else {
-							Format.WriteChannel(ChannelType.Red, pixel, (decimal)value.X);
-							if (Format.HasChannel(ChannelType.Green))
-								Format.WriteChannel(ChannelType.Green, pixel, (decimal)value.Y);
-							if (Format.HasChannel(ChannelType.Blue))
-								Format.WriteChannel(ChannelType.Blue, pixel, (decimal)value.Z);
-						}
-						if (Format.HasChannel(ChannelType.Alpha))
-							Format.WriteChannel(ChannelType.Alpha, pixel, (decimal)value.W);
-						break;
-					case PixelFormatType.Depth:
-					case PixelFormatType.Stencil:
-					case PixelFormatType.DepthStencil:
-						if (Format.HasChannel(ChannelType.Depth)) Format.WriteChannel(ChannelType.Depth, pixel, (decimal)value.X);
-						if (Format.HasChannel(ChannelType.Stencil)) Format.WriteChannel(ChannelType.Stencil, pixel, (decimal)value.Y);
-						break;
-				}
+				PixelConverter.Convert(MemoryMarshal.AsBytes(MemoryMarshal.CreateReadOnlySpan(ref value, 1)), VectorFormat, Pixels.Slice(offset, Format.SizeOf), Format, 1);
 			}
 		}
 	}
@@ -11,14 +11,50 @@ using Tesseract.Core.Numerics;
 namespace Tesseract.Core.Graphics {
 
 	/// <summary>
+	/// <para>
 	/// An image atlas compiles a set of smaller images into one larger image.
+	/// </para>
+	/// <para>
+	/// Images may be added after the atlas has been built, in which case the next build only packs and
+	/// copies the new images, leaving existing entries in place. The areas modified by the last build
+	/// are reported by <see cref="UpdatedAreas"/> so that only those need to be uploaded.
+	/// </para>
 	/// </summary>
 	public class ImageAtlas {
 
 		// The list of pixel offsets of subimages
-		private Vector2i[] offsets = Array.Empty<Vector2i>();
-		// The list of entries in the atlas
+		private readonly List<Vector2i> offsets = new();
+		// The list of entries waiting to be added to the atlas
 		private readonly List<(IImage Image, Recti Area, int ID)> entries = new();
+		// The packer which assigns entry offsets
+		private readonly RectanglePacker packer;
+		// The list of areas updated by the last build
+		private readonly List<Recti> updatedAreas = new();
+
+		/// <summary>
+		/// The atlas image produced by the last build, or null if the atlas has not been built.
+		/// </summary>
+		public IProcessableImage? Image { get; private set; }
+
+		/// <summary>
+		/// The list of areas in the atlas image that were modified by the last build. If the atlas image was
+		/// resized this will contain the entire image.
+		/// </summary>
+		public IReadOnlyList<Recti> UpdatedAreas => updatedAreas;
+
+		/// <summary>
+		/// The ratio of the area used by subimages to the total area of the atlas, between 0 and 1.
+		/// </summary>
+		public float PackingEfficiency => packer.UsedEfficiency;
+
+		/// <summary>
+		/// Creates a new image atlas.
+		/// </summary>
+		/// <param name="initialSize">The initial size to pack images into, defaulting to 256x256</param>
+		/// <param name="maxSize">The maximum size of the atlas, or null for no limit</param>
+		public ImageAtlas(Vector2i? initialSize = null, Vector2i? maxSize = null) {
+			packer = new RectanglePacker(initialSize ?? new Vector2i(256), maxSize);
+		}
 
 		/// <summary>
 		/// Adds an image to the atlas, returning the ID associated with it.
@@ -27,160 +63,47 @@ namespace Tesseract.Core.Graphics {
 		/// <param name="srcArea">The area within the image to add, or null to add the entire image</param>
 		/// <returns>The subimage's ID</returns>
 		public int AddImage(IImage image, Recti? srcArea = null) {
-			int id = entries.Count;
+			int id = offsets.Count;
+			offsets.Add(default);
 			entries.Add((image, srcArea ?? new Recti(image.Size), id));
 			return id;
 		}
 
 		/// <summary>
-		/// Builds the atlas image and computes the offsets of all entries within the atlas.
+		/// Builds the atlas image and computes the offsets of all entries added since the last build. If the
+		/// existing atlas image is large enough the new entries are copied into it, otherwise a larger image is
+		/// created containing the previous contents and the old image is disposed.
 		/// </summary>
 		/// <returns>The built atlas image</returns>
+		/// <exception cref="InvalidOperationException">If the entries cannot fit within the maximum atlas size</exception>
 		public IProcessableImage Build() {
-			Vector2i size = default;
-			offsets = new Vector2i[entries.Count];
-
-			// Sort sprites in descending size (largest first)
-			entries.Sort((a, b) => {
-				int sizeA = a.Area.Size.X * a.Area.Size.Y;
-				int sizeB = b.Area.Size.X * b.Area.Size.Y;
-				return -sizeA.CompareTo(sizeB);
-			});
-
-			// List of areas on the in-progress atlas that are free
-			List<Recti> freeAreas = new();
-
-			// Sorts the free area list
-			void SortFreeAreas() => freeAreas.Sort((a, b) => {
-				// Sort free areas in ascending order (smallest first)
-				int sizeA = a.Size.X * a.Size.Y;
-				int sizeB = b.Size.X * b.Size.Y;
-				return sizeA.CompareTo(sizeB);
-			});
-
-			for(int i = 0; i < entries.Count; i++) {
-				Vector2i spriteSize = entries[i].Area.Size;
-				ref Vector2i spritePosition = ref offsets[i];
-
-				// The first sprite always gets assigned at 0,0
-				if (size.X == 0) {
-					size = spriteSize;
-					spritePosition = default;
-					continue;
-				}
-
-				// Try to find a free area that the sprite can be assigned to first
-				bool hasAssigned = false;
-				for (int j = 0; j < freeAreas.Count; j++) {
-					Recti area = freeAreas[j];
-					// If area is large enough to hold sprite
-					if (area.Size.X >= spriteSize.X && area.Size.Y >= spriteSize.Y) {
-						// Remove area and set sprite position to the origin of the area
-						freeAreas.RemoveAt(j);
-						spritePosition = area.Position;
-						// Compute remaining space outside the sprite
-						Vector2i space = area.Size - spriteSize;
-						if (space.X > 0 || space.Y > 0) {
-							// If free space is larger in width than height
-							if (space.X > space.Y) {
-								// Create free area to the right of the sprite
-								freeAreas.Add(new Recti(
-									area.Position.X + spriteSize.X,
-									area.Position.Y,
-									area.Size.X - spriteSize.X,
-									area.Size.Y
-								));
-								// If sprite does not fill the whole height, add another free area below it
-								if (space.Y > 0) {
-									freeAreas.Add(new Recti(
-										area.Position.X,
-										area.Position.Y + spriteSize.Y,
-										spriteSize.X,
-										area.Size.Y - spriteSize.Y
-									));
-								}
-							} else {
-								// Create free area below the sprite
-								freeAreas.Add(new Recti(
-									area.Position.X,
-									area.Position.Y + spriteSize.Y,
-									area.Size.X,
-									area.Size.Y - spriteSize.Y
-								));
-								// If sprite does not fill the whole width, add another free area to its right
-								if (space.X > 0) {
-									freeAreas.Add(new Recti(
-										area.Position.X + spriteSize.X,
-										area.Position.Y,
-										spriteSize.X - area.Size.X,
-										area.Size.Y
-									));
-								}
-							}
-							SortFreeAreas();
-						}
-						hasAssigned = true;
-						break;
-					}
-				}
-				if (hasAssigned) continue;
-
-				if (size.Y >= size.X) {
-					// Expand in the X axis primarily
-					spritePosition = new Vector2i(size.X, 0);
-					// Add any free area created by expansion
-					if (spriteSize.Y < size.Y) {
-						freeAreas.Add(new Recti(
-							size.X,
-							spriteSize.Y,
-							spriteSize.X,
-							size.Y - spriteSize.Y
-						));
-						SortFreeAreas();
-					} else if (spriteSize.Y > size.Y) {
-						freeAreas.Add(new Recti(
-							0,
-							size.Y,
-							size.X,
-							spriteSize.Y - size.Y
-						));
-						SortFreeAreas();
-					}
-					size.X += spriteSize.X;
-					size.Y = Math.Max(size.Y, spriteSize.Y);
-				} else {
-					// Expand in the Y axis primarily
-					spritePosition = new Vector2i(0, size.Y);
-					// Add any free area created by expansion
-					if (spriteSize.X < size.X) {
-						freeAreas.Add(new Recti(
-							spriteSize.X,
-							size.Y,
-							size.X - spriteSize.X,
-							spriteSize.Y
-						));
-						SortFreeAreas();
-					} else if (spriteSize.X > size.X) {
-						freeAreas.Add(new Recti(
-							size.X,
-							0,
-							spriteSize.X - size.X,
-							size.Y
-						));
-						SortFreeAreas();
-					}
-					size.X = Math.Max(size.X, spriteSize.X);
-					size.Y += spriteSize.Y;
+			updatedAreas.Clear();
+
+			// Pack the new entries, largest first
+			RectanglePacker.SortForPacking(entries, e => e.Area.Size);
+			foreach (var (_, area, id) in entries) offsets[id] = packer.Pack(area.Size);
+
+			// Create a new image if the packed area no longer fits the current one
+			Vector2i size = packer.UsedSize.Max(new Vector2i(1));
+			IProcessableImage? atlasImage = Image;
+			bool resized = false;
+			if (atlasImage == null || atlasImage.Size.X < size.X || atlasImage.Size.Y < size.Y) {
+				var newImage = ImageSharpImage<Rgba32>.Create(size.X, size.Y);
+				if (atlasImage != null) {
+					newImage.Blit(new Recti(atlasImage.Size), atlasImage, default(Vector2i));
+					atlasImage.Dispose();
 				}
+				atlasImage = newImage;
+				Image = atlasImage;
+				updatedAreas.Add(new Recti(size));
+				resized = true;
 			}
 
-			// Create the atlas and add all entries to it
-			var atlasImage = ImageSharpImage<Rgba32>.Create(size.X, size.Y);
-			for(int i = 0; i < entries.Count; i++) {
-				var (image, area, id) = entries[i];
-				var spriteSize = area.Size;
-				var offset = offsets[id];
-				atlasImage.Blit(new Recti(offset, spriteSize), image, area.Position);
+			// Add the new entries to the atlas
+			foreach (var (image, area, id) in entries) {
+				Recti dstArea = new(offsets[id], area.Size);
+				atlasImage.Blit(dstArea, image, area.Position);
+				if (!resized) updatedAreas.Add(dstArea);
 			}
 
 			entries.Clear();
@@ -1,8 +1,11 @@
 ﻿
 using System;
+using System.Buffers;
+using System.Buffers.Text;
 using System.Collections.Generic;
 using System.IO;
 using System.Numerics;
+using System.Text;
 using System.Threading.Tasks;
 using Tesseract.Core.Resource;
 using Tesseract.Core.Graphics.Accelerated;
@@ -19,159 +22,347 @@ namespace Tesseract.Core.Graphics.Model {
 			}
 		}
 
-		private class OBJModelParser {
+		/*
+		 * OBJ files are loaded by reading the stream in fixed-size blocks which are split at line boundaries,
+		 * each of which is parsed as an independent chunk in parallel directly from the UTF-8 bytes. Once all
+		 * chunks are parsed they are merged in order, offsetting any chunk-relative state. Faces with more
+		 * than three vertices are triangulated as fans.
+		 */
 
-			private const int ParallelThreshold = 1000;
+		// The size of blocks to read from the stream and parse as chunks
+		private const int ChunkSize = 1024 * 1024;
+
+		// A face corner, with indices of the position, texture coordinate, and normal (or -1 if not present)
+		private record struct OBJCorner(int Vertex, int TexCoord, int Normal);
+
+		// Flags for which indices of a corner are relative to the end of the chunk's element lists
+		[Flags]
+		private enum OBJRelative : byte {
+			None = 0,
+			Vertex = 1,
+			TexCoord = 2,
+			Normal = 4
+		}
+
+		// A group or object declaration, tracking the number of corners before it within its chunk
+		private record struct OBJGroupEvent(int CornerOffset, bool IsObject, string Name);
+
+		private class OBJChunkParser {
 
-			// The list of face indices
-			private readonly List<(int,int,int)> indices = new();
 			// The lists of vertices, texture coordinates, and normals
-			private readonly List<Vector3> vertices = new();
-			private readonly List<Vector2> texCoords = new();
-			private readonly List<Vector3> normals = new();
+			public readonly List<Vector3> Vertices = new();
+			public readonly List<Vector2> TexCoords = new();
+			public readonly List<Vector3> Normals = new();
+			// The list of triangle corners
+			public readonly List<OBJCorner> Corners = new();
+			// Corners with relative indices and which of their indices are relative, these must be offset by the number
+			// of elements before the chunk
+			public readonly List<(int Index, OBJRelative Relative)> RelativeCorners = new();
+			// The list of group and object declarations
+			public readonly List<OBJGroupEvent> Groups = new();
+
+			// Scratch list of the corners of the current face and which of their indices are relative
+			private readonly List<(OBJCorner Corner, OBJRelative Relative)> face = new();
+
+			private static bool IsWhiteSpace(byte b) => b == (byte)' ' || b == (byte)'\t' || b == (byte)'\r' || b == (byte)'\f' || b == (byte)'\v';
 
-			// If the face indices are "paired" (all indices for each vertex are equal)
-			private bool isPairedIndices = true;
+			private static ReadOnlySpan<byte> TrimStart(ReadOnlySpan<byte> span) {
+				int i = 0;
+				while (i < span.Length && IsWhiteSpace(span[i])) i++;
+				return span[i..];
+			}
 
-			private readonly Dictionary<string, List<ModelNode>> objects = new();
+			private static ReadOnlySpan<byte> Trim(ReadOnlySpan<byte> span) {
+				span = TrimStart(span);
+				int i = span.Length;
+				while (i > 0 && IsWhiteSpace(span[i - 1])) i--;
+				return span[..i];
+			}
 
-			// Object tracking state
-			private string currentObjectName = "";
-			private List<ModelNode> currentObjectGroups = new();
+			private static ReadOnlySpan<byte> NextToken(ref ReadOnlySpan<byte> line) {
+				line = TrimStart(line);
+				int off = 0;
+				while (off < line.Length && !IsWhiteSpace(line[off])) off++;
+				ReadOnlySpan<byte> token = line[..off];
+				line = line[off..];
+				return token;
+			}
 
-			// Group tracking state
-			private string currentGroupName = "";
-			private ModelDrawCall currentGroupDraw = new() { Mode = DrawMode.TriangleList };
+			private static float NextFloat(ref ReadOnlySpan<byte> line) {
+				line = TrimStart(line);
+				if (!Utf8Parser.TryParse(line, out float value, out int consumed)) throw new InvalidDataException("Invalid number in OBJ file");
+				line = line[consumed..];
+				return value;
+			}
 
-			private void CheckDrawCall() {
-				if (currentGroupDraw.Length > 0) {
-					currentObjectGroups.Add(new ModelNode() {
-						Name = currentGroupName,
-						DrawCalls = new ModelDrawCall[] { currentGroupDraw },
-						LocalTransform = Matrix4x4.Identity
-					});
-				}
+			// Parses a single index, converting it to zero-based or chunk-relative form
+			private static int ParseIndex(ref ReadOnlySpan<byte> token, int count, OBJRelative component, ref OBJRelative relative) {
+				if (!Utf8Parser.TryParse(token, out int index, out int consumed) || index == 0) throw new InvalidDataException("Invalid index in OBJ file");
+				token = token[consumed..];
+				if (index > 0) return index - 1;
+				relative |= component;
+				return count + index;
 			}
 
-			private void CheckGroup() {
-				if (currentObjectGroups.Count > 0) {
-					objects[currentObjectName] = currentObjectGroups;
-					currentObjectGroups = new();
+			private (OBJCorner, OBJRelative) NextCorner(ReadOnlySpan<byte> token) {
+				OBJRelative relative = OBJRelative.None;
+				int vertex = ParseIndex(ref token, Vertices.Count, OBJRelative.Vertex, ref relative), texCoord = -1, normal = -1;
+				if (token.Length > 0 && token[0] == (byte)'/') {
+					token = token[1..];
+					if (token.Length > 0 && token[0] != (byte)'/') texCoord = ParseIndex(ref token, TexCoords.Count, OBJRelative.TexCoord, ref relative);
+					if (token.Length > 0 && token[0] == (byte)'/') {
+						token = token[1..];
+						normal = ParseIndex(ref token, Normals.Count, OBJRelative.Normal, ref relative);
+					}
 				}
+				return (new OBJCorner(vertex, texCoord, normal), relative);
 			}
 
-			public OBJModel ToModel() {
-				// Check any trailing vertex groupings
-				CheckDrawCall();
-				CheckGroup();
-
-				if (isPairedIndices) {
-					int[] mindices = new int[indices.Count];
-					if (indices.Count > ParallelThreshold) Parallel.For(0, indices.Count, i => mindices[i] = indices[i].Item1);
-					else for (int i = 0; i < indices.Count; i++) mindices[i] = indices[i].Item1;
-
-					return new OBJModel(mindices, vertices.ToArray(),
-						texCoords.Count > 0 ? texCoords.ToArray() : null,
-						normals.Count > 0 ? normals.ToArray() : null
-					);
-				} else {
-					int[] mindices = new int[indices.Count];
-					Vector3[] mvertices = new Vector3[indices.Count];
-					Vector2[]? mtexCoords = texCoords.Count > 0 ? new Vector2[indices.Count] : null;
-					Vector3[]? mnormals = normals.Count > 0 ? new Vector3[indices.Count] : null;
-					if (indices.Count > ParallelThreshold) {
-						Parallel.For(0, indices.Count, i => {
-							mindices[i] = i;
-							var index = indices[i];
-							mvertices[i] = vertices[index.Item1];
-							if (mtexCoords != null) mtexCoords[i] = texCoords[index.Item2];
-							if (mnormals != null) mnormals[i] = normals[index.Item3];
-						});
+			public void Parse(ReadOnlySpan<byte> data) {
+				while (data.Length > 0) {
+					int end = data.IndexOf((byte)'\n');
+					ReadOnlySpan<byte> line;
+					if (end < 0) {
+						line = data;
+						data = default;
 					} else {
-						for(int i = 0; i < indices.Count; i++) {
-							mindices[i] = i;
-							var index = indices[i];
-							mvertices[i] = vertices[index.Item1];
-							if (mtexCoords != null) mtexCoords[i] = texCoords[index.Item2];
-							if (mnormals != null) mnormals[i] = normals[index.Item3];
-						}
+						line = data[..end];
+						data = data[(end + 1)..];
 					}
-					return new OBJModel(mindices, mvertices, mtexCoords, mnormals);
+					ParseLine(line);
 				}
 			}
 
-			public void ParseLine(string line) {
-				string NextToken() {
-					line = line.TrimStart();
-					int off = 0;
-					for (; off < line.Length; off++)
-						if (char.IsWhiteSpace(line[off])) break;
-					string token = line[0..off];
-					line = line[off..];
-					return token;
-				}
-				float NextFloat() => float.Parse(NextToken());
-				(int,int,int) NextIndex() {
-					(int, int, int) ival = (-1,-1,-1);
-					string idx = NextToken();
-					string[] parts = idx.Split('/');
-					ival.Item1 = int.Parse(parts[0]) - 1;
-					if (parts.Length > 1) {
-						ival.Item2 = int.Parse(parts[1]) - 1;
-						if (ival.Item2 != ival.Item1) isPairedIndices = false;
+			private void AddCorner((OBJCorner Corner, OBJRelative Relative) corner) {
+				if (corner.Relative != OBJRelative.None) RelativeCorners.Add((Corners.Count, corner.Relative));
+				Corners.Add(corner.Corner);
+			}
+
+			private void ParseLine(ReadOnlySpan<byte> line) {
+				ReadOnlySpan<byte> tok = NextToken(ref line);
+				if (tok.Length == 0 || tok[0] == (byte)'#') return;
+				if (tok.SequenceEqual("v"u8)) { // Vertex (position)
+					Vertices.Add(new Vector3(NextFloat(ref line), NextFloat(ref line), NextFloat(ref line)));
+				} else if (tok.SequenceEqual("vt"u8)) { // Texture coordinate
+					TexCoords.Add(new Vector2(NextFloat(ref line), NextFloat(ref line)));
+				} else if (tok.SequenceEqual("vn"u8)) { // Normal
+					Normals.Add(new Vector3(NextFloat(ref line), NextFloat(ref line), NextFloat(ref line)));
+				} else if (tok.SequenceEqual("f"u8)) { // Face (triangulated as a fan)
+					face.Clear();
+					while (true) {
+						ReadOnlySpan<byte> corner = NextToken(ref line);
+						if (corner.Length == 0) break;
+						face.Add(NextCorner(corner));
+					}
+					if (face.Count < 3) throw new InvalidDataException("OBJ face has fewer than 3 vertices");
+					for (int i = 2; i < face.Count; i++) {
+						AddCorner(face[0]);
+						AddCorner(face[i - 1]);
+						AddCorner(face[i]);
 					}
-					if (parts.Length > 2) {
-						ival.Item3 = int.Parse(parts[2]) - 1;
-						if (ival.Item3 != ival.Item1 || ival.Item3 != ival.Item2) isPairedIndices = false;
+				} else if (tok.SequenceEqual("o"u8)) { // (Named) Object
+					Groups.Add(new OBJGroupEvent(Corners.Count, true, Encoding.UTF8.GetString(Trim(line))));
+				} else if (tok.SequenceEqual("g"u8)) { // (Named) Vertex Group
+					Groups.Add(new OBJGroupEvent(Corners.Count, false, Encoding.UTF8.GetString(Trim(line))));
+				}
+			}
+
+		}
+
+		// Parses a block of bytes as a chunk, returning the block to the pool
+		private static OBJChunkParser ParseChunk(byte[] block, int length) {
+			try {
+				OBJChunkParser parser = new();
+				parser.Parse(block.AsSpan(0, length));
+				return parser;
+			} finally {
+				ArrayPool<byte>.Shared.Return(block);
+			}
+		}
+
+		// Reads the stream in blocks split at line boundaries, parsing each block in parallel
+		private static OBJChunkParser[] ParseChunks(Stream stream) {
+			List<Task<OBJChunkParser>> tasks = new();
+			byte[] block = ArrayPool<byte>.Shared.Rent(ChunkSize);
+			int length = 0;
+			bool first = true;
+			while (true) {
+				// Fill the block as much as possible
+				int n = stream.Read(block, length, block.Length - length);
+				length += n;
+				if (n > 0 && length < block.Length) continue;
+
+				// Split the block at the last line ending, carrying any partial line to the next block
+				int split = n == 0 ? length : block.AsSpan(0, length).LastIndexOf((byte)'\n') + 1;
+				if (split == 0 && n > 0) {
+					// A single line does not fit in the block, grow it
+					byte[] bigger = ArrayPool<byte>.Shared.Rent(block.Length * 2);
+					block.AsSpan(0, length).CopyTo(bigger);
+					ArrayPool<byte>.Shared.Return(block);
+					block = bigger;
+					continue;
+				}
+				// Strip a UTF-8 byte order mark from the start of the file, which would otherwise be part of the first token
+				if (first) {
+					first = false;
+					if (block.AsSpan(0, split).StartsWith("\uFEFF"u8)) {
+						block.AsSpan(3, length - 3).CopyTo(block);
+						length -= 3;
+						split -= 3;
 					}
-					return ival;
 				}
+				byte[] next = ArrayPool<byte>.Shared.Rent(ChunkSize);
+				int carry = length - split;
+				block.AsSpan(split, carry).CopyTo(next);
 
-				string tok = NextToken();
-				if (tok.StartsWith('#')) return;
-				switch(tok) {
-					case "v": // Vertex (position)
-						vertices.Add(new Vector3(NextFloat(), NextFloat(), NextFloat()));
-						break;
-					case "vt": // Texture coordinate
-						texCoords.Add(new Vector2(NextFloat(), NextFloat()));
-						break;
-					case "vn": // Normal
-						normals.Add(new Vector3(NextFloat(), NextFloat(), NextFloat()));
-						break;
-					case "f": // Face (triangle)
-						indices.Add(NextIndex());
-						indices.Add(NextIndex());
-						indices.Add(NextIndex());
-						currentGroupDraw.Length += 3;
-						break;
-					case "o": // (Named) Object
-						CheckDrawCall();
-						CheckGroup();
-						currentObjectName = line.Trim();
-						currentObjectGroups = new List<ModelNode>();
-						break;
-					case "g": // (Named) Vertex Group
-						CheckDrawCall();
-						currentGroupName = line.Trim();
-						currentGroupDraw = new ModelDrawCall() {
-							Mode = DrawMode.TriangleList,
-							Offset = currentGroupDraw.Offset + currentGroupDraw.Length
-						};
-						break;
+				byte[] chunk = block;
+				if (split > 0) tasks.Add(n == 0 && tasks.Count == 0 ? Task.FromResult(ParseChunk(chunk, split)) : Task.Run(() => ParseChunk(chunk, split)));
+				else ArrayPool<byte>.Shared.Return(chunk);
+
+				block = next;
+				length = carry;
+				if (n == 0) break;
+			}
+			ArrayPool<byte>.Shared.Return(block);
+
+			OBJChunkParser[] chunks = new OBJChunkParser[tasks.Count];
+			for (int i = 0; i < chunks.Length; i++) chunks[i] = tasks[i].Result;
+			return chunks;
+		}
+
+		// Builds the node hierarchy from the group and object declarations
+		private static ModelNode BuildNodes(OBJChunkParser[] chunks, int cornerCount) {
+			List<ModelNode> objectNodes = new(), groupNodes = new();
+			string objectName = "", groupName = "";
+			int groupStart = 0;
+
+			void EndGroup(int cornerOffset) {
+				if (cornerOffset > groupStart) {
+					groupNodes.Add(new ModelNode() {
+						Name = groupName,
+						DrawCalls = new ModelDrawCall[] {
+							new ModelDrawCall() { Mode = DrawMode.TriangleList, Offset = groupStart, Length = cornerOffset - groupStart }
+						},
+						LocalTransform = Matrix4x4.Identity,
+						Children = Array.Empty<ModelNode>()
+					});
+				}
+				groupStart = cornerOffset;
+			}
+
+			void EndObject() {
+				if (groupNodes.Count > 0) {
+					objectNodes.Add(new ModelNode() {
+						Name = objectName,
+						DrawCalls = Array.Empty<ModelDrawCall>(),
+						LocalTransform = Matrix4x4.Identity,
+						Children = groupNodes.ToArray()
+					});
+					groupNodes.Clear();
+				}
+			}
+
+			int cornerBase = 0;
+			foreach (OBJChunkParser chunk in chunks) {
+				foreach (var (offset, isObject, name) in chunk.Groups) {
+					EndGroup(cornerBase + offset);
+					if (isObject) {
+						EndObject();
+						objectName = name;
+						groupName = "";
+					} else groupName = name;
 				}
+				cornerBase += chunk.Corners.Count;
 			}
+			EndGroup(cornerCount);
+			EndObject();
 
+			return new ModelNode() {
+				Name = "",
+				DrawCalls = Array.Empty<ModelDrawCall>(),
+				LocalTransform = Matrix4x4.Identity,
+				Children = objectNodes.ToArray()
+			};
 		}
 
-		public IModel Load(Stream stream, IModelLoadContext? context) {
-			StreamReader sr = new(stream);
-			OBJModelParser parser = new();
-			string? line;
-			while((line = sr.ReadLine()) != null) parser.ParseLine(line);
-			return parser.ToModel();
+		// Concatenates the lists from each chunk into a single array
+		private static T[] Concat<T>(OBJChunkParser[] chunks, Func<OBJChunkParser, List<T>> list, int[] offsets) {
+			int total = 0;
+			for (int i = 0; i < chunks.Length; i++) {
+				offsets[i] = total;
+				total += list(chunks[i]).Count;
+			}
+			T[] array = new T[total];
+			Parallel.For(0, chunks.Length, i => list(chunks[i]).CopyTo(array, offsets[i]));
+			return array;
+		}
+
+		private static OBJModel ToModel(OBJChunkParser[] chunks) {
+			int[] vertexOffsets = new int[chunks.Length], texCoordOffsets = new int[chunks.Length], normalOffsets = new int[chunks.Length], cornerOffsets = new int[chunks.Length];
+			Vector3[] vertices = Concat(chunks, c => c.Vertices, vertexOffsets);
+			Vector2[] texCoords = Concat(chunks, c => c.TexCoords, texCoordOffsets);
+			Vector3[] normals = Concat(chunks, c => c.Normals, normalOffsets);
+			OBJCorner[] corners = Concat(chunks, c => c.Corners, cornerOffsets);
+
+			// Resolve relative indices now that the number of elements before each chunk is known, and check if
+			// the face indices are "paired" (all indices for each vertex are equal)
+			bool isPairedIndices = true;
+			Parallel.For(0, chunks.Length, i => {
+				foreach (var (index, relative) in chunks[i].RelativeCorners) {
+					ref OBJCorner corner = ref corners[cornerOffsets[i] + index];
+					if ((relative & OBJRelative.Vertex) != 0) corner.Vertex += vertexOffsets[i];
+					if ((relative & OBJRelative.TexCoord) != 0) corner.TexCoord += texCoordOffsets[i];
+					if ((relative & OBJRelative.Normal) != 0) corner.Normal += normalOffsets[i];
+				}
+				int end = cornerOffsets[i] + chunks[i].Corners.Count;
+				for (int j = cornerOffsets[i]; j < end && isPairedIndices; j++) {
+					OBJCorner corner = corners[j];
+					if ((texCoords.Length > 0 && corner.TexCoord != corner.Vertex) || (normals.Length > 0 && corner.Normal != corner.Vertex)) isPairedIndices = false;
+				}
+			});
+
+			ModelNode root = BuildNodes(chunks, corners.Length);
+
+			if (isPairedIndices) {
+				int[] mindices = new int[corners.Length];
+				Parallel.For(0, chunks.Length, i => {
+					int end = cornerOffsets[i] + chunks[i].Corners.Count;
+					for (int j = cornerOffsets[i]; j < end; j++) mindices[j] = corners[j].Vertex;
+				});
+				return new OBJModel(mindices, vertices,
+					texCoords.Length > 0 ? texCoords : null,
+					normals.Length > 0 ? normals : null
+				) { RootNode = root };
+			} else {
+				// Deduplicate each unique combination of indices into a single vertex
+				int[] mindices = new int[corners.Length];
+				Dictionary<OBJCorner, int> uniqueCorners = new(vertices.Length);
+				List<OBJCorner> unique = new(vertices.Length);
+				for (int i = 0; i < corners.Length; i++) {
+					OBJCorner corner = corners[i];
+					if (!uniqueCorners.TryGetValue(corner, out int index)) {
+						index = unique.Count;
+						uniqueCorners.Add(corner, index);
+						unique.Add(corner);
+					}
+					mindices[i] = index;
+				}
+
+				Vector3[] mvertices = new Vector3[unique.Count];
+				Vector2[]? mtexCoords = texCoords.Length > 0 ? new Vector2[unique.Count] : null;
+				Vector3[]? mnormals = normals.Length > 0 ? new Vector3[unique.Count] : null;
+				for (int i = 0; i < unique.Count; i++) {
+					OBJCorner corner = unique[i];
+					mvertices[i] = vertices[corner.Vertex];
+					if (mtexCoords != null && corner.TexCoord >= 0) mtexCoords[i] = texCoords[corner.TexCoord];
+					if (mnormals != null && corner.Normal >= 0) mnormals[i] = normals[corner.Normal];
+				}
+				return new OBJModel(mindices, mvertices, mtexCoords, mnormals) { RootNode = root };
+			}
 		}
 
+		public IModel Load(Stream stream, IModelLoadContext? context) => ToModel(ParseChunks(stream));
+
 		public void Save(IModel model, Stream stream, IModelSaveContext? context) => throw new NotImplementedException();
 
 		public class OBJModel : IModel {
@@ -0,0 +1,725 @@
+﻿using System;
+using System.Collections.Concurrent;
+using System.Runtime.CompilerServices;
+using System.Runtime.Intrinsics;
+using System.Runtime.Intrinsics.Arm;
+using System.Runtime.Intrinsics.X86;
+
+namespace Tesseract.Core.Graphics {
+
+	/// <summary>
+	/// <para>
+	/// A pixel converter converts runs of pixels from one <see cref="PixelFormat"/> to another. Converters are built once for
+	/// each pair of formats by <see cref="Get(PixelFormat, PixelFormat)"/> and cached, so the layout of the formats is only
+	/// inspected when a converter is first created.
+	/// </para>
+	/// <para>
+	/// Channels are matched by their <see cref="ChannelType"/>. Red, green, and blue channels missing from the source are taken
+	/// from its luminance channel, a missing luminance channel is computed from the red, green, and blue channels, a missing
+	/// alpha channel is treated as opaque, and any other missing channel is zero. Conversions which only reorder, add, or remove
+	/// channels stored identically in both formats (eg. RGBA8 to BGRA8) are performed as vectorized byte shuffles. All other
+	/// conversions go through 32-bit floating point values, using vectorized kernels for formats where every channel has the
+	/// same 8-bit, 16-bit, or floating-point representation.
+	/// </para>
+	/// </summary>
+	public abstract class PixelConverter {
+
+		private static readonly ConcurrentDictionary<(PixelFormat, PixelFormat), PixelConverter> converters = new();
+
+		/// <summary>
+		/// The format of source pixels.
+		/// </summary>
+		public PixelFormat SourceFormat { get; }
+
+		/// <summary>
+		/// The format of destination pixels.
+		/// </summary>
+		public PixelFormat DestinationFormat { get; }
+
+		private PixelConverter(PixelFormat srcFormat, PixelFormat dstFormat) {
+			SourceFormat = srcFormat;
+			DestinationFormat = dstFormat;
+		}
+
+		/// <summary>
+		/// Gets the converter between a pair of pixel formats, creating it if it does not exist.
+		/// </summary>
+		/// <param name="srcFormat">The format of source pixels</param>
+		/// <param name="dstFormat">The format of destination pixels</param>
+		/// <returns>Pixel converter</returns>
+		/// <exception cref="InvalidOperationException">If either format is opaque</exception>
+		/// <exception cref="NotSupportedException">If either format has channels which cannot be converted</exception>
+		public static PixelConverter Get(PixelFormat srcFormat, PixelFormat dstFormat) {
+			if (converters.TryGetValue((srcFormat, dstFormat), out PixelConverter? converter)) return converter;
+			return converters.GetOrAdd((srcFormat, dstFormat), static key => Create(key.Item1, key.Item2));
+		}
+
+		/// <summary>
+		/// Converts pixels between two formats.
+		/// </summary>
+		/// <param name="src">Source pixel data</param>
+		/// <param name="srcFormat">The format of source pixels</param>
+		/// <param name="dst">Destination pixel data</param>
+		/// <param name="dstFormat">The format of destination pixels</param>
+		/// <param name="pixelCount">The number of pixels to convert</param>
+		public static void Convert(ReadOnlySpan<byte> src, PixelFormat srcFormat, Span<byte> dst, PixelFormat dstFormat, int pixelCount) =>
+			Get(srcFormat, dstFormat).Convert(src, dst, pixelCount);
+
+		/// <summary>
+		/// Converts pixels from the source format to the destination format.
+		/// </summary>
+		/// <param name="src">Source pixel data</param>
+		/// <param name="dst">Destination pixel data</param>
+		/// <param name="pixelCount">The number of pixels to convert</param>
+		/// <exception cref="ArgumentException">If either span is too small for the number of pixels</exception>
+		public unsafe void Convert(ReadOnlySpan<byte> src, Span<byte> dst, int pixelCount) {
+			if (pixelCount < 0) throw new ArgumentOutOfRangeException(nameof(pixelCount), "Pixel count cannot be negative");
+			if ((long)pixelCount * SourceFormat.SizeOf > src.Length) throw new ArgumentException("Source span is too small for pixel count", nameof(src));
+			if ((long)pixelCount * DestinationFormat.SizeOf > dst.Length) throw new ArgumentException("Destination span is too small for pixel count", nameof(dst));
+			if (pixelCount == 0) return;
+			fixed (byte* pSrc = src) {
+				fixed (byte* pDst = dst) {
+					ConvertPixels(pSrc, pDst, pixelCount);
+				}
+			}
+		}
+
+		// Converts pixels between the source and destination memory
+		private protected abstract unsafe void ConvertPixels(byte* src, byte* dst, int count);
+
+		//==========//
+		// Channels //
+		//==========//
+
+		// Describes how a channel is stored within a pixel
+		private readonly record struct ChannelCodec(ChannelType Type, int ByteOffset, int WordSize, int Shift, int Bits, ChannelNumberFormat Format) {
+
+			public static ChannelCodec Create(PixelFormat format, PixelChannel channel) {
+				ChannelCodec codec = format.Packed ?
+					new ChannelCodec(channel.Type, 0, format.SizeOf, channel.Offset, channel.Size, channel.NumberFormat) :
+					new ChannelCodec(channel.Type, channel.Offset, channel.Size, 0, channel.Size * 8, channel.NumberFormat);
+
+				if (codec.WordSize is not (1 or 2 or 3 or 4 or 8) || codec.Bits <= 0 || codec.Shift + codec.Bits > codec.WordSize * 8)
+					throw new NotSupportedException($"Unsupported layout for {channel.Type} channel");
+				switch (codec.Format) {
+					case ChannelNumberFormat.Undefined:
+						throw new NotSupportedException($"Cannot convert {channel.Type} channel with undefined number format");
+					case ChannelNumberFormat.UnsignedFloat:
+					case ChannelNumberFormat.SignedFloat:
+						if (codec.Bits is not (16 or 32 or 64)) throw new NotSupportedException($"Unsupported {codec.Bits}-bit floating point {channel.Type} channel");
+						break;
+				}
+				return codec;
+			}
+
+			public ulong Mask => Bits == 64 ? ulong.MaxValue : (1UL << Bits) - 1;
+
+			public unsafe float Read(byte* pixel) => Decode((ReadWord(pixel + ByteOffset, WordSize) >> Shift) & Mask, Bits, Format);
+
+			public unsafe void Write(byte* pixel, float value) {
+				ulong word = Encode(value, Bits, Format) << Shift;
+				if (Shift != 0 || Bits != WordSize * 8) word |= ReadWord(pixel + ByteOffset, WordSize) & ~(Mask << Shift);
+				WriteWord(pixel + ByteOffset, WordSize, word);
+			}
+
+		}
+
+		private static unsafe ulong ReadWord(byte* ptr, int size) => size switch {
+			1 => *ptr,
+			2 => Unsafe.ReadUnaligned<ushort>(ptr),
+			3 => BitConverter.IsLittleEndian ? ptr[0] | ((uint)ptr[1] << 8) | ((uint)ptr[2] << 16) : ptr[2] | ((uint)ptr[1] << 8) | ((uint)ptr[0] << 16),
+			4 => Unsafe.ReadUnaligned<uint>(ptr),
+			_ => Unsafe.ReadUnaligned<ulong>(ptr)
+		};
+
+		private static unsafe void WriteWord(byte* ptr, int size, ulong word) {
+			switch (size) {
+				case 1:
+					*ptr = (byte)word;
+					break;
+				case 2:
+					Unsafe.WriteUnaligned(ptr, (ushort)word);
+					break;
+				case 3:
+					if (BitConverter.IsLittleEndian) {
+						ptr[0] = (byte)word;
+						ptr[1] = (byte)(word >> 8);
+						ptr[2] = (byte)(word >> 16);
+					} else {
+						ptr[0] = (byte)(word >> 16);
+						ptr[1] = (byte)(word >> 8);
+						ptr[2] = (byte)word;
+					}
+					break;
+				case 4:
+					Unsafe.WriteUnaligned(ptr, (uint)word);
+					break;
+				default:
+					Unsafe.WriteUnaligned(ptr, word);
+					break;
+			}
+		}
+
+		// Decodes a channel word to its numeric value, following the same rules as PixelFormat.ReadChannel
+		private static float Decode(ulong word, int bits, ChannelNumberFormat format) {
+			ulong mask = bits == 64 ? ulong.MaxValue : (1UL << bits) - 1;
+			long signed = (long)(word << (64 - bits)) >> (64 - bits);
+			switch (format) {
+				case ChannelNumberFormat.UnsignedNorm:
+				case ChannelNumberFormat.SRGB:
+					return (float)((double)word / mask);
+				case ChannelNumberFormat.SignedNorm:
+					return Math.Max((float)((double)signed / (mask >> 1)), -1);
+				case ChannelNumberFormat.UnsignedScaled:
+				case ChannelNumberFormat.UnsignedInt:
+					return word;
+				case ChannelNumberFormat.SignedScaled:
+				case ChannelNumberFormat.SignedInt:
+					return signed;
+				default:
+					float value = bits switch {
+						16 => (float)BitConverter.Int16BitsToHalf((short)word),
+						32 => BitConverter.Int32BitsToSingle((int)word),
+						_ => (float)BitConverter.Int64BitsToDouble((long)word)
+					};
+					return format == ChannelNumberFormat.UnsignedFloat ? Math.Abs(value) : value;
+			}
+		}
+
+		// Encodes a numeric value to a channel word, clamping and rounding to the nearest representable value
+		private static ulong Encode(float value, int bits, ChannelNumberFormat format) {
+			ulong mask = bits == 64 ? ulong.MaxValue : (1UL << bits) - 1;
+			long max = (long)(mask >> 1);
+			switch (format) {
+				case ChannelNumberFormat.UnsignedNorm:
+				case ChannelNumberFormat.SRGB:
+					return (ulong)(Math.Clamp(value, 0, 1) * (double)mask + 0.5);
+				case ChannelNumberFormat.SignedNorm:
+					return (ulong)Round(Math.Clamp(value, -1, 1) * (double)max) & mask;
+				case ChannelNumberFormat.UnsignedScaled:
+				case ChannelNumberFormat.UnsignedInt:
+					return (ulong)(Math.Clamp(value, 0, (double)mask) + 0.5);
+				case ChannelNumberFormat.SignedScaled:
+				case ChannelNumberFormat.SignedInt:
+					return (ulong)Round(Math.Clamp(value, -max - 1, (double)max)) & mask;
+				default:
+					if (format == ChannelNumberFormat.UnsignedFloat) value = Math.Abs(value);
+					return bits switch {
+						16 => BitConverter.HalfToUInt16Bits((Half)value),
+						32 => BitConverter.SingleToUInt32Bits(value),
+						_ => (ulong)BitConverter.DoubleToInt64Bits(value)
+					};
+			}
+		}
+
+		// Rounds to the nearest integer with midpoints away from zero, matching the vector kernels
+		private static long Round(double value) => (long)(value < 0 ? value - 0.5 : value + 0.5);
+
+		// The source of a destination channel value
+		private enum SourceKind {
+			// Value of a source channel
+			Channel,
+			// Constant value
+			Constant,
+			// Luminance computed from source red, green, and blue channels
+			Luma
+		}
+
+		private readonly record struct ChannelSource(SourceKind Kind, int Index, float Value = 0, int Green = 0, int Blue = 0);
+
+		// Determines where the value for each destination channel comes from
+		private static ChannelSource[] MapChannels(PixelFormat srcFormat, PixelFormat dstFormat) {
+			int FindChannel(ChannelType type) {
+				for (int i = 0; i < srcFormat.Channels.Count; i++) if (srcFormat.Channels[i].Type == type) return i;
+				return -1;
+			}
+
+			var sources = new ChannelSource[dstFormat.Channels.Count];
+			for (int i = 0; i < sources.Length; i++) {
+				ChannelType type = dstFormat.Channels[i].Type;
+				int index = FindChannel(type);
+				if (index >= 0) {
+					sources[i] = new ChannelSource(SourceKind.Channel, index);
+					continue;
+				}
+				switch (type) {
+					case ChannelType.Red:
+					case ChannelType.Green:
+					case ChannelType.Blue:
+						index = FindChannel(ChannelType.Luminance);
+						sources[i] = index >= 0 ? new ChannelSource(SourceKind.Channel, index) : new ChannelSource(SourceKind.Constant, -1);
+						break;
+					case ChannelType.Luminance: {
+						int r = FindChannel(ChannelType.Red), g = FindChannel(ChannelType.Green), b = FindChannel(ChannelType.Blue);
+						if (r >= 0 && g >= 0 && b >= 0) sources[i] = new ChannelSource(SourceKind.Luma, r, 0, g, b);
+						else sources[i] = r >= 0 ? new ChannelSource(SourceKind.Channel, r) : new ChannelSource(SourceKind.Constant, -1);
+					} break;
+					case ChannelType.Alpha:
+						sources[i] = new ChannelSource(SourceKind.Constant, -1, 1);
+						break;
+					default:
+						sources[i] = new ChannelSource(SourceKind.Constant, -1);
+						break;
+				}
+			}
+			return sources;
+		}
+
+		private static PixelConverter Create(PixelFormat srcFormat, PixelFormat dstFormat) {
+			if (srcFormat.IsOpaque || dstFormat.IsOpaque) throw new InvalidOperationException("Cannot convert pixels of opaque formats");
+
+			var srcChannels = new ChannelCodec[srcFormat.Channels.Count];
+			for (int i = 0; i < srcChannels.Length; i++) srcChannels[i] = ChannelCodec.Create(srcFormat, srcFormat.Channels[i]);
+			var dstChannels = new ChannelCodec[dstFormat.Channels.Count];
+			for (int i = 0; i < dstChannels.Length; i++) dstChannels[i] = ChannelCodec.Create(dstFormat, dstFormat.Channels[i]);
+
+			ChannelSource[] sources = MapChannels(srcFormat, dstFormat);
+			return (PixelConverter?)ShuffleConverter.TryCreate(srcFormat, dstFormat, srcChannels, dstChannels, sources) ??
+				new NumericConverter(srcFormat, dstFormat, srcChannels, dstChannels, sources);
+		}
+
+		//=========================//
+		// Byte shuffle conversion //
+		//=========================//
+
+		// Converts between unpacked formats where each destination channel is a raw copy of a source channel or a constant
+		private sealed class ShuffleConverter : PixelConverter {
+
+			// Maximum number of bytes in a pixel that can be shuffled in a vector
+			private const int VectorSize = 16;
+
+			// The source byte offset of each destination byte, or -1 if it is a constant
+			private readonly int[] byteMap;
+			// The constant value of each destination byte
+			private readonly byte[] constants;
+			// If the conversion is an exact copy of each pixel
+			private readonly bool identity;
+
+			// The number of pixels converted by each 128-bit shuffle, or 0 if shuffles cannot be used
+			private readonly int vectorPixels;
+			private readonly Vector128<byte> shuffle128, constants128;
+			// If 256-bit shuffles can be used to convert two vectors of pixels at once
+			private readonly bool vector256;
+			private readonly Vector256<byte> shuffle256, constants256;
+
+			private ShuffleConverter(PixelFormat srcFormat, PixelFormat dstFormat, int[] byteMap, byte[] constants) : base(srcFormat, dstFormat) {
+				this.byteMap = byteMap;
+				this.constants = constants;
+
+				int srcSize = srcFormat.SizeOf, dstSize = dstFormat.SizeOf;
+				identity = srcSize == dstSize;
+				for (int i = 0; i < byteMap.Length; i++) identity &= byteMap[i] == i;
+				if (identity) return;
+
+				if ((Ssse3.IsSupported || AdvSimd.Arm64.IsSupported) && Math.Max(srcSize, dstSize) <= VectorSize) {
+					vectorPixels = VectorSize / Math.Max(srcSize, dstSize);
+					byte[] shuffle = new byte[VectorSize], consts = new byte[VectorSize];
+					// Bytes past the last pixel in a vector are zeroed and will be overwritten by the following vector
+					Array.Fill(shuffle, (byte)0x80);
+					for (int i = 0; i < vectorPixels * dstSize; i++) {
+						int pixel = i / dstSize, offset = i % dstSize;
+						if (byteMap[offset] >= 0) shuffle[i] = (byte)(pixel * srcSize + byteMap[offset]);
+						else consts[i] = constants[offset];
+					}
+					shuffle128 = Vector128.Create(shuffle);
+					constants128 = Vector128.Create(consts);
+					// 256-bit shuffles operate on each 128-bit lane independently, so both lanes must start on a pixel boundary
+					if (Avx2.IsSupported && srcSize == dstSize && VectorSize % srcSize == 0) {
+						vector256 = true;
+						shuffle256 = Vector256.Create(shuffle128, shuffle128);
+						constants256 = Vector256.Create(constants128, constants128);
+					}
+				}
+			}
+
+			public static ShuffleConverter? TryCreate(PixelFormat srcFormat, PixelFormat dstFormat, ChannelCodec[] srcChannels, ChannelCodec[] dstChannels, ChannelSource[] sources) {
+				if (srcFormat.Packed || dstFormat.Packed) return null;
+
+				int[] byteMap = new int[dstFormat.SizeOf];
+				byte[] constants = new byte[dstFormat.SizeOf];
+				Array.Fill(byteMap, -1);
+				for (int i = 0; i < dstChannels.Length; i++) {
+					ChannelCodec dst = dstChannels[i];
+					ChannelSource source = sources[i];
+					switch (source.Kind) {
+						case SourceKind.Channel:
+							ChannelCodec src = srcChannels[source.Index];
+							if (src.WordSize != dst.WordSize || src.Format != dst.Format) return null;
+							for (int j = 0; j < dst.WordSize; j++) byteMap[dst.ByteOffset + j] = src.ByteOffset + j;
+							break;
+						case SourceKind.Constant:
+							unsafe {
+								fixed (byte* pConstants = constants) dst.Write(pConstants, source.Value);
+							}
+							break;
+						default:
+							return null;
+					}
+				}
+				return new ShuffleConverter(srcFormat, dstFormat, byteMap, constants);
+			}
+
+			[MethodImpl(MethodImplOptions.AggressiveInlining)]
+			private static Vector128<byte> Shuffle(Vector128<byte> value, Vector128<byte> shuffle) {
+				if (Ssse3.IsSupported) return Ssse3.Shuffle(value, shuffle);
+				// Table lookups also produce zero for out of range indices
+				else return AdvSimd.Arm64.VectorTableLookup(value, shuffle);
+			}
+
+			private protected override unsafe void ConvertPixels(byte* src, byte* dst, int count) {
+				int srcSize = SourceFormat.SizeOf, dstSize = DestinationFormat.SizeOf;
+				if (identity) {
+					Buffer.MemoryCopy(src, dst, (long)count * dstSize, (long)count * srcSize);
+					return;
+				}
+
+				int i = 0;
+				if (vector256) {
+					int step = 2 * vectorPixels;
+					for (; i <= count - step; i += step) {
+						Vector256<byte> value = Avx.LoadVector256(src + (long)i * srcSize);
+						Avx.Store(dst + (long)i * dstSize, Avx2.Or(Avx2.Shuffle(value, shuffle256), constants256));
+					}
+				}
+				if (vectorPixels > 0) {
+					// Each vector reads and writes a full 16 bytes, which must lie within the pixel data
+					long srcEnd = (long)count * srcSize - VectorSize, dstEnd = (long)count * dstSize - VectorSize;
+					for (; (long)i * srcSize <= srcEnd && (long)i * dstSize <= dstEnd; i += vectorPixels) {
+						Vector128<byte> value = Vector128.Load(src + (long)i * srcSize);
+						Vector128.Store(Shuffle(value, shuffle128) | constants128, dst + (long)i * dstSize);
+					}
+				}
+				for (; i < count; i++) {
+					byte* pSrc = src + (long)i * srcSize, pDst = dst + (long)i * dstSize;
+					for (int j = 0; j < byteMap.Length; j++) {
+						int offset = byteMap[j];
+						pDst[j] = offset >= 0 ? pSrc[offset] : constants[j];
+					}
+				}
+			}
+
+		}
+
+		//======================//
+		// Numerical conversion //
+		//======================//
+
+		// Converts between arbitrary formats through intermediate floating point values
+		private sealed class NumericConverter : PixelConverter {
+
+			// The number of pixels converted at a time through the intermediate buffers
+			private const int BlockSize = 256;
+
+			// Channels of each format, ordered by their intermediate value index
+			private readonly ChannelCodec[] srcChannels, dstChannels;
+			// Source of each destination value
+			private readonly ChannelSource[] sources;
+			// If the intermediate values of the source can be used directly as the intermediate values of the destination
+			private readonly bool identityMap;
+			// If a format can be converted with vector kernels, all channels are contiguous and share the same encoding
+			private readonly bool srcUniform, dstUniform;
+
+			public NumericConverter(PixelFormat srcFormat, PixelFormat dstFormat, ChannelCodec[] srcChannels, ChannelCodec[] dstChannels, ChannelSource[] sources) : base(srcFormat, dstFormat) {
+				// Uniform formats store intermediate values in memory order so they can be converted as a single array
+				srcUniform = SortUniform(srcFormat, srcChannels, out int[] srcOrder);
+				dstUniform = SortUniform(dstFormat, dstChannels, out int[] dstOrder);
+				this.srcChannels = new ChannelCodec[srcChannels.Length];
+				for (int i = 0; i < srcChannels.Length; i++) this.srcChannels[srcOrder[i]] = srcChannels[i];
+				this.dstChannels = new ChannelCodec[dstChannels.Length];
+				for (int i = 0; i < dstChannels.Length; i++) this.dstChannels[dstOrder[i]] = dstChannels[i];
+
+				this.sources = new ChannelSource[sources.Length];
+				for (int i = 0; i < sources.Length; i++) {
+					ChannelSource source = sources[i];
+					if (source.Kind != SourceKind.Constant) {
+						source = source with { Index = srcOrder[source.Index], Green = srcOrder[source.Green], Blue = srcOrder[source.Blue] };
+					}
+					this.sources[dstOrder[i]] = source;
+				}
+
+				identityMap = srcChannels.Length == dstChannels.Length;
+				for (int i = 0; i < this.sources.Length; i++) identityMap &= this.sources[i].Kind == SourceKind.Channel && this.sources[i].Index == i;
+			}
+
+			// Determines if the channels of a format are uniform, computing the intermediate value index of each channel
+			private static bool SortUniform(PixelFormat format, ChannelCodec[] channels, out int[] order) {
+				order = new int[channels.Length];
+				for (int i = 0; i < order.Length; i++) order[i] = i;
+
+				if (format.Packed) return false;
+				ChannelCodec first = channels[0];
+				if (first.WordSize is not (1 or 2 or 4) || format.SizeOf != first.WordSize * channels.Length) return false;
+				if (first.WordSize == 4 && first.Format is not (ChannelNumberFormat.SignedFloat or ChannelNumberFormat.UnsignedFloat)) return false;
+				if (channels.Length > 64) return false;
+				ulong used = 0;
+				for (int i = 0; i < channels.Length; i++) {
+					ChannelCodec channel = channels[i];
+					if (channel.WordSize != first.WordSize || channel.Format != first.Format || channel.ByteOffset % channel.WordSize != 0) return false;
+					int index = channel.ByteOffset / channel.WordSize;
+					if ((used & (1UL << index)) != 0) return false;
+					used |= 1UL << index;
+					order[i] = index;
+				}
+				return true;
+			}
+
+			private protected override unsafe void ConvertPixels(byte* src, byte* dst, int count) {
+				int srcSize = SourceFormat.SizeOf, dstSize = DestinationFormat.SizeOf;
+				int nSrc = srcChannels.Length, nDst = dstChannels.Length;
+				float* srcValues = stackalloc float[BlockSize * nSrc];
+				float* dstValues = srcValues;
+				if (!identityMap) {
+					float* values = stackalloc float[BlockSize * nDst];
+					dstValues = values;
+				}
+
+				for (int start = 0; start < count; start += BlockSize) {
+					int n = Math.Min(BlockSize, count - start);
+					byte* pSrc = src + (long)start * srcSize, pDst = dst + (long)start * dstSize;
+
+					// Decode source pixels
+					if (srcUniform) {
+						ChannelCodec codec = srcChannels[0];
+						DecodeUniform(pSrc, srcValues, n * nSrc, codec.WordSize, codec.Format);
+					} else if (SourceFormat.Packed) {
+						// Packed channels share a single word which only needs to be read once
+						for (int i = 0; i < n; i++) {
+							ulong word = ReadWord(pSrc + i * srcSize, srcSize);
+							float* values = srcValues + i * nSrc;
+							for (int j = 0; j < nSrc; j++) {
+								ChannelCodec codec = srcChannels[j];
+								values[j] = Decode((word >> codec.Shift) & codec.Mask, codec.Bits, codec.Format);
+							}
+						}
+					} else {
+						for (int i = 0; i < n; i++) {
+							byte* pixel = pSrc + i * srcSize;
+							float* values = srcValues + i * nSrc;
+							for (int j = 0; j < nSrc; j++) values[j] = srcChannels[j].Read(pixel);
+						}
+					}
+
+					// Map source values to destination values
+					if (!identityMap) {
+						for (int i = 0; i < n; i++) {
+							float* sv = srcValues + i * nSrc, dv = dstValues + i * nDst;
+							for (int j = 0; j < nDst; j++) {
+								ChannelSource source = sources[j];
+								dv[j] = source.Kind switch {
+									SourceKind.Channel => sv[source.Index],
+									SourceKind.Luma => 0.299f * sv[source.Index] + 0.587f * sv[source.Green] + 0.114f * sv[source.Blue],
+									_ => source.Value
+								};
+							}
+						}
+					}
+
+					// Encode destination pixels
+					if (dstUniform) {
+						ChannelCodec codec = dstChannels[0];
+						EncodeUniform(dstValues, pDst, n * nDst, codec.WordSize, codec.Format);
+					} else if (DestinationFormat.Packed) {
+						for (int i = 0; i < n; i++) {
+							float* values = dstValues + i * nDst;
+							ulong word = 0;
+							for (int j = 0; j < nDst; j++) {
+								ChannelCodec codec = dstChannels[j];
+								word |= Encode(values[j], codec.Bits, codec.Format) << codec.Shift;
+							}
+							WriteWord(pDst + i * dstSize, dstSize, word);
+						}
+					} else {
+						new Span<byte>(pDst, n * dstSize).Clear();
+						for (int i = 0; i < n; i++) {
+							byte* pixel = pDst + i * dstSize;
+							float* values = dstValues + i * nDst;
+							for (int j = 0; j < nDst; j++) dstChannels[j].Write(pixel, values[j]);
+						}
+					}
+				}
+			}
+
+		}
+
+		//================//
+		// Vector kernels //
+		//================//
+
+		// Gets the scale and limits applied to an integer channel's values
+		private static void GetIntegerRange(int bits, ChannelNumberFormat format, out float scale, out float min, out float max) {
+			float unsignedMax = (float)((1UL << bits) - 1), signedMax = (float)((1UL << (bits - 1)) - 1);
+			(scale, min, max) = format switch {
+				ChannelNumberFormat.UnsignedNorm or ChannelNumberFormat.SRGB => (unsignedMax, 0, unsignedMax),
+				ChannelNumberFormat.SignedNorm => (signedMax, -signedMax, signedMax),
+				ChannelNumberFormat.UnsignedScaled or ChannelNumberFormat.UnsignedInt => (1, 0, unsignedMax),
+				_ => (1f, -signedMax - 1, signedMax)
+			};
+		}
+
+		private static bool IsSigned(ChannelNumberFormat format) => format is ChannelNumberFormat.SignedNorm or ChannelNumberFormat.SignedScaled or ChannelNumberFormat.SignedInt;
+
+		// Decodes an array of uniformly encoded values
+		private static unsafe void DecodeUniform(byte* src, float* dst, int count, int size, ChannelNumberFormat format) {
+			if (format is ChannelNumberFormat.SignedFloat or ChannelNumberFormat.UnsignedFloat) {
+				bool abs = format == ChannelNumberFormat.UnsignedFloat;
+				if (size == 2) DecodeHalf(src, dst, count, abs);
+				else {
+					Buffer.MemoryCopy(src, dst, (long)count * sizeof(float), (long)count * sizeof(float));
+					if (abs) for (int j = 0; j < count; j++) dst[j] = Math.Abs(dst[j]);
+				}
+				return;
+			}
+
+			GetIntegerRange(size * 8, format, out float scale, out _, out _);
+			float inv = 1 / scale;
+			// Signed normalized values have one more negative value than positive which is clamped to -1
+			float min = format == ChannelNumberFormat.SignedNorm ? -1 : float.MinValue;
+			bool signed = IsSigned(format);
+			int i = 0;
+			if (Vector128.IsHardwareAccelerated) {
+				Vector128<float> vinv = Vector128.Create(inv), vmin = Vector128.Create(min);
+				if (size == 1) {
+					for (; i <= count - 16; i += 16) {
+						Vector128<byte> b = Vector128.Load(src + i);
+						Vector128<ushort> lo, hi;
+						if (signed) {
+							(Vector128<short> slo, Vector128<short> shi) = Vector128.Widen(b.AsSByte());
+							lo = slo.AsUInt16();
+							hi = shi.AsUInt16();
+						} else (lo, hi) = Vector128.Widen(b);
+						StoreWidened(lo, signed, vinv, vmin, dst + i);
+						StoreWidened(hi, signed, vinv, vmin, dst + i + 8);
+					}
+				} else {
+					for (; i <= count - 8; i += 8) StoreWidened(Vector128.Load((ushort*)src + i), signed, vinv, vmin, dst + i);
+				}
+			}
+			for (; i < count; i++) {
+				float value = size == 1 ? (signed ? (sbyte)src[i] : src[i]) : (signed ? ((short*)src)[i] : ((ushort*)src)[i]);
+				dst[i] = Math.Max(value * inv, min);
+			}
+		}
+
+		// Widens and stores 8 16-bit integers as scaled floating point values
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static unsafe void StoreWidened(Vector128<ushort> value, bool signed, Vector128<float> scale, Vector128<float> min, float* dst) {
+			Vector128<int> lo, hi;
+			if (signed) (lo, hi) = Vector128.Widen(value.AsInt16());
+			else {
+				(Vector128<uint> ulo, Vector128<uint> uhi) = Vector128.Widen(value);
+				lo = ulo.AsInt32();
+				hi = uhi.AsInt32();
+			}
+			Vector128.Store(Vector128.Max(Vector128.ConvertToSingle(lo) * scale, min), dst);
+			Vector128.Store(Vector128.Max(Vector128.ConvertToSingle(hi) * scale, min), dst + 4);
+		}
+
+		// Encodes an array of values with a uniform encoding
+		private static unsafe void EncodeUniform(float* src, byte* dst, int count, int size, ChannelNumberFormat format) {
+			if (format is ChannelNumberFormat.SignedFloat or ChannelNumberFormat.UnsignedFloat) {
+				bool abs = format == ChannelNumberFormat.UnsignedFloat;
+				if (size == 2) EncodeHalf(src, (ushort*)dst, count, abs);
+				else {
+					float* fdst = (float*)dst;
+					for (int j = 0; j < count; j++) fdst[j] = abs ? Math.Abs(src[j]) : src[j];
+				}
+				return;
+			}
+
+			GetIntegerRange(size * 8, format, out float scale, out float min, out float max);
+			int i = 0;
+			if (Vector128.IsHardwareAccelerated) {
+				Vector128<float> vscale = Vector128.Create(scale), vmin = Vector128.Create(min), vmax = Vector128.Create(max);
+				Vector128<float> half = Vector128.Create(0.5f), negHalf = Vector128.Create(-0.5f);
+
+				// Scales, clamps, and rounds 4 values to the nearest integer
+				Vector128<int> ToInteger(float* ptr) {
+					Vector128<float> value = Vector128.Min(Vector128.Max(Vector128.Load(ptr) * vscale, vmin), vmax);
+					value += Vector128.ConditionalSelect(Vector128.LessThan(value, Vector128<float>.Zero), negHalf, half);
+					return Vector128.ConvertToInt32(value);
+				}
+
+				if (size == 1) {
+					for (; i <= count - 16; i += 16) {
+						Vector128<short> lo = Vector128.Narrow(ToInteger(src + i), ToInteger(src + i + 4));
+						Vector128<short> hi = Vector128.Narrow(ToInteger(src + i + 8), ToInteger(src + i + 12));
+						Vector128.Store(Vector128.Narrow(lo, hi).AsByte(), dst + i);
+					}
+				} else {
+					for (; i <= count - 8; i += 8)
+						Vector128.Store(Vector128.Narrow(ToInteger(src + i), ToInteger(src + i + 4)).AsUInt16(), (ushort*)dst + i);
+				}
+			}
+			for (; i < count; i++) {
+				float value = Math.Clamp(src[i] * scale, min, max);
+				int integer = (int)(value < 0 ? value - 0.5f : value + 0.5f);
+				if (size == 1) dst[i] = (byte)integer;
+				else ((ushort*)dst)[i] = (ushort)integer;
+			}
+		}
+
+		// Decodes half precision values, using the conversion from "Half to float: Special edition" by Fabian Giesen
+		private static unsafe void DecodeHalf(byte* src, float* dst, int count, bool abs) {
+			ushort* hsrc = (ushort*)src;
+			int i = 0;
+			if (Vector128.IsHardwareAccelerated) {
+				Vector128<uint> expMask = Vector128.Create(0x7C00u << 13), expAdjust = Vector128.Create((127u - 15) << 23);
+				Vector128<uint> infAdjust = Vector128.Create((128u - 16) << 23), denormAdjust = Vector128.Create(1u << 23);
+				Vector128<float> magic = Vector128.Create(113u << 23).AsSingle();
+				Vector128<uint> signMask = Vector128.Create(abs ? 0u : 0x8000u);
+
+				Vector128<float> Convert(Vector128<uint> h) {
+					Vector128<uint> o = Vector128.ShiftLeft(h & Vector128.Create(0x7FFFu), 13);
+					Vector128<uint> exp = o & expMask;
+					o += expAdjust;
+					Vector128<uint> inf = o + infAdjust;
+					Vector128<uint> denorm = ((o + denormAdjust).AsSingle() - magic).AsUInt32();
+					o = Vector128.ConditionalSelect(Vector128.Equals(exp, expMask), inf, o);
+					o = Vector128.ConditionalSelect(Vector128.Equals(exp, Vector128<uint>.Zero), denorm, o);
+					return (o | Vector128.ShiftLeft(h & signMask, 16)).AsSingle();
+				}
+
+				for (; i <= count - 8; i += 8) {
+					(Vector128<uint> lo, Vector128<uint> hi) = Vector128.Widen(Vector128.Load(hsrc + i));
+					Vector128.Store(Convert(lo), dst + i);
+					Vector128.Store(Convert(hi), dst + i + 4);
+				}
+			}
+			for (; i < count; i++) {
+				float value = (float)BitConverter.UInt16BitsToHalf(hsrc[i]);
+				dst[i] = abs ? Math.Abs(value) : value;
+			}
+		}
+
+		// Encodes half precision values with round-to-nearest-even, using the conversion from "float->half variants" by Fabian Giesen
+		private static unsafe void EncodeHalf(float* src, ushort* dst, int count, bool abs) {
+			int i = 0;
+			if (Vector128.IsHardwareAccelerated) {
+				Vector128<int> f16Max = Vector128.Create((127 + 16) << 23), f32Inf = Vector128.Create(255 << 23), denormLimit = Vector128.Create(113 << 23);
+				Vector128<int> denormMagic = Vector128.Create(((127 - 15) + (23 - 10) + 1) << 23);
+				Vector128<int> nan = Vector128.Create(0x7E00), inf = Vector128.Create(0x7C00);
+				Vector128<int> roundBias = Vector128.Create(((15 - 127) << 23) + 0xFFF), one = Vector128.Create(1);
+				Vector128<uint> signMask = Vector128.Create(0x80000000u);
+
+				Vector128<uint> Convert(float* ptr) {
+					Vector128<uint> bits = Vector128.Load((uint*)ptr);
+					Vector128<uint> sign = abs ? Vector128<uint>.Zero : bits & signMask;
+					Vector128<int> f = (bits & ~signMask).AsInt32();
+
+					Vector128<int> overflow = Vector128.ConditionalSelect(Vector128.GreaterThan(f, f32Inf), nan, inf);
+					Vector128<int> denorm = (f.AsSingle() + denormMagic.AsSingle()).AsInt32() - denormMagic;
+					Vector128<int> normal = Vector128.ShiftRightLogical(f + roundBias + (Vector128.ShiftRightLogical(f, 13) & one), 13);
+
+					Vector128<int> o = Vector128.ConditionalSelect(Vector128.LessThan(f, denormLimit), denorm, normal);
+					o = Vector128.ConditionalSelect(Vector128.GreaterThanOrEqual(f, f16Max), overflow, o);
+					return o.AsUInt32() | Vector128.ShiftRightLogical(sign, 16);
+				}
+
+				for (; i <= count - 8; i += 8) Vector128.Store(Vector128.Narrow(Convert(src + i), Convert(src + i + 4)), dst + i);
+			}
+			for (; i < count; i++) dst[i] = BitConverter.HalfToUInt16Bits((Half)(abs ? Math.Abs(src[i]) : src[i]));
+		}
+
+	}
+
+}
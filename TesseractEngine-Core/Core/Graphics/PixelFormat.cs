@@ -1755,7 +1755,7 @@ namespace Tesseract.Core.Graphics {
 		/// </summary>
 		public static readonly PixelFormat L8A8UNorm = DefineUnpackedFormat(
 			new PixelChannel() { Type = ChannelType.Luminance, Offset = 0, Size = 1, NumberFormat = ChannelNumberFormat.UnsignedNorm },
-			new PixelChannel() { Type = ChannelType.Alpha, Offset = 0, Size = 1, NumberFormat = ChannelNumberFormat.UnsignedNorm }
+			new PixelChannel() { Type = ChannelType.Alpha, Offset = 1, Size = 1, NumberFormat = ChannelNumberFormat.UnsignedNorm }
 		);
 
 		/// <summary>
@@ -1763,7 +1763,7 @@ namespace Tesseract.Core.Graphics {
 		/// </summary>
 		public static readonly PixelFormat L16A16UNorm = DefineUnpackedFormat(
 			new PixelChannel() { Type = ChannelType.Luminance, Offset = 0, Size = 2, NumberFormat = ChannelNumberFormat.UnsignedNorm },
-			new PixelChannel() { Type = ChannelType.Alpha, Offset = 0, Size = 2, NumberFormat = ChannelNumberFormat.UnsignedNorm }
+			new PixelChannel() { Type = ChannelType.Alpha, Offset = 2, Size = 2, NumberFormat = ChannelNumberFormat.UnsignedNorm }
 		);
 
 		//=======================//
@@ -1826,7 +1826,7 @@ namespace Tesseract.Core.Graphics {
 			{ PixelFormatEnum.R8G8B8A8SScaled, R8G8B8A8SScaled },
 			{ PixelFormatEnum.R8G8B8A8UInt, R8G8B8A8UInt },
 			{ PixelFormatEnum.R8G8B8A8SInt, R8G8B8A8SInt },
-			{ PixelFormatEnum.B8G8R8A8SRGB, R8G8B8A8SRGB },
+			{ PixelFormatEnum.R8G8B8A8SRGB, R8G8B8A8SRGB },
 			{ PixelFormatEnum.B8G8R8A8UNorm, B8G8R8A8UNorm },
 			{ PixelFormatEnum.B8G8R8A8SNorm, B8G8R8A8SNorm },
 			{ PixelFormatEnum.B8G8R8A8UScaled, B8G8R8A8UScaled },
@@ -0,0 +1,541 @@
+﻿using System;
+using System.Buffers;
+using System.Buffers.Binary;
+using System.IO;
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+using System.Threading.Tasks;
+
+namespace Tesseract.Core.Graphics.QOI {
+
+	/// <summary>
+	/// Enum of QOI channel values.
+	/// </summary>
+	public enum QOIChannels : byte {
+		/// <summary>
+		/// RGB channels.
+		/// </summary>
+		RGB = 3,
+		/// <summary>
+		/// RGBA channels.
+		/// </summary>
+		RGBA = 4
+	}
+
+	/// <summary>
+	/// Enum of QOI colorspace values.
+	/// </summary>
+	public enum QOIColorspace {
+		/// <summary>
+		/// sRGB colorspace with linear alpha.
+		/// </summary>
+		SRGB = 0,
+		/// <summary>
+		/// Linear colorspace.
+		/// </summary>
+		Linear = 1
+	}
+
+	/// <summary>
+	/// The header information of a QOI image.
+	/// </summary>
+	public readonly record struct QOIHeader {
+
+		/// <summary>
+		/// The width of the image in pixels.
+		/// </summary>
+		public int Width { get; init; }
+
+		/// <summary>
+		/// The height of the image in pixels.
+		/// </summary>
+		public int Height { get; init; }
+
+		/// <summary>
+		/// The channels stored in the image.
+		/// </summary>
+		public QOIChannels Channels { get; init; }
+
+		/// <summary>
+		/// The colorspace of the image.
+		/// </summary>
+		public QOIColorspace Colorspace { get; init; }
+
+		/// <summary>
+		/// If the image uses the chunked container, in which case <see cref="RowsPerChunk"/> and
+		/// <see cref="ChunkCount"/> are valid.
+		/// </summary>
+		public bool Chunked { get; init; }
+
+		/// <summary>
+		/// The number of rows of pixels stored in each chunk.
+		/// </summary>
+		public int RowsPerChunk { get; init; }
+
+		/// <summary>
+		/// The number of chunks in the image.
+		/// </summary>
+		public int ChunkCount { get; init; }
+
+		/// <summary>
+		/// The size of the header in bytes, including the chunk table if chunked.
+		/// </summary>
+		public int Size => Chunked ? QOICodec.ChunkedHeaderSize + ChunkCount * sizeof(uint) : QOICodec.HeaderSize;
+
+	}
+
+	/// <summary>
+	/// <para>
+	/// Encoder and decoder for Quite Ok Image (QOI) data operating directly on spans of raw RGB or RGBA pixels, so
+	/// images can be decoded straight into an <see cref="ArrayImage"/> or a mapped staging buffer.
+	/// </para>
+	/// <para>
+	/// In addition to the standard format (magic "qoif"), a chunked container (magic "qoic") is supported which
+	/// splits the image into bands of rows that are each encoded as an independent QOI stream. The header is
+	/// followed by a table of the encoded size of each chunk, which allows the chunks to be encoded and decoded
+	/// in parallel. The container is otherwise identical to the standard format, including the footer.
+	/// </para>
+	/// </summary>
+	public static class QOICodec {
+
+		/// <summary>
+		/// The size of the standard QOI header in bytes.
+		/// </summary>
+		public const int HeaderSize = 14;
+
+		/// <summary>
+		/// The size of the chunked QOI header in bytes, not including the chunk table.
+		/// </summary>
+		public const int ChunkedHeaderSize = HeaderSize + 8;
+
+		/// <summary>
+		/// The size of the QOI footer in bytes.
+		/// </summary>
+		public const int FooterSize = 8;
+
+		/// <summary>
+		/// The default number of rows per chunk when encoding chunked images.
+		/// </summary>
+		public const int DefaultRowsPerChunk = 64;
+
+		// Magic values
+		private const uint Magic = 0x716F6966; // "qoif"
+		private const uint ChunkedMagic = 0x716F6963; // "qoic"
+
+		// Operation tags
+		private const byte OpIndex = 0x00;
+		private const byte OpDiff = 0x40;
+		private const byte OpLuma = 0x80;
+		private const byte OpRun = 0xC0;
+		private const byte OpRGB = 0xFE;
+		private const byte OpRGBA = 0xFF;
+		private const byte MaskOp = 0xC0;
+
+		// Pixels are handled as little-endian packed RGBA values
+		private const uint OpaqueBlack = 0xFF000000;
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static int Hash(uint px) => (int)(((px & 0xFF) * 3 + ((px >> 8) & 0xFF) * 5 + ((px >> 16) & 0xFF) * 7 + (px >> 24) * 11) & 0x3F);
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static unsafe uint LoadRGB(byte* src) => src[0] | ((uint)src[1] << 8) | ((uint)src[2] << 16) | OpaqueBlack;
+
+		/// <summary>
+		/// Gets the maximum number of bytes an encoded image may require.
+		/// </summary>
+		/// <param name="width">Image width</param>
+		/// <param name="height">Image height</param>
+		/// <param name="channels">Image channels</param>
+		/// <param name="chunked">If the chunked container is used</param>
+		/// <param name="rowsPerChunk">The number of rows per chunk if chunked</param>
+		/// <returns>Maximum encoded size in bytes</returns>
+		public static long GetMaxEncodedSize(int width, int height, QOIChannels channels, bool chunked = false, int rowsPerChunk = DefaultRowsPerChunk) {
+			long size = (long)width * height * ((int)channels + 1) + FooterSize;
+			if (chunked) return size + ChunkedHeaderSize + GetChunkCount(height, rowsPerChunk) * sizeof(uint);
+			else return size + HeaderSize;
+		}
+
+		private static int GetChunkCount(int height, int rowsPerChunk) => (height + rowsPerChunk - 1) / rowsPerChunk;
+
+		//============//
+		// Operations //
+		//============//
+
+		// Encodes a run of pixels as QOI operations, returning the number of bytes written
+		private static unsafe int EncodeOps(byte* src, int count, int channels, byte* dst) {
+			uint* index = stackalloc uint[64];
+			new Span<uint>(index, 64).Clear();
+			uint prev = OpaqueBlack;
+			byte* p = dst;
+
+			for (int i = 0; i < count; ) {
+				uint px = channels == 4 ? Unsafe.ReadUnaligned<uint>(src + i * 4) : LoadRGB(src + i * 3);
+
+				if (px == prev) {
+					// Count the length of the run, comparing whole pixels with vectorized search when possible
+					int run;
+					if (channels == 4) {
+						run = new ReadOnlySpan<uint>(src + i * 4, count - i).IndexOfAnyExcept(prev);
+						if (run < 0) run = count - i;
+					} else {
+						run = 1;
+						while (i + run < count && LoadRGB(src + (i + run) * 3) == prev) run++;
+					}
+					i += run;
+					for (; run >= 62; run -= 62) *p++ = OpRun | 61;
+					if (run > 0) *p++ = (byte)(OpRun | (run - 1));
+					continue;
+				}
+
+				int hash = Hash(px);
+				if (index[hash] == px) {
+					*p++ = (byte)(OpIndex | hash);
+				} else {
+					index[hash] = px;
+					if ((px >> 24) == (prev >> 24)) {
+						sbyte vr = (sbyte)(px - prev);
+						sbyte vg = (sbyte)((px >> 8) - (prev >> 8));
+						sbyte vb = (sbyte)((px >> 16) - (prev >> 16));
+						int vgr = vr - vg, vgb = vb - vg;
+						if (vr >= -2 && vr <= 1 && vg >= -2 && vg <= 1 && vb >= -2 && vb <= 1) {
+							*p++ = (byte)(OpDiff | ((vr + 2) << 4) | ((vg + 2) << 2) | (vb + 2));
+						} else if (vg >= -32 && vg <= 31 && vgr >= -8 && vgr <= 7 && vgb >= -8 && vgb <= 7) {
+							*p++ = (byte)(OpLuma | (vg + 32));
+							*p++ = (byte)(((vgr + 8) << 4) | (vgb + 8));
+						} else {
+							*p++ = OpRGB;
+							*p++ = (byte)px;
+							*p++ = (byte)(px >> 8);
+							*p++ = (byte)(px >> 16);
+						}
+					} else {
+						*p++ = OpRGBA;
+						Unsafe.WriteUnaligned(p, px);
+						p += 4;
+					}
+				}
+				prev = px;
+				i++;
+			}
+
+			return (int)(p - dst);
+		}
+
+		// Decodes QOI operations into a run of pixels, returning the number of bytes consumed
+		private static unsafe int DecodeOps(byte* src, int length, byte* dst, int count, int channels) {
+			uint* index = stackalloc uint[64];
+			new Span<uint>(index, 64).Clear();
+			uint px = OpaqueBlack;
+			byte* p = src, end = src + length;
+
+			for (int i = 0; i < count; ) {
+				if (p >= end) throw new InvalidDataException("Unexpected end of QOI data");
+				byte op = *p++;
+				int run = 1;
+				if (op == OpRGB) {
+					if (end - p < 3) throw new InvalidDataException("Unexpected end of QOI data");
+					px = (px & 0xFF000000) | p[0] | ((uint)p[1] << 8) | ((uint)p[2] << 16);
+					p += 3;
+				} else if (op == OpRGBA) {
+					if (end - p < 4) throw new InvalidDataException("Unexpected end of QOI data");
+					px = Unsafe.ReadUnaligned<uint>(p);
+					p += 4;
+				} else {
+					switch (op & MaskOp) {
+						case OpIndex:
+							px = index[op];
+							break;
+						case OpDiff: {
+								uint r = (uint)(px + ((op >> 4) & 3) - 2) & 0xFF;
+								uint g = (uint)((px >> 8) + ((op >> 2) & 3) - 2) & 0xFF;
+								uint b = (uint)((px >> 16) + (op & 3) - 2) & 0xFF;
+								px = (px & 0xFF000000) | r | (g << 8) | (b << 16);
+							}
+							break;
+						case OpLuma: {
+								if (p >= end) throw new InvalidDataException("Unexpected end of QOI data");
+								byte op2 = *p++;
+								int vg = (op & 0x3F) - 32;
+								uint r = (uint)((int)(px & 0xFF) + vg - 8 + ((op2 >> 4) & 0xF)) & 0xFF;
+								uint g = (uint)((int)((px >> 8) & 0xFF) + vg) & 0xFF;
+								uint b = (uint)((int)((px >> 16) & 0xFF) + vg - 8 + (op2 & 0xF)) & 0xFF;
+								px = (px & 0xFF000000) | r | (g << 8) | (b << 16);
+							}
+							break;
+						default: // OpRun
+							run = Math.Min((op & 0x3F) + 1, count - i);
+							break;
+					}
+				}
+				index[Hash(px)] = px;
+
+				// Store the decoded pixel(s)
+				if (channels == 4) {
+					uint* dst32 = (uint*)(dst + i * 4);
+					if (run == 1) *dst32 = px;
+					else new Span<uint>(dst32, run).Fill(px);
+				} else {
+					byte* dst8 = dst + i * 3;
+					for (int j = 0; j < run; j++, dst8 += 3) {
+						dst8[0] = (byte)px;
+						dst8[1] = (byte)(px >> 8);
+						dst8[2] = (byte)(px >> 16);
+					}
+				}
+				i += run;
+			}
+
+			return (int)(p - src);
+		}
+
+		//========//
+		// Header //
+		//========//
+
+		/// <summary>
+		/// Reads the header of QOI data, in either the standard or chunked container.
+		/// </summary>
+		/// <param name="data">The QOI data</param>
+		/// <returns>The image header</returns>
+		/// <exception cref="InvalidDataException">If the data is not valid QOI data</exception>
+		public static QOIHeader ReadHeader(ReadOnlySpan<byte> data) {
+			if (data.Length < HeaderSize) throw new InvalidDataException("QOI data is too short");
+			uint magic = BinaryPrimitives.ReadUInt32BigEndian(data);
+			if (magic != Magic && magic != ChunkedMagic) throw new InvalidDataException("Magic value does not match QOI format");
+			uint width = BinaryPrimitives.ReadUInt32BigEndian(data[4..]), height = BinaryPrimitives.ReadUInt32BigEndian(data[8..]);
+			QOIChannels channels = (QOIChannels)data[12];
+			if (channels != QOIChannels.RGB && channels != QOIChannels.RGBA) throw new InvalidDataException("Unknown QOI channel value");
+			if (width > int.MaxValue || height > int.MaxValue || (long)width * height > Array.MaxLength / 4) throw new InvalidDataException("QOI image is too large");
+
+			QOIHeader header = new() {
+				Width = (int)width,
+				Height = (int)height,
+				Channels = channels,
+				Colorspace = (QOIColorspace)data[13]
+			};
+			if (magic == ChunkedMagic) {
+				if (data.Length < ChunkedHeaderSize) throw new InvalidDataException("QOI data is too short");
+				uint rowsPerChunk = BinaryPrimitives.ReadUInt32BigEndian(data[14..]), chunkCount = BinaryPrimitives.ReadUInt32BigEndian(data[18..]);
+				if (rowsPerChunk == 0 || rowsPerChunk > int.MaxValue || chunkCount != GetChunkCount(header.Height, (int)rowsPerChunk))
+					throw new InvalidDataException("Invalid QOI chunk layout");
+				header = header with { Chunked = true, RowsPerChunk = (int)rowsPerChunk, ChunkCount = (int)chunkCount };
+			}
+			return header;
+		}
+
+		private static void WriteHeader(Span<byte> dst, int width, int height, QOIChannels channels, QOIColorspace colorspace, bool chunked) {
+			BinaryPrimitives.WriteUInt32BigEndian(dst, chunked ? ChunkedMagic : Magic);
+			BinaryPrimitives.WriteInt32BigEndian(dst[4..], width);
+			BinaryPrimitives.WriteInt32BigEndian(dst[8..], height);
+			dst[12] = (byte)channels;
+			dst[13] = (byte)colorspace;
+		}
+
+		private static void WriteFooter(Span<byte> dst) {
+			dst[..FooterSize].Clear();
+			dst[FooterSize - 1] = 1;
+		}
+
+		private static void CheckPixels(int length, int width, int height, QOIChannels channels, string paramName) {
+			if (width < 0 || height < 0) throw new ArgumentOutOfRangeException(paramName, "Image size cannot be negative");
+			if (channels != QOIChannels.RGB && channels != QOIChannels.RGBA) throw new ArgumentException("Invalid QOI channel value", nameof(channels));
+			// Rejecting images larger than the span also guarantees the total pixel count fits in an int
+			if (length < (long)width * height * (int)channels) throw new ArgumentException("Pixel span is too small for the image", paramName);
+		}
+
+		//==========//
+		// Encoding //
+		//==========//
+
+		/// <summary>
+		/// Encodes raw pixels as a standard QOI image.
+		/// </summary>
+		/// <param name="pixels">The pixel data, tightly packed with the given number of channels</param>
+		/// <param name="width">Image width</param>
+		/// <param name="height">Image height</param>
+		/// <param name="channels">The channels of the pixel data, which are also stored in the image</param>
+		/// <param name="dst">The span to write the encoded image to, which should be at least <see cref="GetMaxEncodedSize"/> bytes</param>
+		/// <param name="colorspace">The colorspace to store in the image</param>
+		/// <returns>The number of bytes written</returns>
+		public static unsafe int Encode(ReadOnlySpan<byte> pixels, int width, int height, QOIChannels channels, Span<byte> dst, QOIColorspace colorspace = QOIColorspace.SRGB) {
+			CheckPixels(pixels.Length, width, height, channels, nameof(pixels));
+			if (dst.Length < GetMaxEncodedSize(width, height, channels)) throw new ArgumentException("Destination span is too small for the encoded image", nameof(dst));
+			WriteHeader(dst, width, height, channels, colorspace, false);
+			int length;
+			fixed (byte* pSrc = pixels, pDst = dst) {
+				length = HeaderSize + EncodeOps(pSrc, width * height, (int)channels, pDst + HeaderSize);
+			}
+			WriteFooter(dst[length..]);
+			return length + FooterSize;
+		}
+
+		/// <summary>
+		/// Encodes raw pixels as a chunked QOI image, encoding chunks in parallel.
+		/// </summary>
+		/// <param name="pixels">The pixel data, tightly packed with the given number of channels</param>
+		/// <param name="width">Image width</param>
+		/// <param name="height">Image height</param>
+		/// <param name="channels">The channels of the pixel data, which are also stored in the image</param>
+		/// <param name="dst">The span to write the encoded image to, which should be at least <see cref="GetMaxEncodedSize"/> bytes</param>
+		/// <param name="colorspace">The colorspace to store in the image</param>
+		/// <param name="rowsPerChunk">The number of rows of pixels to store in each chunk</param>
+		/// <returns>The number of bytes written</returns>
+		public static unsafe int EncodeChunked(ReadOnlySpan<byte> pixels, int width, int height, QOIChannels channels, Span<byte> dst, QOIColorspace colorspace = QOIColorspace.SRGB, int rowsPerChunk = DefaultRowsPerChunk) {
+			CheckPixels(pixels.Length, width, height, channels, nameof(pixels));
+			if (rowsPerChunk <= 0) throw new ArgumentOutOfRangeException(nameof(rowsPerChunk), "Rows per chunk must be positive");
+			if (dst.Length < GetMaxEncodedSize(width, height, channels, true, rowsPerChunk)) throw new ArgumentException("Destination span is too small for the encoded image", nameof(dst));
+
+			int chunkCount = GetChunkCount(height, rowsPerChunk);
+			WriteHeader(dst, width, height, channels, colorspace, true);
+			BinaryPrimitives.WriteInt32BigEndian(dst[14..], rowsPerChunk);
+			BinaryPrimitives.WriteInt32BigEndian(dst[18..], chunkCount);
+
+			int pixelSize = (int)channels;
+			long totalPixels = (long)width * height, chunkPixels = (long)width * rowsPerChunk;
+			byte[][] chunkData = new byte[chunkCount][];
+			int[] chunkLengths = new int[chunkCount];
+			try {
+				fixed (byte* pSrc = pixels) {
+					IntPtr src = (IntPtr)pSrc;
+					// Encode each chunk into its own buffer
+					Parallel.For(0, chunkCount, i => {
+						int count = (int)Math.Min(chunkPixels, totalPixels - i * chunkPixels);
+						byte[] buffer = ArrayPool<byte>.Shared.Rent(count * (pixelSize + 1));
+						chunkData[i] = buffer;
+						fixed (byte* pBuffer = buffer) {
+							chunkLengths[i] = EncodeOps((byte*)src + i * chunkPixels * pixelSize, count, pixelSize, pBuffer);
+						}
+					});
+				}
+
+				// Write the chunk table followed by the chunk data
+				int offset = ChunkedHeaderSize + chunkCount * sizeof(uint);
+				for (int i = 0; i < chunkCount; i++) {
+					BinaryPrimitives.WriteInt32BigEndian(dst[(ChunkedHeaderSize + i * sizeof(uint))..], chunkLengths[i]);
+					chunkData[i].AsSpan(0, chunkLengths[i]).CopyTo(dst[offset..]);
+					offset += chunkLengths[i];
+				}
+				WriteFooter(dst[offset..]);
+				return offset + FooterSize;
+			} finally {
+				foreach (byte[]? buffer in chunkData) if (buffer != null) ArrayPool<byte>.Shared.Return(buffer);
+			}
+		}
+
+		/// <summary>
+		/// Encodes an image as a QOI image, which must have a format of <see cref="PixelFormat.R8G8B8UNorm"/> or
+		/// <see cref="PixelFormat.R8G8B8A8UNorm"/>.
+		/// </summary>
+		/// <param name="image">The image to encode</param>
+		/// <param name="colorspace">The colorspace to store in the image</param>
+		/// <param name="chunked">If the chunked container should be used</param>
+		/// <returns>The encoded image</returns>
+		public static byte[] Encode(IImage image, QOIColorspace colorspace = QOIColorspace.SRGB, bool chunked = false) {
+			QOIChannels channels = GetChannels(image.Format);
+			int width = image.Size.X, height = image.Size.Y;
+			byte[] buffer = ArrayPool<byte>.Shared.Rent((int)GetMaxEncodedSize(width, height, channels, chunked));
+			try {
+				var ptr = image.MapPixels(Native.MapMode.ReadOnly);
+				int length;
+				try {
+					length = chunked ?
+						EncodeChunked(ptr.Span, width, height, channels, buffer, colorspace) :
+						Encode(ptr.Span, width, height, channels, buffer, colorspace);
+				} finally {
+					image.UnmapPixels();
+				}
+				return buffer.AsSpan(0, length).ToArray();
+			} finally {
+				ArrayPool<byte>.Shared.Return(buffer);
+			}
+		}
+
+		//==========//
+		// Decoding //
+		//==========//
+
+		/// <summary>
+		/// Decodes a QOI image in either the standard or chunked container to raw pixels. Chunked images
+		/// are decoded in parallel.
+		/// </summary>
+		/// <param name="data">The QOI data</param>
+		/// <param name="pixels">The span to decode pixels to, tightly packed with the given number of channels</param>
+		/// <param name="channels">The channels to decode to, or null to use the image's channels</param>
+		/// <returns>The image header</returns>
+		/// <exception cref="InvalidDataException">If the data is not a valid QOI image</exception>
+		public static unsafe QOIHeader Decode(ReadOnlySpan<byte> data, Span<byte> pixels, QOIChannels? channels = null) {
+			QOIHeader header = ReadHeader(data);
+			int pixelSize = (int)(channels ?? header.Channels);
+			int width = header.Width, height = header.Height;
+			CheckPixels(pixels.Length, width, height, (QOIChannels)pixelSize, nameof(pixels));
+
+			if (!header.Chunked) {
+				fixed (byte* pSrc = data, pDst = pixels) {
+					DecodeOps(pSrc + HeaderSize, data.Length - HeaderSize, pDst, width * height, pixelSize);
+				}
+				return header;
+			}
+
+			// Compute the offset of each chunk from the chunk table
+			int chunkCount = header.ChunkCount;
+			long totalPixels = (long)width * height, chunkPixels = (long)width * header.RowsPerChunk;
+			if (data.Length < header.Size) throw new InvalidDataException("QOI data is too short");
+			int[] chunkOffsets = new int[chunkCount + 1];
+			long offset = header.Size;
+			for (int i = 0; i < chunkCount; i++) {
+				chunkOffsets[i] = (int)offset;
+				offset += BinaryPrimitives.ReadUInt32BigEndian(data[(ChunkedHeaderSize + i * sizeof(uint))..]);
+				if (offset > data.Length) throw new InvalidDataException("QOI chunk table exceeds data length");
+			}
+			chunkOffsets[chunkCount] = (int)offset;
+
+			fixed (byte* pSrc = data, pDst = pixels) {
+				IntPtr src = (IntPtr)pSrc, dst = (IntPtr)pDst;
+				Parallel.For(0, chunkCount, i => {
+					int count = (int)Math.Min(chunkPixels, totalPixels - i * chunkPixels);
+					DecodeOps((byte*)src + chunkOffsets[i], chunkOffsets[i + 1] - chunkOffsets[i], (byte*)dst + i * chunkPixels * pixelSize, count, pixelSize);
+				});
+			}
+			return header;
+		}
+
+		/// <summary>
+		/// Decodes a QOI image directly into the pixels of an existing image, which must be the same size as the
+		/// encoded image and have a format of <see cref="PixelFormat.R8G8B8UNorm"/> or <see cref="PixelFormat.R8G8B8A8UNorm"/>.
+		/// </summary>
+		/// <param name="data">The QOI data</param>
+		/// <param name="image">The image to decode into</param>
+		/// <returns>The image header</returns>
+		public static QOIHeader Decode(ReadOnlySpan<byte> data, IImage image) {
+			QOIChannels channels = GetChannels(image.Format);
+			QOIHeader header = ReadHeader(data);
+			if (header.Width != image.Size.X || header.Height != image.Size.Y) throw new ArgumentException("Image size does not match encoded image", nameof(image));
+			var ptr = image.MapPixels(Native.MapMode.WriteOnly);
+			try {
+				return Decode(data, ptr.Span, channels);
+			} finally {
+				image.UnmapPixels();
+			}
+		}
+
+		/// <summary>
+		/// Decodes a QOI image into a new array image.
+		/// </summary>
+		/// <param name="data">The QOI data</param>
+		/// <returns>The decoded image</returns>
+		public static ArrayImage DecodeImage(ReadOnlySpan<byte> data) {
+			QOIHeader header = ReadHeader(data);
+			ArrayImage image = new(header.Width, header.Height, header.Channels == QOIChannels.RGB ? PixelFormat.R8G8B8UNorm : PixelFormat.R8G8B8A8UNorm);
+			Decode(data, image.Pixels, header.Channels);
+			return image;
+		}
+
+		private static QOIChannels GetChannels(PixelFormat format) {
+			if (format.Equals(PixelFormat.R8G8B8A8UNorm)) return QOIChannels.RGBA;
+			if (format.Equals(PixelFormat.R8G8B8UNorm)) return QOIChannels.RGB;
+			throw new ArgumentException("Image must have RGB8 or RGBA8 pixel format");
+		}
+
+	}
+
+}
@@ -1,7 +1,8 @@
 ﻿using System;
-using System.Buffers.Binary;
+using System.Buffers;
 using System.Collections.Generic;
 using System.IO;
+using System.Runtime.InteropServices;
 using System.Threading;
 using System.Threading.Tasks;
 using Tesseract.Core.Resource;
@@ -14,34 +15,6 @@ using SixLabors.ImageSharp.Processing;
 
 namespace Tesseract.Core.Graphics.QOI {
 
-	/// <summary>
-	/// Enum of QOI channel values.
-	/// </summary>
-	public enum QOIChannels : byte {
-		/// <summary>
-		/// RGB channels.
-		/// </summary>
-		RGB = 3,
-		/// <summary>
-		/// RGBA channels.
-		/// </summary>
-		RGBA = 4
-	}
-
-	/// <summary>
-	/// Enum of QOI colorspace values.
-	/// </summary>
-	public enum QOIColorspace {
-		/// <summary>
-		/// sRGB colorspace with linear alpha.
-		/// </summary>
-		SRGB = 0,
-		/// <summary>
-		/// Linear colorspace.
-		/// </summary>
-		Linear = 1
-	}
-
 	/// <summary>
 	/// An <see cref="ImageIO"/> implementation for Quite Ok Image (QOI) encoded files.
 	/// </summary>
@@ -70,149 +43,63 @@ namespace Tesseract.Core.Graphics.QOI {
 
 		private QOIImageFormat() { }
 
-		// Hash function for QOI colors
-		internal static int Hash(Rgba32 color) => (color.R * 3 + color.G * 5 + color.B * 7 + color.A * 11) & 0x3F;
-
 	}
 
 	public class QOIEncoder : IImageEncoder {
 
 		public bool SkipMetadata { get; init; } = false;
 
-		public void Encode<TPixel>(Image<TPixel> image, Stream stream) where TPixel : unmanaged, IPixel<TPixel> {
-			// Write the magic header
-			Span<byte> tmp = stackalloc byte[4] {
-				(byte)'q',
-				(byte)'o',
-				(byte)'i',
-				(byte)'f'
-			};
-			stream.Write(tmp);
-
-			// Write the width and height
+		/// <summary>
+		/// The colorspace to store in encoded images.
+		/// </summary>
+		public QOIColorspace Colorspace { get; init; } = QOIColorspace.SRGB;
+
+		/// <summary>
+		/// If the chunked container should be used, allowing the image to be decoded in parallel.
+		/// </summary>
+		public bool Chunked { get; init; } = false;
+
+		// Encodes the pixels of an image in one of the natively supported pixel formats
+		private void EncodePixels<TPixel>(Image<TPixel> image, QOIChannels channels, Stream stream) where TPixel : unmanaged, IPixel<TPixel> {
 			int width = image.Width, height = image.Height;
-			BinaryPrimitives.WriteInt32BigEndian(tmp, width);
-			stream.Write(tmp);
-			BinaryPrimitives.WriteInt32BigEndian(tmp, height);
-			stream.Write(tmp);
-			int npixels = width * height;
-
-
-			bool hasAlpha = false;
-
-			// Check which format we are using and write it
-			if (typeof(TPixel) == typeof(Rgba32)) {
-				// 4-byte, linear
-				stream.WriteByte(4);
-				stream.WriteByte(1);
-				hasAlpha = true;
-			} else if (typeof(TPixel) == typeof(Rgb24)) {
-				// 3-byte, linear
-				stream.WriteByte(3);
-				stream.WriteByte(1);
-			} else throw new ArgumentException("Image has unsupported pixel format for QOI encoding", nameof(image));
-
-			// For each pixel in the image (top -> bottom, left -> right)
-			image.ProcessPixelRows(accesor => {
-				// The number of pixels currently being RLE'd
-				int runLen = 0;
-
-				// The last color seen by the encoder
-				Rgba32 c = new(0, 0, 0, 255);
-				// The current pixel being encoded
-				Rgba32 nc = new();
-
-				// Hashtable of already seen colors (only updated by DIFF, LUMA, and RGB(A) packets)
-				Span<Rgba32> table = stackalloc Rgba32[64];
-				// Corresponding boolean list for if a hashtable slot is valid
-				Span<bool> tableValid = stackalloc bool[64];
-
-				// Initialize the table with the initial color
-				int tmp2 = QOIImageFormat.Hash(c);
-				table[tmp2] = c;
-				tableValid[tmp2] = true;
-
-				for (int y = 0; y < height; y++) {
-					Span<TPixel> row = accesor.GetRowSpan(y);
-					for(int x = 0; x < width; x++) {
-						row[x].ToRgba32(ref nc);
-						if (!hasAlpha) nc.A = 0xFF;
-
-						// Check for RLE capability first
-						if (c == nc) runLen++;
-						else {
-							// Else need to try a different technique
-							// Write any remaining RLE packet
-							if (runLen != 0) stream.WriteByte((byte)(0xC0 | (runLen - 1)));
-
-							// Generate the hash of the pixel
-							int hash = QOIImageFormat.Hash(nc);
-
-							// Next, attempt to use the hash table
-							if (table[hash] == nc && tableValid[hash]) stream.WriteByte((byte)hash);
-							else {
-								// Then, attempt to encode using pixel differences
-								sbyte dr = (sbyte)(nc.R - c.R);
-								sbyte dg = (sbyte)(nc.G - c.G);
-								sbyte db = (sbyte)(nc.B - c.B);
-								// Try DIFF packet first
-								if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
-									stream.WriteByte((byte)(0x40 | (((dr + 2) & 0x3) << 4) | (((dg + 2) & 0x3) << 2) | ((db + 2) & 0x3)));
-								} else {
-									// Then try LUMA packet
-									sbyte drmdg = (sbyte)(dr - dg);
-									sbyte dbmdg = (sbyte)(db - dg);
-									if (dg >= -32 && dg <= 31 && drmdg >= -8 && drmdg <= 7 && drmdg >= -8 && drmdg <= 7) {
-										stream.WriteByte((byte)(0x80 | ((dg + 32) & 0x3F)));
-										stream.WriteByte((byte)(
-											(((drmdg) + 8) << 4) |
-											((dbmdg + 8) & 0xF)
-										));
-									} else {
-										// Finally, resort to an RGB(A) packet
-										if (nc.A == c.A) {
-											stream.WriteByte(0xFE);
-											stream.WriteByte(nc.R);
-											stream.WriteByte(nc.G);
-											stream.WriteByte(nc.B);
-										} else {
-											stream.WriteByte(0xFF);
-											stream.WriteByte(nc.R);
-											stream.WriteByte(nc.G);
-											stream.WriteByte(nc.B);
-											stream.WriteByte(nc.A);
-										}
-									}
-								}
-								// Update hashtable with newest color
-								table[hash] = nc;
-								tableValid[hash] = true;
-							}
-						}
-
-						// Handle RLE length limit of 62
-						if (runLen == 62) {
-							stream.WriteByte(0xFD);
-							runLen = 0;
-						}
-					}
+			int pixelSize = (int)channels;
+			byte[]? pixelBuffer = null;
+			byte[] encoded = ArrayPool<byte>.Shared.Rent((int)QOICodec.GetMaxEncodedSize(width, height, channels, Chunked));
+			try {
+				// Use the image memory directly if it is contiguous, else copy it out
+				ReadOnlySpan<byte> pixels;
+				if (image.DangerousTryGetSinglePixelMemory(out Memory<TPixel> memory)) {
+					pixels = MemoryMarshal.AsBytes(memory.Span);
+				} else {
+					pixelBuffer = ArrayPool<byte>.Shared.Rent(width * height * pixelSize);
+					image.CopyPixelDataTo(pixelBuffer.AsSpan(0, width * height * pixelSize));
+					pixels = pixelBuffer;
 				}
 
-				// If any RLE encoding remaining, write it
-				if (runLen != 0) stream.WriteByte((byte)(0xC0 | (runLen - 1)));
-			});
-
-			// Write the footer
-			stream.Write(stackalloc byte[] {
-				0,
-				0,
-				0,
-				0,
-				0,
-				0,
-				0,
-				1
-			});
+				int length = Chunked ?
+					QOICodec.EncodeChunked(pixels, width, height, channels, encoded, Colorspace) :
+					QOICodec.Encode(pixels, width, height, channels, encoded, Colorspace);
+				stream.Write(encoded, 0, length);
+			} finally {
+				ArrayPool<byte>.Shared.Return(encoded);
+				if (pixelBuffer != null) ArrayPool<byte>.Shared.Return(pixelBuffer);
+			}
+		}
+
+		public void Encode<TPixel>(Image<TPixel> image, Stream stream) where TPixel : unmanaged, IPixel<TPixel> {
+			if (image is Image<Rgba32> rgba) EncodePixels(rgba, QOIChannels.RGBA, stream);
+			else if (image is Image<Rgb24> rgb) EncodePixels(rgb, QOIChannels.RGB, stream);
+			else {
+				// Convert other formats to RGBA or RGB depending on if they have alpha
+				bool hasAlpha = (image.PixelType.AlphaRepresentation ?? PixelAlphaRepresentation.None) != PixelAlphaRepresentation.None;
+				if (hasAlpha) {
+					using var tmp = image.CloneAs<Rgba32>();
+					EncodePixels(tmp, QOIChannels.RGBA, stream);
+				} else {
+					using var tmp = image.CloneAs<Rgb24>();
+					EncodePixels(tmp, QOIChannels.RGB, stream);
+				}
+			}
 		}
 
 		public Task EncodeAsync<TPixel>(Image<TPixel> image, Stream stream, CancellationToken cancellationToken) where TPixel : unmanaged, IPixel<TPixel> =>
@@ -222,139 +109,58 @@ namespace Tesseract.Core.Graphics.QOI {
 
 	public class QOIDecoder : IImageDecoder {
 
-		// Decodes the contents of a QOI image into an ImageSharp image of the given pixel format
-		private Image DecodePixels<TPixel>(Stream stream, Image<TPixel> img) where TPixel : unmanaged, IPixel<TPixel> {
-			byte NextByte() {
-				int val = stream.ReadByte();
-				if (val == -1) throw new IOException("Unexpected end of stream");
-				return (byte)val;
+		// Reads the remaining contents of a stream into a pooled buffer
+		private static byte[] ReadAll(Stream stream, out int length) {
+			byte[] buffer = ArrayPool<byte>.Shared.Rent(stream.CanSeek ? (int)Math.Max(stream.Length - stream.Position + 1, QOICodec.ChunkedHeaderSize) : 65536);
+			length = 0;
+			int n;
+			while ((n = stream.Read(buffer, length, buffer.Length - length)) > 0) {
+				length += n;
+				if (length == buffer.Length) {
+					byte[] newBuffer = ArrayPool<byte>.Shared.Rent(buffer.Length * 2);
+					buffer.AsSpan(0, length).CopyTo(newBuffer);
+					ArrayPool<byte>.Shared.Return(buffer);
+					buffer = newBuffer;
+				}
 			}
+			return buffer;
+		}
 
-			img.ProcessPixelRows(access => {
-				Rgba32 c = new();
-				TPixel px = new();
-
-				PixelAlphaRepresentation alphaRep = img.PixelType.AlphaRepresentation ?? PixelAlphaRepresentation.None;
-				bool hasAlpha = alphaRep != PixelAlphaRepresentation.None;
-
-				Span<Rgba32> array = stackalloc Rgba32[64];
-				array[QOIImageFormat.Hash(c)] = c;
-				int run = 0;
-
-				for (int y = 0; y < access.Height; y++) {
-					Span<TPixel> row = access.GetRowSpan(y);
-					for(int x = 0; x < access.Width; x++) {
-						// If has remaining pixels in RLE, use that instead
-						if (run > 0) {
-							row[x] = px;
-							run--;
-							continue;
-						}
-
-						byte op = NextByte();
-
-						switch (op) {
-							case 0xFE: // QOI_OP_RGB
-								c.R = NextByte();
-								c.G = NextByte();
-								c.B = NextByte();
-								break;
-							case 0xFF: // QOI_OP_RGBA
-								c.R = NextByte();
-								c.G = NextByte();
-								c.B = NextByte();
-								c.A = NextByte();
-								break;
-							default:
-								switch (op & 0xC0) {
-									case 0b00_000000: // QOI_OP_INDEX
-										c = array[op & 0x3F];
-										break;
-									case 0b01_000000: // QOI_OP_DIFF
-										{
-											int dr = ((op >> 4) & 0x3) - 2;
-											int dg = ((op >> 2) & 0x3) - 2;
-											int db = (op & 0x3) - 2;
-											c.R += (byte)dr;
-											c.G += (byte)dg;
-											c.B += (byte)db;
-										}
-										break;
-									case 0b10_000000: // QOI_OP_LUMA
-										{
-											int dg = (op & 0x3F) - 32;
-											byte op2 = NextByte();
-											int drmdg = ((op2 >> 4) & 0xF) - 8;
-											int dbmdg = (op2 & 0xF) - 8;
-											int dr = dg + drmdg;
-											int db = dg + dbmdg;
-											c.R += (byte)dr;
-											c.G += (byte)dg;
-											c.B += (byte)db;
-										}
-										break;
-									case 0b11_000000: // QOI_OP_RUN
-										run = (op & 0x3F); // Current pixel will be stored, remaining run length is read
-										break;
-								}
-								break;
-						}
-
-						// Store decoded pixel, and update array
-						px.FromRgba32(c);
-						row[x] = px;
-						array[QOIImageFormat.Hash(c)] = c;
+		// Decodes the contents of a QOI image into an ImageSharp image of the given pixel format
+		private static Image<TPixel> DecodePixels<TPixel>(ReadOnlySpan<byte> data, QOIHeader header) where TPixel : unmanaged, IPixel<TPixel> {
+			Image<TPixel> img = new(header.Width, header.Height);
+			try {
+				if (img.DangerousTryGetSinglePixelMemory(out Memory<TPixel> memory)) {
+					QOICodec.Decode(data, MemoryMarshal.AsBytes(memory.Span), header.Channels);
+				} else {
+					// Decode to a temporary buffer and copy if the image is not contiguous
+					int size = header.Width * header.Height * (int)header.Channels;
+					byte[] pixels = ArrayPool<byte>.Shared.Rent(size);
+					try {
+						QOICodec.Decode(data, pixels.AsSpan(0, size), header.Channels);
+						img.Dispose();
+						img = Image.LoadPixelData<TPixel>(pixels.AsSpan(0, size), header.Width, header.Height);
+					} finally {
+						ArrayPool<byte>.Shared.Return(pixels);
 					}
 				}
-			});
-
+			} catch {
+				img.Dispose();
+				throw;
+			}
 			return img;
 		}
 
-		private struct Header {
-
-			public uint Width;
-			public uint Height;
-			public QOIChannels Channels;
-			public QOIColorspace Colorspace;
-
-		}
-
-		private Header ReadHeader(Stream stream) {
-			Header header = new();
-			Span<byte> buf = stackalloc byte[4];
-
-			stream.ReadFully(buf);
-			if (
-				buf[0] != 'q' ||
-				buf[1] != 'o' ||
-				buf[2] != 'i' ||
-				buf[3] != 'f'
-			) throw new InvalidDataException("Magic value does not match QOI format");
-
-			stream.ReadFully(buf);
-			header.Width = BinaryPrimitives.ReadUInt32BigEndian(buf);
-			stream.ReadFully(buf);
-			header.Height = BinaryPrimitives.ReadUInt32BigEndian(buf);
-			int nextb = stream.ReadByte();
-			if (nextb == -1) throw new IOException("Unexpected end of stream");
-			header.Channels = (QOIChannels)nextb;
-			nextb = stream.ReadByte();
-			if (nextb == -1) throw new IOException("Unexpected end of stream");
-			header.Colorspace = (QOIColorspace)nextb;
-
-			return header;
-		}
-
-
 		public ImageInfo Identify(DecoderOptions options, Stream stream) {
-			var header = ReadHeader(stream);
+			Span<byte> buf = stackalloc byte[QOICodec.ChunkedHeaderSize];
+			stream.ReadFully(buf);
+			var header = QOICodec.ReadHeader(buf);
 
 			PixelTypeInfo ptinfo = new((int)header.Channels * 8);
 
 			return new ImageInfo(
 				ptinfo,
-				new Size((int)header.Width, (int)header.Height),
+				new Size(header.Width, header.Height),
 				null
 			);
 		}
@@ -365,16 +171,23 @@ namespace Tesseract.Core.Graphics.QOI {
 		public Image<TPixel> Decode<TPixel>(DecoderOptions options, Stream stream) where TPixel : unmanaged, IPixel<TPixel> {
 			Image img = Decode(options, stream);
 			if (img is Image<TPixel> timg) return timg;
-			else return img.CloneAs<TPixel>();
+			using (img) return img.CloneAs<TPixel>();
 		}
 
 		public Image Decode(DecoderOptions options, Stream stream) {
-			Header header = ReadHeader(stream);
-			Image img = header.Channels switch {
-				QOIChannels.RGB => DecodePixels(stream, new Image<Rgb24>((int)header.Width, (int)header.Height)),
-				QOIChannels.RGBA => DecodePixels(stream, new Image<Rgba32>((int)header.Width, (int)header.Height)),
-				_ => throw new InvalidDataException("Unknown QOI channel value"),
-			};
+			byte[] data = ReadAll(stream, out int length);
+			Image img;
+			try {
+				ReadOnlySpan<byte> span = data.AsSpan(0, length);
+				QOIHeader header = QOICodec.ReadHeader(span);
+				img = header.Channels switch {
+					QOIChannels.RGB => DecodePixels<Rgb24>(span, header),
+					QOIChannels.RGBA => DecodePixels<Rgba32>(span, header),
+					_ => throw new InvalidDataException("Unknown QOI channel value"),
+				};
+			} finally {
+				ArrayPool<byte>.Shared.Return(data);
+			}
 			if (options.TargetSize != null) {
 				var newSize = options.TargetSize.Value;
 				if (newSize != img.Size) {
@@ -402,7 +215,7 @@ namespace Tesseract.Core.Graphics.QOI {
 				header[0] == 'q' &&
 				header[1] == 'o' &&
 				header[2] == 'i' &&
-				header[3] == 'f') {
+				(header[3] == 'f' || header[3] == 'c')) {
 				format = QOIImageFormat.Instance;
 				return true;
 			}
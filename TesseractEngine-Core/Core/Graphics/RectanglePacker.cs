@@ -0,0 +1,242 @@
+﻿using System;
+using System.Collections.Generic;
+using Tesseract.Core.Numerics;
+
+namespace Tesseract.Core.Graphics {
+
+	/// <summary>
+	/// <para>
+	/// A rectangle packer incrementally assigns positions to rectangles within a 2D bin such that they do
+	/// not overlap. This uses the "skyline bottom-left" heuristic, which tracks the top edge of the packed
+	/// area as a list of horizontal segments and places each rectangle on the segment which results in the
+	/// lowest top edge. Each insertion is linear in the number of skyline segments, so packing remains fast
+	/// for many thousands of rectangles.
+	/// </para>
+	/// <para>
+	/// Rectangles are never moved once placed. If a rectangle does not fit the bin will be grown (doubling
+	/// its smallest dimension) up to <see cref="MaxSize"/>, which only adds free space beyond the existing
+	/// contents. This allows packing to continue after a previous result has been used, such as when
+	/// only newly added regions of an atlas need to be uploaded.
+	/// </para>
+	/// </summary>
+	public class RectanglePacker {
+
+		// A horizontal segment of the skyline, spanning [X, X + Width) at height Y
+		private struct SkylineNode {
+
+			public int X;
+
+			public int Y;
+
+			public int Width;
+
+		}
+
+		// The skyline, sorted by X and covering the full width of the bin
+		private readonly List<SkylineNode> skyline = new();
+
+		/// <summary>
+		/// The current size of the bin.
+		/// </summary>
+		public Vector2i Size { get; private set; }
+
+		/// <summary>
+		/// The maximum size the bin may grow to.
+		/// </summary>
+		public Vector2i MaxSize { get; }
+
+		/// <summary>
+		/// The size of the bounding box around all packed rectangles.
+		/// </summary>
+		public Vector2i UsedSize { get; private set; }
+
+		/// <summary>
+		/// The total area covered by packed rectangles.
+		/// </summary>
+		public long UsedArea { get; private set; }
+
+		/// <summary>
+		/// The number of rectangles which have been packed.
+		/// </summary>
+		public int Count { get; private set; }
+
+		/// <summary>
+		/// The packing efficiency as the ratio of the packed area to the area of the bin, between 0 and 1.
+		/// </summary>
+		public float Efficiency => Size.X == 0 || Size.Y == 0 ? 0 : (float)((double)UsedArea / ((long)Size.X * Size.Y));
+
+		/// <summary>
+		/// The packing efficiency as the ratio of the packed area to the area of the bounding box around
+		/// the packed rectangles, between 0 and 1.
+		/// </summary>
+		public float UsedEfficiency => UsedSize.X == 0 || UsedSize.Y == 0 ? 0 : (float)((double)UsedArea / ((long)UsedSize.X * UsedSize.Y));
+
+		/// <summary>
+		/// Creates a new rectangle packer.
+		/// </summary>
+		/// <param name="initialSize">The initial size of the bin</param>
+		/// <param name="maxSize">The maximum size of the bin, or null to allow growing without bound</param>
+		/// <exception cref="ArgumentOutOfRangeException">If the initial size is not positive or exceeds the maximum size</exception>
+		public RectanglePacker(Vector2i initialSize, Vector2i? maxSize = null) {
+			Vector2i max = maxSize ?? new Vector2i(int.MaxValue / 2);
+			if (initialSize.X <= 0 || initialSize.Y <= 0) throw new ArgumentOutOfRangeException(nameof(initialSize), "Initial bin size must be positive");
+			if (initialSize.X > max.X || initialSize.Y > max.Y) throw new ArgumentOutOfRangeException(nameof(initialSize), "Initial bin size cannot exceed maximum size");
+			Size = initialSize;
+			MaxSize = max;
+			skyline.Add(new SkylineNode() { X = 0, Y = 0, Width = initialSize.X });
+		}
+
+		/// <summary>
+		/// Removes all packed rectangles, keeping the current bin size.
+		/// </summary>
+		public void Clear() {
+			skyline.Clear();
+			skyline.Add(new SkylineNode() { X = 0, Y = 0, Width = Size.X });
+			UsedSize = default;
+			UsedArea = 0;
+			Count = 0;
+		}
+
+		/// <summary>
+		/// Attempts to pack a rectangle of the given size, growing the bin if needed.
+		/// </summary>
+		/// <param name="size">The size of the rectangle to pack</param>
+		/// <param name="position">The position the rectangle was packed at</param>
+		/// <returns>If the rectangle was packed, false if it cannot fit even at the maximum bin size</returns>
+		/// <exception cref="ArgumentOutOfRangeException">If the size of the rectangle is negative</exception>
+		public bool TryPack(Vector2i size, out Vector2i position) {
+			if (size.X < 0 || size.Y < 0) throw new ArgumentOutOfRangeException(nameof(size), "Rectangle size cannot be negative");
+			position = default;
+			if (size.X > MaxSize.X || size.Y > MaxSize.Y) return false;
+
+			int index;
+			while ((index = FindPosition(size, out position)) < 0) {
+				if (!Grow()) return false;
+			}
+
+			Place(index, position, size);
+			return true;
+		}
+
+		/// <summary>
+		/// Packs a rectangle of the given size, growing the bin if needed.
+		/// </summary>
+		/// <param name="size">The size of the rectangle to pack</param>
+		/// <returns>The position the rectangle was packed at</returns>
+		/// <exception cref="InvalidOperationException">If the rectangle cannot fit even at the maximum bin size</exception>
+		public Vector2i Pack(Vector2i size) {
+			if (!TryPack(size, out Vector2i position)) throw new InvalidOperationException($"Cannot pack {size.X}x{size.Y} rectangle within maximum size {MaxSize.X}x{MaxSize.Y}");
+			return position;
+		}
+
+		/// <summary>
+		/// Sorts a list of items into the order that packs them most efficiently, which is by descending height
+		/// and then by descending width.
+		/// </summary>
+		/// <typeparam name="T">The item type</typeparam>
+		/// <param name="items">The items to sort</param>
+		/// <param name="getSize">Function to get the size of an item</param>
+		public static void SortForPacking<T>(List<T> items, Func<T, Vector2i> getSize) {
+			items.Sort((a, b) => {
+				Vector2i sizeA = getSize(a), sizeB = getSize(b);
+				int cmp = sizeB.Y.CompareTo(sizeA.Y);
+				return cmp != 0 ? cmp : sizeB.X.CompareTo(sizeA.X);
+			});
+		}
+
+		// Finds the skyline node with the best (lowest top edge, then narrowest) fit for a rectangle, or -1 if it does not fit
+		private int FindPosition(Vector2i size, out Vector2i position) {
+			int bestIndex = -1, bestTop = int.MaxValue, bestWidth = int.MaxValue;
+			position = default;
+			for (int i = 0; i < skyline.Count; i++) {
+				int y = FitAt(i, size);
+				if (y < 0) continue;
+				int top = y + size.Y;
+				int width = skyline[i].Width;
+				if (top < bestTop || (top == bestTop && width < bestWidth)) {
+					bestIndex = i;
+					bestTop = top;
+					bestWidth = width;
+					position = new Vector2i(skyline[i].X, y);
+				}
+			}
+			return bestIndex;
+		}
+
+		// Computes the Y position a rectangle would rest at if placed at the given node, or -1 if it does not fit
+		private int FitAt(int index, Vector2i size) {
+			int x = skyline[index].X;
+			if (x + size.X > Size.X || size.Y > Size.Y) return -1;
+			int y = 0, remaining = size.X;
+			for (int i = index; remaining > 0; i++) {
+				SkylineNode node = skyline[i];
+				y = Math.Max(y, node.Y);
+				if (y + size.Y > Size.Y) return -1;
+				remaining -= node.Width;
+			}
+			return y;
+		}
+
+		// Places a rectangle on the skyline at the given node
+		private void Place(int index, Vector2i position, Vector2i size) {
+			Count++;
+			UsedArea += (long)size.X * size.Y;
+			UsedSize = UsedSize.Max(position + size);
+			// Zero-sized rectangles do not change the skyline
+			if (size.X == 0 || size.Y == 0) return;
+
+			skyline.Insert(index, new SkylineNode() { X = position.X, Y = position.Y + size.Y, Width = size.X });
+
+			// Shrink or remove the nodes now covered by the new node
+			int right = position.X + size.X;
+			int i = index + 1;
+			while (i < skyline.Count) {
+				SkylineNode node = skyline[i];
+				if (node.X >= right) break;
+				int nodeRight = node.X + node.Width;
+				if (nodeRight <= right) {
+					skyline.RemoveAt(i);
+				} else {
+					node.Width = nodeRight - right;
+					node.X = right;
+					skyline[i] = node;
+					break;
+				}
+			}
+
+			// Merge adjacent nodes of the same height
+			int start = Math.Max(index - 1, 0);
+			for (i = start; i < skyline.Count - 1 && i <= index + 1; ) {
+				SkylineNode a = skyline[i], b = skyline[i + 1];
+				if (a.Y == b.Y) {
+					a.Width += b.Width;
+					skyline[i] = a;
+					skyline.RemoveAt(i + 1);
+				} else i++;
+			}
+		}
+
+		// Grows the bin along its smaller dimension, returning false if it is already at the maximum size
+		private bool Grow() {
+			Vector2i size = Size;
+			bool growX = size.X <= size.Y ? size.X < MaxSize.X : size.Y >= MaxSize.Y;
+			if (growX) {
+				if (size.X >= MaxSize.X) return false;
+				int newWidth = (int)Math.Min((long)size.X * 2, MaxSize.X);
+				// Extend the skyline with the new empty columns
+				SkylineNode last = skyline[^1];
+				if (last.Y == 0) {
+					last.Width += newWidth - size.X;
+					skyline[^1] = last;
+				} else skyline.Add(new SkylineNode() { X = size.X, Y = 0, Width = newWidth - size.X });
+				Size = new Vector2i(newWidth, size.Y);
+			} else {
+				if (size.Y >= MaxSize.Y) return false;
+				Size = new Vector2i(size.X, (int)Math.Min((long)size.Y * 2, MaxSize.Y));
+			}
+			return true;
+		}
+
+	}
+
+}
@@ -2,6 +2,7 @@
 using System.Buffers;
 using System.Collections.Generic;
 using System.Linq;
+using System.Runtime.CompilerServices;
 using System.Runtime.InteropServices;
 using System.Text;
 using System.Threading;
@@ -19,7 +20,13 @@ namespace Tesseract.Core.Native {
 	/// is destroyed when the stack goes out of scope, eg:
 	/// </para>
 	/// <para><code>using MemoryStack sp = MemoryStack.Push()</code></para>
-	/// <para>Note: The memory stack grows downwards in memory, starting at the top of stack memory.</para>
+	/// <para>
+	/// A growable stack is made of one or more pinned segments. When an allocation does not fit in the current segment
+	/// it is placed in the next segment, which is created if needed. Segments are never moved or freed while the stack
+	/// is alive, so pointers to live allocations remain valid as the stack grows, and segments are reused once the frames
+	/// using them are popped. The thread-local stacks returned by <see cref="Current"/> are growable.
+	/// </para>
+	/// <para>Note: The memory stack grows downwards in memory, starting at the top of each segment.</para>
 	/// </summary>
 	public class MemoryStack : IDisposable {
 
@@ -28,12 +35,43 @@ namespace Tesseract.Core.Native {
 		/// </summary>
 		public const int DefaultSize = 65536;
 
-		private static readonly ThreadLocal<MemoryStack> localStack = new(() => new MemoryStack());
+		[ThreadStatic]
+		private static MemoryStack? localStack;
+
+		// Weak references to every thread-local stack, so stacks of exited threads can be collected with their segments
+		private static readonly List<WeakReference<MemoryStack>> threadStacks = new();
 
 		/// <summary>
 		/// The thread-local ("current") memory stack.
 		/// </summary>
-		public static MemoryStack Current => localStack.Value!;
+		public static MemoryStack Current => localStack ?? CreateThreadStack();
+
+		/// <summary>
+		/// The thread-local memory stacks of every live thread which has used one. This can be used to gather
+		/// usage statistics such as <see cref="HighWaterMark"/> and <see cref="OverflowCount"/>. The stack of
+		/// an exited thread may still be reported until it is garbage collected.
+		/// </summary>
+		public static IReadOnlyList<MemoryStack> ThreadStacks {
+			get {
+				List<MemoryStack> stacks = new();
+				lock (threadStacks) {
+					foreach (WeakReference<MemoryStack> reference in threadStacks) {
+						if (reference.TryGetTarget(out MemoryStack? stack)) stacks.Add(stack);
+					}
+				}
+				return stacks;
+			}
+		}
+
+		private static MemoryStack CreateThreadStack() {
+			MemoryStack stack = new(DefaultSize, true);
+			lock (threadStacks) {
+				threadStacks.RemoveAll(reference => !reference.TryGetTarget(out _));
+				threadStacks.Add(new WeakReference<MemoryStack>(stack));
+			}
+			localStack = stack;
+			return stack;
+		}
 
 		/// <summary>
 		/// Gets the current memory stack and pushes a new stack frame.
@@ -41,48 +79,127 @@ namespace Tesseract.Core.Native {
 		/// <returns>Current memory stack</returns>
 		public static MemoryStack Push() => Current.PushFrame();
 
-		// The underlying memory
-		private readonly Memory<byte> memory;
-		// The handle to the memory
-		private readonly MemoryHandle memoryHandle;
-		// The pointer to the base of stack memory
-		private readonly IntPtr pBase;
-		// The current offset into the stack
+		private struct Segment {
+
+			// The underlying pinned memory
+			public byte[] Memory;
+			// The pointer to the base of the segment
+			public IntPtr Base;
+			// The position of the top of the segment in the stack's address space
+			public int Start;
+
+		}
+
+		// The segments of stack memory
+		private Segment[] segments = new Segment[1];
+		// The number of allocated segments
+		private int segmentCount = 0;
+		// The index of the current segment
+		private int segment = 0;
+		// The current offset into the current segment
 		private int offset;
-		private readonly Stack<int> frameStack = new();
+		// The saved positions of each stack frame, packed as (segment << 32) | offset
+		private long[] frames = new long[16];
+		// The number of saved stack frames
+		private int frameCount = 0;
 
-		public MemoryStack(int capacity) {
-			memory = new byte[capacity];
-			memoryHandle = memory.Pin();
-			unsafe { pBase = (IntPtr)memoryHandle.Pointer; }
-			offset = memory.Length;
+		/// <summary>
+		/// If this stack will allocate new segments when it runs out of memory instead of throwing an exception.
+		/// </summary>
+		public bool Growable { get; }
+
+		/// <summary>
+		/// The size of each segment allocated by this stack. Allocations larger than this are given a segment of their own.
+		/// </summary>
+		public int SegmentSize { get; }
+
+		/// <summary>
+		/// The number of segments currently allocated by this stack.
+		/// </summary>
+		public int SegmentCount => segmentCount;
+
+		/// <summary>
+		/// The total number of bytes of memory allocated by this stack.
+		/// </summary>
+		public int Capacity {
+			get {
+				ref Segment last = ref segments[segmentCount - 1];
+				return last.Start + last.Memory.Length;
+			}
 		}
 
-		public MemoryStack() {
-			memory = new byte[DefaultSize];
-			memoryHandle = memory.Pin();
-			unsafe { pBase = (IntPtr)memoryHandle.Pointer; }
-			offset = memory.Length;
+		/// <summary>
+		/// The maximum value of <see cref="Pointer"/> observed since the stack was created or statistics were reset. This
+		/// is the peak number of bytes in use, including alignment padding and space skipped at the end of full segments.
+		/// </summary>
+		public int HighWaterMark { get; private set; }
+
+		/// <summary>
+		/// The number of allocations which did not fit into the current segment since the stack was created or statistics were reset.
+		/// </summary>
+		public int OverflowCount { get; private set; }
+
+		/// <summary>
+		/// Creates a new memory stack.
+		/// </summary>
+		/// <param name="capacity">The size of each segment of the stack</param>
+		/// <param name="growable">If the stack should allocate new segments when it runs out of memory</param>
+		public MemoryStack(int capacity, bool growable = false) {
+			if (capacity <= 0) throw new ArgumentOutOfRangeException(nameof(capacity));
+			Growable = growable;
+			SegmentSize = capacity;
+			AddSegment(capacity);
+			offset = capacity;
 		}
 
-		~MemoryStack() {
-			memoryHandle.Dispose();
+		public MemoryStack() : this(DefaultSize) { }
+
+		private void AddSegment(int size) {
+			if (segmentCount == segments.Length) Array.Resize(ref segments, segmentCount * 2);
+			byte[] memory = GC.AllocateUninitializedArray<byte>(size, true);
+			int start = 0;
+			if (segmentCount > 0) {
+				ref Segment last = ref segments[segmentCount - 1];
+				start = last.Start + last.Memory.Length;
+			}
+			unsafe {
+				segments[segmentCount++] = new Segment() {
+					Memory = memory,
+					Base = (IntPtr)Unsafe.AsPointer(ref MemoryMarshal.GetArrayDataReference(memory)),
+					Start = start
+				};
+			}
 		}
 
 		/// <summary>
-		/// Pointer to the base of stack memory.
+		/// Pointer to the base of the first segment of stack memory.
 		/// </summary>
-		public IntPtr Base => pBase;
+		public IntPtr Base => segments[0].Base;
 
 		/// <summary>
-		/// The 'stack pointer' indicating where the top of the stack is relative to the base.
+		/// The 'stack pointer' indicating where the top of the stack is, as the number of bytes from the top
+		/// of the stack's address space. This value may be saved and restored to free memory allocated in between.
 		/// </summary>
 		public int Pointer {
 			set {
-				if (value < 0 || value > memory.Length) throw new ArgumentOutOfRangeException(nameof(value));
-				offset = value;
+				if (value < 0 || value > Capacity) throw new ArgumentOutOfRangeException(nameof(value));
+				int i = 0;
+				while (value > segments[i].Start + segments[i].Memory.Length) i++;
+				segment = i;
+				offset = segments[i].Memory.Length - (value - segments[i].Start);
+			}
+			get {
+				ref Segment seg = ref segments[segment];
+				return seg.Start + (seg.Memory.Length - offset);
 			}
-			get => offset;
+		}
+
+		/// <summary>
+		/// Resets the <see cref="HighWaterMark"/> and <see cref="OverflowCount"/> statistics.
+		/// </summary>
+		public void ResetStatistics() {
+			HighWaterMark = Pointer;
+			OverflowCount = 0;
 		}
 
 		/// <summary>
@@ -90,7 +207,8 @@ namespace Tesseract.Core.Native {
 		/// </summary>
 		/// <returns>This object</returns>
 		public MemoryStack PushFrame() {
-			frameStack.Push(offset);
+			if (frameCount == frames.Length) Array.Resize(ref frames, frameCount * 2);
+			frames[frameCount++] = ((long)segment << 32) | (uint)offset;
 			return this;
 		}
 
@@ -99,7 +217,10 @@ namespace Tesseract.Core.Native {
 		/// </summary>
 		/// <returns>This object</returns>
 		public MemoryStack PopFrame() {
-			offset = frameStack.Pop();
+			if (frameCount == 0) throw new InvalidOperationException("Memory stack frame underflow");
+			long frame = frames[--frameCount];
+			segment = (int)(frame >> 32);
+			offset = (int)frame;
 			return this;
 		}
 
@@ -108,6 +229,31 @@ namespace Tesseract.Core.Native {
 			PopFrame();
 		}
 
+		// Attempts to allocate memory from the top of a segment, returning the new offset or -1 if there is not enough space
+		private static int TryAlloc(in Segment seg, int top, int bytesize, int alignment) {
+			long newoffset = (long)top - bytesize;
+			if (newoffset < 0) return -1;
+			newoffset -= (seg.Base + (nint)newoffset) % alignment;
+			return newoffset < 0 ? -1 : (int)newoffset;
+		}
+
+		private IntPtr AllocBytes(int bytesize, int alignment) {
+			int newoffset = TryAlloc(segments[segment], offset, bytesize, alignment);
+			if (newoffset < 0) {
+				if (!Growable) throw new ArgumentOutOfRangeException(nameof(bytesize), "Not enough memory to allocate structure");
+				OverflowCount++;
+				// Try any segments retained from previous growth, otherwise add a segment large enough for the allocation
+				do {
+					if (++segment == segmentCount) AddSegment(Math.Max(SegmentSize, bytesize + alignment));
+					newoffset = TryAlloc(segments[segment], segments[segment].Memory.Length, bytesize, alignment);
+				} while (newoffset < 0);
+			}
+			offset = newoffset;
+			int pointer = Pointer;
+			if (pointer > HighWaterMark) HighWaterMark = pointer;
+			return segments[segment].Base + offset;
+		}
+
 		/// <summary>
 		/// Allocates one or more values of an unmanaged data type. The data is uninitialized and will contain
 		/// whatever data was previously in stack memory at the same location.
@@ -120,14 +266,7 @@ namespace Tesseract.Core.Native {
 			if (size <= 0) return default;
 			unsafe {
 				if (alignment <= 0) alignment = sizeof(nint);
-				int bytesize = size * sizeof(T);
-				int newoffset = offset - bytesize;
-				IntPtr pNew = pBase + newoffset;
-				nint alignpad = (nint)pNew % alignment;
-				newoffset -= (int)alignpad;
-				if (newoffset < 0) throw new ArgumentOutOfRangeException(nameof(size), "Not enough memory to allocate structure");
-				offset = newoffset;
-				return new UnmanagedPointer<T>(pBase + offset, size);
+				return new UnmanagedPointer<T>(AllocBytes(size * sizeof(T), alignment), size);
 			}
 		}
 
@@ -234,12 +373,8 @@ namespace Tesseract.Core.Native {
 		/// <returns>Span of values in stack memory</returns>
 		public Span<T> AllocSpan<T>(int size) where T : unmanaged {
 			if (size <= 0) return Span<T>.Empty;
-			int bytesize = size * Marshal.SizeOf<T>();
-			int newoffset = offset - bytesize;
-			if (newoffset < 0) throw new ArgumentOutOfRangeException(nameof(size), "Not enough memory to allocate structure");
-			offset = newoffset;
 			unsafe {
-				return new Span<T>((void*)(pBase + offset), size);
+				return new Span<T>((void*)AllocBytes(size * sizeof(T), 1), size);
 			}
 		}
 
@@ -1,4 +1,5 @@
 ﻿using System;
+using System.Buffers;
 using System.Collections.Generic;
 using System.IO;
 using System.Linq;
@@ -36,7 +37,21 @@ namespace Tesseract.Core.Net {
 
 		private readonly INetSocket socket;
 
-		private readonly Thread connectionThread;
+		// Cancellation source to stop networking once the connection is closed
+		private readonly CancellationTokenSource networkCancel = new();
+
+		// The task running the connection's networking
+		private readonly Task networkTask;
+
+		// The thread firing the close events while networking is torn down, or -1
+		private volatile int teardownThread = -1;
+
+		// Reusable stream and reader for decoding packet payloads
+		private readonly ReadOnlySequenceStream rxPayloadStream = new();
+		private readonly BinaryReader rxPayloadReader;
+
+		// The tick count of the last received packet
+		private long lastRxPacket = Environment.TickCount64;
 
 		/// <summary>
 		/// Creates a new client with the given interface, and an optional existing socket.
@@ -53,8 +68,6 @@ namespace Tesseract.Core.Net {
 					SocketType.Stream,
 					ProtocolType.Tcp
 				);
-				sock.Blocking = false;
-
 				// Get the host name from the interface, for clients this must not be null
 				string? hostname = iface.HostName;
 				if (hostname == null) throw new ArgumentNullException(nameof(iface), "Host name must be non-null");
@@ -73,16 +86,19 @@ namespace Tesseract.Core.Net {
 				if (socket.ConnectionInfo is IPEndPoint ep) RemoteAddress = ep.Address;
 			}
 			
-			connectionThread = new Thread(RunNetworking);
-			connectionThread.Start();
+			rxPayloadReader = new BinaryReader(rxPayloadStream);
+			networkTask = Task.Run(RunNetworking);
 		}
 
 		public virtual void Dispose() {
 			GC.SuppressFinalize(this);
 			// Make sure the connection is closed before disposing
-			if (IsAlive) {
-				Close(NetCloseCause.Disconnect);
-				while (IsAlive) Thread.Sleep(10);
+			if (IsAlive) Close(NetCloseCause.Disconnect);
+			// Wait for networking to finish tearing down the connection, unless disposed by its own close events
+			if (Environment.CurrentManagedThreadId != teardownThread) {
+				try {
+					networkTask.Wait();
+				} catch (AggregateException) { }
 			}
 			// Dispose of the network socket
 			socket.Dispose();
@@ -92,6 +108,10 @@ namespace Tesseract.Core.Net {
 		private static readonly TimeSpan NetworkInterval = TimeSpan.FromMilliseconds(10);
 		// A "keep-alive" packet should be sent every 100 milliseconds
 		private static readonly TimeSpan KeepaliveInterval = TimeSpan.FromMilliseconds(100);
+		// The initial size of the receive buffer
+		private const int ReceiveBufferSize = 4096;
+		// The maximum payload length of a packet, larger packets are treated as a network error
+		private const uint MaxPacketLength = 16 * 1024 * 1024;
 
 		/// <summary>
 		/// Enumeration of results of trying to perform a completion.
@@ -116,45 +136,58 @@ namespace Tesseract.Core.Net {
 		/// </summary>
 		protected class CompletionState {
 
-			// The completion source for the completion packet
-			private readonly TaskCompletionSource<Packet> taskCompletion = new();
+			// The completion source for the completion packet, continuations are run asynchronously
+			// because completions are performed while the network state is locked
+			private readonly TaskCompletionSource<Packet> taskCompletion = new(TaskCreationOptions.RunContinuationsAsynchronously);
+
+			// Registration of the cancellation callback
+			private readonly CancellationTokenRegistration cancelRegistration;
 
 			/// <summary>
 			/// The task that will complete when the correct completion packet is received.
 			/// </summary>
-			public Task<Packet> CompletionTask { get; }
+			public Task<Packet> CompletionTask => taskCompletion.Task;
 
 			/// <summary>
 			/// The expected completion ID.
 			/// </summary>
 			public uint CompletionID { get; }
 
-			public CompletionState(uint completionID, CancellationToken ct) {
-				CompletionTask = AwaitPacket(ct);
+			public CompletionState(uint completionID, NetState state, CancellationToken ct) {
 				CompletionID = completionID;
+				// When cancelled remove the completion from the state so it does not linger until the connection closes
+				if (ct.CanBeCanceled) {
+					cancelRegistration = ct.Register(() => {
+						if (taskCompletion.TrySetCanceled(ct)) {
+							lock (state) {
+								state.Completions.Remove(completionID);
+							}
+						}
+					});
+				}
 			}
 
 			/// <summary>
 			/// Attempts to perform the completion with the given packet.
 			/// </summary>
 			/// <param name="completion">Packet to try as a completion</param>
-			/// <returns>If the completion state is finished</returns>
+			/// <returns>The result of the completion</returns>
 			public CompletionResult TryComplete(Packet completion) {
 				// If the IDs match, set the result to perform the completion
-				if (completion.CompletionNumber == CompletionID) {
-					taskCompletion.SetResult(completion);
+				if (completion.CompletionNumber == CompletionID && taskCompletion.TrySetResult(completion)) {
+					cancelRegistration.Dispose();
 					return CompletionResult.Completed;
 				}
-				// If the completion is already done (ie. cancelled), don't do it and discard the state
-				if (CompletionTask.IsCompleted) return CompletionResult.Discarded;
-				// Else not complete
-				return CompletionResult.Await;
+				// Else the completion is already done (ie. cancelled) and should be discarded
+				return CompletionResult.Discarded;
 			}
 
-			// Method to generate the actual packet task with cancellation
-			private async Task<Packet> AwaitPacket(CancellationToken ct) {
-				Task<Packet> packetTask = taskCompletion.Task;
-				return await packetTask.WaitAsync(ct);
+			/// <summary>
+			/// Fails the completion because the connection was closed.
+			/// </summary>
+			public void Abort() {
+				cancelRegistration.Dispose();
+				taskCompletion.TrySetException(new IOException("The connection was closed"));
 			}
 
 		}
@@ -180,16 +213,35 @@ namespace Tesseract.Core.Net {
 			public IList<Packet> TxBuffer { get; } = new List<Packet>();
 
 			/// <summary>
-			/// The list of scheduled completions.
+			/// The scheduled completions, keyed by the sequence number of the packet they complete.
 			/// </summary>
-			public IList<CompletionState> Completions { get; } = new List<CompletionState>();
+			public IDictionary<uint, CompletionState> Completions { get; } = new Dictionary<uint, CompletionState>();
 
 			/// <summary>
-			/// Writes all of the packets in the transmit buffer to a binary writer, then clears the buffer.
+			/// Writes all of the packets in the transmit buffer, with their headers, to a binary writer
+			/// then clears the buffer. The writer's stream must be seekable.
 			/// </summary>
-			/// <param name="bw"></param>
+			/// <param name="bw">Writer to write packets to</param>
 			public void WritePackets(BinaryWriter bw) {
-				foreach (Packet packet in TxBuffer) packet.Write(bw);
+				Span<byte> header = stackalloc byte[PacketHeader.SizeOf];
+				Stream stream = bw.BaseStream;
+				foreach (Packet packet in TxBuffer) {
+					// Reserve space for the header, which is filled in once the payload length is known
+					long start = stream.Position;
+					stream.Write(header);
+					packet.Write(bw);
+					bw.Flush();
+					long end = stream.Position;
+					new PacketHeader() {
+						ID = packet.ID,
+						SequenceNumber = packet.SequenceNumber,
+						CompletionNumber = packet.CompletionNumber,
+						Length = (uint)(end - start - PacketHeader.SizeOf)
+					}.Write(header);
+					stream.Position = start;
+					stream.Write(header);
+					stream.Position = end;
+				}
 				TxBuffer.Clear();
 			}
 
@@ -217,12 +269,12 @@ namespace Tesseract.Core.Net {
 		/// </summary>
 		/// <param name="header">The bad packet's header</param>
 		/// <param name="payload">The bad packet's payload</param>
-		protected void HandleBadPacket(PacketHeader header, byte[] payload) {
+		protected void HandleBadPacket(PacketHeader header, in ReadOnlySequence<byte> payload) {
 			Interface.OnBadPacket(new PacketData() {
 				ID = header.ID,
 				SequenceNumber = header.SequenceNumber,
 				CompletionNumber = header.CompletionNumber,
-				Data = payload
+				Data = payload.ToArray()
 			}, this);
 		}
 
@@ -234,15 +286,16 @@ namespace Tesseract.Core.Net {
 		/// <para>
 		/// This method performs the task of validating the packet at the network layer, and
 		/// constructing and reading an instance of a <see cref="Packet"/> object from the packet
-		/// data. If there is an error decoding the packet, <see cref="HandleBadPacket(PacketHeader, byte[])"/>
-		/// is invoked and null is returned.
+		/// data. If there is an error decoding the packet, <see cref="HandleBadPacket(PacketHeader, in ReadOnlySequence{byte})"/>
+		/// is invoked and null is returned. The payload refers directly to the receive buffer and
+		/// is only valid for the duration of the call.
 		/// </para>
 		/// </summary>
 		/// <param name="ns">The current network state</param>
 		/// <param name="header">The packet's header</param>
 		/// <param name="payload">The packet's payload</param>
 		/// <returns>The decoded packet, or null</returns>
-		protected virtual Packet? ReceivePacket(NetState ns, PacketHeader header, byte[] payload) {
+		protected virtual Packet? ReceivePacket(NetState ns, PacketHeader header, in ReadOnlySequence<byte> payload) {
 			// Copy and increment sequence number
 			uint expectedID = ns.RxSequence++;
 			// Find packet constructor
@@ -252,19 +305,24 @@ namespace Tesseract.Core.Net {
 				HandleBadPacket(header, payload);
 				return null;
 			}
-			// Build the packet and decode it from the payload
-			Packet pkt = ctor();
-			using MemoryStream ms = new(payload);
-			try {
-				pkt.Read(new BinaryReader(ms));
-			} catch (Exception) {
+			// Check that sequence numbers match
+			if (header.SequenceNumber != expectedID) {
 				HandleBadPacket(header, payload);
 				return null;
 			}
-			// Check that sequence numbers match
-			if (pkt.SequenceNumber != expectedID) {
+			// Build the packet and decode it directly from the payload
+			Packet pkt = ctor();
+			pkt.ID = header.ID;
+			pkt.SequenceNumber = header.SequenceNumber;
+			pkt.CompletionNumber = header.CompletionNumber;
+			rxPayloadStream.Sequence = payload;
+			try {
+				pkt.Read(rxPayloadReader);
+			} catch (Exception) {
 				HandleBadPacket(header, payload);
 				return null;
+			} finally {
+				rxPayloadStream.Sequence = default;
 			}
 			// Finally, return good packet
 			return pkt;
@@ -285,24 +343,9 @@ namespace Tesseract.Core.Net {
 		protected virtual bool CheckReceivedPacket(NetState state, Packet pkt) {
 			// Check packet against completions
 			if (pkt.CompletionNumber != 0) {
-				var completions = state.Completions;
 				bool completed = false;
-				for (int i = 0; i < completions.Count; i++) {
-					var completion = completions[i];
-					switch (completion.TryComplete(pkt)) {
-						case CompletionResult.Completed:
-							completed = true;
-							completions.RemoveAt(i);
-							i--;
-							break;
-						case CompletionResult.Discarded:
-							completions.RemoveAt(i);
-							i--;
-							break;
-						case CompletionResult.Await:
-							break;
-					}
-				}
+				if (state.Completions.Remove(pkt.CompletionNumber, out CompletionState? completion))
+					completed = completion.TryComplete(pkt) == CompletionResult.Completed;
 				if (!completed) Interface.OnOrphanedCompletion(pkt, this);
 			}
 
@@ -315,74 +358,60 @@ namespace Tesseract.Core.Net {
 			} else return true;
 		}
 
-		private void RunNetworking() {
-			// The receive and transmit FIFOs
-			FIFOStream rxstream = new(), txstream = new();
-			// The receive and transmit buffers
-			byte[] rxbuffer = new byte[4096], txbuffer = new byte[4096];
-			// Transmit buffer state variables
-			int txoffset = 0, txlength = 0;
-			// Binary readers and writers for the receive and transmit FIFOs
-			BinaryReader rxrd = new(rxstream);
-			BinaryWriter txwr = new(txstream);
-
-			// Timestamps for the last received packet and last keepalive send
-			DateTime lastRxPacket = DateTime.Now, lastKeepAlive = lastRxPacket;
-
-			// Packet decoding state
-			PacketHeader header = new();
-			bool hasHeader = false;
+		// Sets the connection as closed due to an error
+		private void SetNetworkError(Exception e) {
+			CloseInfo = new NetCloseInfo() {
+				Cause = NetCloseCause.NetworkError,
+				Message = "Unhandled exception: " + e.Message,
+				Remote = false
+			};
+			IsAlive = false;
+		}
+
+		/*
+		 * Networking is split into two asynchronous loops, so no thread is held by a connection while it
+		 * is idle. The receive loop awaits data from the socket into a pooled buffer and decodes packets
+		 * directly from it. The transmit loop runs once every network interval, encoding all queued
+		 * packets into a pooled buffer and sending them with a single write.
+		 */
+
+		private async Task RunNetworking() {
+			Task<Exception?> receiveTask = ReceiveNetworking(networkCancel.Token);
+			using PeriodicTimer timer = new(NetworkInterval);
+			using PooledMemoryStream txstream = new();
+			using BinaryWriter txwr = new(txstream);
+
+			// Timestamp for the last keepalive send
+			long lastKeepAlive = Environment.TickCount64;
 
 			// Connection close state
-			bool closeFlag = false;
-			NetCloseInfo? closeInfo = null;
+			bool closeFlag;
+			NetCloseInfo? closeInfo;
 			Exception? closeException = null;
 
 			do {
 				// Entire operation is done in a try-block to catch any exceptions while processing
 				try {
-					// If the socket is not connected it cannot be alive
-					if (!socket.Connected) {
+					// If the socket is not connected or has stopped receiving it cannot be alive
+					if (!socket.Connected || receiveTask.IsCompleted) {
 						IsAlive = false;
 						break;
 					}
 
-					DateTime now = DateTime.Now;
+					long now = Environment.TickCount64;
 
-					// Read bytes from socket and transfer to FIFO
-					int numrx;
-					do {
-						numrx = socket.Receive(rxbuffer);
-						rxstream.Write(rxbuffer, 0, numrx);
-						Interlocked.Add(ref rxBytes, (ulong)numrx);
-					} while (numrx > 0);
+					// Check that we have not timed out
+					if (now - Interlocked.Read(ref lastRxPacket) > (long)Interface.Timeout.TotalMilliseconds) {
+						IsAlive = false;
+						break;
+					}
+					// Enqueue keepalive packet if needed
+					if (now - lastKeepAlive > (long)KeepaliveInterval.TotalMilliseconds) {
+						Send(new InternalPacket00BKeepalive());
+						lastKeepAlive = now;
+					}
 
 					lock (State) {
-						// Decode packets until we run out of data
-						while (true) {
-							// Read header
-							if (!hasHeader) {
-								if (rxstream.Length < PacketHeader.SizeOf) break;
-								header.Read(rxrd);
-								hasHeader = true;
-							}
-							// Wait until we have the complete payload
-							if (header.Length > rxstream.Length) break;
-							// Read payload
-							byte[] payload = new byte[header.Length];
-							rxstream.Read(payload);
-							// Decode packet
-							Packet? pkt = ReceivePacket(State, header, payload);
-							// Fire packet received event
-							if (pkt != null) {
-								if (CheckReceivedPacket(State, pkt))
-									Interface.OnPacketReceived(pkt, this);
-								lastRxPacket = now;
-							}
-							// Reset state
-							hasHeader = false;
-						}
-
 						// Encode packets to transmit
 						State.WritePackets(txwr);
 						// Update close flag and info
@@ -390,75 +419,131 @@ namespace Tesseract.Core.Net {
 						closeInfo = State.ClosingInfo;
 					}
 
-					// Check that we have not timed out
-					if ((now - lastRxPacket) > Interface.Timeout) IsAlive = false;
-					// Enqueue keepalive packet if needed
-					if ((now - lastKeepAlive) > KeepaliveInterval) {
-						Send(new InternalPacket00BKeepalive());
-						lastKeepAlive = now;
+					// Send all encoded packets at once
+					if (txstream.Length > 0) {
+						await socket.SendAsync(txstream.WrittenMemory, networkCancel.Token);
+						Interlocked.Add(ref txBytes, (ulong)txstream.Length);
+						txstream.Reset();
 					}
 
-					// If we are closing, do special synchronous transmit operations (all remaining packets MUST be sent)
+					// If we are closing, all remaining packets have been sent so the socket can be closed
 					if (closeFlag) {
-						void SendSync(byte[] buffer, int offset, int length) {
-							do {
-								int n = socket.Send(buffer.AsSpan().Slice(offset, length));
-								offset += n;
-								length -= n;
-								Interlocked.Add(ref txBytes, (ulong)n);
-							} while (length > 0);
-						}
-						// Write any remaining bytes
-						if (txlength > 0) SendSync(txbuffer, txoffset, txlength);
-						// Write all buffered packets
-						while(txstream.Length > 0) {
-							txlength = txstream.Read(txbuffer);
-							SendSync(txbuffer, 0, txlength);
-						}
 						// Close the socket voluntarily
 						socket.Disconnect();
 						// The connection is no longer alive since we are closing it
 						CloseInfo = closeInfo;
 						IsAlive = false;
-					} else {
-						// Else do normal non-blocking transmit
-						int n;
-						do {
-							// If the buffer is empty, refill it
-							if (txlength <= 0) {
-								txlength = txstream.Read(txbuffer);
-								txoffset = 0;
-							}
-							do {
-								// Attempt to send data
-								n = socket.Send(txbuffer.AsSpan().Slice(txoffset, txlength));
-								txoffset += n;
-								txlength -= n;
-								Interlocked.Add(ref txBytes, (ulong)n);
-								// Repeat while data is actually being sent and we still have data in the buffer
-							} while (n > 0 && txlength > 0);
-							// Keep transmitting until either the socket stops transmitting or we run out of bytes to transmit
-						} while (n > 0 && txstream.Length > 0);
+						break;
 					}
 
-					// Sleep for the networking interval
-					Thread.Sleep(NetworkInterval);
+					// Wait for the networking interval
+					await timer.WaitForNextTickAsync();
 				} catch (Exception e) {
 					// If an exception occurs, forcibly disconnect us since we are in an unknown state
 					closeException = e;
-					CloseInfo = new NetCloseInfo() {
-						Cause = NetCloseCause.NetworkError,
-						Message = "Unhandled exception: " + e.Message,
-						Remote = false
-					};
-					IsAlive = false;
+					SetNetworkError(e);
 				}
 			} while (IsAlive);
+
+			// Stop receiving and wait for the receive loop to finish
+			networkCancel.Cancel();
+			closeException ??= await receiveTask;
+			networkCancel.Dispose();
 			// Really make sure the socket is disconnected
-			if (socket.Connected) socket.Disconnect();
-			// Fire events
-			Interface.OnDisconnect(this, closeException);
-			OnClosed();
+			try {
+				if (socket.Connected) socket.Disconnect();
+			} catch (Exception e) {
+				closeException ??= e;
+			}
+			// Fail any completions still waiting for a packet
+			lock (State) {
+				State.ShouldClose = true;
+				foreach (CompletionState completion in State.Completions.Values) completion.Abort();
+				State.Completions.Clear();
+			}
+			// Fire events, remembering the thread so they may dispose the connection
+			teardownThread = Environment.CurrentManagedThreadId;
+			try {
+				Interface.OnDisconnect(this, closeException);
+				OnClosed();
+			} finally {
+				teardownThread = -1;
+			}
+		}
+
+		// Receives and decodes packets until cancelled or the connection closes, returning any exception that stopped it
+		private async Task<Exception?> ReceiveNetworking(CancellationToken ct) {
+			byte[] rxbuffer = ArrayPool<byte>.Shared.Rent(ReceiveBufferSize);
+			// The range of received bytes that have not been decoded yet
+			int rxstart = 0, rxend = 0;
+			try {
+				while (!ct.IsCancellationRequested) {
+					// If the buffer is full, move the undecoded bytes to the start or grow the buffer if they fill it
+					if (rxend == rxbuffer.Length) {
+						int pending = rxend - rxstart;
+						if (rxstart > 0) {
+							Buffer.BlockCopy(rxbuffer, rxstart, rxbuffer, 0, pending);
+						} else {
+							byte[] newbuffer = ArrayPool<byte>.Shared.Rent(rxbuffer.Length * 2);
+							Buffer.BlockCopy(rxbuffer, 0, newbuffer, 0, pending);
+							ArrayPool<byte>.Shared.Return(rxbuffer);
+							rxbuffer = newbuffer;
+						}
+						rxstart = 0;
+						rxend = pending;
+					}
+
+					// Receive bytes from the socket, zero bytes means the connection was closed
+					int numrx = await socket.ReceiveAsync(rxbuffer.AsMemory(rxend), ct);
+					if (numrx <= 0) {
+						IsAlive = false;
+						return null;
+					}
+					rxend += numrx;
+					Interlocked.Add(ref rxBytes, (ulong)numrx);
+
+					// Decode packets until we run out of data
+					lock (State) {
+						rxstart += DecodePackets(new ReadOnlySequence<byte>(rxbuffer, rxstart, rxend - rxstart));
+					}
+					if (rxstart == rxend) rxstart = rxend = 0;
+				}
+				return null;
+			} catch (OperationCanceledException) when (ct.IsCancellationRequested) {
+				return null;
+			} catch (Exception e) {
+				SetNetworkError(e);
+				return e;
+			} finally {
+				ArrayPool<byte>.Shared.Return(rxbuffer);
+			}
+		}
+
+		// Decodes all complete packets in the received data, returning the number of bytes consumed
+		private int DecodePackets(ReadOnlySequence<byte> data) {
+			Span<byte> headerBytes = stackalloc byte[PacketHeader.SizeOf];
+			PacketHeader header = new();
+			int consumed = 0;
+			while (data.Length >= PacketHeader.SizeOf) {
+				// Read header
+				data.Slice(0, PacketHeader.SizeOf).CopyTo(headerBytes);
+				header.Read(headerBytes);
+				if (header.Length > MaxPacketLength) throw new InvalidDataException($"Packet length {header.Length} exceeds maximum length");
+				// Wait until we have the complete payload
+				long length = PacketHeader.SizeOf + (long)header.Length;
+				if (data.Length < length) break;
+				// Decode packet
+				Packet? pkt = ReceivePacket(State, header, data.Slice(PacketHeader.SizeOf, header.Length));
+				// Fire packet received event
+				if (pkt != null) {
+					if (CheckReceivedPacket(State, pkt))
+						Interface.OnPacketReceived(pkt, this);
+					Interlocked.Exchange(ref lastRxPacket, Environment.TickCount64);
+				}
+				data = data.Slice(length);
+				consumed += (int)length;
+			}
+			return consumed;
 		}
 
 		/// <summary>
@@ -482,6 +567,15 @@ namespace Tesseract.Core.Net {
 			if (pkConfirm is not InternalPacket02SConfirmInfo) throw new InvalidDataException("Received response packet is not confirmation");
 		}
 
+		// Assigns a packet its ID and sequence number and enqueues it for transmission, the state must be locked
+		private void Enqueue(Packet packet) {
+			PacketID? id = Interface.PacketManager.FindID(packet.GetType());
+			if (id == null) throw new ArgumentException($"Packet type {packet.GetType()} is not registered", nameof(packet));
+			packet.ID = id.Value;
+			packet.SequenceNumber = State.TxSequence++;
+			State.TxBuffer.Add(packet);
+		}
+
 		public void Send(Packet packet, Packet? responseTo = null) {
 			// If responding to a packet, 
 			if (responseTo != null) packet.CompletionNumber = responseTo.SequenceNumber;
@@ -489,22 +583,24 @@ namespace Tesseract.Core.Net {
 				// Make sure we're not closing
 				if (State.ShouldClose) return;
 				// Assign the packet a sequence number and enqueue it
-				packet.SequenceNumber = State.TxSequence++;
-				State.TxBuffer.Add(packet);
+				Enqueue(packet);
 			}
 		}
 
 		public Task<Packet> SendAndAwait(Packet packet, CancellationToken ct, Packet? responseTo = null) {
 			if (responseTo != null) packet.CompletionNumber = responseTo.SequenceNumber;
+			// Don't send anything if the caller has already given up on the response
+			if (ct.IsCancellationRequested) return Task.FromCanceled<Packet>(ct);
 			lock(State) {
 				// Make sure we're not closing
 				if (State.ShouldClose) return Task.FromException<Packet>(new IOException("The connection is closing"));
 				// Assign the packet a sequence number and enqueue it
-				packet.SequenceNumber = State.TxSequence++;
-				State.TxBuffer.Add(packet);
+				Enqueue(packet);
 				// Add a new completion for the packet's sequence number and return the completion task
-				CompletionState cs = new(packet.SequenceNumber, ct);
-				State.Completions.Add(cs);
+				CompletionState cs = new(packet.SequenceNumber, State, ct);
+				// If the token was cancelled since the check above its callback already ran in the constructor, before there was
+				// an entry to remove, so the completion must not be added
+				if (!cs.CompletionTask.IsCompleted) State.Completions.Add(packet.SequenceNumber, cs);
 				return cs.CompletionTask;
 			}
 		}
@@ -517,8 +613,7 @@ namespace Tesseract.Core.Net {
 					Cause = cause,
 					Message = message
 				};
-				pkt.SequenceNumber = State.TxSequence++;
-				State.TxBuffer.Add(pkt);
+				Enqueue(pkt);
 				// Set state close information
 				NetCloseInfo info = new() { Cause = cause, Message = message, Remote = false };
 				State.ClosingInfo = info;
@@ -47,6 +47,40 @@ namespace Tesseract.Core.Net {
 		/// <returns>The number of bytes actually received</returns>
 		public int Receive(Span<byte> data);
 
+		/// <summary>
+		/// Asynchronously sends all of the given bytes to the remote end of the connection. The default
+		/// implementation repeatedly calls <see cref="Send(in ReadOnlySpan{byte})"/>, waiting briefly if
+		/// no progress is made.
+		/// </summary>
+		/// <param name="data">Buffer containing the data to send</param>
+		/// <param name="ct">Cancellation token for the operation</param>
+		/// <returns>Task completed when all data has been sent</returns>
+		public async ValueTask SendAsync(ReadOnlyMemory<byte> data, CancellationToken ct) {
+			while (data.Length > 0) {
+				ct.ThrowIfCancellationRequested();
+				int n = Send(data.Span);
+				if (n > 0) data = data[n..];
+				else await Task.Delay(1, ct);
+			}
+		}
+
+		/// <summary>
+		/// Asynchronously receives bytes from the remote end of the connection, completing once at least
+		/// one byte is available or the connection is closed. The default implementation polls
+		/// <see cref="Receive(Span{byte})"/>.
+		/// </summary>
+		/// <param name="data">Buffer to store received data into</param>
+		/// <param name="ct">Cancellation token for the operation</param>
+		/// <returns>The number of bytes actually received, or 0 if the connection was closed</returns>
+		public async ValueTask<int> ReceiveAsync(Memory<byte> data, CancellationToken ct) {
+			while (true) {
+				ct.ThrowIfCancellationRequested();
+				int n = Receive(data.Span);
+				if (n > 0 || !Connected) return n;
+				await Task.Delay(1, ct);
+			}
+		}
+
 	}
 
 	/// <summary>
@@ -89,6 +123,15 @@ namespace Tesseract.Core.Net {
 
 		public int Send(in ReadOnlySpan<byte> data) => socket.Send(data);
 
+		public async ValueTask SendAsync(ReadOnlyMemory<byte> data, CancellationToken ct) {
+			while (data.Length > 0) {
+				int n = await socket.SendAsync(data, SocketFlags.None, ct);
+				data = data[n..];
+			}
+		}
+
+		public ValueTask<int> ReceiveAsync(Memory<byte> data, CancellationToken ct) => socket.ReceiveAsync(data, SocketFlags.None, ct);
+
 	}
 
 	/// <summary>
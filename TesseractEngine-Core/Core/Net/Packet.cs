@@ -1,4 +1,5 @@
 ﻿using System;
+using System.Buffers.Binary;
 using System.Collections.Generic;
 using System.IO;
 using System.Linq;
@@ -102,6 +103,34 @@ namespace Tesseract.Core.Net {
 			bw.Write(CompletionNumber);
 			bw.Write(Length);
 		}
+
+		/// <summary>
+		/// Reads the header from a span of at least <see cref="SizeOf"/> bytes, in the same
+		/// format as <see cref="Read(BinaryReader)"/>.
+		/// </summary>
+		/// <param name="data">The header bytes</param>
+		public void Read(ReadOnlySpan<byte> data) {
+			ID = new PacketID(
+				BinaryPrimitives.ReadUInt16LittleEndian(data),
+				BinaryPrimitives.ReadUInt16LittleEndian(data[2..])
+			);
+			SequenceNumber = BinaryPrimitives.ReadUInt32LittleEndian(data[4..]);
+			CompletionNumber = BinaryPrimitives.ReadUInt32LittleEndian(data[8..]);
+			Length = BinaryPrimitives.ReadUInt32LittleEndian(data[12..]);
+		}
+
+		/// <summary>
+		/// Writes the header to a span of at least <see cref="SizeOf"/> bytes, in the same
+		/// format as <see cref="Write(BinaryWriter)"/>.
+		/// </summary>
+		/// <param name="data">The span to write the header to</param>
+		public void Write(Span<byte> data) {
+			BinaryPrimitives.WriteUInt16LittleEndian(data, ID.ModuleID);
+			BinaryPrimitives.WriteUInt16LittleEndian(data[2..], ID.SubID);
+			BinaryPrimitives.WriteUInt32LittleEndian(data[4..], SequenceNumber);
+			BinaryPrimitives.WriteUInt32LittleEndian(data[8..], CompletionNumber);
+			BinaryPrimitives.WriteUInt32LittleEndian(data[12..], Length);
+		}
 	}
 
 	/// <summary>
@@ -178,13 +207,17 @@ namespace Tesseract.Core.Net {
 	public abstract class PacketManager {
 
 		private readonly Dictionary<PacketID, Func<Packet>> ctors = new();
+		private readonly Dictionary<Type, PacketID> ids = new();
 
 		/// <summary>
 		/// Registers a new packet with the packet manager.
 		/// </summary>
 		/// <typeparam name="T">The type of the packet</typeparam>
 		/// <param name="id">The ID to map the packet to</param>
-		protected void RegisterPacket<T>(PacketID id) where T : Packet, new() => ctors[id] = () => new T();
+		protected void RegisterPacket<T>(PacketID id) where T : Packet, new() {
+			ctors[id] = () => new T() { ID = id };
+			ids[typeof(T)] = id;
+		}
 
 		protected PacketManager() {
 			// All packet managers must register the basic internal packets
@@ -207,6 +240,16 @@ namespace Tesseract.Core.Net {
 			return null;
 		}
 
+		/// <summary>
+		/// Attempts to find the ID a packet type is registered with.
+		/// </summary>
+		/// <param name="type">Packet type</param>
+		/// <returns>The ID of the packet type, or null if it is not registered</returns>
+		public virtual PacketID? FindID(Type type) {
+			if (ids.TryGetValue(type, out PacketID id)) return id;
+			return null;
+		}
+
 		/// <summary>
 		/// Constructs a packet of the type corresponding to the given ID.
 		/// </summary>
@@ -93,7 +93,13 @@ namespace Tesseract.Core.Net {
 		private async void Listen(CancellationToken ct) {
 			uint connection = 0;
 			while(!ct.IsCancellationRequested) {
-				INetSocket remote = await serverSocket.Listen(ct);
+				INetSocket remote;
+				try {
+					remote = await serverSocket.Listen(ct);
+				} catch (OperationCanceledException) when (ct.IsCancellationRequested) {
+					// Shutting down
+					return;
+				}
 				if (ct.IsCancellationRequested) return;
 				Accept(remote, connection++);
 			}
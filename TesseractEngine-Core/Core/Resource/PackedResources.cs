@@ -0,0 +1,575 @@
+﻿using System;
+using System.Buffers;
+using System.Collections.Generic;
+using System.IO;
+using System.IO.Compression;
+using System.IO.MemoryMappedFiles;
+using System.Linq;
+using System.Runtime.InteropServices;
+using System.Text;
+using Tesseract.Core.Utilities;
+
+namespace Tesseract.Core.Resource {
+
+	/// <summary>
+	/// Enumeration of compression methods which may be applied to entries in a packed archive.
+	/// </summary>
+	public enum PackedCompression : uint {
+		/// <summary>
+		/// The entry is stored uncompressed and can be accessed without copying.
+		/// </summary>
+		None = 0,
+		/// <summary>
+		/// The entry is compressed with Deflate.
+		/// </summary>
+		Deflate = 1,
+		/// <summary>
+		/// The entry is compressed with Brotli.
+		/// </summary>
+		Brotli = 2
+	}
+
+	/// <summary>
+	/// <para>
+	/// Definitions for the packed archive format. A packed archive stores a set of files in a single file
+	/// which is designed to be memory mapped, such that opening the archive is a single file open and
+	/// resources can be looked up and accessed without any further filesystem access.
+	/// </para>
+	/// <para>
+	/// The archive starts with a fixed header followed by the index, which is a table of entries sorted by
+	/// the 64-bit XXHash of their UTF-8 path (and by path for equal hashes), then the UTF-8 path strings.
+	/// Entry data follows, with each entry starting on an aligned boundary (by default the page size). All
+	/// values are stored little-endian.
+	/// </para>
+	/// </summary>
+	public static class PackedArchive {
+
+		/// <summary>
+		/// The magic value at the start of a packed archive ("TPAK").
+		/// </summary>
+		public const uint Magic = 0x4B415054;
+
+		/// <summary>
+		/// The current version of the packed archive format.
+		/// </summary>
+		public const ushort Version = 1;
+
+		/// <summary>
+		/// The default alignment of entry data.
+		/// </summary>
+		public const int DefaultAlignment = 4096;
+
+		/// <summary>
+		/// The header of a packed archive.
+		/// </summary>
+		[StructLayout(LayoutKind.Sequential)]
+		public struct Header {
+
+			/// <summary>
+			/// The magic value, equal to <see cref="PackedArchive.Magic"/>.
+			/// </summary>
+			public uint Magic;
+
+			/// <summary>
+			/// The format version.
+			/// </summary>
+			public ushort Version;
+
+			private readonly ushort reserved0;
+
+			/// <summary>
+			/// The number of entries in the index.
+			/// </summary>
+			public uint EntryCount;
+
+			/// <summary>
+			/// The alignment of entry data.
+			/// </summary>
+			public uint Alignment;
+
+			/// <summary>
+			/// The offset of the index in the file.
+			/// </summary>
+			public ulong IndexOffset;
+
+			/// <summary>
+			/// The offset of the path strings in the file.
+			/// </summary>
+			public ulong StringsOffset;
+
+			/// <summary>
+			/// The total size of the path strings.
+			/// </summary>
+			public ulong StringsSize;
+
+			/// <summary>
+			/// The offset of the first entry's data in the file.
+			/// </summary>
+			public ulong DataOffset;
+
+			/// <summary>
+			/// The total size of the archive file.
+			/// </summary>
+			public ulong FileSize;
+
+			private readonly ulong reserved1;
+
+		}
+
+		/// <summary>
+		/// An entry in the index of a packed archive.
+		/// </summary>
+		[StructLayout(LayoutKind.Sequential)]
+		public struct Entry {
+
+			/// <summary>
+			/// The XXHash64 of the entry's UTF-8 path.
+			/// </summary>
+			public ulong PathHash;
+
+			/// <summary>
+			/// The offset of the entry's path relative to the start of the path strings.
+			/// </summary>
+			public uint PathOffset;
+
+			/// <summary>
+			/// The length of the entry's path in bytes.
+			/// </summary>
+			public uint PathLength;
+
+			/// <summary>
+			/// The offset of the entry's data in the file.
+			/// </summary>
+			public ulong Offset;
+
+			/// <summary>
+			/// The size of the entry's data as stored in the file.
+			/// </summary>
+			public ulong StoredSize;
+
+			/// <summary>
+			/// The uncompressed size of the entry.
+			/// </summary>
+			public ulong Size;
+
+			/// <summary>
+			/// The compression applied to the entry's data.
+			/// </summary>
+			public PackedCompression Compression;
+
+			private readonly uint reserved;
+
+		}
+
+		/// <summary>
+		/// Computes the hash of an entry path as stored in the index.
+		/// </summary>
+		/// <param name="path">UTF-8 path of the entry</param>
+		/// <returns>Path hash</returns>
+		public static ulong HashPath(ReadOnlySpan<byte> path) => XXHash64.Compute(path);
+
+	}
+
+	/// <summary>
+	/// Options for building a packed archive with <see cref="PackedArchiveBuilder"/>.
+	/// </summary>
+	public record class PackedArchiveOptions {
+
+		/// <summary>
+		/// The alignment of entry data, which must be a power of two. Page alignment allows mapped
+		/// entries to be accessed with the minimum number of page faults but wastes space for small
+		/// files, which can be reduced by lowering this value.
+		/// </summary>
+		public int Alignment { get; init; } = PackedArchive.DefaultAlignment;
+
+		/// <summary>
+		/// The default compression to apply to entries.
+		/// </summary>
+		public PackedCompression Compression { get; init; } = PackedCompression.None;
+
+		/// <summary>
+		/// Function which selects the compression to apply to an entry given its path, overriding
+		/// <see cref="Compression"/> if not null. This can be used to skip compressing formats which
+		/// are already compressed.
+		/// </summary>
+		public Func<string, PackedCompression>? CompressionSelector { get; init; }
+
+		/// <summary>
+		/// The compression level to use for compressed entries.
+		/// </summary>
+		public CompressionLevel CompressionLevel { get; init; } = CompressionLevel.Optimal;
+
+		/// <summary>
+		/// The maximum ratio of compressed to uncompressed size for which an entry will be stored
+		/// compressed. Entries which do not compress below this ratio are stored uncompressed.
+		/// </summary>
+		public double MaxCompressionRatio { get; init; } = 0.9;
+
+	}
+
+	/// <summary>
+	/// Builds packed archives which can be accessed with a <see cref="PackedResourceDomain"/>.
+	/// </summary>
+	public static class PackedArchiveBuilder {
+
+		// A file to be written to the archive
+		private class PendingEntry {
+
+			public required string Path;
+
+			public required byte[] PathUTF8;
+
+			public required string Source;
+
+			public PackedArchive.Entry Entry;
+
+		}
+
+		private static long Align(long value, int alignment) => (value + alignment - 1) & ~(long)(alignment - 1);
+
+		/// <summary>
+		/// Builds a packed archive from all the files within a directory, recursively. Entry paths are
+		/// relative to the directory and use '/' as the directory separator.
+		/// </summary>
+		/// <param name="directory">The directory to pack</param>
+		/// <param name="outputPath">The path of the archive file to create</param>
+		/// <param name="options">The options to build the archive with</param>
+		public static void Build(string directory, string outputPath, PackedArchiveOptions? options = null) {
+			directory = Path.GetFullPath(directory);
+			string fullOutput = Path.GetFullPath(outputPath);
+			var files = Directory.EnumerateFiles(directory, "*", SearchOption.AllDirectories)
+				.Where(file => file != fullOutput)
+				.Select(file => (Path.GetRelativePath(directory, file).Replace(Path.DirectorySeparatorChar, '/'), file));
+			using FileStream output = new(outputPath, FileMode.Create, FileAccess.ReadWrite);
+			Build(files, output, options);
+		}
+
+		/// <summary>
+		/// Builds a packed archive from a collection of files.
+		/// </summary>
+		/// <param name="files">The files to pack as pairs of entry path and the path of the source file</param>
+		/// <param name="output">The seekable stream to write the archive to</param>
+		/// <param name="options">The options to build the archive with</param>
+		/// <exception cref="ArgumentException">If the options are invalid or an entry path is duplicated</exception>
+		public static void Build(IEnumerable<(string Path, string Source)> files, Stream output, PackedArchiveOptions? options = null) {
+			options ??= new PackedArchiveOptions();
+			int alignment = options.Alignment;
+			if (alignment <= 0 || (alignment & (alignment - 1)) != 0) throw new ArgumentException("Alignment must be a power of two", nameof(options));
+			if (!output.CanSeek) throw new ArgumentException("Output stream must be seekable", nameof(output));
+
+			// Data is written in path order so related files are adjacent
+			List<PendingEntry> entries = files.Select(file => new PendingEntry() {
+				Path = file.Path,
+				PathUTF8 = Encoding.UTF8.GetBytes(file.Path),
+				Source = file.Source
+			}).OrderBy(entry => entry.Path, StringComparer.Ordinal).ToList();
+			for (int i = 1; i < entries.Count; i++)
+				if (entries[i].Path == entries[i - 1].Path) throw new ArgumentException($"Duplicate entry path \"{entries[i].Path}\"", nameof(files));
+
+			// Compute the layout of the index and strings
+			int headerSize = Marshal.SizeOf<PackedArchive.Header>(), entrySize = Marshal.SizeOf<PackedArchive.Entry>();
+			long indexOffset = headerSize;
+			long stringsOffset = indexOffset + (long)entries.Count * entrySize;
+			long stringsSize = 0;
+			foreach (PendingEntry entry in entries) {
+				entry.Entry.PathHash = PackedArchive.HashPath(entry.PathUTF8);
+				entry.Entry.PathOffset = checked((uint)stringsSize);
+				entry.Entry.PathLength = (uint)entry.PathUTF8.Length;
+				stringsSize += entry.PathUTF8.Length;
+			}
+			long dataOffset = Align(stringsOffset + stringsSize, alignment);
+
+			// Write the path strings
+			output.Position = stringsOffset;
+			foreach (PendingEntry entry in entries) output.Write(entry.PathUTF8);
+
+			// Write the data for each entry
+			long offset = dataOffset;
+			using MemoryStream compressed = new();
+			foreach (PendingEntry entry in entries) {
+				byte[] data = File.ReadAllBytes(entry.Source);
+				ReadOnlySpan<byte> stored = data;
+				PackedCompression compression = options.CompressionSelector?.Invoke(entry.Path) ?? options.Compression;
+				if (compression != PackedCompression.None && data.Length > 0) {
+					compressed.SetLength(0);
+					using (Stream compressor = compression switch {
+						PackedCompression.Deflate => new DeflateStream(compressed, options.CompressionLevel, true),
+						PackedCompression.Brotli => new BrotliStream(compressed, options.CompressionLevel, true),
+						_ => throw new ArgumentException($"Unknown compression method {compression}", nameof(options))
+					}) compressor.Write(data);
+					if (compressed.Length <= data.Length * options.MaxCompressionRatio) stored = compressed.GetBuffer().AsSpan(0, (int)compressed.Length);
+					else compression = PackedCompression.None;
+				} else compression = PackedCompression.None;
+
+				output.Position = offset;
+				output.Write(stored);
+				entry.Entry.Offset = (ulong)offset;
+				entry.Entry.StoredSize = (ulong)stored.Length;
+				entry.Entry.Size = (ulong)data.Length;
+				entry.Entry.Compression = compression;
+				offset = Align(offset + stored.Length, alignment);
+			}
+			// Pad the file so the last entry ends on an aligned boundary
+			output.SetLength(Math.Max(offset, dataOffset));
+
+			// Write the index sorted by hash, then by path
+			PackedArchive.Entry[] index = entries
+				.OrderBy(entry => entry.Entry.PathHash)
+				.ThenBy(entry => entry.Path, StringComparer.Ordinal)
+				.Select(entry => entry.Entry).ToArray();
+			output.Position = indexOffset;
+			output.Write(MemoryMarshal.AsBytes(index.AsSpan()));
+
+			PackedArchive.Header header = new() {
+				Magic = PackedArchive.Magic,
+				Version = PackedArchive.Version,
+				EntryCount = (uint)entries.Count,
+				Alignment = (uint)alignment,
+				IndexOffset = (ulong)indexOffset,
+				StringsOffset = (ulong)stringsOffset,
+				StringsSize = (ulong)stringsSize,
+				DataOffset = (ulong)dataOffset,
+				FileSize = (ulong)output.Length
+			};
+			output.Position = 0;
+			output.Write(MemoryMarshal.AsBytes(MemoryMarshal.CreateReadOnlySpan(ref header, 1)));
+			output.Flush();
+		}
+
+	}
+
+	/// <summary>
+	/// <para>
+	/// A packed resource domain provides resources stored in a packed archive built with <see cref="PackedArchiveBuilder"/>.
+	/// The archive is memory mapped when the domain is created, and all lookups are performed using the prebuilt index
+	/// so no filesystem access is needed to test for, get metadata of, or read resources.
+	/// </para>
+	/// <para>
+	/// Uncompressed entries are accessed directly from the mapped file, either as streams or as memory via
+	/// <see cref="GetMemory(ResourceLocation)"/>. Any memory or streams accessing the archive are only valid until the
+	/// domain is disposed.
+	/// </para>
+	/// </summary>
+	public class PackedResourceDomain : ResourceDomain, IDisposable {
+
+		// Memory manager exposing a region of the mapped file
+		private sealed unsafe class MappedMemoryManager : MemoryManager<byte> {
+
+			private readonly byte* pointer;
+			private readonly int length;
+
+			public MappedMemoryManager(byte* pointer, int length) {
+				this.pointer = pointer;
+				this.length = length;
+			}
+
+			public override Span<byte> GetSpan() => new(pointer, length);
+
+			public override MemoryHandle Pin(int elementIndex = 0) => new(pointer + elementIndex);
+
+			public override void Unpin() { }
+
+			protected override void Dispose(bool disposing) { }
+
+		}
+
+		private readonly MemoryMappedFile file;
+		private readonly MemoryMappedViewAccessor view;
+		private readonly unsafe byte* basePointer;
+		private readonly long length;
+		private readonly PackedArchive.Header header;
+		// Directory listings, built on first enumeration
+		private Dictionary<string, List<ResourceLocation>>? directories;
+		private bool pointerAcquired = false;
+		private bool disposed = false;
+
+		/// <summary>
+		/// The number of entries in the archive.
+		/// </summary>
+		public int Count => (int)header.EntryCount;
+
+		// The index of the archive, within the mapped file
+		private unsafe ReadOnlySpan<PackedArchive.Entry> Index => new(basePointer + header.IndexOffset, (int)header.EntryCount);
+
+		// The path strings of the archive, within the mapped file
+		private unsafe ReadOnlySpan<byte> Strings => new(basePointer + header.StringsOffset, (int)header.StringsSize);
+
+		/// <summary>
+		/// Creates a new packed resource domain, memory mapping the given archive file.
+		/// </summary>
+		/// <param name="name">Name of the resource domain</param>
+		/// <param name="path">Path to the packed archive file</param>
+		/// <exception cref="InvalidDataException">If the file is not a valid packed archive</exception>
+		public unsafe PackedResourceDomain(string name, string path) : base(name) {
+			if (!BitConverter.IsLittleEndian) throw new PlatformNotSupportedException("Packed archives can only be mapped on little-endian platforms");
+			file = MemoryMappedFile.CreateFromFile(path, FileMode.Open, null, 0, MemoryMappedFileAccess.Read);
+			try {
+				view = file.CreateViewAccessor(0, 0, MemoryMappedFileAccess.Read);
+				byte* ptr = null;
+				view.SafeMemoryMappedViewHandle.AcquirePointer(ref ptr);
+				pointerAcquired = true;
+				basePointer = ptr + view.PointerOffset;
+				length = (long)view.SafeMemoryMappedViewHandle.ByteLength - view.PointerOffset;
+
+				if (length < sizeof(PackedArchive.Header)) throw new InvalidDataException("Packed archive is too short");
+				header = *(PackedArchive.Header*)basePointer;
+				if (header.Magic != PackedArchive.Magic) throw new InvalidDataException("Magic value does not match packed archive format");
+				if (header.Version != PackedArchive.Version) throw new InvalidDataException($"Unsupported packed archive version {header.Version}");
+				if (header.FileSize > (ulong)length ||
+					header.IndexOffset + (ulong)header.EntryCount * (ulong)sizeof(PackedArchive.Entry) > header.FileSize ||
+					header.StringsOffset + header.StringsSize > header.FileSize ||
+					header.StringsSize > int.MaxValue)
+					throw new InvalidDataException("Packed archive layout exceeds file size");
+			} catch {
+				Dispose();
+				throw;
+			}
+		}
+
+		// Finds the index of the entry with the given path, or -1 if it does not exist
+		private int FindEntry(string path) {
+			int maxBytes = Encoding.UTF8.GetMaxByteCount(path.Length);
+			byte[]? rented = null;
+			Span<byte> utf8 = maxBytes <= 256 ? stackalloc byte[256] : (rented = ArrayPool<byte>.Shared.Rent(maxBytes));
+			try {
+				utf8 = utf8[..Encoding.UTF8.GetBytes(path, utf8)];
+				ulong hash = PackedArchive.HashPath(utf8);
+
+				// Binary search for the first entry with the hash, then compare paths
+				ReadOnlySpan<PackedArchive.Entry> index = Index;
+				int lo = 0, hi = index.Length;
+				while (lo < hi) {
+					int mid = (lo + hi) >>> 1;
+					if (index[mid].PathHash < hash) lo = mid + 1;
+					else hi = mid;
+				}
+				ReadOnlySpan<byte> strings = Strings;
+				for (int i = lo; i < index.Length && index[i].PathHash == hash; i++) {
+					ref readonly PackedArchive.Entry entry = ref index[i];
+					if (strings.Slice((int)entry.PathOffset, (int)entry.PathLength).SequenceEqual(utf8)) return i;
+				}
+				return -1;
+			} finally {
+				if (rented != null) ArrayPool<byte>.Shared.Return(rented);
+			}
+		}
+
+		// Gets the entry for a resource location, throwing an exception if it does not exist
+		private PackedArchive.Entry GetEntry(ResourceLocation file) {
+			if (file.Domain != this) throw new ArgumentException("Cannot operate on a resource location from a different domain", nameof(file));
+			ObjectDisposedException.ThrowIf(disposed, this);
+			int index = FindEntry(PathPrefix + file.Path);
+			if (index < 0) throw new IOException("Cannot open a resource that does not exist");
+			PackedArchive.Entry entry = Index[index];
+			if (entry.Offset + entry.StoredSize > header.FileSize) throw new InvalidDataException("Packed archive entry exceeds file size");
+			return entry;
+		}
+
+		// Opens a stream over the stored data of an entry
+		private unsafe Stream OpenStoredStream(in PackedArchive.Entry entry) =>
+			new UnmanagedMemoryStream(basePointer + entry.Offset, (long)entry.StoredSize);
+
+		public override bool Exists(ResourceLocation file) => !disposed && FindEntry(PathPrefix + file.Path) >= 0;
+
+		public override Stream OpenStream(ResourceLocation file) {
+			PackedArchive.Entry entry = GetEntry(file);
+			Stream stream = OpenStoredStream(entry);
+			return entry.Compression switch {
+				PackedCompression.None => stream,
+				PackedCompression.Deflate => new DeflateStream(stream, CompressionMode.Decompress),
+				PackedCompression.Brotli => new BrotliStream(stream, CompressionMode.Decompress),
+				_ => throw new InvalidDataException($"Unknown packed archive compression {entry.Compression}")
+			};
+		}
+
+		/// <summary>
+		/// Gets the contents of a resource as memory. Uncompressed resources are returned directly from the
+		/// mapped archive without copying, while compressed resources are decompressed into a new array.
+		/// </summary>
+		/// <param name="file">The resource to access</param>
+		/// <returns>The resource contents</returns>
+		/// <exception cref="ArgumentException">If the resource location is from a different domain</exception>
+		/// <exception cref="IOException">If the resource does not exist</exception>
+		public unsafe ReadOnlyMemory<byte> GetMemory(ResourceLocation file) {
+			PackedArchive.Entry entry = GetEntry(file);
+			if (entry.Size > int.MaxValue) throw new IOException("Resource is too large to access as memory");
+			if (entry.Compression == PackedCompression.None)
+				return new MappedMemoryManager(basePointer + entry.Offset, (int)entry.Size).Memory;
+
+			byte[] data = new byte[entry.Size];
+			using Stream stream = OpenStream(file);
+			stream.ReadFully(data);
+			return data;
+		}
+
+		/// <summary>
+		/// Attempts to get the contents of a resource as memory without copying, which is only possible
+		/// if the resource is stored uncompressed.
+		/// </summary>
+		/// <param name="file">The resource to access</param>
+		/// <param name="memory">The resource contents</param>
+		/// <returns>If the resource exists and is uncompressed</returns>
+		public unsafe bool TryGetMemory(ResourceLocation file, out ReadOnlyMemory<byte> memory) {
+			memory = default;
+			if (file.Domain != this || disposed) return false;
+			int index = FindEntry(PathPrefix + file.Path);
+			if (index < 0) return false;
+			PackedArchive.Entry entry = Index[index];
+			if (entry.Compression != PackedCompression.None || entry.Size > int.MaxValue || entry.Offset + entry.Size > header.FileSize) return false;
+			memory = new MappedMemoryManager(basePointer + entry.Offset, (int)entry.Size).Memory;
+			return true;
+		}
+
+		public override IEnumerable<ResourceLocation> EnumerateDirectory(ResourceLocation dir) {
+			if (dir.Domain != this) throw new ArgumentException("Cannot operate on a resource location from a different domain", nameof(dir));
+			ObjectDisposedException.ThrowIf(disposed, this);
+			lock (this) {
+				directories ??= BuildDirectories();
+				return directories.TryGetValue(dir.Path, out List<ResourceLocation>? entries) ? entries : Enumerable.Empty<ResourceLocation>();
+			}
+		}
+
+		// Builds the directory listings from the paths of all entries
+		private Dictionary<string, List<ResourceLocation>> BuildDirectories() {
+			Dictionary<string, List<ResourceLocation>> dirs = new();
+			ReadOnlySpan<byte> strings = Strings;
+			foreach (PackedArchive.Entry entry in Index) {
+				string path = Encoding.UTF8.GetString(strings.Slice((int)entry.PathOffset, (int)entry.PathLength));
+				if (!path.StartsWith(PathPrefix, StringComparison.Ordinal)) continue;
+				ResourceLocation location = new(this, path[PathPrefix.Length..]);
+				string parent = location.Parent.Path;
+				if (!dirs.TryGetValue(parent, out List<ResourceLocation>? list)) {
+					list = new List<ResourceLocation>();
+					dirs[parent] = list;
+				}
+				list.Add(location);
+			}
+			return dirs;
+		}
+
+		public override ResourceMetadata GetMetadata(ResourceLocation file) {
+			if (file.Domain != this) throw new ArgumentException("Cannot operate on a resource location from a different domain", nameof(file));
+
+			int index = disposed ? -1 : FindEntry(PathPrefix + file.Path);
+			string? mime = null;
+			if (index >= 0 && MIME.TryGuessFromExtension(FileResourceDomain.GetExtensionFromFileName(file.Name), out string? type)) mime = type;
+
+			return new ResourceMetadata() {
+				MIMEType = mime,
+				Size = index >= 0 ? (long)Index[index].Size : -1,
+				Local = true
+			};
+		}
+
+		public void Dispose() {
+			GC.SuppressFinalize(this);
+			if (disposed) return;
+			disposed = true;
+			if (pointerAcquired) view.SafeMemoryMappedViewHandle.ReleasePointer();
+			view?.Dispose();
+			file.Dispose();
+		}
+
+	}
+
+}
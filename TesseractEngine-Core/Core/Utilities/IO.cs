@@ -1,4 +1,5 @@
 ﻿using System;
+using System.Buffers;
 using System.Collections.Generic;
 using System.IO;
 using System.Linq;
@@ -8,126 +9,234 @@ using System.Threading.Tasks;
 namespace Tesseract.Core.Utilities {
 
 	/// <summary>
+	/// <para>
 	/// A "first-in first-out" stream, which will store all written bytes to a buffer
 	/// which can then be read. Note that this stream is not seekable, and its length
 	/// and position have slightly different meaning for <see cref="Length"/> and
 	/// <see cref="Position"/>. The length corresponds to the number of bytes currently
 	/// in the buffer (effectively an "available" value) and the position corresponds
 	/// to the total number of bytes that have been read from the stream.
+	/// </para>
+	/// <para>
+	/// Data is stored in a single growable ring buffer rented from <see cref="ArrayPool{T}.Shared"/>.
+	/// Buffered data can be parsed in place through <see cref="PeekSpan"/> or <see cref="GetReadSequence"/>
+	/// and then consumed with <see cref="Consume(int)"/>, and data can be written in place by using the
+	/// stream as an <see cref="IBufferWriter{T}"/>.
+	/// </para>
 	/// </summary>
-	public class FIFOStream : Stream {
-
-		// The size of each block in the FIFO list
-		private const int BlockSize = 4096;
-
-		/* The FIFO is implemented by lists of blocks containing the actual data, with
-		 * a variable keeping track of the actual number of bytes in the FIFO. Blocks
-		 * are divided between "live" (containing actual data) and "dead" (no longer
-		 * in use). Dead blocks are recycled to reduce GC overhead from constantly
-		 * discarding and createding new blocks.
-		 */
-
-		// The list of "dead" blocks to be reused
-		private readonly LinkedList<byte[]> deadBlocks = new();
-		// The list of "live" blocks in use
-		private readonly LinkedList<byte[]> liveBlocks = new();
-		// The number of actual bytes in the live buffer
-		private long liveLength = 0;
-		// The offset into the firstmost live buffer that data actually starts at
-		private int liveOffset = 0;
+	public class FIFOStream : Stream, IBufferWriter<byte> {
+
+		// The minimum capacity of the ring buffer
+		private const int MinCapacity = 4096;
+
+		// Segment of a sequence over the ring buffer, reused between calls to GetReadSequence
+		private sealed class BufferSegment : ReadOnlySequenceSegment<byte> {
+
+			public void Set(ReadOnlyMemory<byte> memory, BufferSegment? next, long runningIndex) {
+				Memory = memory;
+				Next = next;
+				RunningIndex = runningIndex;
+			}
+
+		}
+
+		// The ring buffer, which holds the live data starting at the head offset and possibly wrapping around its end
+		private byte[] buffer = Array.Empty<byte>();
+		// The offset of the first live byte in the buffer
+		private int head = 0;
+		// The number of live bytes in the buffer
+		private int length = 0;
 		// The total number of bytes that have been extracted from the FIFO
 		private long walkedBytes = 0;
 
+		private BufferSegment? firstSegment, secondSegment;
+
 		public override bool CanRead => true;
 
 		public override bool CanSeek => false;
 
 		public override bool CanWrite => true;
 
-		public override long Length => liveLength;
+		public override long Length => length;
 
 		public override long Position { get => walkedBytes; set => throw new NotSupportedException(); }
 
+		/// <summary>
+		/// The number of bytes the stream can hold before its buffer must grow.
+		/// </summary>
+		public int Capacity => buffer.Length;
+
 		public override void Flush() {
-			// Clear the dead blocks 
-			deadBlocks.Clear();
-		}
-
-		public override int Read(byte[] buffer, int offset, int count) {
-			if (count <= 0) return 0;
-			// Clamp count to available length
-			count = (int)System.Math.Min(count, liveLength);
-			// While there are still bytes to read
-			while(count > 0) {
-				// Get next block
-				byte[] block = liveBlocks.First!.Value;
-				// Compute available bytes in block
-				int avail = block.Length - liveOffset;
-				// Compute number of bytes to read
-				int len = System.Math.Min(avail, count);
-				// Perform array copy
-				Array.Copy(block, liveOffset, buffer, offset, len);
-				// Adjust destination offset
-				offset += len;
-				// Adjust count
-				count -= len;
-				// Adjust read offset
-				liveOffset += len;
-				// If the block is now empty
-				if (liveOffset == block.Length) {
-					// Make the block "dead" and step to the next block
-					liveBlocks.RemoveFirst();
-					deadBlocks.AddLast(block);
-					liveOffset = 0;
-				}
-			}
-			// Increment walked bytes
+			// Release the buffer if it is not holding any data
+			if (length == 0) ReleaseBuffer();
+		}
+
+		private void ReleaseBuffer() {
+			if (buffer.Length > 0) ArrayPool<byte>.Shared.Return(buffer);
+			buffer = Array.Empty<byte>();
+			head = 0;
+		}
+
+		// Grows the buffer to hold at least the given number of bytes, moving the live data to the start of the new buffer
+		private void Grow(int required) {
+			int newCapacity = System.Math.Max(MinCapacity, System.Math.Max(required, buffer.Length * 2));
+			byte[] newBuffer = ArrayPool<byte>.Shared.Rent(newCapacity);
+			Peek(newBuffer);
+			ReleaseBuffer();
+			buffer = newBuffer;
+		}
+
+		// Moves unwrapped live data to the start of the buffer, joining the free space before and after it
+		private void Compact() {
+			buffer.AsSpan(head, length).CopyTo(buffer);
+			head = 0;
+		}
+
+		//=========//
+		// Reading //
+		//=========//
+
+		/// <summary>
+		/// Gets the longest contiguous span of buffered data at the front of the FIFO without consuming it. If the buffered
+		/// data wraps around the end of the ring buffer this will be shorter than <see cref="Length"/>. The span is only valid
+		/// until the stream is next modified.
+		/// </summary>
+		/// <returns>Contiguous span of buffered data</returns>
+		public ReadOnlySpan<byte> PeekSpan() => buffer.AsSpan(head, System.Math.Min(length, buffer.Length - head));
+
+		/// <summary>
+		/// Gets a sequence over all of the buffered data without consuming it. The sequence is only valid until the
+		/// stream is next modified.
+		/// </summary>
+		/// <returns>Sequence of buffered data</returns>
+		public ReadOnlySequence<byte> GetReadSequence() {
+			int firstLength = buffer.Length - head;
+			if (length <= firstLength) return new ReadOnlySequence<byte>(buffer, head, length);
+
+			firstSegment ??= new BufferSegment();
+			secondSegment ??= new BufferSegment();
+			int secondLength = length - firstLength;
+			secondSegment.Set(buffer.AsMemory(0, secondLength), null, firstLength);
+			firstSegment.Set(buffer.AsMemory(head, firstLength), secondSegment, 0);
+			return new ReadOnlySequence<byte>(firstSegment, 0, secondSegment, secondLength);
+		}
+
+		/// <summary>
+		/// Copies buffered data from the front of the FIFO without consuming it.
+		/// </summary>
+		/// <param name="dest">The buffer to copy to</param>
+		/// <returns>The number of bytes copied</returns>
+		public int Peek(Span<byte> dest) {
+			int count = System.Math.Min(dest.Length, length);
+			int firstLength = System.Math.Min(count, buffer.Length - head);
+			buffer.AsSpan(head, firstLength).CopyTo(dest);
+			buffer.AsSpan(0, count - firstLength).CopyTo(dest[firstLength..]);
+			return count;
+		}
+
+		/// <summary>
+		/// Consumes bytes from the front of the FIFO, such as after they have been parsed in place.
+		/// </summary>
+		/// <param name="count">The number of bytes to consume</param>
+		public void Consume(int count) {
+			if (count < 0 || count > length) throw new ArgumentOutOfRangeException(nameof(count), "Cannot consume past the end of the buffered data");
+			length -= count;
 			walkedBytes += count;
-			liveLength -= count;
+			// Restart at the beginning of the buffer once empty, keeping free space contiguous
+			if (length == 0) head = 0;
+			else {
+				head += count;
+				if (head >= buffer.Length) head -= buffer.Length;
+			}
+		}
+
+		public override int Read(byte[] buffer, int offset, int count) => Read(buffer.AsSpan(offset, count));
+
+		public override int Read(Span<byte> buffer) {
+			int count = Peek(buffer);
+			Consume(count);
 			return count;
 		}
 
+		public override int ReadByte() {
+			if (length == 0) return -1;
+			byte value = buffer[head];
+			Consume(1);
+			return value;
+		}
+
 		public override long Seek(long offset, SeekOrigin origin) => throw new NotSupportedException();
 
 		public override void SetLength(long value) => throw new NotSupportedException();
 
-		// Generates a new block, either from the dead list or allocated
-		private byte[] NewBlock() {
-			if (deadBlocks.Count > 0) {
-				byte[] block = deadBlocks.First!.Value;
-				deadBlocks.RemoveFirst();
-				return block;
-			} else return new byte[BlockSize];
-		}
-
-		public override void Write(byte[] buffer, int offset, int count) {
-			if (count <= 0) return;
-			// The live buffer *must* have at least one block in it
-			if (liveBlocks.Count == 0) liveBlocks.AddLast(NewBlock());
-			// Compute the write offset based on the current live offset and live length
-			// The write offset will always be in the lastmost block
-			int writeOffset = (int)((liveOffset + liveLength) % BlockSize);
-			while(count > 0) {
-				// Get last block
-				byte[] block = liveBlocks.Last!.Value;
-				// Compute available bytes
-				int avail = block.Length - writeOffset;
-				// Compute bytes to write
-				int len = System.Math.Min(avail, count);
-				// Copy bytes to the block
-				Array.Copy(buffer, offset, block, writeOffset, len);
-				// Adjust source offset
-				offset += len;
-				// Adjust count
-				count -= len;
-				// If there is still data to be written, we need to add a new block and reset
-				if (count > 0) {
-					liveBlocks.AddLast(NewBlock());
-					writeOffset = 0;
-				}
+		//=========//
+		// Writing //
+		//=========//
+
+		// Gets the amount of contiguous free space following the live data
+		private int ContiguousFree => head + length < buffer.Length ? buffer.Length - (head + length) : buffer.Length - length;
+
+		// Gets the offset following the live data
+		private int Tail {
+			get {
+				int tail = head + length;
+				return tail >= buffer.Length ? tail - buffer.Length : tail;
+			}
+		}
+
+		/// <summary>
+		/// Gets a span to write data into the end of the FIFO, which must be committed with <see cref="IBufferWriter{T}.Advance(int)"/>.
+		/// </summary>
+		/// <param name="sizeHint">The minimum size of the span</param>
+		/// <returns>Span to write data to</returns>
+		public Span<byte> GetSpan(int sizeHint = 0) => GetMemory(sizeHint).Span;
+
+		/// <summary>
+		/// Gets a memory block to write data into the end of the FIFO, which must be committed with <see cref="IBufferWriter{T}.Advance(int)"/>.
+		/// </summary>
+		/// <param name="sizeHint">The minimum size of the memory block</param>
+		/// <returns>Memory to write data to</returns>
+		public Memory<byte> GetMemory(int sizeHint = 0) {
+			sizeHint = System.Math.Max(sizeHint, 1);
+			if (ContiguousFree < sizeHint) {
+				// Only grow if there is not enough free space in total, as wrapped data already has contiguous free space
+				if (buffer.Length - length < sizeHint) Grow(length + sizeHint);
+				else Compact();
+			}
+			return buffer.AsMemory(Tail, ContiguousFree);
+		}
+
+		void IBufferWriter<byte>.Advance(int count) {
+			if (count < 0 || count > ContiguousFree) throw new ArgumentOutOfRangeException(nameof(count), "Cannot commit more bytes than were requested");
+			length += count;
+		}
+
+		public override void Write(byte[] buffer, int offset, int count) => Write(buffer.AsSpan(offset, count));
+
+		public override void Write(ReadOnlySpan<byte> buffer) {
+			if (buffer.IsEmpty) return;
+			if (this.buffer.Length - length < buffer.Length) Grow(length + buffer.Length);
+			int tail = Tail;
+			int firstLength = System.Math.Min(buffer.Length, this.buffer.Length - tail);
+			buffer[..firstLength].CopyTo(this.buffer.AsSpan(tail));
+			buffer[firstLength..].CopyTo(this.buffer);
+			length += buffer.Length;
+		}
+
+		public override void WriteByte(byte value) {
+			if (length == buffer.Length) Grow(length + 1);
+			buffer[Tail] = value;
+			length++;
+		}
+
+		protected override void Dispose(bool disposing) {
+			if (disposing) {
+				ReleaseBuffer();
+				length = 0;
 			}
-			liveLength += count;
+			base.Dispose(disposing);
 		}
+
 	}
 
 	/// <summary>
@@ -225,4 +334,203 @@ namespace Tesseract.Core.Utilities {
 
 	}
 
-}
+	/// <summary>
+	/// A read-only stream over a <see cref="ReadOnlySequence{T}"/> of bytes. The sequence may be replaced
+	/// at any time, allowing a single stream (and any readers wrapping it) to be reused to decode many
+	/// buffers without copying them.
+	/// </summary>
+	public class ReadOnlySequenceStream : Stream {
+
+		private ReadOnlySequence<byte> sequence;
+		// The part of the sequence that has not been read yet
+		private ReadOnlySequence<byte> remaining;
+
+		/// <summary>
+		/// The sequence of bytes the stream reads from. Setting this resets the position to the start
+		/// of the new sequence.
+		/// </summary>
+		public ReadOnlySequence<byte> Sequence {
+			get => sequence;
+			set {
+				sequence = value;
+				remaining = value;
+			}
+		}
+
+		public override bool CanRead => true;
+
+		public override bool CanSeek => true;
+
+		public override bool CanWrite => false;
+
+		public override long Length => sequence.Length;
+
+		public override long Position {
+			get => sequence.Length - remaining.Length;
+			set {
+				if (value < 0 || value > sequence.Length) throw new ArgumentOutOfRangeException(nameof(value));
+				remaining = sequence.Slice(value);
+			}
+		}
+
+		public ReadOnlySequenceStream() { }
+
+		public ReadOnlySequenceStream(ReadOnlySequence<byte> sequence) {
+			Sequence = sequence;
+		}
+
+		public override void Flush() { }
+
+		public override int Read(byte[] buffer, int offset, int count) => Read(buffer.AsSpan(offset, count));
+
+		public override int Read(Span<byte> buffer) {
+			int count = (int)Math.Min(buffer.Length, remaining.Length);
+			if (count == 0) return 0;
+			ReadOnlySpan<byte> first = remaining.FirstSpan;
+			if (first.Length >= count) first[..count].CopyTo(buffer);
+			else remaining.Slice(0, count).CopyTo(buffer);
+			remaining = remaining.Slice(count);
+			return count;
+		}
+
+		public override int ReadByte() {
+			if (remaining.IsEmpty) return -1;
+			byte value = remaining.FirstSpan[0];
+			remaining = remaining.Slice(1);
+			return value;
+		}
+
+		public override long Seek(long offset, SeekOrigin origin) {
+			Position = origin switch {
+				SeekOrigin.Begin => offset,
+				SeekOrigin.Current => Position + offset,
+				SeekOrigin.End => Length + offset,
+				_ => throw new ArgumentException("Invalid seek origin", nameof(origin))
+			};
+			return Position;
+		}
+
+		public override void SetLength(long value) => throw new NotSupportedException();
+
+		public override void Write(byte[] buffer, int offset, int count) => throw new NotSupportedException();
+
+	}
+
+	/// <summary>
+	/// A seekable in-memory stream which rents its storage from an <see cref="ArrayPool{T}"/>. Calling
+	/// <see cref="Reset"/> returns the storage to the pool so that idle streams do not hold onto memory.
+	/// </summary>
+	public class PooledMemoryStream : Stream {
+
+		private readonly ArrayPool<byte> pool;
+		private byte[] buffer = Array.Empty<byte>();
+		private int length = 0, position = 0;
+
+		/// <summary>
+		/// The bytes that have been written to the stream.
+		/// </summary>
+		public ReadOnlyMemory<byte> WrittenMemory => buffer.AsMemory(0, length);
+
+		/// <summary>
+		/// The bytes that have been written to the stream.
+		/// </summary>
+		public Span<byte> WrittenSpan => buffer.AsSpan(0, length);
+
+		public override bool CanRead => true;
+
+		public override bool CanSeek => true;
+
+		public override bool CanWrite => true;
+
+		public override long Length => length;
+
+		public override long Position {
+			get => position;
+			set {
+				if (value < 0 || value > int.MaxValue) throw new ArgumentOutOfRangeException(nameof(value));
+				position = (int)value;
+			}
+		}
+
+		/// <summary>
+		/// Creates a new pooled memory stream.
+		/// </summary>
+		/// <param name="pool">The pool to rent from, or null to use the shared pool</param>
+		public PooledMemoryStream(ArrayPool<byte>? pool = null) {
+			this.pool = pool ?? ArrayPool<byte>.Shared;
+		}
+
+		/// <summary>
+		/// Clears the stream and returns its storage to the pool.
+		/// </summary>
+		public void Reset() {
+			if (buffer.Length > 0) pool.Return(buffer);
+			buffer = Array.Empty<byte>();
+			length = position = 0;
+		}
+
+		private void EnsureCapacity(long capacity) {
+			if (capacity > Array.MaxLength) throw new IOException("Stream is too long");
+			if (capacity <= buffer.Length) return;
+			byte[] newBuffer = pool.Rent((int)Math.Max(capacity, Math.Max(buffer.Length * 2L, 256)));
+			buffer.AsSpan(0, length).CopyTo(newBuffer);
+			if (buffer.Length > 0) pool.Return(buffer);
+			buffer = newBuffer;
+		}
+
+		public override void Flush() { }
+
+		public override int Read(byte[] buffer, int offset, int count) => Read(buffer.AsSpan(offset, count));
+
+		public override int Read(Span<byte> buffer) {
+			int count = Math.Max(Math.Min(buffer.Length, length - position), 0);
+			this.buffer.AsSpan(position, count).CopyTo(buffer);
+			position += count;
+			return count;
+		}
+
+		public override long Seek(long offset, SeekOrigin origin) {
+			Position = origin switch {
+				SeekOrigin.Begin => offset,
+				SeekOrigin.Current => position + offset,
+				SeekOrigin.End => length + offset,
+				_ => throw new ArgumentException("Invalid seek origin", nameof(origin))
+			};
+			return position;
+		}
+
+		public override void SetLength(long value) {
+			if (value < 0) throw new ArgumentOutOfRangeException(nameof(value));
+			EnsureCapacity(value);
+			if (value > length) buffer.AsSpan(length, (int)value - length).Clear();
+			length = (int)value;
+			position = Math.Min(position, length);
+		}
+
+		public override void Write(byte[] buffer, int offset, int count) => Write(buffer.AsSpan(offset, count));
+
+		public override void Write(ReadOnlySpan<byte> buffer) {
+			long end = (long)position + buffer.Length;
+			EnsureCapacity(end);
+			// Zero any gap left by seeking past the end
+			if (position > length) this.buffer.AsSpan(length, position - length).Clear();
+			buffer.CopyTo(this.buffer.AsSpan(position));
+			position = (int)end;
+			length = Math.Max(length, position);
+		}
+
+		public override void WriteByte(byte value) {
+			if (position >= buffer.Length) EnsureCapacity(position + 1L);
+			if (position > length) buffer.AsSpan(length, position - length).Clear();
+			buffer[position++] = value;
+			length = Math.Max(length, position);
+		}
+
+		protected override void Dispose(bool disposing) {
+			Reset();
+			base.Dispose(disposing);
+		}
+
+	}
+
+}
\ No newline at end of file
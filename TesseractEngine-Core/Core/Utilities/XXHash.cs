@@ -1,10 +1,13 @@
 ﻿using System;
+using System.Buffers.Binary;
 using System.Collections.Generic;
 using System.Linq;
 using System.Numerics;
 using System.Text;
 using System.Threading.Tasks;
 using System.Runtime.CompilerServices;
+using System.Runtime.Intrinsics;
+using System.Runtime.Intrinsics.X86;
 
 namespace Tesseract.Core.Utilities {
 	
@@ -24,7 +27,7 @@ namespace Tesseract.Core.Utilities {
 		private unsafe fixed ulong state[4]; // State variables
 		private unsafe fixed byte buffer[MaxBufferSize]; // Input buffer
 		private int bufferSize;
-		private int totalLength;
+		private long totalLength;
 
 		/// <summary>
 		/// The 64-bit hash value.
@@ -34,44 +37,14 @@ namespace Tesseract.Core.Utilities {
 				unsafe {
 					ulong result;
 
-					if (totalLength >= MaxBufferSize) {
-						result =
-							BitOperations.RotateLeft(state[0], 1) +
-							BitOperations.RotateLeft(state[1], 7) +
-							BitOperations.RotateLeft(state[2], 12) +
-							BitOperations.RotateLeft(state[3], 18);
-						result = (result ^ ProcessSingle(0, state[0])) * Prime1 + Prime4;
-						result = (result ^ ProcessSingle(0, state[1])) * Prime1 + Prime4;
-						result = (result ^ ProcessSingle(0, state[2])) * Prime1 + Prime4;
-						result = (result ^ ProcessSingle(0, state[3])) * Prime1 + Prime4;
-					} else {
-						result = state[2] + Prime5;
-					}
+					if (totalLength >= MaxBufferSize) result = Merge(state[0], state[1], state[2], state[3]);
+					else result = state[2] + Prime5;
 
-					result += (uint)totalLength;
+					result += (ulong)totalLength;
 
 					fixed(byte* pbuffer = buffer) {
-						byte* data = pbuffer;
-						byte* stop = data + bufferSize;
-
-						for (; data + 8 <= stop; data += 8)
-							result = BitOperations.RotateLeft(result ^ ProcessSingle(0, *(ulong*)data), 27) * Prime1 + Prime4;
-
-						if (data + 4 <= stop) {
-							result = BitOperations.RotateLeft(result ^ (*(uint*)data) * Prime1, 23) * Prime2 + Prime3;
-							data += 4;
-						}
-
-						while (data != stop)
-							result = BitOperations.RotateLeft(result ^ (*data++) * Prime5, 11) * Prime1;
+						return Finish(result, pbuffer, bufferSize);
 					}
-
-					result ^= result >> 33;
-					result *= Prime2;
-					result ^= result >> 29;
-					result *= Prime3;
-					result ^= result >> 32;
-					return result;
 				}
 			}
 		}
@@ -87,7 +60,8 @@ namespace Tesseract.Core.Utilities {
 				state[2] = seed;
 				state[3] = seed - Prime1;
 			}
-			bufferSize = totalLength = 0;
+			bufferSize = 0;
+			totalLength = 0;
 		}
 		
 		/// <summary>
@@ -104,32 +78,30 @@ namespace Tesseract.Core.Utilities {
 				fixed(byte* pinput = input, pbuffer = buffer) {
 					byte* data = pinput;
 
-					if (bufferSize + input.Length < MaxBufferSize) {
-						while (length-- > 0) buffer[bufferSize++] = *data++;
+					if (bufferSize + length < MaxBufferSize) {
+						Unsafe.CopyBlockUnaligned(pbuffer + bufferSize, data, (uint)length);
+						bufferSize += length;
 						return this;
 					}
 
 					byte* stop = data + length;
-					byte* stopBlock = stop - MaxBufferSize;
 
 					if (bufferSize > 0) {
-						while (bufferSize < MaxBufferSize) buffer[bufferSize++] = *data++;
-						Process((ulong*)pbuffer, ref state[0], ref state[1], ref state[2], ref state[3]);
+						int fill = MaxBufferSize - bufferSize;
+						Unsafe.CopyBlockUnaligned(pbuffer + bufferSize, data, (uint)fill);
+						data += fill;
+						Process(pbuffer, ref state[0], ref state[1], ref state[2], ref state[3]);
 					}
 
 					ulong s0 = state[0], s1 = state[1], s2 = state[2], s3 = state[3];
-					while(data <= stopBlock) {
-						Process((ulong*)data, ref s0, ref s1, ref s2, ref s3);
-						data += 32;
-					}
+					data = ProcessBlocks(data, stop, ref s0, ref s1, ref s2, ref s3);
 					state[0] = s0;
 					state[1] = s1;
 					state[2] = s2;
 					state[3] = s3;
 
 					bufferSize = (int)(stop - data);
-					for (int i = 0; i < bufferSize; i++)
-						buffer[i] = data[i];
+					Unsafe.CopyBlockUnaligned(pbuffer, data, (uint)bufferSize);
 				}
 			}
 			return this;
@@ -153,11 +125,77 @@ namespace Tesseract.Core.Utilities {
 			BitOperations.RotateLeft(previous + input * Prime2, 31) * Prime1;
 
 		[MethodImpl(MethodImplOptions.AggressiveInlining)]
-		private unsafe void Process(ulong* block, ref ulong state0, ref ulong state1, ref ulong state2, ref ulong state3) {
-			state0 = ProcessSingle(state0, block[0]);
-			state1 = ProcessSingle(state1, block[1]);
-			state2 = ProcessSingle(state2, block[2]);
-			state3 = ProcessSingle(state3, block[3]);
+		private static unsafe void Process(byte* block, ref ulong state0, ref ulong state1, ref ulong state2, ref ulong state3) {
+			state0 = ProcessSingle(state0, Unsafe.ReadUnaligned<ulong>(block));
+			state1 = ProcessSingle(state1, Unsafe.ReadUnaligned<ulong>(block + 8));
+			state2 = ProcessSingle(state2, Unsafe.ReadUnaligned<ulong>(block + 16));
+			state3 = ProcessSingle(state3, Unsafe.ReadUnaligned<ulong>(block + 24));
+		}
+
+		// Processes every complete 32-byte block between data and stop, returning a pointer to the remaining bytes
+		private static unsafe byte* ProcessBlocks(byte* data, byte* stop, ref ulong state0, ref ulong state1, ref ulong state2, ref ulong state3) {
+			byte* stopBlock = stop - MaxBufferSize;
+			ulong s0 = state0, s1 = state1, s2 = state2, s3 = state3;
+			while (data <= stopBlock) {
+				Process(data, ref s0, ref s1, ref s2, ref s3);
+				data += MaxBufferSize;
+			}
+			state0 = s0;
+			state1 = s1;
+			state2 = s2;
+			state3 = s3;
+			return data;
+		}
+
+		private static ulong Merge(ulong state0, ulong state1, ulong state2, ulong state3) {
+			ulong result =
+				BitOperations.RotateLeft(state0, 1) +
+				BitOperations.RotateLeft(state1, 7) +
+				BitOperations.RotateLeft(state2, 12) +
+				BitOperations.RotateLeft(state3, 18);
+			result = (result ^ ProcessSingle(0, state0)) * Prime1 + Prime4;
+			result = (result ^ ProcessSingle(0, state1)) * Prime1 + Prime4;
+			result = (result ^ ProcessSingle(0, state2)) * Prime1 + Prime4;
+			result = (result ^ ProcessSingle(0, state3)) * Prime1 + Prime4;
+			return result;
+		}
+
+		// Mixes in the remaining (< 32) bytes of input and applies the final avalanche
+		private static unsafe ulong Finish(ulong result, byte* data, int length) {
+			byte* stop = data + length;
+
+			for (; data + 8 <= stop; data += 8)
+				result = BitOperations.RotateLeft(result ^ ProcessSingle(0, Unsafe.ReadUnaligned<ulong>(data)), 27) * Prime1 + Prime4;
+
+			if (data + 4 <= stop) {
+				result = BitOperations.RotateLeft(result ^ Unsafe.ReadUnaligned<uint>(data) * Prime1, 23) * Prime2 + Prime3;
+				data += 4;
+			}
+
+			while (data != stop)
+				result = BitOperations.RotateLeft(result ^ (*data++) * Prime5, 11) * Prime1;
+
+			result ^= result >> 33;
+			result *= Prime2;
+			result ^= result >> 29;
+			result *= Prime3;
+			result ^= result >> 32;
+			return result;
+		}
+
+		// One-shot hash of a contiguous input, avoiding the buffering of the streaming state
+		private static unsafe ulong Compute(byte* data, int length, ulong seed) {
+			byte* stop = data + length;
+			ulong result;
+			if (length >= MaxBufferSize) {
+				ulong s0 = seed + Prime1 + Prime2, s1 = seed + Prime2, s2 = seed, s3 = seed - Prime1;
+				data = ProcessBlocks(data, stop, ref s0, ref s1, ref s2, ref s3);
+				result = Merge(s0, s1, s2, s3);
+			} else {
+				result = seed + Prime5;
+			}
+			result += (ulong)length;
+			return Finish(result, data, (int)(stop - data));
 		}
 
 		public override int GetHashCode() => (int)Hash;
@@ -168,11 +206,12 @@ namespace Tesseract.Core.Utilities {
 		/// <param name="input">Byte sequence to hash</param>
 		/// <param name="seed">Seed value</param>
 		/// <returns>Hash value</returns>
-		[MethodImpl(MethodImplOptions.AggressiveInlining)]
 		public static ulong Compute(in ReadOnlySpan<byte> input, ulong seed = 0) {
-			XXHash64 hash = new(seed);
-			hash.Add(input);
-			return hash;
+			unsafe {
+				fixed(byte* pInput = input) {
+					return Compute(pInput, input.Length, seed);
+				}
+			}
 		}
 
 		/// <summary>
@@ -183,13 +222,446 @@ namespace Tesseract.Core.Utilities {
 		/// <returns>Hash value</returns>
 		[MethodImpl(MethodImplOptions.AggressiveInlining)]
 		public static ulong Compute<T>(T input, ulong seed = 0) where T : unmanaged {
-			XXHash64 hash = new(seed);
-			hash.Add(input);
-			return hash;
+			unsafe {
+				return Compute((byte*)&input, sizeof(T), seed);
+			}
 		}
 
 		public static implicit operator ulong(XXHash64 hash) => hash.Hash;
 
 	}
 
+	/// <summary>
+	/// <para>A pure C# implementation of the one-shot 64 and 128-bit variants of the XXH3 hashing algorithm.</para>
+	/// <para>XXH3 is considerably faster than xxHash64 for both small keys and large inputs, and long inputs are
+	/// processed using AVX2 or SSE2 when available. The results match the reference implementation.</para>
+	/// </summary>
+	public static class XXHash3 {
+
+		private const ulong Prime32_1 = 0x9E3779B1U;
+		private const ulong Prime32_2 = 0x85EBCA77U;
+		private const ulong Prime32_3 = 0xC2B2AE3DU;
+		private const ulong Prime64_1 = 0x9E3779B185EBCA87UL;
+		private const ulong Prime64_2 = 0xC2B2AE3D27D4EB4FUL;
+		private const ulong Prime64_3 = 0x165667B19E3779F9UL;
+		private const ulong Prime64_4 = 0x85EBCA77C2B2AE63UL;
+		private const ulong Prime64_5 = 0x27D4EB2F165667C5UL;
+		private const ulong PrimeMX1 = 0x165667919E3779F9UL;
+		private const ulong PrimeMX2 = 0x9FB21C651E98DF25UL;
+
+		private const int SecretSize = 192;
+		private const int SecretSizeMin = 136;
+		private const int StripeLength = 64;
+		private const int SecretConsumeRate = 8;
+		private const int AccumulatorCount = 8;
+		private const int MidSizeMax = 240;
+		private const int MidSizeStartOffset = 3;
+		private const int MidSizeLastOffset = 17;
+		private const int SecretLastAccStart = 7;
+		private const int SecretMergeAccsStart = 11;
+
+		// The default secret
+		private static ReadOnlySpan<byte> DefaultSecret => new byte[SecretSize] {
+			0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+			0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+			0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+			0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+			0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+			0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+			0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+			0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+			0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+			0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+			0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+			0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e
+		};
+
+		/// <summary>
+		/// Computes the 64-bit XXH3 hash of a byte sequence.
+		/// </summary>
+		/// <param name="input">Byte sequence to hash</param>
+		/// <param name="seed">Seed value</param>
+		/// <returns>Hash value</returns>
+		public static ulong Compute64(in ReadOnlySpan<byte> input, ulong seed = 0) {
+			unsafe {
+				fixed(byte* pInput = input, pSecret = DefaultSecret) {
+					return Hash64(pInput, input.Length, pSecret, seed);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Computes the 64-bit XXH3 hash of the byte representation of an unmanaged value.
+		/// </summary>
+		/// <param name="input">Value to hash</param>
+		/// <param name="seed">Seed value</param>
+		/// <returns>Hash value</returns>
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		public static ulong Compute64<T>(T input, ulong seed = 0) where T : unmanaged {
+			unsafe {
+				return Compute64(new ReadOnlySpan<byte>(&input, sizeof(T)), seed);
+			}
+		}
+
+		/// <summary>
+		/// Computes the 128-bit XXH3 hash of a byte sequence.
+		/// </summary>
+		/// <param name="input">Byte sequence to hash</param>
+		/// <param name="seed">Seed value</param>
+		/// <returns>Hash value</returns>
+		public static UInt128 Compute128(in ReadOnlySpan<byte> input, ulong seed = 0) {
+			unsafe {
+				fixed (byte* pInput = input, pSecret = DefaultSecret) {
+					return Hash128(pInput, input.Length, pSecret, seed);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Computes the 128-bit XXH3 hash of the byte representation of an unmanaged value.
+		/// </summary>
+		/// <param name="input">Value to hash</param>
+		/// <param name="seed">Seed value</param>
+		/// <returns>Hash value</returns>
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		public static UInt128 Compute128<T>(T input, ulong seed = 0) where T : unmanaged {
+			unsafe {
+				return Compute128(new ReadOnlySpan<byte>(&input, sizeof(T)), seed);
+			}
+		}
+
+		//==============//
+		// Common Utils //
+		//==============//
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static unsafe ulong Read64(byte* ptr) => Unsafe.ReadUnaligned<ulong>(ptr);
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static unsafe uint Read32(byte* ptr) => Unsafe.ReadUnaligned<uint>(ptr);
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static ulong Mul128Fold64(ulong lhs, ulong rhs) {
+			ulong high = Math.BigMul(lhs, rhs, out ulong low);
+			return low ^ high;
+		}
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static ulong XorShift64(ulong v, int shift) => v ^ (v >> shift);
+
+		private static ulong Avalanche(ulong h) {
+			h = XorShift64(h, 37);
+			h *= PrimeMX1;
+			return XorShift64(h, 32);
+		}
+
+		private static ulong Avalanche64(ulong h) {
+			h ^= h >> 33;
+			h *= Prime64_2;
+			h ^= h >> 29;
+			h *= Prime64_3;
+			h ^= h >> 32;
+			return h;
+		}
+
+		private static ulong RRMXMX(ulong h, ulong length) {
+			h ^= BitOperations.RotateLeft(h, 49) ^ BitOperations.RotateLeft(h, 24);
+			h *= PrimeMX2;
+			h ^= (h >> 35) + length;
+			h *= PrimeMX2;
+			return XorShift64(h, 28);
+		}
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static unsafe ulong Mix16B(byte* input, byte* secret, ulong seed) =>
+			Mul128Fold64(Read64(input) ^ (Read64(secret) + seed), Read64(input + 8) ^ (Read64(secret + 8) - seed));
+
+		private static unsafe void InitCustomSecret(byte* customSecret, ulong seed) {
+			fixed(byte* pSecret = DefaultSecret) {
+				for (int i = 0; i < SecretSize / 16; i++) {
+					Unsafe.WriteUnaligned(customSecret + 16 * i, Read64(pSecret + 16 * i) + seed);
+					Unsafe.WriteUnaligned(customSecret + 16 * i + 8, Read64(pSecret + 16 * i + 8) - seed);
+				}
+			}
+		}
+
+		//=============//
+		// Long Inputs //
+		//=============//
+
+		// Accumulates a number of stripes, keeping the accumulators in registers
+		private static unsafe void Accumulate(ulong* acc, byte* input, byte* secret, int stripeCount) {
+			if (Avx2.IsSupported) {
+				Vector256<ulong> acc0 = Avx.LoadVector256(acc), acc1 = Avx.LoadVector256(acc + 4);
+				for (int n = 0; n < stripeCount; n++) {
+					byte* stripe = input + n * StripeLength, key = secret + n * SecretConsumeRate;
+					acc0 = AccumulateAvx2(acc0, Avx.LoadVector256((ulong*)stripe), Avx.LoadVector256((ulong*)key));
+					acc1 = AccumulateAvx2(acc1, Avx.LoadVector256((ulong*)(stripe + 32)), Avx.LoadVector256((ulong*)(key + 32)));
+				}
+				Avx.Store(acc, acc0);
+				Avx.Store(acc + 4, acc1);
+			} else if (Sse2.IsSupported) {
+				Vector128<ulong> acc0 = Sse2.LoadVector128(acc), acc1 = Sse2.LoadVector128(acc + 2), acc2 = Sse2.LoadVector128(acc + 4), acc3 = Sse2.LoadVector128(acc + 6);
+				for (int n = 0; n < stripeCount; n++) {
+					byte* stripe = input + n * StripeLength, key = secret + n * SecretConsumeRate;
+					acc0 = AccumulateSse2(acc0, Sse2.LoadVector128((ulong*)stripe), Sse2.LoadVector128((ulong*)key));
+					acc1 = AccumulateSse2(acc1, Sse2.LoadVector128((ulong*)(stripe + 16)), Sse2.LoadVector128((ulong*)(key + 16)));
+					acc2 = AccumulateSse2(acc2, Sse2.LoadVector128((ulong*)(stripe + 32)), Sse2.LoadVector128((ulong*)(key + 32)));
+					acc3 = AccumulateSse2(acc3, Sse2.LoadVector128((ulong*)(stripe + 48)), Sse2.LoadVector128((ulong*)(key + 48)));
+				}
+				Sse2.Store(acc, acc0);
+				Sse2.Store(acc + 2, acc1);
+				Sse2.Store(acc + 4, acc2);
+				Sse2.Store(acc + 6, acc3);
+			} else {
+				for (int n = 0; n < stripeCount; n++) {
+					byte* stripe = input + n * StripeLength, key = secret + n * SecretConsumeRate;
+					for (int i = 0; i < AccumulatorCount; i++) {
+						ulong dataVal = Read64(stripe + 8 * i);
+						ulong dataKey = dataVal ^ Read64(key + 8 * i);
+						acc[i ^ 1] += dataVal;
+						acc[i] += (dataKey & 0xFFFFFFFF) * (dataKey >> 32);
+					}
+				}
+			}
+		}
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static Vector256<ulong> AccumulateAvx2(Vector256<ulong> acc, Vector256<ulong> data, Vector256<ulong> key) {
+			Vector256<uint> dataKey = Avx2.Xor(data, key).AsUInt32();
+			Vector256<ulong> product = Avx2.Multiply(dataKey, Avx2.Shuffle(dataKey, 0b00_11_00_01));
+			Vector256<ulong> dataSwap = Avx2.Shuffle(data.AsUInt32(), 0b01_00_11_10).AsUInt64();
+			return Avx2.Add(product, Avx2.Add(acc, dataSwap));
+		}
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static Vector128<ulong> AccumulateSse2(Vector128<ulong> acc, Vector128<ulong> data, Vector128<ulong> key) {
+			Vector128<uint> dataKey = Sse2.Xor(data, key).AsUInt32();
+			Vector128<ulong> product = Sse2.Multiply(dataKey, Sse2.Shuffle(dataKey, 0b00_11_00_01));
+			Vector128<ulong> dataSwap = Sse2.Shuffle(data.AsUInt32(), 0b01_00_11_10).AsUInt64();
+			return Sse2.Add(product, Sse2.Add(acc, dataSwap));
+		}
+
+		private static unsafe void ScrambleAcc(ulong* acc, byte* secret) {
+			if (Avx2.IsSupported) {
+				Vector256<uint> prime = Vector256.Create((uint)Prime32_1);
+				for (int i = 0; i < 2; i++) {
+					Vector256<ulong> accVec = Avx.LoadVector256(acc + 4 * i);
+					Vector256<ulong> keyVec = Avx.LoadVector256((ulong*)secret + 4 * i);
+					accVec = Avx2.Xor(Avx2.Xor(accVec, Avx2.ShiftRightLogical(accVec, 47)), keyVec);
+					Vector256<ulong> productLo = Avx2.Multiply(accVec.AsUInt32(), prime);
+					Vector256<ulong> productHi = Avx2.Multiply(Avx2.Shuffle(accVec.AsUInt32(), 0b00_11_00_01), prime);
+					Avx.Store(acc + 4 * i, Avx2.Add(productLo, Avx2.ShiftLeftLogical(productHi, 32)));
+				}
+			} else if (Sse2.IsSupported) {
+				Vector128<uint> prime = Vector128.Create((uint)Prime32_1);
+				for (int i = 0; i < 4; i++) {
+					Vector128<ulong> accVec = Sse2.LoadVector128(acc + 2 * i);
+					Vector128<ulong> keyVec = Sse2.LoadVector128((ulong*)secret + 2 * i);
+					accVec = Sse2.Xor(Sse2.Xor(accVec, Sse2.ShiftRightLogical(accVec, 47)), keyVec);
+					Vector128<ulong> productLo = Sse2.Multiply(accVec.AsUInt32(), prime);
+					Vector128<ulong> productHi = Sse2.Multiply(Sse2.Shuffle(accVec.AsUInt32(), 0b00_11_00_01), prime);
+					Sse2.Store(acc + 2 * i, Sse2.Add(productLo, Sse2.ShiftLeftLogical(productHi, 32)));
+				}
+			} else {
+				for (int i = 0; i < AccumulatorCount; i++) {
+					ulong acc64 = XorShift64(acc[i], 47) ^ Read64(secret + 8 * i);
+					acc[i] = acc64 * Prime32_1;
+				}
+			}
+		}
+
+		private static unsafe void HashLongLoop(ulong* acc, byte* input, int length, byte* secret, int secretSize) {
+			int stripesPerBlock = (secretSize - StripeLength) / SecretConsumeRate;
+			int blockLength = StripeLength * stripesPerBlock;
+			int blockCount = (length - 1) / blockLength;
+
+			for (int n = 0; n < blockCount; n++) {
+				Accumulate(acc, input + n * blockLength, secret, stripesPerBlock);
+				ScrambleAcc(acc, secret + secretSize - StripeLength);
+			}
+
+			int stripeCount = ((length - 1) - (blockLength * blockCount)) / StripeLength;
+			Accumulate(acc, input + blockCount * blockLength, secret, stripeCount);
+
+			Accumulate(acc, input + length - StripeLength, secret + secretSize - StripeLength - SecretLastAccStart, 1);
+		}
+
+		private static unsafe void InitAcc(ulong* acc) {
+			acc[0] = Prime32_3;
+			acc[1] = Prime64_1;
+			acc[2] = Prime64_2;
+			acc[3] = Prime64_3;
+			acc[4] = Prime64_4;
+			acc[5] = Prime32_2;
+			acc[6] = Prime64_5;
+			acc[7] = Prime32_1;
+		}
+
+		private static unsafe ulong MergeAccs(ulong* acc, byte* secret, ulong start) {
+			ulong result = start;
+			for (int i = 0; i < 4; i++)
+				result += Mul128Fold64(acc[2 * i] ^ Read64(secret + 16 * i), acc[2 * i + 1] ^ Read64(secret + 16 * i + 8));
+			return Avalanche(result);
+		}
+
+		//========//
+		// 64-Bit //
+		//========//
+
+		private static unsafe ulong Hash64(byte* input, int length, byte* secret, ulong seed) {
+			if (length <= 16) {
+				if (length > 8) {
+					ulong bitflip1 = (Read64(secret + 24) ^ Read64(secret + 32)) + seed;
+					ulong bitflip2 = (Read64(secret + 40) ^ Read64(secret + 48)) - seed;
+					ulong inputLo = Read64(input) ^ bitflip1;
+					ulong inputHi = Read64(input + length - 8) ^ bitflip2;
+					ulong acc = (ulong)length + BinaryPrimitives.ReverseEndianness(inputLo) + inputHi + Mul128Fold64(inputLo, inputHi);
+					return Avalanche(acc);
+				} else if (length >= 4) {
+					seed ^= (ulong)BinaryPrimitives.ReverseEndianness((uint)seed) << 32;
+					uint input1 = Read32(input);
+					uint input2 = Read32(input + length - 4);
+					ulong bitflip = (Read64(secret + 8) ^ Read64(secret + 16)) - seed;
+					ulong input64 = input2 + ((ulong)input1 << 32);
+					return RRMXMX(input64 ^ bitflip, (ulong)length);
+				} else if (length > 0) {
+					uint combined = ((uint)input[0] << 16) | ((uint)input[length >> 1] << 24) | input[length - 1] | ((uint)length << 8);
+					ulong bitflip = (Read32(secret) ^ Read32(secret + 4)) + seed;
+					return Avalanche64(combined ^ bitflip);
+				} else {
+					return Avalanche64(seed ^ (Read64(secret + 56) ^ Read64(secret + 64)));
+				}
+			} else if (length <= 128) {
+				ulong acc = (ulong)length * Prime64_1;
+				if (length > 32) {
+					if (length > 64) {
+						if (length > 96) {
+							acc += Mix16B(input + 48, secret + 96, seed);
+							acc += Mix16B(input + length - 64, secret + 112, seed);
+						}
+						acc += Mix16B(input + 32, secret + 64, seed);
+						acc += Mix16B(input + length - 48, secret + 80, seed);
+					}
+					acc += Mix16B(input + 16, secret + 32, seed);
+					acc += Mix16B(input + length - 32, secret + 48, seed);
+				}
+				acc += Mix16B(input, secret, seed);
+				acc += Mix16B(input + length - 16, secret + 16, seed);
+				return Avalanche(acc);
+			} else if (length <= MidSizeMax) {
+				ulong acc = (ulong)length * Prime64_1;
+				int roundCount = length / 16;
+				for (int i = 0; i < 8; i++) acc += Mix16B(input + 16 * i, secret + 16 * i, seed);
+				ulong accEnd = Mix16B(input + length - 16, secret + SecretSizeMin - MidSizeLastOffset, seed);
+				acc = Avalanche(acc);
+				for (int i = 8; i < roundCount; i++) accEnd += Mix16B(input + 16 * i, secret + 16 * (i - 8) + MidSizeStartOffset, seed);
+				return Avalanche(acc + accEnd);
+			} else {
+				byte* customSecret = stackalloc byte[SecretSize];
+				if (seed != 0) {
+					InitCustomSecret(customSecret, seed);
+					secret = customSecret;
+				}
+				ulong* acc = stackalloc ulong[AccumulatorCount];
+				InitAcc(acc);
+				HashLongLoop(acc, input, length, secret, SecretSize);
+				return MergeAccs(acc, secret + SecretMergeAccsStart, (ulong)length * Prime64_1);
+			}
+		}
+
+		//=========//
+		// 128-Bit //
+		//=========//
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static unsafe void Mix32B(ref ulong accLo, ref ulong accHi, byte* input1, byte* input2, byte* secret, ulong seed) {
+			accLo += Mix16B(input1, secret, seed);
+			accLo ^= Read64(input2) + Read64(input2 + 8);
+			accHi += Mix16B(input2, secret + 16, seed);
+			accHi ^= Read64(input1) + Read64(input1 + 8);
+		}
+
+		private static UInt128 Finish128(ulong accLo, ulong accHi, int length, ulong seed) {
+			ulong lo = accLo + accHi;
+			ulong hi = (accLo * Prime64_1) + (accHi * Prime64_4) + (((ulong)length - seed) * Prime64_2);
+			return new UInt128(0 - Avalanche(hi), Avalanche(lo));
+		}
+
+		private static unsafe UInt128 Hash128(byte* input, int length, byte* secret, ulong seed) {
+			if (length <= 16) {
+				if (length > 8) {
+					ulong bitflipl = (Read64(secret + 32) ^ Read64(secret + 40)) - seed;
+					ulong bitfliph = (Read64(secret + 48) ^ Read64(secret + 56)) + seed;
+					ulong inputLo = Read64(input);
+					ulong inputHi = Read64(input + length - 8);
+					ulong mHi = Math.BigMul(inputLo ^ inputHi ^ bitflipl, Prime64_1, out ulong mLo);
+					mLo += (ulong)(length - 1) << 54;
+					inputHi ^= bitfliph;
+					mHi += inputHi + (ulong)(uint)inputHi * (Prime32_2 - 1);
+					mLo ^= BinaryPrimitives.ReverseEndianness(mHi);
+					ulong hHi = Math.BigMul(mLo, Prime64_2, out ulong hLo);
+					hHi += mHi * Prime64_2;
+					return new UInt128(Avalanche(hHi), Avalanche(hLo));
+				} else if (length >= 4) {
+					seed ^= (ulong)BinaryPrimitives.ReverseEndianness((uint)seed) << 32;
+					uint inputLo = Read32(input);
+					uint inputHi = Read32(input + length - 4);
+					ulong input64 = inputLo + ((ulong)inputHi << 32);
+					ulong bitflip = (Read64(secret + 16) ^ Read64(secret + 24)) + seed;
+					ulong keyed = input64 ^ bitflip;
+					ulong mHi = Math.BigMul(keyed, Prime64_1 + ((ulong)length << 2), out ulong mLo);
+					mHi += mLo << 1;
+					mLo ^= mHi >> 3;
+					mLo = XorShift64(mLo, 35);
+					mLo *= PrimeMX2;
+					mLo = XorShift64(mLo, 28);
+					return new UInt128(Avalanche(mHi), mLo);
+				} else if (length > 0) {
+					uint combinedl = ((uint)input[0] << 16) | ((uint)input[length >> 1] << 24) | input[length - 1] | ((uint)length << 8);
+					uint combinedh = BitOperations.RotateLeft(BinaryPrimitives.ReverseEndianness(combinedl), 13);
+					ulong bitflipl = (Read32(secret) ^ Read32(secret + 4)) + seed;
+					ulong bitfliph = (Read32(secret + 8) ^ Read32(secret + 12)) - seed;
+					return new UInt128(Avalanche64(combinedh ^ bitfliph), Avalanche64(combinedl ^ bitflipl));
+				} else {
+					ulong bitflipl = Read64(secret + 64) ^ Read64(secret + 72);
+					ulong bitfliph = Read64(secret + 80) ^ Read64(secret + 88);
+					return new UInt128(Avalanche64(seed ^ bitfliph), Avalanche64(seed ^ bitflipl));
+				}
+			} else if (length <= 128) {
+				ulong accLo = (ulong)length * Prime64_1, accHi = 0;
+				if (length > 32) {
+					if (length > 64) {
+						if (length > 96) Mix32B(ref accLo, ref accHi, input + 48, input + length - 64, secret + 96, seed);
+						Mix32B(ref accLo, ref accHi, input + 32, input + length - 48, secret + 64, seed);
+					}
+					Mix32B(ref accLo, ref accHi, input + 16, input + length - 32, secret + 32, seed);
+				}
+				Mix32B(ref accLo, ref accHi, input, input + length - 16, secret, seed);
+				return Finish128(accLo, accHi, length, seed);
+			} else if (length <= MidSizeMax) {
+				ulong accLo = (ulong)length * Prime64_1, accHi = 0;
+				for (int i = 32; i < 160; i += 32) Mix32B(ref accLo, ref accHi, input + i - 32, input + i - 16, secret + i - 32, seed);
+				accLo = Avalanche(accLo);
+				accHi = Avalanche(accHi);
+				for (int i = 160; i <= length; i += 32) Mix32B(ref accLo, ref accHi, input + i - 32, input + i - 16, secret + MidSizeStartOffset + i - 160, seed);
+				Mix32B(ref accLo, ref accHi, input + length - 16, input + length - 32, secret + SecretSizeMin - MidSizeLastOffset - 16, 0 - seed);
+				return Finish128(accLo, accHi, length, seed);
+			} else {
+				byte* customSecret = stackalloc byte[SecretSize];
+				if (seed != 0) {
+					InitCustomSecret(customSecret, seed);
+					secret = customSecret;
+				}
+				ulong* acc = stackalloc ulong[AccumulatorCount];
+				InitAcc(acc);
+				HashLongLoop(acc, input, length, secret, SecretSize);
+				ulong lo = MergeAccs(acc, secret + SecretMergeAccsStart, (ulong)length * Prime64_1);
+				ulong hi = MergeAccs(acc, secret + SecretSize - (AccumulatorCount * sizeof(ulong)) - SecretMergeAccsStart, ~((ulong)length * Prime64_2));
+				return new UInt128(hi, lo);
+			}
+		}
+
+	}
+
 }
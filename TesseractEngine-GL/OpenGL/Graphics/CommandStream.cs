@@ -0,0 +1,267 @@
+﻿using System;
+using System.Buffers;
+using System.Collections.Generic;
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+
+namespace Tesseract.OpenGL.Graphics {
+
+	/// <summary>
+	/// Enumeration of command opcodes stored in a <see cref="GLCommandStream"/>.
+	/// </summary>
+	public enum GLCommandOp : int {
+		BeginRenderPass,
+		BindPipeline,
+		BindResources,
+		BindVertexArray,
+		ClearAttachments,
+		ClearColorTexture,
+		ClearDepthStencilTexture,
+		CopyBuffer,
+		CopyBufferToTexture,
+		CopyTexture,
+		CopyTextureToBuffer,
+		Dispatch,
+		DispatchIndirect,
+		Draw,
+		DrawIndexed,
+		DrawIndexedIndirect,
+		DrawIndirect,
+		EndRenderPass,
+		ExecuteCommands,
+		FillBufferUInt32,
+		GenerateMipmaps,
+		NextSubpass,
+		ResolveTexture,
+		SetBlendConstants,
+		SetDepthBias,
+		SetDepthBounds,
+		SetLineWidth,
+		SetScissors,
+		SetStencilCompareMask,
+		SetStencilReference,
+		SetStencilWriteMask,
+		SetViewports,
+		SetCullMode,
+		SetDepthBoundsTestEnable,
+		SetDepthCompareOp,
+		SetDepthTestEnable,
+		SetDepthWriteEnable,
+		SetFrontFace,
+		SetDrawMode,
+		SetStencilOp,
+		SetStencilTestEnable,
+		SetDepthBiasEnable,
+		SetLogicOp,
+		SetPatchControlPoints,
+		SetPrimitiveRestartEnable,
+		SetRasterizerDiscardEnable,
+		SetColorWriteEnable,
+		UpdateBuffer
+	}
+
+	/// <summary>
+	/// <para>
+	/// A command stream stores recorded OpenGL commands as a compact sequence of binary records, each consisting
+	/// of a <see cref="GLCommandOp"/> followed by its unmanaged parameters. Object parameters (eg. pipelines or
+	/// buffers) are stored in a side table and referenced by index, and variable-length parameters are stored
+	/// inline prefixed by their length.
+	/// </para>
+	/// <para>
+	/// The byte storage is rented from <see cref="ArrayPool{T}.Shared"/> and is kept when the stream is reset, so
+	/// re-recording a command stream does not allocate once its storage has grown to fit the commands.
+	/// </para>
+	/// </summary>
+	public sealed class GLCommandStream : IDisposable {
+
+		// The alignment of inline span data
+		private const int SpanAlignment = 8;
+
+		private byte[] data;
+		private int length = 0;
+		private readonly List<object> objects = new();
+
+		/// <summary>
+		/// The number of bytes of command data in the stream.
+		/// </summary>
+		public int Length => length;
+
+		/// <summary>
+		/// If the stream contains no commands.
+		/// </summary>
+		public bool IsEmpty => length == 0;
+
+		/// <summary>
+		/// Creates a new command stream.
+		/// </summary>
+		/// <param name="initialCapacity">The initial capacity of the stream in bytes</param>
+		public GLCommandStream(int initialCapacity = 1024) {
+			data = ArrayPool<byte>.Shared.Rent(initialCapacity);
+		}
+
+		/// <summary>
+		/// Clears all commands from the stream, keeping its storage.
+		/// </summary>
+		public void Reset() {
+			length = 0;
+			objects.Clear();
+		}
+
+		// Ensures there is space for the given number of additional bytes
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private void Ensure(int count) {
+			if (data.Length - length < count) Grow(count);
+		}
+
+		private void Grow(int count) {
+			byte[] newData = ArrayPool<byte>.Shared.Rent(Math.Max(data.Length * 2, length + count));
+			data.AsSpan(0, length).CopyTo(newData);
+			ArrayPool<byte>.Shared.Return(data);
+			data = newData;
+		}
+
+		/// <summary>
+		/// Writes an unmanaged value to the stream.
+		/// </summary>
+		/// <typeparam name="T">Value type</typeparam>
+		/// <param name="value">Value to write</param>
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		public unsafe void Write<T>(in T value) where T : unmanaged {
+			Ensure(sizeof(T));
+			Unsafe.WriteUnaligned(ref data[length], value);
+			length += sizeof(T);
+		}
+
+		/// <summary>
+		/// Writes the opcode of a command to the stream.
+		/// </summary>
+		/// <param name="op">Command opcode</param>
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		public void Write(GLCommandOp op) => Write<GLCommandOp>(op);
+
+		/// <summary>
+		/// Writes an object reference to the stream.
+		/// </summary>
+		/// <param name="obj">Object to write</param>
+		public void WriteObject(object obj) {
+			Write(objects.Count);
+			objects.Add(obj);
+		}
+
+		/// <summary>
+		/// Writes a span of unmanaged values to the stream, prefixed by its length.
+		/// </summary>
+		/// <typeparam name="T">Element type</typeparam>
+		/// <param name="values">Values to write</param>
+		public void WriteSpan<T>(in ReadOnlySpan<T> values) where T : unmanaged {
+			ReadOnlySpan<byte> bytes = MemoryMarshal.AsBytes(values);
+			Write(values.Length);
+			int padding = (SpanAlignment - (length & (SpanAlignment - 1))) & (SpanAlignment - 1);
+			Ensure(padding + bytes.Length);
+			length += padding;
+			bytes.CopyTo(data.AsSpan(length));
+			length += bytes.Length;
+		}
+
+		/// <summary>
+		/// Writes a list of unmanaged values to the stream, in the same format as <see cref="WriteSpan{T}(in ReadOnlySpan{T})"/>
+		/// so they can be read back as a span.
+		/// </summary>
+		/// <typeparam name="T">Element type</typeparam>
+		/// <param name="values">Values to write</param>
+		public unsafe void WriteList<T>(IReadOnlyList<T> values) where T : unmanaged {
+			if (values is T[] array) {
+				WriteSpan<T>(array);
+				return;
+			}
+			int count = values.Count;
+			Write(count);
+			int padding = (SpanAlignment - (length & (SpanAlignment - 1))) & (SpanAlignment - 1);
+			Ensure(padding + count * sizeof(T));
+			length += padding;
+			for (int i = 0; i < count; i++) {
+				Unsafe.WriteUnaligned(ref data[length], values[i]);
+				length += sizeof(T);
+			}
+		}
+
+		/// <summary>
+		/// Creates a reader over the commands in the stream. The stream must not be modified while it is being read.
+		/// </summary>
+		/// <returns>Command reader</returns>
+		public Reader GetReader() => new(data.AsSpan(0, length), objects);
+
+		/// <summary>
+		/// A reader which sequentially reads values from a command stream.
+		/// </summary>
+		public ref struct Reader {
+
+			private readonly ReadOnlySpan<byte> data;
+			private readonly List<object> objects;
+			private int position;
+
+			internal Reader(ReadOnlySpan<byte> data, List<object> objects) {
+				this.data = data;
+				this.objects = objects;
+				position = 0;
+			}
+
+			/// <summary>
+			/// If the reader has reached the end of the stream.
+			/// </summary>
+			public bool AtEnd => position >= data.Length;
+
+			/// <summary>
+			/// Reads an unmanaged value from the stream.
+			/// </summary>
+			/// <typeparam name="T">Value type</typeparam>
+			/// <returns>Value read</returns>
+			[MethodImpl(MethodImplOptions.AggressiveInlining)]
+			public unsafe T Read<T>() where T : unmanaged {
+				T value = Unsafe.ReadUnaligned<T>(ref Unsafe.AsRef(in data[position]));
+				position += sizeof(T);
+				return value;
+			}
+
+			/// <summary>
+			/// Reads the opcode of a command from the stream.
+			/// </summary>
+			/// <returns>Command opcode</returns>
+			[MethodImpl(MethodImplOptions.AggressiveInlining)]
+			public GLCommandOp ReadOp() => Read<GLCommandOp>();
+
+			/// <summary>
+			/// Reads an object reference from the stream.
+			/// </summary>
+			/// <typeparam name="T">Object type</typeparam>
+			/// <returns>Object read</returns>
+			[MethodImpl(MethodImplOptions.AggressiveInlining)]
+			public T ReadObject<T>() where T : class => (T)objects[Read<int>()];
+
+			/// <summary>
+			/// Reads a span of unmanaged values from the stream. The returned span directly references the stream's storage.
+			/// </summary>
+			/// <typeparam name="T">Element type</typeparam>
+			/// <returns>Values read</returns>
+			public unsafe ReadOnlySpan<T> ReadSpan<T>() where T : unmanaged {
+				int count = Read<int>();
+				position += (SpanAlignment - (position & (SpanAlignment - 1))) & (SpanAlignment - 1);
+				ReadOnlySpan<T> values = MemoryMarshal.Cast<byte, T>(data.Slice(position, count * sizeof(T)));
+				position += count * sizeof(T);
+				return values;
+			}
+
+		}
+
+		public void Dispose() {
+			if (data.Length > 0) {
+				ArrayPool<byte>.Shared.Return(data);
+				data = Array.Empty<byte>();
+			}
+			length = 0;
+			objects.Clear();
+		}
+
+	}
+
+}
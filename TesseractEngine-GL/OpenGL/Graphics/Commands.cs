@@ -3,6 +3,7 @@ using System.Collections.Generic;
 using System.Linq;
 using System.Numerics;
 using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
 using Tesseract.Core.Graphics.Accelerated;
 using Tesseract.Core.Numerics;
 using Tesseract.Core.Native;
@@ -23,28 +24,33 @@ namespace Tesseract.OpenGL.Graphics {
 
 		public CommandBufferType Type { get; }
 
-		// The list of command delegates
-		private readonly List<Action> commands = new();
+		// The stream of recorded commands
+		private readonly GLCommandStream commands = new();
+		// The sink which records into and replays the command stream
+		private readonly GLCommandSink sink;
 
 		public GLCommandBuffer(GLGraphics graphics, CommandBufferCreateInfo createInfo) {
 			Graphics = graphics;
 			Type = createInfo.Type;
+			sink = new GLCommandSink(graphics, commands);
 		}
 
-		public ICommandSink BeginRecording() => new GLCommandSink(Graphics, commands.Add); // Sink into command buffer
+		public ICommandSink BeginRecording() {
+			commands.Reset();
+			return sink; // Sink into command buffer
+		}
 
 		public void Dispose() {
 			GC.SuppressFinalize(this);
+			commands.Dispose();
 		}
 
 		public void EndRecording() { } // No-op
 
 		/// <summary>
-		/// Runs the list of commands stored in the command buffer.
+		/// Runs the commands stored in the command buffer.
 		/// </summary>
-		public void RunCommands() {
-			foreach (Action cmd in commands) cmd();
-		}
+		public void RunCommands() => sink.Replay();
 
 	}
 
@@ -59,12 +65,191 @@ namespace Tesseract.OpenGL.Graphics {
 		// The OpenGL interface
 		private GLInterface Interface => Graphics.Interface;
 
-		// Delegate to indirect commands through (usually a command buffer).
-		private readonly Action<Action>? indirect;
+		// Stream to record commands into instead of executing them immediately (usually from a command buffer).
+		private readonly GLCommandStream? stream;
 
-		public GLCommandSink(GLGraphics graphics, Action<Action>? indirect = null) {
+		public GLCommandSink(GLGraphics graphics, GLCommandStream? stream = null) {
 			Graphics = graphics;
-			this.indirect = indirect;
+			this.stream = stream;
+		}
+
+		/// <summary>
+		/// Replays the commands recorded into this sink's command stream. Each command is executed through the same
+		/// path as immediate commands, so redundant state changes are filtered by the <see cref="GLState"/>.
+		/// </summary>
+		internal void Replay() {
+			if (stream == null) return;
+			var state = Graphics.State;
+			var iface = Interface;
+			var reader = stream.GetReader();
+			while (!reader.AtEnd) {
+				switch (reader.ReadOp()) {
+					case GLCommandOp.BeginRenderPass:
+						state.BeginRenderPass(reader.ReadObject<IRenderPass>(), reader.ReadObject<IFramebuffer>(), reader.Read<Recti>(), reader.ReadSpan<ICommandSink.ClearValue>());
+						break;
+					case GLCommandOp.BindPipeline:
+						state.BindPipeline(reader.ReadObject<GLPipeline>());
+						break;
+					case GLCommandOp.BindResources:
+						reader.ReadObject<GLBindSet>().Bind();
+						break;
+					case GLCommandOp.BindVertexArray:
+						state.BindVertexArray(reader.ReadObject<GLVertexArray>());
+						break;
+					case GLCommandOp.ClearAttachments: {
+							var values = reader.ReadSpan<ICommandSink.ClearAttachment>();
+							ClearAttachmentsImpl(values, reader.ReadSpan<ICommandSink.ClearRect>());
+						}
+						break;
+					case GLCommandOp.ClearColorTexture:
+						ClearColorTextureImpl(reader.ReadObject<GLTexture>(), reader.Read<ICommandSink.ClearValue>(), reader.ReadSpan<TextureSubresourceRange>());
+						break;
+					case GLCommandOp.ClearDepthStencilTexture:
+						ClearDepthStencilTextureImpl(reader.ReadObject<GLTexture>(), reader.Read<ICommandSink.ClearValue>(), reader.ReadSpan<TextureSubresourceRange>());
+						break;
+					case GLCommandOp.CopyBuffer:
+						CopyBufferImpl(reader.ReadObject<GLBuffer>(), reader.ReadObject<GLBuffer>(), reader.ReadSpan<ICommandSink.CopyBufferRegion>());
+						break;
+					case GLCommandOp.CopyBufferToTexture:
+						CopyBufferToTextureImpl(reader.ReadObject<GLTexture>(), reader.ReadObject<GLBuffer>(), reader.ReadSpan<ICommandSink.CopyBufferTexture>());
+						break;
+					case GLCommandOp.CopyTexture:
+						CopyTextureImpl(reader.ReadObject<GLTexture>(), reader.ReadObject<GLTexture>(), reader.ReadSpan<ICommandSink.CopyTextureRegion>());
+						break;
+					case GLCommandOp.CopyTextureToBuffer:
+						CopyTextureToBufferImpl(reader.ReadObject<GLTexture>(), reader.ReadObject<GLBuffer>(), reader.ReadSpan<ICommandSink.CopyBufferTexture>());
+						break;
+					case GLCommandOp.Dispatch:
+						iface.Dispatch(reader.Read<Vector3ui>());
+						break;
+					case GLCommandOp.DispatchIndirect:
+						iface.DispatchIndirect(reader.ReadObject<GLBuffer>().ID, reader.Read<nint>());
+						break;
+					case GLCommandOp.Draw:
+						iface.Draw(reader.Read<uint>(), reader.Read<uint>(), reader.Read<uint>(), reader.Read<uint>());
+						break;
+					case GLCommandOp.DrawIndexed:
+						iface.DrawIndexed(reader.Read<uint>(), reader.Read<uint>(), reader.Read<uint>(), reader.Read<int>(), reader.Read<uint>());
+						break;
+					case GLCommandOp.DrawIndexedIndirect:
+						iface.DrawIndexedIndirect(reader.ReadObject<GLBuffer>().ID, reader.Read<nint>(), reader.Read<int>(), reader.Read<int>());
+						break;
+					case GLCommandOp.DrawIndirect:
+						iface.DrawIndirect(reader.ReadObject<GLBuffer>().ID, reader.Read<nint>(), reader.Read<int>(), reader.Read<int>());
+						break;
+					case GLCommandOp.EndRenderPass:
+						state.EndRenderPass();
+						break;
+					case GLCommandOp.ExecuteCommands:
+						reader.ReadObject<GLCommandBuffer>().RunCommands();
+						break;
+					case GLCommandOp.FillBufferUInt32:
+						iface.FillBufferUInt32(reader.ReadObject<GLBuffer>().ID, reader.Read<nint>(), reader.Read<nint>(), reader.Read<uint>());
+						break;
+					case GLCommandOp.GenerateMipmaps: {
+							var texture = reader.ReadObject<GLTexture>();
+							bool hasFilter = reader.Read<bool>();
+							GLFilter filter = reader.Read<GLFilter>();
+							iface.GenerateMipmaps(texture, hasFilter ? filter : null);
+						}
+						break;
+					case GLCommandOp.NextSubpass:
+						state.NextSubpass();
+						break;
+					case GLCommandOp.ResolveTexture:
+						ResolveTextureImpl(reader.ReadObject<GLTexture>(), reader.ReadObject<GLTexture>(), reader.ReadSpan<ICommandSink.CopyTextureRegion>());
+						break;
+					case GLCommandOp.SetBlendConstants:
+						state.SetBlendConstants(reader.Read<Vector4>());
+						break;
+					case GLCommandOp.SetDepthBias:
+						state.SetDepthBias(reader.Read<GLPipeline.DepthBiasFactors>());
+						break;
+					case GLCommandOp.SetDepthBounds:
+						state.SetDepthBounds(reader.Read<float>(), reader.Read<float>());
+						break;
+					case GLCommandOp.SetLineWidth:
+						state.SetLineWidth(reader.Read<float>());
+						break;
+					case GLCommandOp.SetScissors: {
+							uint first = reader.Read<uint>();
+							state.SetScissors(reader.ReadSpan<Recti>(), first);
+						}
+						break;
+					case GLCommandOp.SetStencilCompareMask:
+						state.SetStencilCompareMask(reader.Read<GLFace>(), reader.Read<uint>());
+						break;
+					case GLCommandOp.SetStencilReference:
+						state.SetStencilReference(reader.Read<GLFace>(), reader.Read<int>());
+						break;
+					case GLCommandOp.SetStencilWriteMask:
+						state.SetStencilWriteMask(reader.Read<GLFace>(), reader.Read<uint>());
+						break;
+					case GLCommandOp.SetViewports: {
+							uint first = reader.Read<uint>();
+							state.SetViewports(reader.ReadSpan<Viewport>(), first);
+						}
+						break;
+					case GLCommandOp.SetCullMode:
+						state.SetCullMode(reader.Read<bool>(), reader.Read<GLFace>());
+						break;
+					case GLCommandOp.SetDepthBoundsTestEnable:
+						state.SetDepthBoundsTestEnable(reader.Read<bool>());
+						break;
+					case GLCommandOp.SetDepthCompareOp:
+						state.SetDepthCompareOp(reader.Read<GLCompareFunc>());
+						break;
+					case GLCommandOp.SetDepthTestEnable:
+						state.SetDepthTestEnable(reader.Read<bool>());
+						break;
+					case GLCommandOp.SetDepthWriteEnable:
+						state.SetDepthWriteEnable(reader.Read<bool>());
+						break;
+					case GLCommandOp.SetFrontFace:
+						state.SetFrontFace(reader.Read<GLCullFace>());
+						break;
+					case GLCommandOp.SetDrawMode:
+						state.SetDrawMode(reader.Read<GLDrawMode>());
+						break;
+					case GLCommandOp.SetStencilOp:
+						state.SetStencilOp(reader.Read<GLFace>(), reader.Read<GLPipeline.StencilOpState>());
+						break;
+					case GLCommandOp.SetStencilTestEnable:
+						state.SetStencilTestEnable(reader.Read<bool>());
+						break;
+					case GLCommandOp.SetDepthBiasEnable:
+						state.SetDepthBiasEnable(reader.Read<bool>());
+						break;
+					case GLCommandOp.SetLogicOp:
+						state.SetLogicOp(reader.Read<GLLogicOp>());
+						break;
+					case GLCommandOp.SetPatchControlPoints:
+						state.SetPatchControlPoints(reader.Read<uint>());
+						break;
+					case GLCommandOp.SetPrimitiveRestartEnable:
+						state.SetPrimitiveRestartEnable(reader.Read<bool>());
+						break;
+					case GLCommandOp.SetRasterizerDiscardEnable:
+						state.SetRasterizerDiscardEnable(reader.Read<bool>());
+						break;
+					case GLCommandOp.SetColorWriteEnable:
+						state.SetColorWriteEnable(reader.ReadSpan<bool>());
+						break;
+					case GLCommandOp.UpdateBuffer: {
+							uint buffer = reader.ReadObject<GLBuffer>().ID;
+							nint offset = reader.Read<nint>();
+							var data = reader.ReadSpan<byte>();
+							unsafe {
+								fixed (byte* pData = data) {
+									iface.BufferSubData(buffer, offset, data.Length, (IntPtr)pData);
+								}
+							}
+						}
+						break;
+					default:
+						throw new GLException("Invalid command in command stream");
+				}
+			}
 		}
 
 		public void Barrier(in ICommandSink.PipelineBarriers barriers) {
@@ -81,17 +266,12 @@ namespace Tesseract.OpenGL.Graphics {
 		}
 
 		public void BeginRenderPass(in ICommandSink.RenderPassBegin begin, SubpassContents contents) {
-			if (indirect != null) {
-				IRenderPass renderPass = begin.RenderPass;
-				IFramebuffer framebuffer = begin.Framebuffer;
-				Recti renderArea = begin.RenderArea;
-				ICommandSink.ClearValue[] clearValues = begin.ClearValues.ToArray();
-				indirect(() => Graphics.State.BeginRenderPass(new ICommandSink.RenderPassBegin() {
-					RenderPass = renderPass,
-					Framebuffer = framebuffer,
-					RenderArea = renderArea,
-					ClearValues = clearValues
-				}));
+			if (stream != null) {
+				stream.Write(GLCommandOp.BeginRenderPass);
+				stream.WriteObject(begin.RenderPass);
+				stream.WriteObject(begin.Framebuffer);
+				stream.Write(begin.RenderArea);
+				stream.WriteList(begin.ClearValues);
 			} else {
 				Graphics.State.BeginRenderPass(begin);
 			}
@@ -99,8 +279,10 @@ namespace Tesseract.OpenGL.Graphics {
 
 		public void BindPipeline(IPipeline pipeline) {
 			GLPipeline glpipeline = (GLPipeline)pipeline;
-			if (indirect != null) indirect(() => Graphics.State.BindPipeline(glpipeline));
-			else Graphics.State.BindPipeline(glpipeline);
+			if (stream != null) {
+				stream.Write(GLCommandOp.BindPipeline);
+				stream.WriteObject(glpipeline);
+			} else Graphics.State.BindPipeline(glpipeline);
 		}
 
 		public void BindPipelineWithState(IPipelineSet set, PipelineDynamicCreateInfo state) {
@@ -123,28 +305,12 @@ namespace Tesseract.OpenGL.Graphics {
 			if (glset.IsVariable(PipelineDynamicState.DepthBoundsTestEnable)) SetDepthBoundsTestEnable(state.DepthBoundsTestEnable);
 			if (glset.IsVariable(PipelineDynamicState.StencilTestEnable)) SetStencilTestEnable(state.StencilTestEnable);
 			if (glset.IsVariable(PipelineDynamicState.StencilReference)) {
-				var reference = ((int)state.FrontStencilState.Reference, (int)state.BackStencilState.Reference);
-				if (indirect != null) {
-					indirect(() => {
-						Graphics.State.SetStencilReference(GLFace.Front, reference.Item1);
-						Graphics.State.SetStencilReference(GLFace.Back, reference.Item2);
-					});
-				} else {
-					Graphics.State.SetStencilReference(GLFace.Front, reference.Item1);
-					Graphics.State.SetStencilReference(GLFace.Back, reference.Item2);
-				}
+				SetStencilReference(CullFace.Front, state.FrontStencilState.Reference);
+				SetStencilReference(CullFace.Back, state.BackStencilState.Reference);
 			}
 			if (glset.IsVariable(PipelineDynamicState.StencilCompareMask)) {
-				var mask = (state.FrontStencilState.CompareMask, state.BackStencilState.CompareMask);
-				if (indirect != null) {
-					indirect(() => {
-						Graphics.State.SetStencilCompareMask(GLFace.Front, mask.Item1);
-						Graphics.State.SetStencilCompareMask(GLFace.Back, mask.Item2);
-					});
-				} else {
-					Graphics.State.SetStencilCompareMask(GLFace.Front, mask.Item1);
-					Graphics.State.SetStencilCompareMask(GLFace.Back, mask.Item2);
-				}
+				SetStencilCompareMask(CullFace.Front, state.FrontStencilState.CompareMask);
+				SetStencilCompareMask(CullFace.Back, state.BackStencilState.CompareMask);
 			}
 			if (glset.IsVariable(PipelineDynamicState.StencilOp)) {
 				var front = state.FrontStencilState;
@@ -153,16 +319,8 @@ namespace Tesseract.OpenGL.Graphics {
 				SetStencilOp(CullFace.Back, back.FailOp, back.PassOp, back.DepthFailOp, back.CompareOp);
 			}
 			if (glset.IsVariable(PipelineDynamicState.StencilWriteMask)) {
-				var mask = (state.FrontStencilState.WriteMask, state.BackStencilState.WriteMask);
-				if (indirect != null) {
-					indirect(() => {
-						Graphics.State.SetStencilWriteMask(GLFace.Front, mask.Item1);
-						Graphics.State.SetStencilWriteMask(GLFace.Back, mask.Item2);
-					});
-				} else {
-					Graphics.State.SetStencilWriteMask(GLFace.Front, mask.Item1);
-					Graphics.State.SetStencilWriteMask(GLFace.Back, mask.Item2);
-				}
+				SetStencilWriteMask(CullFace.Front, state.FrontStencilState.WriteMask);
+				SetStencilWriteMask(CullFace.Back, state.BackStencilState.WriteMask);
 			}
 
 			if (glset.IsVariable(PipelineDynamicState.DepthBounds)) SetDepthBounds(state.DepthBounds.Min, state.DepthBounds.Max);
@@ -172,8 +330,10 @@ namespace Tesseract.OpenGL.Graphics {
 
 		public void BindResources(PipelineType bindPoint, IPipelineLayout layout, IBindSet set) {
 			GLBindSet glset = (GLBindSet)set;
-			if (indirect != null) indirect(glset.Bind);
-			else glset.Bind();
+			if (stream != null) {
+				stream.Write(GLCommandOp.BindResources);
+				stream.WriteObject(glset);
+			} else glset.Bind();
 		}
 
 		public void BindResources(PipelineType bindPoint, IPipelineLayout layout, IReadOnlyList<IBindSet> sets) {
@@ -182,8 +342,10 @@ namespace Tesseract.OpenGL.Graphics {
 
 		public void BindVertexArray(IVertexArray array) {
 			GLVertexArray glarray = (GLVertexArray)array;
-			if (indirect != null) indirect(() => Graphics.State.BindVertexArray(glarray));
-			else Graphics.State.BindVertexArray(glarray);
+			if (stream != null) {
+				stream.Write(GLCommandOp.BindVertexArray);
+				stream.WriteObject(glarray);
+			} else Graphics.State.BindVertexArray(glarray);
 		}
 
 		public void BlitFramebuffer(IFramebuffer dst, int dstAttachment, TextureLayout dstLayout, Recti dstArea, IFramebuffer src, int srcAttachment, TextureLayout srcLayout, Recti srcArea, TextureAspect aspect, TextureFilter filter) {
@@ -248,10 +410,10 @@ namespace Tesseract.OpenGL.Graphics {
 		}
 
 		public void ClearAttachments(in ReadOnlySpan<ICommandSink.ClearAttachment> values, in ReadOnlySpan<ICommandSink.ClearRect> regions) {
-			if (indirect != null) {
-				var values2 = values.ToArray();
-				var regions2 = regions.ToArray();
-				indirect(() => ClearAttachmentsImpl(values2, regions2));
+			if (stream != null) {
+				stream.Write(GLCommandOp.ClearAttachments);
+				stream.WriteSpan(values);
+				stream.WriteSpan(regions);
 			} else ClearAttachmentsImpl(values, regions);
 		}
 
@@ -280,9 +442,11 @@ namespace Tesseract.OpenGL.Graphics {
 				Aspect = TextureAspect.Color,
 				Color = color
 			};
-			if (indirect != null) {
-				var regions2 = regions.ToArray();
-				indirect(() => ClearColorTextureImpl(gldst, value, regions2));
+			if (stream != null) {
+				stream.Write(GLCommandOp.ClearColorTexture);
+				stream.WriteObject(gldst);
+				stream.Write(value);
+				stream.WriteSpan(regions);
 			} else ClearColorTextureImpl(gldst, value, regions);
 		}
 
@@ -313,9 +477,11 @@ namespace Tesseract.OpenGL.Graphics {
 				Stencil = stencil
 			};
 			if ((value.Aspect & TextureAspect.Color) != 0) return;
-			if (indirect != null) {
-				var regions2 = regions.ToArray();
-				indirect(() => ClearDepthStencilTextureImpl(gldst, value, regions2));
+			if (stream != null) {
+				stream.Write(GLCommandOp.ClearDepthStencilTexture);
+				stream.WriteObject(gldst);
+				stream.Write(value);
+				stream.WriteSpan(regions);
 			} else ClearDepthStencilTextureImpl(gldst, value, regions);
 		}
 
@@ -326,9 +492,11 @@ namespace Tesseract.OpenGL.Graphics {
 
 		public void CopyBuffer(IBuffer dst, IBuffer src, in ReadOnlySpan<ICommandSink.CopyBufferRegion> regions) {
 			GLBuffer gldst = (GLBuffer)dst, glsrc = (GLBuffer)src;
-			if (indirect != null) {
-				var regions2 = regions.ToArray();
-				indirect(() => CopyBufferImpl(gldst, glsrc, regions2));
+			if (stream != null) {
+				stream.Write(GLCommandOp.CopyBuffer);
+				stream.WriteObject(gldst);
+				stream.WriteObject(glsrc);
+				stream.WriteSpan(regions);
 			} else CopyBufferImpl(gldst, glsrc, regions);
 		}
 
@@ -372,26 +540,35 @@ namespace Tesseract.OpenGL.Graphics {
 		public void CopyBufferToTexture(ITexture dst, TextureLayout dstLayout, IBuffer src, in ReadOnlySpan<ICommandSink.CopyBufferTexture> copies) {
 			GLTexture gldst = (GLTexture)dst;
 			GLBuffer glsrc = (GLBuffer)src;
-			if (indirect != null) {
-				var copies2 = copies.ToArray();
-				indirect(() => CopyBufferToTextureImpl(gldst, glsrc, copies2));
+			if (stream != null) {
+				stream.Write(GLCommandOp.CopyBufferToTexture);
+				stream.WriteObject(gldst);
+				stream.WriteObject(glsrc);
+				stream.WriteSpan(copies);
 			} else CopyBufferToTextureImpl(gldst, glsrc, copies);
 		}
 
-		public void CopyTexture(ITexture dst, TextureLayout dstLayout, ITexture src, TextureLayout srcLayout, in ReadOnlySpan<ICommandSink.CopyTextureRegion> regions) {
-			GLTexture gldst = (GLTexture)dst, glsrc = (GLTexture)src;
+		private void CopyTextureImpl(GLTexture gldst, GLTexture glsrc, in ReadOnlySpan<ICommandSink.CopyTextureRegion> regions) {
 			foreach (var region in regions) {
 				Vector3i srcoffset = (Vector3i)region.SrcOffset, dstoffset = (Vector3i)region.DstOffset;
 				SubresourceToOffset(glsrc, region.SrcSubresource, ref srcoffset);
 				SubresourceToOffset(gldst, region.DstSubresource, ref dstoffset);
 				int dstMipLevel = (int)region.DstSubresource.MipLevel;
 				int srcMipLevel = (int)region.SrcSubresource.MipLevel;
-				Vector3i size = (Vector3i)region.Size;
-				if (indirect != null) indirect(() => Interface.CopyImageSubData(gldst, dstMipLevel, dstoffset, glsrc, srcMipLevel, srcoffset, size));
-				else Interface.CopyImageSubData(gldst, dstMipLevel, dstoffset, gldst, dstMipLevel, dstoffset, size);
+				Interface.CopyImageSubData(gldst, dstMipLevel, dstoffset, glsrc, srcMipLevel, srcoffset, (Vector3i)region.Size);
 			}
 		}
 
+		public void CopyTexture(ITexture dst, TextureLayout dstLayout, ITexture src, TextureLayout srcLayout, in ReadOnlySpan<ICommandSink.CopyTextureRegion> regions) {
+			GLTexture gldst = (GLTexture)dst, glsrc = (GLTexture)src;
+			if (stream != null) {
+				stream.Write(GLCommandOp.CopyTexture);
+				stream.WriteObject(gldst);
+				stream.WriteObject(glsrc);
+				stream.WriteSpan(regions);
+			} else CopyTextureImpl(gldst, glsrc, regions);
+		}
+
 		private void CopyTextureToBufferImpl(GLTexture glsrc, GLBuffer gldst, in ReadOnlySpan<ICommandSink.CopyBufferTexture> copies) {
 			var state = Graphics.State;
 			state.BindBuffer(GLBufferTarget.PixelPack, gldst.ID);
@@ -418,50 +595,78 @@ namespace Tesseract.OpenGL.Graphics {
 				}
 			}
 
-			if (indirect != null) {
-				var copies2 = copies.ToArray();
-				indirect(() => CopyTextureToBufferImpl(glsrc, gldst, copies2));
+			if (stream != null) {
+				stream.Write(GLCommandOp.CopyTextureToBuffer);
+				stream.WriteObject(glsrc);
+				stream.WriteObject(gldst);
+				stream.WriteSpan(copies);
 			} else CopyTextureToBufferImpl(glsrc, gldst, copies);
 		}
 
 		public void Dispatch(Vector3ui groupCounts) {
-			if (indirect != null) indirect(() => Interface.Dispatch(groupCounts));
-			else Interface.Dispatch(groupCounts);
+			if (stream != null) {
+				stream.Write(GLCommandOp.Dispatch);
+				stream.Write(groupCounts);
+			} else Interface.Dispatch(groupCounts);
 		}
 
 		public void DispatchIndirect(IBuffer buffer, nuint offset) {
 			GLBuffer glbuffer = (GLBuffer)buffer;
-			if (indirect != null) indirect(() => Interface.DispatchIndirect(glbuffer.ID, (nint)offset));
-			else Interface.DispatchIndirect(glbuffer.ID, (nint)offset);
+			if (stream != null) {
+				stream.Write(GLCommandOp.DispatchIndirect);
+				stream.WriteObject(glbuffer);
+				stream.Write((nint)offset);
+			} else Interface.DispatchIndirect(glbuffer.ID, (nint)offset);
 		}
 
 		public void Draw(uint vertexCount, uint instanceCount, uint firstVertex, uint firstInstance) {
-			if (indirect != null) indirect(() => Interface.Draw(vertexCount, instanceCount, firstVertex, firstInstance));
-			else Interface.Draw(vertexCount, instanceCount, firstVertex, firstInstance);
+			if (stream != null) {
+				stream.Write(GLCommandOp.Draw);
+				stream.Write(vertexCount);
+				stream.Write(instanceCount);
+				stream.Write(firstVertex);
+				stream.Write(firstInstance);
+			} else Interface.Draw(vertexCount, instanceCount, firstVertex, firstInstance);
 		}
 
 		public void DrawIndexed(uint indexCount, uint instanceCount, uint firstIndex, int vertexOffset, uint firstInstance) {
-			if (indirect != null) indirect(() => Interface.DrawIndexed(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance));
-			else Interface.DrawIndexed(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+			if (stream != null) {
+				stream.Write(GLCommandOp.DrawIndexed);
+				stream.Write(indexCount);
+				stream.Write(instanceCount);
+				stream.Write(firstIndex);
+				stream.Write(vertexOffset);
+				stream.Write(firstInstance);
+			} else Interface.DrawIndexed(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
 		}
 
 		public void DrawIndexedIndirect(IBuffer buffer, nuint offset, uint drawCount, uint stride = DrawIndexedParams.SizeOf) {
 			GLBuffer glbuffer = (GLBuffer)buffer;
-			if (indirect != null) indirect(() => Interface.DrawIndexedIndirect(glbuffer.ID, (nint)offset, (int)drawCount, (int)stride));
-			else Interface.DrawIndexedIndirect(glbuffer.ID, (nint)offset, (int)drawCount, (int)stride);
+			if (stream != null) {
+				stream.Write(GLCommandOp.DrawIndexedIndirect);
+				stream.WriteObject(glbuffer);
+				stream.Write((nint)offset);
+				stream.Write((int)drawCount);
+				stream.Write((int)stride);
+			} else Interface.DrawIndexedIndirect(glbuffer.ID, (nint)offset, (int)drawCount, (int)stride);
 		}
 
 		public void DrawIndirect(IBuffer buffer, nuint offset, uint drawCount, uint stride = DrawParams.SizeOf) {
 			GLBuffer glbuffer = (GLBuffer)buffer;
-			if (indirect != null) indirect(() => Interface.DrawIndirect(glbuffer.ID, (nint)offset, (int)drawCount, (int)stride));
-			else Interface.DrawIndirect(glbuffer.ID, (nint)offset, (int)drawCount, (int)stride);
+			if (stream != null) {
+				stream.Write(GLCommandOp.DrawIndirect);
+				stream.WriteObject(glbuffer);
+				stream.Write((nint)offset);
+				stream.Write((int)drawCount);
+				stream.Write((int)stride);
+			} else Interface.DrawIndirect(glbuffer.ID, (nint)offset, (int)drawCount, (int)stride);
 		}
 
 		// TODO
 		public void EndRendering() { }
 
 		public void EndRenderPass() {
-			if (indirect != null) indirect(Graphics.State.EndRenderPass);
+			if (stream != null) stream.Write(GLCommandOp.EndRenderPass);
 			else Graphics.State.EndRenderPass();
 		}
 
@@ -471,25 +676,36 @@ namespace Tesseract.OpenGL.Graphics {
 
 		public void ExecuteCommands(ICommandBuffer buffer) {
 			GLCommandBuffer glbuffer = (GLCommandBuffer)buffer;
-			if (indirect != null) indirect(glbuffer.RunCommands);
-			else glbuffer.RunCommands();
+			if (stream != null) {
+				stream.Write(GLCommandOp.ExecuteCommands);
+				stream.WriteObject(glbuffer);
+			} else glbuffer.RunCommands();
 		}
 
 		public void FillBufferUInt32(IBuffer dst, nuint dstOffset, nuint dstSize, uint data) {
 			GLBuffer gldst = (GLBuffer)dst;
-			if (indirect != null) indirect(() => Interface.FillBufferUInt32(gldst.ID, (nint)dstOffset, (nint)dstSize, data));
-			else Interface.FillBufferUInt32(gldst.ID, (nint)dstOffset, (nint)dstSize, data);
+			if (stream != null) {
+				stream.Write(GLCommandOp.FillBufferUInt32);
+				stream.WriteObject(gldst);
+				stream.Write((nint)dstOffset);
+				stream.Write((nint)dstSize);
+				stream.Write(data);
+			} else Interface.FillBufferUInt32(gldst.ID, (nint)dstOffset, (nint)dstSize, data);
 		}
 
 		public void GenerateMipmaps(ITexture dst, TextureLayout initialLayout, TextureLayout finalLayout, TextureFilter? filter = null) {
 			if (dst.MipLevels < 2) return;
 			GLTexture gldst = (GLTexture)dst;
-			if (indirect != null) indirect(() => Interface.GenerateMipmaps(gldst, filter != null ? GLEnums.Convert(filter.Value) : null));
-			else Interface.GenerateMipmaps(gldst, filter != null ? GLEnums.Convert(filter.Value) : null);
+			if (stream != null) {
+				stream.Write(GLCommandOp.GenerateMipmaps);
+				stream.WriteObject(gldst);
+				stream.Write(filter != null);
+				stream.Write(filter != null ? GLEnums.Convert(filter.Value) : default);
+			} else Interface.GenerateMipmaps(gldst, filter != null ? GLEnums.Convert(filter.Value) : null);
 		}
 
 		public void NextSubpass(SubpassContents contents) {
-			if (indirect != null) indirect(Graphics.State.NextSubpass);
+			if (stream != null) stream.Write(GLCommandOp.NextSubpass);
 			else Graphics.State.NextSubpass();
 		}
 
@@ -519,15 +735,19 @@ namespace Tesseract.OpenGL.Graphics {
 
 		public void ResolveTexture(ITexture dst, TextureLayout dstLayout, ITexture src, TextureLayout srcLayout, in ReadOnlySpan<ICommandSink.CopyTextureRegion> regions) {
 			GLTexture gldst = (GLTexture)dst, glsrc = (GLTexture)src;
-			if (indirect != null) {
-				var regions2 = regions.ToArray();
-				indirect(() => ResolveTextureImpl(gldst, glsrc, regions2));
+			if (stream != null) {
+				stream.Write(GLCommandOp.ResolveTexture);
+				stream.WriteObject(gldst);
+				stream.WriteObject(glsrc);
+				stream.WriteSpan(regions);
 			} else ResolveTextureImpl(gldst, glsrc, regions);
 		}
 
 		public void SetBlendConstants(Vector4 blendConst) {
-			if (indirect != null) indirect(() => Graphics.State.SetBlendConstants(blendConst));
-			else Graphics.State.SetBlendConstants(blendConst);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetBlendConstants);
+				stream.Write(blendConst);
+			} else Graphics.State.SetBlendConstants(blendConst);
 		}
 
 		public void SetDepthBias(float constFactor, float clamp, float slopeFactor) {
@@ -536,95 +756,128 @@ namespace Tesseract.OpenGL.Graphics {
 				SlopeFactor = slopeFactor,
 				Clamp = clamp
 			};
-			if (indirect != null) indirect(() => Graphics.State.SetDepthBias(biasFactors));
-			else Graphics.State.SetDepthBias(biasFactors);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetDepthBias);
+				stream.Write(biasFactors);
+			} else Graphics.State.SetDepthBias(biasFactors);
 		}
 
 		public void SetDepthBounds(float min, float max) {
-			if (indirect != null) indirect(() => Graphics.State.SetDepthBounds(min, max));
-			else Graphics.State.SetDepthBounds(min, max);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetDepthBounds);
+				stream.Write(min);
+				stream.Write(max);
+			} else Graphics.State.SetDepthBounds(min, max);
 		}
 
 		public void SetLineWidth(float lineWidth) {
-			if (indirect != null) indirect(() => Graphics.State.SetLineWidth(lineWidth));
-			else Graphics.State.SetLineWidth(lineWidth);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetLineWidth);
+				stream.Write(lineWidth);
+			} else Graphics.State.SetLineWidth(lineWidth);
 		}
 
 		public void SetScissors(in ReadOnlySpan<Recti> scissors, uint firstScissor = 0) {
-			if (indirect != null) {
-				Recti[] scissors2 = scissors.ToArray();
-				indirect(() => Graphics.State.SetScissors(scissors2, firstScissor));
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetScissors);
+				stream.Write(firstScissor);
+				stream.WriteSpan(scissors);
 			} else Graphics.State.SetScissors(scissors, firstScissor);
 		}
 
 		public void SetStencilCompareMask(CullFace face, uint compareMask) {
 			if (face == CullFace.None) return;
 			var glface = GLEnums.Convert(face);
-			if (indirect != null) indirect(() => Graphics.State.SetStencilCompareMask(glface, compareMask));
-			else Graphics.State.SetStencilCompareMask(glface, compareMask);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetStencilCompareMask);
+				stream.Write(glface);
+				stream.Write(compareMask);
+			} else Graphics.State.SetStencilCompareMask(glface, compareMask);
 		}
 
 		public void SetStencilReference(CullFace face, uint reference) {
 			if (face == CullFace.None) return;
 			var glface = GLEnums.Convert(face);
-			if (indirect != null) indirect(() => Graphics.State.SetStencilReference(glface, (int)reference));
-			else Graphics.State.SetStencilReference(glface, (int)reference);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetStencilReference);
+				stream.Write(glface);
+				stream.Write((int)reference);
+			} else Graphics.State.SetStencilReference(glface, (int)reference);
 		}
 
 		public void SetStencilWriteMask(CullFace face, uint writeMask) {
 			if (face == CullFace.None) return;
 			var glface = GLEnums.Convert(face);
-			if (indirect != null) indirect(() => Graphics.State.SetStencilWriteMask(glface, writeMask));
-			else Graphics.State.SetStencilWriteMask(glface, writeMask);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetStencilWriteMask);
+				stream.Write(glface);
+				stream.Write(writeMask);
+			} else Graphics.State.SetStencilWriteMask(glface, writeMask);
 		}
 
 		public void SetSync(ISync dst, PipelineStage stage) => throw new GLException("SetSync is unsupported on OpenGL");
 
 		public void SetViewports(in ReadOnlySpan<Viewport> viewports, uint firstViewport = 0) {
 			if (viewports.Length == 0) return;
-			if (indirect != null) {
-				Viewport[] viewports2 = viewports.ToArray();
-				indirect(() => Graphics.State.SetViewports(viewports2, firstViewport));
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetViewports);
+				stream.Write(firstViewport);
+				stream.WriteSpan(viewports);
 			} else Graphics.State.SetViewports(viewports, firstViewport);
 		}
 
 		public void SetCullMode(CullFace culling) {
 			GLFace face = GLEnums.Convert(culling);
-			if (indirect != null) indirect(() => Graphics.State.SetCullMode(culling != CullFace.None, face));
-			else Graphics.State.SetCullMode(culling != CullFace.None, face);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetCullMode);
+				stream.Write(culling != CullFace.None);
+				stream.Write(face);
+			} else Graphics.State.SetCullMode(culling != CullFace.None, face);
 		}
 
 		public void SetDepthBoundsTestEnable(bool enabled) {
-			if (indirect != null) indirect(() => Graphics.State.SetDepthBoundsTestEnable(enabled));
-			else Graphics.State.SetDepthBoundsTestEnable(enabled);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetDepthBoundsTestEnable);
+				stream.Write(enabled);
+			} else Graphics.State.SetDepthBoundsTestEnable(enabled);
 		}
 
 		public void SetDepthCompareOp(CompareOp op) {
 			GLCompareFunc glop = GLEnums.Convert(op);
-			if (indirect != null) indirect(() => Graphics.State.SetDepthCompareOp(glop));
-			else Graphics.State.SetDepthCompareOp(glop);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetDepthCompareOp);
+				stream.Write(glop);
+			} else Graphics.State.SetDepthCompareOp(glop);
 		}
 
 		public void SetDepthTestEnable(bool enabled) {
-			if (indirect != null) indirect(() => Graphics.State.SetDepthTestEnable(enabled));
-			else Graphics.State.SetDepthTestEnable(enabled);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetDepthTestEnable);
+				stream.Write(enabled);
+			} else Graphics.State.SetDepthTestEnable(enabled);
 		}
 
 		public void SetDepthWriteEnable(bool enabled) {
-			if (indirect != null) indirect(() => Graphics.State.SetDepthWriteEnable(enabled));
-			else Graphics.State.SetDepthWriteEnable(enabled);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetDepthWriteEnable);
+				stream.Write(enabled);
+			} else Graphics.State.SetDepthWriteEnable(enabled);
 		}
 
 		public void SetFrontFace(FrontFace face) {
 			GLCullFace glface = GLEnums.Convert(face);
-			if (indirect != null) indirect(() => Graphics.State.SetFrontFace(glface));
-			else Graphics.State.SetFrontFace(glface);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetFrontFace);
+				stream.Write(glface);
+			} else Graphics.State.SetFrontFace(glface);
 		}
 
 		public void SetDrawMode(DrawMode mode) {
 			GLDrawMode glmode = GLEnums.Convert(mode);
-			if (indirect != null) indirect(() => Graphics.State.SetDrawMode(glmode));
-			else Graphics.State.SetDrawMode(glmode);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetDrawMode);
+				stream.Write(glmode);
+			} else Graphics.State.SetDrawMode(glmode);
 		}
 
 		public void SetScissorsWithCount(in ReadOnlySpan<Recti> scissors) => SetScissors(scissors);
@@ -638,78 +891,83 @@ namespace Tesseract.OpenGL.Graphics {
 				CompareOp = GLEnums.ConvertStencilFunc(compareOp)
 			};
 			GLFace glfaces = GLEnums.Convert(faces);
-			if (indirect != null) indirect(() => Graphics.State.SetStencilOp(glfaces, state));
-			else Graphics.State.SetStencilOp(glfaces, state);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetStencilOp);
+				stream.Write(glfaces);
+				stream.Write(state);
+			} else Graphics.State.SetStencilOp(glfaces, state);
 		}
 
 		public void SetStencilTestEnable(bool enabled) {
-			if (indirect != null) indirect(() => Graphics.State.SetStencilTestEnable(enabled));
-			else Graphics.State.SetStencilTestEnable(enabled);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetStencilTestEnable);
+				stream.Write(enabled);
+			} else Graphics.State.SetStencilTestEnable(enabled);
 		}
 
 		public void SetViewportsWithCount(in ReadOnlySpan<Viewport> viewports) => SetViewports(viewports);
 
 		public void SetDepthBiasEnable(bool enabled) {
-			if (indirect != null) indirect(() => Graphics.State.SetDepthBiasEnable(enabled));
-			else Graphics.State.SetDepthBiasEnable(enabled);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetDepthBiasEnable);
+				stream.Write(enabled);
+			} else Graphics.State.SetDepthBiasEnable(enabled);
 		}
 
 		public void SetLogicOp(LogicOp op) {
 			GLLogicOp glop = GLEnums.Convert(op);
-			if (indirect != null) indirect(() => Graphics.State.SetLogicOp(glop));
-			else Graphics.State.SetLogicOp(glop);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetLogicOp);
+				stream.Write(glop);
+			} else Graphics.State.SetLogicOp(glop);
 		}
 
 		public void SetPatchControlPoints(uint controlPoints) {
-			if (indirect != null) indirect(() => Graphics.State.SetPatchControlPoints(controlPoints));
-			else Graphics.State.SetPatchControlPoints(controlPoints);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetPatchControlPoints);
+				stream.Write(controlPoints);
+			} else Graphics.State.SetPatchControlPoints(controlPoints);
 		}
 
 		public void SetPrimitiveRestartEnable(bool enabled) {
-			if (indirect != null) indirect(() => Graphics.State.SetPrimitiveRestartEnable(enabled));
-			else Graphics.State.SetPrimitiveRestartEnable(enabled);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetPrimitiveRestartEnable);
+				stream.Write(enabled);
+			} else Graphics.State.SetPrimitiveRestartEnable(enabled);
 		}
 
 		public void SetRasterizerDiscardEnable(bool enabled) {
-			if (indirect != null) indirect(() => Graphics.State.SetRasterizerDiscardEnable(enabled));
-			else Graphics.State.SetRasterizerDiscardEnable(enabled);
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetRasterizerDiscardEnable);
+				stream.Write(enabled);
+			} else Graphics.State.SetRasterizerDiscardEnable(enabled);
 		}
 
 		public void SetVertexFormat(VertexFormat format) { } // No-op, vertex specification is done via vertex arrays
 
 		public void SetColorWriteEnable(in ReadOnlySpan<bool> enables) {
-			if (indirect != null) {
-				bool[] enables2 = enables.ToArray();
-				indirect(() => Graphics.State.SetColorWriteEnable(enables2));
+			if (stream != null) {
+				stream.Write(GLCommandOp.SetColorWriteEnable);
+				stream.WriteSpan(enables);
 			} else Graphics.State.SetColorWriteEnable(enables);
 		}
 
 		public void UpdateBuffer(IBuffer dst, nuint dstOffset, nuint dstSize, IntPtr pData) {
 			GLBuffer gldst = (GLBuffer)dst;
-			if (indirect != null) {
-				byte[] data2 = new byte[dstSize];
-				MemoryUtil.Copy(data2, new UnmanagedPointer<byte>(pData), dstSize);
-				indirect(() => {
-					unsafe {
-						fixed(byte* pData2 = data2) {
-							Graphics.Interface.BufferSubData(gldst.ID, (nint)dstOffset, (nint)dstSize, (IntPtr)pData2);
-						}
-					}
-				});
+			if (stream != null) {
+				unsafe {
+					UpdateBuffer(dst, dstOffset, new ReadOnlySpan<byte>((void*)pData, checked((int)dstSize)));
+				}
 			} else Graphics.Interface.BufferSubData(gldst.ID, (nint)dstOffset, (nint)dstSize, pData);
 		}
 
 		public void UpdateBuffer<T>(IBuffer dst, nuint dstOffset, in ReadOnlySpan<T> data) where T : unmanaged {
 			GLBuffer gldst = (GLBuffer)dst;
-			if (indirect != null) {
-				T[] data2 = data.ToArray();
-				indirect(() => {
-					unsafe {
-						fixed(T* pData2 = data2) {
-							Graphics.Interface.BufferSubData(gldst.ID, (nint)dstOffset, data2.Length * sizeof(T), (IntPtr)pData2);
-						}
-					}
-				});
+			if (stream != null) {
+				stream.Write(GLCommandOp.UpdateBuffer);
+				stream.WriteObject(gldst);
+				stream.Write((nint)dstOffset);
+				stream.WriteSpan(MemoryMarshal.AsBytes(data));
 			} else {
 				unsafe {
 					fixed (T* pData = data) {
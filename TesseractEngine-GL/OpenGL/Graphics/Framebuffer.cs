@@ -148,7 +148,7 @@ namespace Tesseract.OpenGL.Graphics {
 		/// <summary>
 		/// Begins a render pass using this framebuffer.
 		/// </summary>
-		internal void BeginRenderPass(ICommandSink.RenderPassBegin beginInfo) {
+		internal void BeginRenderPass(Recti renderArea, ReadOnlySpan<ICommandSink.ClearValue> clearValues) {
 			var state = Graphics.State;
 			var renderPass = state.CurrentRenderPass;
 			if (renderPass == null) return;
@@ -166,7 +166,7 @@ namespace Tesseract.OpenGL.Graphics {
 			}
 
 			if (renderPass.ClearAttachments.Count > 0) {
-				state.SetTempScissor(beginInfo.RenderArea);
+				state.SetTempScissor(renderArea);
 				// For each attachment to clear in the render pass
 				foreach (int clearAttachment in renderPass.ClearAttachments) {
 					// Get the clear mapping
@@ -176,7 +176,7 @@ namespace Tesseract.OpenGL.Graphics {
 					if (AttachmentViews != null) format = AttachmentViews[clearAttachment].Format;
 					else if (clearAttachment == 1) format = PixelFormat.D32SFloatS8UInt;
 					// Clear the mapped framebuffer for the attachment
-					iface.ClearFramebuffer(clearID, clearFBAttachment, beginInfo.ClearValues[clearAttachment], format);
+					iface.ClearFramebuffer(clearID, clearFBAttachment, clearValues[clearAttachment], format);
 				}
 				state.UnsetTempScissor();
 			}
@@ -79,6 +79,8 @@ namespace Tesseract.OpenGL.Graphics {
 
 		public ThreadSafetyLevel APIThreadSafety => ThreadSafetyLevel.SingleThread;
 
+		public string PipelineCacheIdentifier { get; }
+
 		private readonly IGLGraphicsMemory memory;
 
 		public ulong TotalVideoMemory => memory.TotalVideoMemory;
@@ -94,6 +96,8 @@ namespace Tesseract.OpenGL.Graphics {
 		public GLGraphicsProperties(GL gl) {
 			RendererName = gl.GL11.GetString(Native.GLEnums.GL_RENDERER)!;
 			VendorName = gl.GL11.GetString(Native.GLEnums.GL_VENDOR)!;
+			// The version string includes the driver version, which program binaries depend on
+			PipelineCacheIdentifier = $"OpenGL:{VendorName}:{RendererName}:{gl.GL11.GetString(Native.GLEnums.GL_VERSION)}";
 
 			if (gl.WGLAMDGPUAssociation != null) memory = new WGLAMDGLGraphicsMemory(gl);
 			else if (gl.NVXGPUMemoryInfo) memory = new NVXGLGraphicsMemory(gl);
@@ -50,13 +50,13 @@ namespace Tesseract.OpenGL.Graphics {
 				switch(createInfo.SourceType) {
 					case ShaderSourceType.GLSL:
 						byteSource = ShaderSourceUtil.GetGLSL(createInfo.Source);
-						SourceHash = XXHash64.Compute(byteSource);
+						SourceHash = XXHash3.Compute64(byteSource);
 						gl33.ShaderSource(ID, byteSource);
 						break;
 					case ShaderSourceType.SPIRV:
 						if (es2c == null) throw new GLException("Cannot load SPIR-V shader source without GL_ARB_ES2_compatibility");
 						byteSource = MemoryMarshal.Cast<int, byte>(ShaderSourceUtil.GetSPIRV(createInfo.Source));
-						SourceHash = XXHash64.Compute(byteSource);
+						SourceHash = XXHash3.Compute64(byteSource);
 						es2c.ShaderBinary(stackalloc uint[] { ID }, Native.GLEnums.GL_SHADER_BINARY_FORMAT_SPIR_V_ARB, byteSource);
 
 						// Since its a binary we don't need to compile it
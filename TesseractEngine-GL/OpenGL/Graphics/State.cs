@@ -577,11 +577,23 @@ namespace Tesseract.OpenGL.Graphics {
 		/// </summary>
 		/// <param name="beginInfo">Render pass begin information</param>
 		public void BeginRenderPass(in ICommandSink.RenderPassBegin beginInfo) {
-			CurrentRenderPass = (GLRenderPass)beginInfo.RenderPass;
-			CurrentFramebuffer = (GLFramebuffer)beginInfo.Framebuffer;
-			CurrentRenderArea = beginInfo.RenderArea;
+			var clearValues = beginInfo.ClearValues as ICommandSink.ClearValue[] ?? beginInfo.ClearValues.ToArray();
+			BeginRenderPass(beginInfo.RenderPass, beginInfo.Framebuffer, beginInfo.RenderArea, clearValues);
+		}
+
+		/// <summary>
+		/// Begins a render pass.
+		/// </summary>
+		/// <param name="renderPass">The render pass to begin</param>
+		/// <param name="framebuffer">The framebuffer to render to</param>
+		/// <param name="renderArea">The area of the framebuffer to render to</param>
+		/// <param name="clearValues">The clear values for each attachment of the render pass</param>
+		public void BeginRenderPass(IRenderPass renderPass, IFramebuffer framebuffer, Recti renderArea, ReadOnlySpan<ICommandSink.ClearValue> clearValues) {
+			CurrentRenderPass = (GLRenderPass)renderPass;
+			CurrentFramebuffer = (GLFramebuffer)framebuffer;
+			CurrentRenderArea = renderArea;
 			CurrentSubpass = 0;
-			CurrentFramebuffer.BeginRenderPass(beginInfo);
+			CurrentFramebuffer.BeginRenderPass(renderArea, clearValues);
 			CurrentFramebuffer.BeginSubpass();
 		}
 
@@ -826,13 +838,25 @@ namespace Tesseract.OpenGL.Graphics {
 			}
 		}
 
-		public void SetViewports(in ReadOnlySpan<Viewport> viewports, uint first = 0) => Graphics.Interface.SetViewports(first, viewports);
+		private Viewport[] cachedViewports = Array.Empty<Viewport>();
+		private int cachedViewportCount = 0;
+		private uint cachedFirstViewport = 0;
+
+		public void SetViewports(in ReadOnlySpan<Viewport> viewports, uint first = 0) {
+			if (first == cachedFirstViewport && viewports.SequenceEqual(cachedViewports.AsSpan()[..cachedViewportCount])) return;
+			Graphics.Interface.SetViewports(first, viewports);
+			if (cachedViewports.Length < viewports.Length) cachedViewports = new Viewport[viewports.Length];
+			viewports.CopyTo(cachedViewports.AsSpan());
+			cachedViewportCount = viewports.Length;
+			cachedFirstViewport = first;
+		}
 
 		private Recti[] cachedScissors = Array.Empty<Recti>();
 		private int cachedScissorCount = 0;
 		private uint cachedFirstScissor = 0;
 
 		public void SetScissors(in ReadOnlySpan<Recti> scissors, uint first = 0) {
+			if (first == cachedFirstScissor && scissors.SequenceEqual(cachedScissors.AsSpan()[..cachedScissorCount])) return;
 			Graphics.Interface.SetScissors(first, scissors);
 			if (cachedScissors.Length < scissors.Length) cachedScissors = new Recti[scissors.Length];
 			scissors.CopyTo(cachedScissors.AsSpan());
@@ -1,6 +1,7 @@
 ﻿using System;
 using System.Collections.Generic;
 using System.Diagnostics;
+using System.Diagnostics.CodeAnalysis;
 using System.Linq;
 using System.Numerics;
 using System.Reflection;
@@ -41,10 +42,43 @@ namespace Tesseract.ImGui.Core {
 		/// </summary>
 		public bool PreserveFramebuffer { get; init; } = true;
 
+		/// <summary>
+		/// The number of frames which may be in flight at once. Each frame has its own fence, uniform buffer, and
+		/// region of the vertex and index buffers, so rendering only waits on the GPU once it is this many frames ahead.
+		/// </summary>
+		public int FramesInFlight { get; init; } = 2;
+
 		public ImGuiCoreRenderInfo() { }
 
 	}
 
+	/// <summary>
+	/// Statistics for a frame rendered by the core ImGui renderer.
+	/// </summary>
+	public readonly record struct ImGuiCoreRenderStats {
+
+		/// <summary>
+		/// The number of bytes of vertex, index, and uniform data uploaded for the frame.
+		/// </summary>
+		public ulong BytesUploaded { get; init; }
+
+		/// <summary>
+		/// The number of draw calls recorded for the frame.
+		/// </summary>
+		public int DrawCalls { get; init; }
+
+		/// <summary>
+		/// The time spent waiting on fences for the GPU to finish with the frame's resources.
+		/// </summary>
+		public TimeSpan FenceStallTime { get; init; }
+
+		/// <summary>
+		/// If the vertex or index buffers were reallocated for the frame, which requires waiting for every frame in flight.
+		/// </summary>
+		public bool Reallocated { get; init; }
+
+	}
+
 	/// <summary>
 	/// ImGui renderer implementation for the core graphics interface.
 	/// </summary>
@@ -119,7 +153,66 @@ namespace Tesseract.ImGui.Core {
 			public IGraphics Graphics { get; }
 			public ImGuiCoreRenderInfo Info { get; }
 
-			public ISync Fence { get; }
+			// Resources owned by a single frame in flight
+			public class Frame : IDisposable {
+
+				// Fence signaled when the GPU has finished with the frame
+				public ISync Fence { get; }
+				// If the frame has been submitted and its fence has not been waited on
+				public bool Pending { get; set; } = false;
+				// IDs of textures remapped while the frame was in flight, whose bind sets are updated when it is next recorded
+				public List<int> StaleTextureIDs { get; } = new();
+
+				public IBuffer UniformBuffer { get; }
+				public IPointer<Matrix4x4> UniformPtr { get; }
+
+				public ICommandBuffer? CommandBuffer { get; }
+				public ICommandBuffer[] CommandBuffers { get; } = Array.Empty<ICommandBuffer>();
+
+				public Frame(IGraphics graphics) {
+					Fence = graphics.CreateSync(new SyncCreateInfo() {
+						Direction = SyncDirection.GPUToHost,
+						Features = SyncFeatures.GPUWorkSignaling | SyncFeatures.HostWaiting,
+						Granularity = SyncGranularity.CommandBuffer
+					});
+
+					UniformBuffer = graphics.CreateBuffer(new BufferCreateInfo() {
+						Size = (ulong)Marshal.SizeOf<Matrix4x4>(),
+						Usage = BufferUsage.UniformBuffer,
+						MapFlags = MemoryMapFlags.Write | MemoryMapFlags.Persistent
+					});
+					UniformPtr = UniformBuffer.Map<Matrix4x4>(MemoryMapFlags.Write | MemoryMapFlags.Persistent);
+
+					if (graphics.Properties.PreferredCommandMode == CommandMode.Buffered) {
+						CommandBuffer = graphics.CreateCommandBuffer(new CommandBufferCreateInfo() {
+							Type = CommandBufferType.Primary,
+							Usage = CommandBufferUsage.Graphics | CommandBufferUsage.Rerecordable
+						});
+						CommandBuffers = new ICommandBuffer[] { CommandBuffer };
+					}
+				}
+
+				// Waits for the GPU to finish with the frame, returning the time spent waiting
+				public TimeSpan Wait() {
+					if (!Pending) return TimeSpan.Zero;
+					long start = Stopwatch.GetTimestamp();
+					Fence.HostWait(ulong.MaxValue);
+					Pending = false;
+					return Stopwatch.GetElapsedTime(start);
+				}
+
+				public void Dispose() {
+					GC.SuppressFinalize(this);
+					Wait();
+					Fence.Dispose();
+					UniformBuffer.Unmap();
+					UniformBuffer.Dispose();
+					CommandBuffer?.Dispose();
+				}
+
+			}
+
+			public Frame[] Frames { get; }
 
 			// Pipeline resources
 
@@ -142,10 +235,10 @@ namespace Tesseract.ImGui.Core {
 
 			public ITexture? FontTexture { get; set; } = null;
 
-			// Buffer resources
+			// Buffer resources, split into a region for each frame in flight
 
-			private int vertexCapacity = 10000;
-			private int indexCapacity = 10000;
+			public int VertexCapacity { get; private set; } = 10000;
+			public int IndexCapacity { get; private set; } = 10000;
 
 			public IBuffer VertexBuffer { get; private set; }
 			public IBuffer IndexBuffer { get; private set; }
@@ -155,23 +248,14 @@ namespace Tesseract.ImGui.Core {
 
 			public IVertexArray VertexArray { get; private set; }
 
-			public IBuffer UniformBuffer { get; }
-			public IPointer<Matrix4x4> UniformPtr { get; }
-
-
-			public ICommandBuffer? CommandBuffer { get; }
-			public ICommandBuffer[] CommandBuffers { get; } = Array.Empty<ICommandBuffer>();
-
 
 			public Resources(IGraphics graphics, ImGuiCoreRenderInfo info) {
 				Graphics = graphics;
 				Info = info;
-				
-				Fence = graphics.CreateSync(new SyncCreateInfo() {
-					Direction = SyncDirection.GPUToHost,
-					Features = SyncFeatures.GPUWorkSignaling | SyncFeatures.HostWaiting,
-					Granularity = SyncGranularity.CommandBuffer
-				});
+
+				if (info.FramesInFlight < 1) throw new ArgumentOutOfRangeException(nameof(info), "Must have at least one frame in flight");
+				Frames = new Frame[info.FramesInFlight];
+				for (int i = 0; i < Frames.Length; i++) Frames[i] = new Frame(graphics);
 
 				RenderPass = graphics.CreateRenderPass(new RenderPassCreateInfo() {
 					Attachments = new RenderPassAttachment[] {
@@ -269,92 +353,67 @@ namespace Tesseract.ImGui.Core {
 
 				Sampler = graphics.CreateSampler(new SamplerCreateInfo() { });
 
-				VertexBuffer = graphics.CreateBuffer(new BufferCreateInfo() {
-					Size = (ulong)(vertexCapacity * ImDrawVert.SizeOf),
+				CreateBuffers();
+			}
+
+			// Creates the vertex and index buffers and the vertex array using them
+			[MemberNotNull(nameof(VertexBuffer), nameof(IndexBuffer), nameof(Vertices), nameof(Indices), nameof(VertexArray))]
+			private void CreateBuffers() {
+				VertexBuffer = Graphics.CreateBuffer(new BufferCreateInfo() {
+					Size = (ulong)(VertexCapacity * Frames.Length * ImDrawVert.SizeOf),
 					Usage = BufferUsage.VertexBuffer,
 					MapFlags = MemoryMapFlags.Write | MemoryMapFlags.Persistent
 				});
 				Vertices = VertexBuffer.Map<ImDrawVert>(MemoryMapFlags.Write | MemoryMapFlags.Persistent);
 
-				IndexBuffer = graphics.CreateBuffer(new BufferCreateInfo() {
-					Size = (ulong)(indexCapacity * sizeof(ushort)),
+				IndexBuffer = Graphics.CreateBuffer(new BufferCreateInfo() {
+					Size = (ulong)(IndexCapacity * Frames.Length * sizeof(ushort)),
 					Usage = BufferUsage.IndexBuffer,
 					MapFlags = MemoryMapFlags.Write | MemoryMapFlags.Persistent
 				});
 				Indices = IndexBuffer.Map<ushort>(MemoryMapFlags.Write | MemoryMapFlags.Persistent);
 
-				VertexArray = graphics.CreateVertexArray(new VertexArrayCreateInfo() {
+				VertexArray = Graphics.CreateVertexArray(new VertexArrayCreateInfo() {
 					Format = vertexFormat,
 					VertexBuffers = new (BufferBinding Binding, uint Index)[] {
 						(new BufferBinding() { Buffer = VertexBuffer }, 0)
 					},
 					IndexBuffer = (new BufferBinding() { Buffer = IndexBuffer }, IndexType.UInt16)
 				});
+			}
 
-				UniformBuffer = graphics.CreateBuffer(new BufferCreateInfo() {
-					Size = (ulong)Marshal.SizeOf<Matrix4x4>(),
-					Usage = BufferUsage.UniformBuffer,
-					MapFlags = MemoryMapFlags.Write | MemoryMapFlags.Persistent
-				});
-				UniformPtr = UniformBuffer.Map<Matrix4x4>(MemoryMapFlags.Write | MemoryMapFlags.Persistent);
+			// Disposes of the vertex and index buffers and the vertex array
+			private void DisposeBuffers() {
+				VertexArray.Dispose();
+				VertexBuffer.Unmap();
+				VertexBuffer.Dispose();
+				IndexBuffer.Unmap();
+				IndexBuffer.Dispose();
+			}
 
-				if (graphics.Properties.PreferredCommandMode == CommandMode.Buffered) {
-					CommandBuffer = graphics.CreateCommandBuffer(new CommandBufferCreateInfo() {
-						Type = CommandBufferType.Primary,
-						Usage = CommandBufferUsage.Graphics | CommandBufferUsage.Rerecordable
-					});
-					CommandBuffers = new ICommandBuffer[] { CommandBuffer };
-				}
+			// Waits for every frame in flight to finish, returning the time spent waiting
+			public TimeSpan WaitAll() {
+				TimeSpan time = TimeSpan.Zero;
+				foreach (Frame frame in Frames) time += frame.Wait();
+				return time;
 			}
 
-			// Prepares the resources required for the given draw data
-			public void Prepare(IImDrawData drawData) {
+			// Prepares the resources required for the given draw data, returning if the buffers had to be reallocated
+			public bool Prepare(IImDrawData drawData, ref TimeSpan stallTime) {
 				// Rounds up count to avoid constant reallocation
 				static int RoundCount(int count) => (int)BitOperations.RoundUpToPowerOf2((uint)count);
 
-				bool recreateVertArray = false;
-
-				// Check vertex buffer size
 				int vertexCount = RoundCount(drawData.TotalVtxCount);
-				if (vertexCount > vertexCapacity) {
-					VertexBuffer.Unmap();
-					VertexBuffer.Dispose();
-					VertexBuffer = Graphics.CreateBuffer(new BufferCreateInfo() {
-						Size = (ulong)(vertexCount * ImDrawVert.SizeOf),
-						Usage = BufferUsage.VertexBuffer,
-						MapFlags = MemoryMapFlags.Write
-					});
-					Vertices = VertexBuffer.Map<ImDrawVert>(MemoryMapFlags.Write | MemoryMapFlags.Persistent);
-					vertexCapacity = vertexCount;
-					recreateVertArray = true;
-				}
-
-				// Check index buffer size
 				int indexCount = RoundCount(drawData.TotalIdxCount);
-				if (indexCount > indexCapacity) {
-					IndexBuffer.Unmap();
-					IndexBuffer.Dispose();
-					IndexBuffer = Graphics.CreateBuffer(new BufferCreateInfo() {
-						Size = (ulong)(indexCount * sizeof(ushort)),
-						Usage = BufferUsage.IndexBuffer,
-						MapFlags = MemoryMapFlags.Write
-					});
-					Indices = IndexBuffer.Map<ushort>(MemoryMapFlags.Write | MemoryMapFlags.Persistent);
-					indexCapacity = indexCount;
-					recreateVertArray = true;
-				}
-
-				// Recreate vertex array as needed
-				if (recreateVertArray) {
-					VertexArray.Dispose();
-					VertexArray = Graphics.CreateVertexArray(new VertexArrayCreateInfo() {
-						Format = vertexFormat,
-						VertexBuffers = new (BufferBinding Binding, uint Index)[] {
-							(new BufferBinding() { Buffer = VertexBuffer }, 0)
-						},
-						IndexBuffer = (new BufferBinding() { Buffer = IndexBuffer }, IndexType.UInt16)
-					});
-				}
+				if (vertexCount <= VertexCapacity && indexCount <= IndexCapacity) return false;
+
+				// Other frames may still be using the buffers, so they must finish before they are recreated
+				stallTime += WaitAll();
+				DisposeBuffers();
+				VertexCapacity = Math.Max(VertexCapacity, vertexCount);
+				IndexCapacity = Math.Max(IndexCapacity, indexCount);
+				CreateBuffers();
+				return true;
 			}
 
 			// Creates and maps the font texture
@@ -436,7 +495,8 @@ namespace Tesseract.ImGui.Core {
 			public void Dispose() {
 				GC.SuppressFinalize(this);
 
-				Fence.Dispose();
+				WaitAll();
+				foreach (Frame frame in Frames) frame.Dispose();
 
 				RenderPass.Dispose();
 
@@ -452,18 +512,9 @@ namespace Tesseract.ImGui.Core {
 
 				Sampler.Dispose();
 
-				VertexBuffer.Unmap();
-				VertexBuffer.Dispose();
-				IndexBuffer.Unmap();
-				IndexBuffer.Dispose();
-				VertexArray.Dispose();
-
-				UniformBuffer.Unmap();
-				UniformBuffer.Dispose();
+				DisposeBuffers();
 
 				FontTexture?.Dispose();
-
-				CommandBuffer?.Dispose();
 			}
 		}
 
@@ -478,6 +529,14 @@ namespace Tesseract.ImGui.Core {
 		// If the renderer has rendered at least one frame
 		private static bool hasRenderedFrame = false;
 
+		// The index of the frame in flight to use for the next frame
+		private static int frameIndex = 0;
+
+		/// <summary>
+		/// Statistics for the most recently rendered frame.
+		/// </summary>
+		public static ImGuiCoreRenderStats LastFrameStats { get; private set; }
+
 		/// <summary>
 		/// Initializes the core ImGui renderer using the given information.
 		/// </summary>
@@ -497,15 +556,32 @@ namespace Tesseract.ImGui.Core {
 			resources?.Dispose();
 			resources = null;
 
+			recycledTextureIDs.Clear();
+			textures.Clear();
+			bindSets.Clear();
+
 			hasRenderedFrame = false;
+			frameIndex = 0;
+			LastFrameStats = default;
 		}
 
 		// The list of texture IDs which have been recycled
 		private static readonly List<int> recycledTextureIDs = new();
 		// The list of mapped textures
 		private static readonly List<ITexture?> textures = new();
-		// The list of bind sets containing mapped textures
-		private static readonly List<IBindSet> bindSets = new();
+		// The list of bind sets containing mapped textures, with a set for each frame in flight
+		private static readonly List<IBindSet[]> bindSets = new();
+
+		// Creates a bind set write for the texture sampler binding
+		private static BindSetWrite CreateTextureWrite(ITexture texture) => new() {
+			Binding = resources!.BindingTexture.Binding,
+			Type = BindType.CombinedTextureSampler,
+			TextureInfo = new TextureBinding() {
+				Sampler = resources.Sampler,
+				TexureLayout = TextureLayout.ShaderSampled,
+				TextureView = texture.IdentityView
+			}
+		};
 
 		/// <summary>
 		/// Maps a texture for use with ImGui.
@@ -518,39 +594,34 @@ namespace Tesseract.ImGui.Core {
 			if (recycledTextureIDs.Count > 0) {
 				id = recycledTextureIDs[0];
 				recycledTextureIDs.RemoveAt(0);
-				// Update texture and bind set
+				// Update texture and bind sets, deferring the sets of frames the GPU may still be using
 				textures[id] = texture;
-				bindSets[id].Update(new BindSetWrite() {
-					TextureInfo = new TextureBinding() {
-						Sampler = resources!.Sampler,
-						TexureLayout = TextureLayout.ShaderSampled,
-						TextureView = texture.IdentityView
-					}
-				});
+				var frames = resources!.Frames;
+				for (int i = 0; i < frames.Length; i++) {
+					if (frames[i].Pending) frames[i].StaleTextureIDs.Add(id);
+					else bindSets[id][i].Update(CreateTextureWrite(texture));
+				}
 			} else {
-				// Else add a new texture and bind set
+				// Else add a new texture and bind sets, each using the uniform buffer of its frame
 				id = textures.Count;
 				textures.Add(texture);
-				var set = resources!.BindPool.AllocSet(new BindSetAllocateInfo() {
-					Layouts = new IBindSetLayout[] { resources!.BindSetLayout }
-				});
-				set.Update(
-					new BindSetWrite() {
-						Binding = resources.BindingGlobals.Binding,
-						Type = BindType.UniformBuffer,
-						BufferInfo = new BufferBinding() { Buffer = resources!.UniformBuffer },
-					},
-					new	BindSetWrite() {
-						Binding = resources.BindingTexture.Binding,
-						Type = BindType.CombinedTextureSampler,
-						TextureInfo = new TextureBinding() {
-							Sampler = resources!.Sampler,
-							TexureLayout = TextureLayout.ShaderSampled,
-							TextureView = texture.IdentityView
-						}
-					}
-				);
-				bindSets.Add(set);
+				var frames = resources!.Frames;
+				var sets = new IBindSet[frames.Length];
+				for (int i = 0; i < frames.Length; i++) {
+					var set = resources.BindPool.AllocSet(new BindSetAllocateInfo() {
+						Layouts = new IBindSetLayout[] { resources.BindSetLayout }
+					});
+					set.Update(
+						new BindSetWrite() {
+							Binding = resources.BindingGlobals.Binding,
+							Type = BindType.UniformBuffer,
+							BufferInfo = new BufferBinding() { Buffer = frames[i].UniformBuffer },
+						},
+						CreateTextureWrite(texture)
+					);
+					sets[i] = set;
+				}
+				bindSets.Add(sets);
 			}
 			return (nuint)id;
 		}
@@ -607,6 +678,9 @@ namespace Tesseract.ImGui.Core {
 		private static Recti renderArea;
 		// The clipping rectangle offset and scale for the current frame
 		private static Vector2 clipOffset, clipScale;
+		// Statistics accumulated for the current frame
+		private static ulong bytesUploaded;
+		private static int drawCalls;
 
 		// Sets the initial rendering state
 		private static void SetupRenderState(ICommandSink cmd) {
@@ -623,24 +697,38 @@ namespace Tesseract.ImGui.Core {
 			cmd.BindVertexArray(resources.VertexArray);
 		}
 
-		// Renders the commands in a single draw list to the shared buffers
-		private static void RenderDrawList(ICommandSink sink, IImDrawList list, ref int vertexOffset, ref int indexOffset) {
-			var vertices = resources!.Vertices.Span[vertexOffset..];
-			var indices = resources!.Indices.Span[indexOffset..];
-
-			// Copy vertices and indices to the buffers at the current offset
-			list.VtxBuffer.AsSpan().CopyTo(vertices);
-			list.IdxBuffer.AsSpan().CopyTo(indices);
-			// Flush the buffer ranges
-			resources!.VertexBuffer.FlushHostToGPU(new MemoryRange() {
-				Offset = (ulong)(vertexOffset * ImDrawVert.SizeOf),
-				Length = (ulong)(list.VtxBuffer.Count * ImDrawVert.SizeOf)
-			});
-			resources!.IndexBuffer.FlushHostToGPU(new MemoryRange() {
-				Offset = (ulong)(indexOffset * sizeof(ushort)),
-				Length = (ulong)(list.IdxBuffer.Count * sizeof(ushort))
-			});
+		// Copies the vertices and indices of every draw list to the current frame's region of the shared buffers
+		private static void UploadDrawData(IImDrawData drawData, int vertexBase, int indexBase) {
+			var vertices = resources!.Vertices.Span[vertexBase..];
+			var indices = resources.Indices.Span[indexBase..];
+
+			int vertexCount = 0, indexCount = 0;
+			foreach (var list in drawData.CmdLists) {
+				list.VtxBuffer.AsSpan().CopyTo(vertices[vertexCount..]);
+				list.IdxBuffer.AsSpan().CopyTo(indices[indexCount..]);
+				vertexCount += list.VtxBuffer.Count;
+				indexCount += list.IdxBuffer.Count;
+			}
 
+			// Flush the written ranges once for the whole frame
+			ulong vertexBytes = (ulong)(vertexCount * ImDrawVert.SizeOf), indexBytes = (ulong)(indexCount * sizeof(ushort));
+			if (vertexBytes > 0) {
+				resources.VertexBuffer.FlushHostToGPU(new MemoryRange() {
+					Offset = (ulong)(vertexBase * ImDrawVert.SizeOf),
+					Length = vertexBytes
+				});
+			}
+			if (indexBytes > 0) {
+				resources.IndexBuffer.FlushHostToGPU(new MemoryRange() {
+					Offset = (ulong)(indexBase * sizeof(ushort)),
+					Length = indexBytes
+				});
+			}
+			bytesUploaded += vertexBytes + indexBytes;
+		}
+
+		// Renders the commands in a single draw list from the shared buffers
+		private static void RenderDrawList(ICommandSink sink, IImDrawList list, ref int vertexOffset, ref int indexOffset) {
 			// For each command in the draw list
 			foreach (var cmd in list.CmdBuffer) {
 				// Handle user callbacks, else just render the vertices
@@ -657,18 +745,19 @@ namespace Tesseract.ImGui.Core {
 					Vector2i clipPos = (Vector2i)clipMin;
 					Vector2i clipSize = (Vector2i)(clipMax - clipMin);
 
-					if (resources.Graphics.Properties.CoordinateSystem == CoordinateSystem.LeftHanded)
+					if (resources!.Graphics.Properties.CoordinateSystem == CoordinateSystem.LeftHanded)
 						clipPos.Y = (renderArea.Size.Y - clipPos.Y) - clipSize.Y;
 
 					// Set scissor to clip area
 					sink.SetScissor(new Recti(clipPos, clipSize));
 
-					// Bind resource set for texture ID
-					var bindSet = bindSets[(int)cmd.TextureID];
-					sink.BindResources(PipelineType.Graphics, resources!.PipelineLayout, bindSet);
+					// Bind resource set for texture ID and the current frame
+					var bindSet = bindSets[(int)cmd.TextureID][frameIndex];
+					sink.BindResources(PipelineType.Graphics, resources.PipelineLayout, bindSet);
 
 					// Draw elements
 					sink.DrawIndexed(cmd.ElemCount, 1, (uint)(cmd.IdxOffset + indexOffset), (int)(cmd.VtxOffset + vertexOffset), 0);
+					drawCalls++;
 				}
 			}
 
@@ -677,7 +766,7 @@ namespace Tesseract.ImGui.Core {
 			indexOffset += list.IdxBuffer.Count;
 		}
 
-		private static void RenderDrawData(ICommandSink cmd, IImDrawData drawData, IFramebuffer framebuffer) {
+		private static void RenderDrawData(ICommandSink cmd, IImDrawData drawData, IFramebuffer framebuffer, int vertexBase, int indexBase) {
 			// Begin rendering
 			cmd.BeginRenderPass(new ICommandSink.RenderPassBegin() {
 				RenderArea = renderArea,
@@ -690,8 +779,8 @@ namespace Tesseract.ImGui.Core {
 			SetupRenderState(cmd);
 
 			// Render each draw list
-			int vertexOffset = 0;
-			int indexOffset = 0;
+			int vertexOffset = vertexBase;
+			int indexOffset = indexBase;
 			foreach (var list in drawData.CmdLists) RenderDrawList(cmd, list, ref vertexOffset, ref indexOffset);
 
 			// End rendering
@@ -699,7 +788,8 @@ namespace Tesseract.ImGui.Core {
 		}
 
 		/// <summary>
-		/// Renders ImGui draw data to the given framebuffer.
+		/// Renders ImGui draw data to the given framebuffer. Up to <see cref="ImGuiCoreRenderInfo.FramesInFlight"/> frames
+		/// may be rendered before waiting for the GPU to finish with the oldest frame.
 		/// </summary>
 		/// <param name="drawData">The draw data to render</param>
 		/// <param name="framebuffer">The framebuffer to render to</param>
@@ -707,14 +797,23 @@ namespace Tesseract.ImGui.Core {
 		/// <exception cref="InvalidOperationException">If the renderer is not initialized</exception>
 		public static void RenderDrawData(IImDrawData drawData, IFramebuffer framebuffer, IGraphics.CommandBufferSubmitInfo submitInfo) {
 			if (resources == null) throw new InvalidOperationException("Cannot render draw data until renderer is initialized");
-			
-			// Wait for fence indicating we can modify resources
-			var fence = resources.Fence;
-			if (hasRenderedFrame) fence.HostWait(ulong.MaxValue);
-			fence.HostReset();
+
+			// Wait for the fence indicating the GPU is done with this frame's resources
+			var frame = resources.Frames[frameIndex];
+			TimeSpan stallTime = frame.Wait();
+			frame.Fence.HostReset();
+
+			// Update the bind sets of textures remapped while this frame was in flight
+			foreach (int id in frame.StaleTextureIDs) {
+				ITexture? texture = textures[id];
+				if (texture != null) bindSets[id][frameIndex].Update(CreateTextureWrite(texture));
+			}
+			frame.StaleTextureIDs.Clear();
 
 			// Prepare resources for the given draw data
-			resources.Prepare(drawData);
+			bool reallocated = resources.Prepare(drawData, ref stallTime);
+			bytesUploaded = 0;
+			drawCalls = 0;
 
 			// Get variables for rendering
 			renderArea = new Recti(framebuffer.Size);
@@ -731,29 +830,43 @@ namespace Tesseract.ImGui.Core {
 				0, 0, -1, 0,
 				(R + L) / (L - R), (T + B) / (B - T), 0, 1
 			);
-			resources.UniformPtr.Value = Matrix4x4.Transpose(orthoProjection);
-			resources.UniformBuffer.FlushHostToGPU();
+			frame.UniformPtr.Value = Matrix4x4.Transpose(orthoProjection);
+			frame.UniformBuffer.FlushHostToGPU();
+			bytesUploaded += (ulong)Marshal.SizeOf<Matrix4x4>();
 
 			// Setup clipping information
 			clipOffset = drawData.DisplayPos;
 			clipScale = drawData.FramebufferScale;
 
+			// Upload geometry to this frame's region of the shared buffers
+			int vertexBase = frameIndex * resources.VertexCapacity;
+			int indexBase = frameIndex * resources.IndexCapacity;
+			UploadDrawData(drawData, vertexBase, indexBase);
+
 			// Initialize list of signal synchronization objects
 			signalSyncs.Clear();
 			signalSyncs.AddRange(submitInfo.SignalSync);
-			signalSyncs.Add(fence);
+			signalSyncs.Add(frame.Fence);
 
 			// Run the set of commands
-			if (resources.CommandBuffer != null) {
-				var cmd = resources.CommandBuffer.BeginRecording();
-				RenderDrawData(cmd, drawData, framebuffer);
-				resources.CommandBuffer.EndRecording();
-				resources.Graphics.SubmitCommands(submitInfo with { CommandBuffer = resources.CommandBuffers, SignalSync = signalSyncs });
+			if (frame.CommandBuffer != null) {
+				var cmd = frame.CommandBuffer.BeginRecording();
+				RenderDrawData(cmd, drawData, framebuffer, vertexBase, indexBase);
+				frame.CommandBuffer.EndRecording();
+				resources.Graphics.SubmitCommands(submitInfo with { CommandBuffer = frame.CommandBuffers, SignalSync = signalSyncs });
 			} else {
-				resources.Graphics.RunCommands(cmd => RenderDrawData(cmd, drawData, framebuffer), CommandBufferUsage.Graphics, submitInfo with { SignalSync = signalSyncs });
+				resources.Graphics.RunCommands(cmd => RenderDrawData(cmd, drawData, framebuffer, vertexBase, indexBase), CommandBufferUsage.Graphics, submitInfo with { SignalSync = signalSyncs });
 			}
+			frame.Pending = true;
 
+			LastFrameStats = new ImGuiCoreRenderStats() {
+				BytesUploaded = bytesUploaded,
+				DrawCalls = drawCalls,
+				FenceStallTime = stallTime,
+				Reallocated = reallocated
+			};
 
+			frameIndex = (frameIndex + 1) % resources.Frames.Length;
 			hasRenderedFrame = true;
 		}
 
@@ -616,6 +616,8 @@ namespace Tesseract.LMDB {
 
 		public MDBException(string str, MDBResult err) : base(str + ": " + MDB.StrError(err)) { }
 
+		public MDBException(string str, Exception inner) : base(str, inner) { }
+
 	}
 
 }
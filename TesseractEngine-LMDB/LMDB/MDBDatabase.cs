@@ -0,0 +1,285 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+using System.Text;
+using System.Threading.Tasks;
+
+namespace Tesseract.LMDB {
+
+	using MDBDBI = UInt32;
+
+	/// <summary>
+	/// <para>A typed view of a database whose keys and values are blittable structures.</para>
+	/// <para>
+	/// Values are read in place through <c>ref readonly</c> references into the memory map, so no copy is made unless the
+	/// caller dereferences them. Like the spans returned by <see cref="MDBTxn.Get(MDBDBI, in ReadOnlySpan{byte})"/>, these
+	/// references are only valid until a subsequent update operation or the end of the transaction, must never be written
+	/// through, and may not be naturally aligned in the memory map.
+	/// </para>
+	/// <para>
+	/// Keys are compared using the database's comparison function. With the default lexical comparison multi-byte integer
+	/// keys will not sort numerically on little-endian machines; open the database with <see cref="MDBDBFlags.IntegerKey"/>
+	/// if range scans over integer keys must be ordered.
+	/// </para>
+	/// </summary>
+	/// <typeparam name="K">Key type</typeparam>
+	/// <typeparam name="V">Value type</typeparam>
+	public class MDBDatabase<K, V> where K : unmanaged where V : unmanaged {
+
+		/// <summary>
+		/// The environment the database belongs to.
+		/// </summary>
+		public MDBEnv Env { get; }
+
+		/// <summary>
+		/// The database interface handle.
+		/// </summary>
+		public MDBDBI DBI { get; }
+
+		/// <summary>
+		/// Creates a typed view of an already opened database.
+		/// </summary>
+		/// <param name="env">The environment the database belongs to</param>
+		/// <param name="dbi">The database interface handle</param>
+		public MDBDatabase(MDBEnv env, MDBDBI dbi) {
+			Env = env;
+			DBI = dbi;
+		}
+
+		/// <summary>
+		/// Opens a database and creates a typed view of it. See <see cref="MDBTxn.Open(string?, MDBDBFlags)"/> for the
+		/// restrictions on opening databases.
+		/// </summary>
+		/// <param name="txn">The transaction to open the database in</param>
+		/// <param name="name">The name of the database to open, or null for the unnamed database</param>
+		/// <param name="flags">Special options for this database</param>
+		/// <exception cref="MDBException">If an error occured opening the handle</exception>
+		public MDBDatabase(MDBTxn txn, string? name, MDBDBFlags flags = 0) : this(txn.Env, txn.Open(name, flags)) { }
+
+		// Gets a reference to a value returned by the database, checking that it has the expected size
+		internal static unsafe ref V AsValue(MDBVal data) {
+			if (data.Size != (nuint)sizeof(V)) throw new MDBException($"Database value size ({data.Size}) does not match the size of {typeof(V).Name} ({sizeof(V)})");
+			return ref Unsafe.AsRef<V>((void*)data.Data);
+		}
+
+		// Gets a reference to a key returned by the database, checking that it has the expected size
+		internal static unsafe ref K AsKey(MDBVal data) {
+			if (data.Size != (nuint)sizeof(K)) throw new MDBException($"Database key size ({data.Size}) does not match the size of {typeof(K).Name} ({sizeof(K)})");
+			return ref Unsafe.AsRef<K>((void*)data.Data);
+		}
+
+		/// <summary>
+		/// Gets a read-only reference to the value stored for a key, or a null reference if the key does not exist.
+		/// The result must be checked with <see cref="Unsafe.IsNullRef{T}(ref T)"/> before it is used.
+		/// </summary>
+		/// <param name="txn">The transaction to read in</param>
+		/// <param name="key">The key to search for in the database</param>
+		/// <returns>A reference to the value in the database, or a null reference</returns>
+		/// <exception cref="MDBException">If an error occurs getting the data</exception>
+		public ref readonly V GetValueRefOrNullRef(MDBTxn txn, in K key) {
+			unsafe {
+				fixed (K* pKey = &key) {
+					MDBVal vkey = new() {
+						Size = (nuint)sizeof(K),
+						Data = (IntPtr)pKey
+					};
+					MDBResult err = MDB.Functions.mdb_get(txn.Txn, DBI, vkey, out MDBVal data);
+					if (err == MDBResult.NotFound) return ref Unsafe.NullRef<V>();
+					if (err != MDBResult.Success) throw new MDBException("Failed to get database entry", err);
+					return ref AsValue(data);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Gets a read-only reference to the value stored for a key.
+		/// </summary>
+		/// <param name="txn">The transaction to read in</param>
+		/// <param name="key">The key to search for in the database</param>
+		/// <returns>A reference to the value in the database</returns>
+		/// <exception cref="KeyNotFoundException">If the specified key was not found in the database</exception>
+		/// <exception cref="MDBException">If an error occurs getting the data</exception>
+		public ref readonly V Get(MDBTxn txn, in K key) {
+			ref readonly V value = ref GetValueRefOrNullRef(txn, key);
+			if (Unsafe.IsNullRef(ref Unsafe.AsRef(value))) throw new KeyNotFoundException();
+			return ref value;
+		}
+
+		/// <summary>
+		/// Gets a copy of the value stored for a key, returning if the key was found.
+		/// </summary>
+		/// <param name="txn">The transaction to read in</param>
+		/// <param name="key">The key to search for in the database</param>
+		/// <param name="value">The value stored for the key</param>
+		/// <returns>If the key was found in the database</returns>
+		/// <exception cref="MDBException">If an error occurs getting the data</exception>
+		public bool TryGet(MDBTxn txn, in K key, out V value) {
+			ref readonly V data = ref GetValueRefOrNullRef(txn, key);
+			if (Unsafe.IsNullRef(ref Unsafe.AsRef(data))) {
+				value = default;
+				return false;
+			}
+			value = Unsafe.ReadUnaligned<V>(ref Unsafe.As<V, byte>(ref Unsafe.AsRef(data)));
+			return true;
+		}
+
+		/// <summary>
+		/// Stores a value for a key.
+		/// </summary>
+		/// <param name="txn">The write transaction to store in</param>
+		/// <param name="key">The key to store in the database</param>
+		/// <param name="value">The value to store</param>
+		/// <param name="flags">Special options for this operation</param>
+		/// <returns>If the value was stored, false if the key already exists and <see cref="MDBWriteFlags.NoOverwrite"/> was given</returns>
+		/// <exception cref="MDBException">If an error occurs putting the item into the database</exception>
+		public bool Put(MDBTxn txn, in K key, in V value, MDBWriteFlags flags = 0) {
+			unsafe {
+				fixed (K* pKey = &key) {
+					fixed (V* pValue = &value) {
+						MDBVal vkey = new() {
+							Size = (nuint)sizeof(K),
+							Data = (IntPtr)pKey
+						};
+						MDBVal vdata = new() {
+							Size = (nuint)sizeof(V),
+							Data = (IntPtr)pValue
+						};
+						MDBResult err = MDB.Functions.mdb_put(txn.Txn, DBI, vkey, ref vdata, flags);
+						if (err == MDBResult.KeyExist) return false;
+						if (err != MDBResult.Success) throw new MDBException("Failed to put database entry", err);
+						return true;
+					}
+				}
+			}
+		}
+
+		/// <summary>
+		/// <para>
+		/// Reserves space for the value of a key using <see cref="MDBWriteFlags.Reserve"/>, returning a reference to the
+		/// space in the database so the value can be written in place without an intermediate copy. The reference is only
+		/// valid until the next update operation or the end of the transaction.
+		/// </para>
+		/// <para>This must not be used with databases opened with <see cref="MDBDBFlags.DupSort"/>.</para>
+		/// </summary>
+		/// <param name="txn">The write transaction to store in</param>
+		/// <param name="key">The key to store in the database</param>
+		/// <param name="flags">Special options for this operation</param>
+		/// <returns>
+		/// A reference to the reserved value, or a null reference if the key already exists and <see cref="MDBWriteFlags.NoOverwrite"/> was given
+		/// </returns>
+		/// <exception cref="MDBException">If an error occurs putting the item into the database</exception>
+		public ref V Reserve(MDBTxn txn, in K key, MDBWriteFlags flags = 0) {
+			unsafe {
+				fixed (K* pKey = &key) {
+					MDBVal vkey = new() {
+						Size = (nuint)sizeof(K),
+						Data = (IntPtr)pKey
+					};
+					MDBVal vdata = new() { Size = (nuint)sizeof(V) };
+					MDBResult err = MDB.Functions.mdb_put(txn.Txn, DBI, vkey, ref vdata, flags | MDBWriteFlags.Reserve);
+					if (err == MDBResult.KeyExist) return ref Unsafe.NullRef<V>();
+					if (err != MDBResult.Success) throw new MDBException("Failed to reserve database entry", err);
+					return ref Unsafe.AsRef<V>((void*)vdata.Data);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Deletes a key and its value from the database.
+		/// </summary>
+		/// <param name="txn">The write transaction to delete in</param>
+		/// <param name="key">The key to delete from the database</param>
+		/// <returns>If the corresponding entry was deleted</returns>
+		/// <exception cref="MDBException">If an error occurs deleting the item</exception>
+		public bool Delete(MDBTxn txn, in K key) {
+			unsafe {
+				fixed (K* pKey = &key) {
+					return txn.Del(DBI, new ReadOnlySpan<byte>(pKey, sizeof(K)));
+				}
+			}
+		}
+
+		/// <summary>
+		/// <para>
+		/// Bulk loads entries into the database using <see cref="MDBWriteFlags.Append"/>, which skips key comparisons
+		/// and page splitting, and <see cref="MDBWriteFlags.Reserve"/>, which writes each value directly into its page.
+		/// The keys must be in ascending order and greater than every key already in the database.
+		/// </para>
+		/// <para>This must not be used with databases opened with <see cref="MDBDBFlags.DupSort"/>.</para>
+		/// </summary>
+		/// <param name="txn">The write transaction to load into</param>
+		/// <param name="keys">The keys to store, in ascending order</param>
+		/// <param name="values">The values to store for each key</param>
+		/// <exception cref="ArgumentException">If the number of keys and values differ</exception>
+		/// <exception cref="MDBException">If the keys are not in order, or an error occurs putting an item into the database</exception>
+		public void Append(MDBTxn txn, ReadOnlySpan<K> keys, ReadOnlySpan<V> values) {
+			if (keys.Length != values.Length) throw new ArgumentException("The number of keys and values must be equal");
+			using MDBCursor cursor = txn.OpenCursor(DBI);
+			unsafe {
+				fixed (K* pKeys = keys) {
+					for (int i = 0; i < keys.Length; i++) {
+						MDBVal vkey = new() {
+							Size = (nuint)sizeof(K),
+							Data = (IntPtr)(pKeys + i)
+						};
+						MDBVal vdata = new() { Size = (nuint)sizeof(V) };
+						MDBResult err = MDB.Functions.mdb_cursor_put(cursor.Cursor, vkey, &vdata, MDBWriteFlags.Append | MDBWriteFlags.Reserve);
+						if (err == MDBResult.KeyExist) throw new MDBException("Keys must be appended in ascending order");
+						if (err != MDBResult.Success) throw new MDBException("Failed to append database entry", err);
+						Unsafe.WriteUnaligned((void*)vdata.Data, values[i]);
+					}
+				}
+			}
+		}
+
+		/// <summary>
+		/// Enumerates the entries of the database in key order using an existing cursor, which must have been opened
+		/// on this database. Reusing a cursor (see <see cref="MDBCursor.Renew"/>) avoids allocating one for each scan.
+		/// </summary>
+		/// <param name="cursor">The cursor to enumerate with</param>
+		/// <returns>An enumerator over every entry</returns>
+		public MDBRangeEnumerator<K, V> Range(MDBCursor cursor) => new(cursor, DBI, false);
+
+		/// <summary>
+		/// Enumerates the entries of the database in key order using an existing cursor, starting at the first key greater
+		/// than or equal to <paramref name="start"/>.
+		/// </summary>
+		/// <param name="cursor">The cursor to enumerate with</param>
+		/// <param name="start">The inclusive lower bound of the range</param>
+		/// <returns>An enumerator over the range</returns>
+		public MDBRangeEnumerator<K, V> Range(MDBCursor cursor, in K start) => new(cursor, DBI, false, start);
+
+		/// <summary>
+		/// Enumerates the entries of the database in key order using an existing cursor, starting at the first key greater
+		/// than or equal to <paramref name="start"/> and stopping before the first key greater than or equal to <paramref name="end"/>.
+		/// </summary>
+		/// <param name="cursor">The cursor to enumerate with</param>
+		/// <param name="start">The inclusive lower bound of the range</param>
+		/// <param name="end">The exclusive upper bound of the range</param>
+		/// <returns>An enumerator over the range</returns>
+		public MDBRangeEnumerator<K, V> Range(MDBCursor cursor, in K start, in K end) => new(cursor, DBI, false, start, end);
+
+		/// <summary>
+		/// Enumerates the entries of the database in key order, opening a cursor which is closed when the enumerator is disposed.
+		/// </summary>
+		/// <param name="txn">The transaction to read in</param>
+		/// <returns>An enumerator over every entry</returns>
+		/// <exception cref="MDBException">If an error occurs opening the cursor</exception>
+		public MDBRangeEnumerator<K, V> Range(MDBTxn txn) => new(txn.OpenCursor(DBI), DBI, true);
+
+		/// <summary>
+		/// Enumerates the entries of the database in key order between two keys, opening a cursor which is closed when
+		/// the enumerator is disposed.
+		/// </summary>
+		/// <param name="txn">The transaction to read in</param>
+		/// <param name="start">The inclusive lower bound of the range</param>
+		/// <param name="end">The exclusive upper bound of the range</param>
+		/// <returns>An enumerator over the range</returns>
+		/// <exception cref="MDBException">If an error occurs opening the cursor</exception>
+		public MDBRangeEnumerator<K, V> Range(MDBTxn txn, in K start, in K end) => new(txn.OpenCursor(DBI), DBI, true, start, end);
+
+	}
+
+}
@@ -3,6 +3,7 @@ using System.Collections.Generic;
 using System.Linq;
 using System.Runtime.InteropServices;
 using System.Text;
+using System.Threading;
 using System.Threading.Tasks;
 using Tesseract.Core.Native;
 
@@ -188,6 +189,12 @@ namespace Tesseract.LMDB {
 			}
 		}
 
+		private MDBReadTxnPool? readPool;
+		/// <summary>
+		/// The pool of read-only transactions used by <see cref="BeginRead"/>, created on first use and disposed with the environment.
+		/// </summary>
+		public MDBReadTxnPool ReadPool => LazyInitializer.EnsureInitialized(ref readPool, () => new MDBReadTxnPool(this));
+
 		/// <summary>
 		/// <para>Create an LMDB environment handle.</para>
 		/// </summary>
@@ -282,6 +289,7 @@ namespace Tesseract.LMDB {
 
 		public void Dispose() {
 			GC.SuppressFinalize(this);
+			readPool?.Dispose();
 			if (Env != IntPtr.Zero) {
 				unsafe {
 					MDB.Functions.mdb_env_close(Env);
@@ -333,6 +341,17 @@ namespace Tesseract.LMDB {
 			}
 		}
 
+		/// <summary>
+		/// <para>Rent a read-only transaction from the environment's <see cref="ReadPool"/>.</para>
+		/// <para>
+		/// This is preferable to <see cref="Begin(MDBTxn?, MDBEnvFlags)"/> for short, frequent reads since the transaction
+		/// is reset and renewed instead of being recreated. The transaction is returned to the pool when disposed.
+		/// </para>
+		/// </summary>
+		/// <returns>A pooled read-only transaction</returns>
+		/// <exception cref="MDBException">If an error occurs starting or renewing the transaction</exception>
+		public MDBPooledReadTxn BeginRead() => ReadPool.Rent();
+
 		/// <summary>
 		/// Dump the entries in the reader lock table.
 		/// </summary>
@@ -0,0 +1,125 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Runtime.CompilerServices;
+using System.Text;
+using System.Threading.Tasks;
+
+namespace Tesseract.LMDB {
+
+	using MDBDBI = UInt32;
+
+	/// <summary>
+	/// A key/value pair read in place from a database. The references are only valid until the next cursor operation,
+	/// update operation, or the end of the transaction.
+	/// </summary>
+	/// <typeparam name="K">Key type</typeparam>
+	/// <typeparam name="V">Value type</typeparam>
+	public readonly ref struct MDBEntry<K, V> where K : unmanaged where V : unmanaged {
+
+		/// <summary>
+		/// The key of the entry.
+		/// </summary>
+		public readonly ref readonly K Key;
+
+		/// <summary>
+		/// The value of the entry.
+		/// </summary>
+		public readonly ref readonly V Value;
+
+		public MDBEntry(ref K key, ref V value) {
+			Key = ref key;
+			Value = ref value;
+		}
+
+	}
+
+	/// <summary>
+	/// <para>
+	/// Allocation-free enumerator over a range of keys in a typed database, stepping an <see cref="MDBCursor"/> and exposing
+	/// each entry in place as an <see cref="MDBEntry{K, V}"/>. The enumerator can be used directly in a <c>foreach</c> loop.
+	/// </para>
+	/// <para>
+	/// The range bounds are compared with the database's comparison function. If the enumerator opened its own cursor it
+	/// is closed when the enumerator is disposed, otherwise the cursor remains owned by the caller.
+	/// </para>
+	/// </summary>
+	/// <typeparam name="K">Key type</typeparam>
+	/// <typeparam name="V">Value type</typeparam>
+	public ref struct MDBRangeEnumerator<K, V> where K : unmanaged where V : unmanaged {
+
+		private readonly MDBCursor cursor;
+		private readonly MDBDBI dbi;
+		private readonly bool ownsCursor;
+		private readonly bool hasStart, hasEnd;
+		private readonly K start, end;
+		private bool started, finished;
+		private MDBVal currentKey, currentValue;
+
+		internal MDBRangeEnumerator(MDBCursor cursor, MDBDBI dbi, bool ownsCursor) {
+			this.cursor = cursor;
+			this.dbi = dbi;
+			this.ownsCursor = ownsCursor;
+		}
+
+		internal MDBRangeEnumerator(MDBCursor cursor, MDBDBI dbi, bool ownsCursor, in K start) : this(cursor, dbi, ownsCursor) {
+			hasStart = true;
+			this.start = start;
+		}
+
+		internal MDBRangeEnumerator(MDBCursor cursor, MDBDBI dbi, bool ownsCursor, in K start, in K end) : this(cursor, dbi, ownsCursor, start) {
+			hasEnd = true;
+			this.end = end;
+		}
+
+		/// <summary>
+		/// The entry at the current position of the enumerator.
+		/// </summary>
+		public MDBEntry<K, V> Current => new(ref MDBDatabase<K, V>.AsKey(currentKey), ref MDBDatabase<K, V>.AsValue(currentValue));
+
+		public MDBRangeEnumerator<K, V> GetEnumerator() => this;
+
+		/// <summary>
+		/// Advances to the next entry in the range.
+		/// </summary>
+		/// <returns>If there is another entry in the range</returns>
+		/// <exception cref="MDBException">If an error occurs reading from the cursor</exception>
+		public bool MoveNext() {
+			if (finished) return false;
+			unsafe {
+				MDBResult err;
+				MDBCursorOp op = started ? MDBCursorOp.Next : (hasStart ? MDBCursorOp.SetRange : MDBCursorOp.First);
+				fixed (K* pStart = &start) {
+					MDBVal key = hasStart && !started ? new MDBVal() { Size = (nuint)sizeof(K), Data = (IntPtr)pStart } : default;
+					err = MDB.Functions.mdb_cursor_get(cursor.Cursor, ref key, out MDBVal value, op);
+					currentKey = key;
+					currentValue = value;
+				}
+				started = true;
+
+				if (err == MDBResult.NotFound) {
+					finished = true;
+					return false;
+				}
+				if (err != MDBResult.Success) throw new MDBException("Failed to get from cursor", err);
+
+				if (hasEnd) {
+					fixed (K* pEnd = &end) {
+						MDBVal vend = new() { Size = (nuint)sizeof(K), Data = (IntPtr)pEnd };
+						if (MDB.Functions.mdb_cmp(cursor.Txn.Txn, dbi, currentKey, vend) >= 0) {
+							finished = true;
+							return false;
+						}
+					}
+				}
+				return true;
+			}
+		}
+
+		public void Dispose() {
+			if (ownsCursor) cursor.Dispose();
+		}
+
+	}
+
+}
@@ -0,0 +1,249 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace Tesseract.LMDB {
+
+	using MDBDBI = UInt32;
+
+	/// <summary>
+	/// Reader lock table usage of an environment, see <see cref="MDBReadTxnPool.CheckReaders"/>.
+	/// </summary>
+	public struct MDBReaderSlotUsage {
+
+		/// <summary>
+		/// Max reader slots in the environment.
+		/// </summary>
+		public uint MaxReaders;
+
+		/// <summary>
+		/// Max reader slots used in the environment, which is a high-water mark rather than the current number of readers.
+		/// </summary>
+		public uint UsedReaders;
+
+		/// <summary>
+		/// The number of transactions currently rented from the pool.
+		/// </summary>
+		public int ActiveTransactions;
+
+		/// <summary>
+		/// The number of reset transactions held by the pool for reuse.
+		/// </summary>
+		public int IdleTransactions;
+
+		/// <summary>
+		/// The number of stale reader slots cleared by the check.
+		/// </summary>
+		public int StaleReadersCleared;
+
+	}
+
+	/// <summary>
+	/// <para>
+	/// A read-only transaction rented from a <see cref="MDBReadTxnPool"/>, which is returned to the pool when disposed.
+	/// The transaction must not be committed or aborted directly, and like any read-only transaction it must only be used
+	/// by the thread which rented it unless <see cref="MDBEnvFlags.NoTLS"/> is in use.
+	/// </para>
+	/// </summary>
+	public readonly struct MDBPooledReadTxn : IDisposable {
+
+		private readonly MDBReadTxnPool pool;
+		private readonly MDBReadTxnPool.Reader reader;
+		private readonly int lease;
+
+		/// <summary>
+		/// The underlying transaction.
+		/// </summary>
+		public MDBTxn Txn => reader.Txn;
+
+		internal MDBPooledReadTxn(MDBReadTxnPool pool, MDBReadTxnPool.Reader reader, int lease) {
+			this.pool = pool;
+			this.reader = reader;
+			this.lease = lease;
+		}
+
+		/// <summary>
+		/// Gets a cursor for a database in this transaction. Cursors are cached with the pooled transaction and renewed
+		/// with <see cref="MDBCursor.Renew"/> when it is reused, so they must not be disposed by the caller.
+		/// </summary>
+		/// <param name="dbi">The database interface handle</param>
+		/// <returns>A cursor for the database</returns>
+		/// <exception cref="MDBException">If an error occurs opening or renewing the cursor</exception>
+		public MDBCursor GetCursor(MDBDBI dbi) => reader.GetCursor(dbi);
+
+		public void Dispose() => pool?.Return(reader, lease);
+
+		public static implicit operator MDBTxn(MDBPooledReadTxn txn) => txn.Txn;
+
+	}
+
+	/// <summary>
+	/// <para>
+	/// A per-thread pool of read-only transactions. Returned transactions are released with <see cref="MDBTxn.Reset"/>
+	/// and reacquired with <see cref="MDBTxn.Renew"/>, avoiding the native allocation and the finalizable
+	/// <see cref="MDBTxn"/> created by <see cref="MDBEnv.Begin(MDBTxn?, MDBEnvFlags)"/> for every read.
+	/// </para>
+	/// <para>
+	/// Transactions are pooled per thread because reader lock table slots are tied to threads unless
+	/// <see cref="MDBEnvFlags.NoTLS"/> is in use. A transaction returned from a different thread than the one which rented
+	/// it is aborted instead of pooled. With <see cref="MDBEnvFlags.NoTLS"/> every idle transaction keeps its own reader
+	/// slot, so <see cref="MaxIdlePerThread"/> should be kept small relative to <see cref="MDBEnv.MaxReaders"/>.
+	/// </para>
+	/// </summary>
+	public class MDBReadTxnPool : IDisposable {
+
+		// A pooled transaction with the cursors opened in it
+		internal class Reader : IDisposable {
+
+			public readonly MDBTxn Txn;
+			public readonly int ThreadID = Environment.CurrentManagedThreadId;
+			// Incremented every time the transaction is rented, to detect stale leases and cursors
+			public int Lease;
+			public bool Active;
+
+			// Cursors indexed by database handle, with the lease they were last renewed in
+			private MDBCursor?[] cursors = Array.Empty<MDBCursor?>();
+			private int[] cursorLeases = Array.Empty<int>();
+
+			public Reader(MDBTxn txn) {
+				Txn = txn;
+			}
+
+			public MDBCursor GetCursor(MDBDBI dbi) {
+				if (dbi >= cursors.Length) {
+					int length = (int)Math.Max(dbi + 1, (uint)cursors.Length * 2);
+					Array.Resize(ref cursors, length);
+					Array.Resize(ref cursorLeases, length);
+				}
+
+				MDBCursor? cursor = cursors[dbi];
+				if (cursor == null) {
+					cursor = Txn.OpenCursor(dbi);
+					cursors[dbi] = cursor;
+				} else if (cursorLeases[dbi] != Lease) {
+					cursor.Renew();
+				}
+				cursorLeases[dbi] = Lease;
+				return cursor;
+			}
+
+			public void Dispose() {
+				// Read-only cursors must be closed explicitly
+				foreach (MDBCursor? cursor in cursors) cursor?.Dispose();
+				Txn.Dispose();
+			}
+
+		}
+
+		/// <summary>
+		/// The environment transactions are started in.
+		/// </summary>
+		public MDBEnv Env { get; }
+
+		/// <summary>
+		/// The maximum number of reset transactions kept by each thread.
+		/// </summary>
+		public int MaxIdlePerThread { get; }
+
+		private readonly ThreadLocal<Stack<Reader>> idle = new(() => new Stack<Reader>(), true);
+		private int activeCount, idleCount;
+		private volatile bool disposed;
+
+		/// <summary>
+		/// Creates a new read transaction pool.
+		/// </summary>
+		/// <param name="env">The environment to start transactions in</param>
+		/// <param name="maxIdlePerThread">The maximum number of reset transactions kept by each thread</param>
+		public MDBReadTxnPool(MDBEnv env, int maxIdlePerThread = 4) {
+			Env = env;
+			MaxIdlePerThread = maxIdlePerThread;
+		}
+
+		/// <summary>
+		/// Rents a read-only transaction, renewing a pooled transaction of the current thread if one is available.
+		/// </summary>
+		/// <returns>The rented transaction</returns>
+		/// <exception cref="MDBException">If an error occurs starting or renewing the transaction</exception>
+		public MDBPooledReadTxn Rent() {
+			if (disposed) throw new ObjectDisposedException(nameof(MDBReadTxnPool));
+
+			if (idle.Value!.TryPop(out Reader? reader)) {
+				Interlocked.Decrement(ref idleCount);
+				try {
+					reader.Txn.Renew();
+				} catch {
+					reader.Dispose();
+					throw;
+				}
+			} else {
+				reader = new Reader(Env.Begin(null, MDBEnvFlags.ReadOnly));
+			}
+
+			reader.Lease++;
+			reader.Active = true;
+			Interlocked.Increment(ref activeCount);
+			return new MDBPooledReadTxn(this, reader, reader.Lease);
+		}
+
+		// Returns a rented transaction to the pool, ignoring stale or repeated returns
+		internal void Return(Reader reader, int lease) {
+			if (!reader.Active || reader.Lease != lease) return;
+			reader.Active = false;
+			Interlocked.Decrement(ref activeCount);
+
+			if (disposed || reader.ThreadID != Environment.CurrentManagedThreadId) {
+				reader.Dispose();
+				return;
+			}
+
+			Stack<Reader> stack = idle.Value!;
+			if (stack.Count >= MaxIdlePerThread) {
+				reader.Dispose();
+				return;
+			}
+
+			reader.Txn.Reset();
+			stack.Push(reader);
+			Interlocked.Increment(ref idleCount);
+		}
+
+		/// <summary>
+		/// Clears stale entries in the reader lock table with <see cref="MDBEnv.CheckReaders"/> and reports the usage of
+		/// reader slots by the environment and this pool.
+		/// </summary>
+		/// <returns>The reader slot usage</returns>
+		/// <exception cref="MDBException">If an error occurs checking the readers</exception>
+		public MDBReaderSlotUsage CheckReaders() {
+			int stale = Env.CheckReaders();
+			MDBEnvInfo info = Env.Info;
+			return new MDBReaderSlotUsage() {
+				MaxReaders = info.MaxReaders,
+				UsedReaders = info.NumReaders,
+				ActiveTransactions = Volatile.Read(ref activeCount),
+				IdleTransactions = Volatile.Read(ref idleCount),
+				StaleReadersCleared = stale
+			};
+		}
+
+		/// <summary>
+		/// Aborts every idle transaction in the pool. Transactions which are still rented are aborted when returned.
+		/// </summary>
+		public void Dispose() {
+			GC.SuppressFinalize(this);
+			if (disposed) return;
+			disposed = true;
+			foreach (Stack<Reader> stack in idle.Values) {
+				while (stack.TryPop(out Reader? reader)) {
+					Interlocked.Decrement(ref idleCount);
+					reader.Dispose();
+				}
+			}
+			idle.Dispose();
+		}
+
+	}
+
+}
@@ -0,0 +1,342 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+using System.Text;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace Tesseract.LMDB {
+
+	using MDBDBI = UInt32;
+
+	/// <summary>
+	/// <para>
+	/// Coalesces many small writes into batched write transactions committed by a background writer thread. Writes are
+	/// copied into a pending buffer when enqueued, and each time the writer wakes it swaps the buffers and applies every
+	/// pending write in a single transaction, so the cost of a commit (and its disk sync) is shared by the whole batch.
+	/// </para>
+	/// <para>
+	/// Writes become visible to readers only once their batch commits; use <see cref="Flush"/> to wait for this. If the
+	/// pending buffer grows past <see cref="MaxPendingBytes"/> enqueueing blocks until the writer catches up. Writes with
+	/// <see cref="MDBWriteFlags.NoOverwrite"/> that find an existing key, and deletes of missing keys, are silently
+	/// skipped. If a batch fails the queue stops, and the error is rethrown by the next enqueue or flush.
+	/// </para>
+	/// </summary>
+	public class MDBWriteQueue : IDisposable {
+
+		/// <summary>
+		/// The environment written to.
+		/// </summary>
+		public MDBEnv Env { get; }
+
+		/// <summary>
+		/// The size of pending writes in bytes above which enqueueing blocks until the current batch is taken by the writer.
+		/// </summary>
+		public int MaxPendingBytes { get; }
+
+		/// <summary>
+		/// The time the writer waits after being woken to let more writes accumulate before committing a batch. A zero
+		/// delay commits as soon as possible, coalescing only the writes enqueued while the previous batch was committing.
+		/// </summary>
+		public TimeSpan CommitDelay { get; set; } = TimeSpan.Zero;
+
+		/// <summary>
+		/// The number of batches which have been committed.
+		/// </summary>
+		public long CommittedBatches {
+			get {
+				lock (sync) return committedBatches;
+			}
+		}
+
+		/// <summary>
+		/// The number of writes which have been committed.
+		/// </summary>
+		public long CommittedWrites {
+			get {
+				lock (sync) return committedWrites;
+			}
+		}
+
+		private enum WriteOp : byte {
+			Put,
+			Delete
+		}
+
+		// Header preceding the key and value bytes of each write in a batch buffer
+		[StructLayout(LayoutKind.Sequential)]
+		private struct WriteHeader {
+
+			public MDBDBI DBI;
+			public MDBWriteFlags Flags;
+			public int KeySize;
+			public int ValueSize;
+			public WriteOp Op;
+
+		}
+
+		private readonly object sync = new();
+		private readonly Thread writer;
+
+		// The buffer being filled by producers and the buffer being committed by the writer
+		private byte[] pending, committing;
+		private int pendingLength;
+
+		private long enqueuedWrites, committedWrites, committedBatches;
+		private bool stopping, writerExited;
+		private Exception? error;
+
+		/// <summary>
+		/// Creates a write queue and starts its writer thread.
+		/// </summary>
+		/// <param name="env">The environment to write to</param>
+		/// <param name="maxPendingBytes">The size of pending writes in bytes above which enqueueing blocks</param>
+		public MDBWriteQueue(MDBEnv env, int maxPendingBytes = 16 * 1024 * 1024) {
+			Env = env;
+			MaxPendingBytes = maxPendingBytes;
+			pending = new byte[4096];
+			committing = new byte[4096];
+			writer = new Thread(WriterLoop) {
+				IsBackground = true,
+				Name = "LMDB Write Queue"
+			};
+			writer.Start();
+		}
+
+		// Rethrows a failure from the writer thread, must be called while holding the lock
+		private void ThrowIfFailed() {
+			if (error != null) throw new MDBException("Batched write transaction failed", error);
+		}
+
+		// Throws if no more writes can be enqueued, must be called while holding the lock
+		private void ThrowIfStopping() {
+			ThrowIfFailed();
+			if (stopping) throw new ObjectDisposedException(nameof(MDBWriteQueue));
+		}
+
+		private void Enqueue(WriteOp op, MDBDBI dbi, ReadOnlySpan<byte> key, ReadOnlySpan<byte> value, MDBWriteFlags flags) {
+			if ((flags & (MDBWriteFlags.Reserve | MDBWriteFlags.Multiple | MDBWriteFlags.Current)) != 0)
+				throw new ArgumentException("Reserve, Multiple, and Current writes cannot be batched", nameof(flags));
+
+			int size = Unsafe.SizeOf<WriteHeader>() + key.Length + value.Length;
+			lock (sync) {
+				ThrowIfStopping();
+
+				// Apply backpressure if the writer has fallen behind, the queue may be disposed while waiting
+				while (pendingLength > 0 && pendingLength + size > MaxPendingBytes) {
+					Monitor.Wait(sync);
+					ThrowIfStopping();
+				}
+
+				if (pending.Length < pendingLength + size) Array.Resize(ref pending, Math.Max(pending.Length * 2, pendingLength + size));
+
+				Span<byte> dst = pending.AsSpan(pendingLength, size);
+				WriteHeader header = new() {
+					DBI = dbi,
+					Flags = flags,
+					KeySize = key.Length,
+					ValueSize = value.Length,
+					Op = op
+				};
+				MemoryMarshal.Write(dst, ref header);
+				dst = dst[Unsafe.SizeOf<WriteHeader>()..];
+				key.CopyTo(dst);
+				value.CopyTo(dst[key.Length..]);
+
+				bool wasEmpty = pendingLength == 0;
+				pendingLength += size;
+				enqueuedWrites++;
+				if (wasEmpty) Monitor.PulseAll(sync);
+			}
+		}
+
+		/// <summary>
+		/// Enqueues a write of a key/data pair.
+		/// </summary>
+		/// <param name="dbi">The database interface handle</param>
+		/// <param name="key">The key to store</param>
+		/// <param name="data">The data to store</param>
+		/// <param name="flags">Special options for this operation, which may not include <see cref="MDBWriteFlags.Reserve"/></param>
+		/// <exception cref="MDBException">If a previous batch failed</exception>
+		public void Put(MDBDBI dbi, ReadOnlySpan<byte> key, ReadOnlySpan<byte> data, MDBWriteFlags flags = 0) =>
+			Enqueue(WriteOp.Put, dbi, key, data, flags);
+
+		/// <summary>
+		/// Similar to <see cref="Put(MDBDBI, ReadOnlySpan{byte}, ReadOnlySpan{byte}, MDBWriteFlags)"/>, but uses the byte
+		/// representation of values for both the key and value.
+		/// </summary>
+		/// <typeparam name="K">Key type</typeparam>
+		/// <typeparam name="V">Value type</typeparam>
+		/// <param name="dbi">The database interface handle</param>
+		/// <param name="key">The key to store</param>
+		/// <param name="value">The value to store</param>
+		/// <param name="flags">Special options for this operation, which may not include <see cref="MDBWriteFlags.Reserve"/></param>
+		/// <exception cref="MDBException">If a previous batch failed</exception>
+		public void Put<K, V>(MDBDBI dbi, in K key, in V value, MDBWriteFlags flags = 0) where K : unmanaged where V : unmanaged =>
+			Enqueue(WriteOp.Put, dbi, AsBytes(key), AsBytes(value), flags);
+
+		/// <summary>
+		/// Enqueues a write of a key/value pair to a typed database.
+		/// </summary>
+		/// <typeparam name="K">Key type</typeparam>
+		/// <typeparam name="V">Value type</typeparam>
+		/// <param name="db">The database to write to</param>
+		/// <param name="key">The key to store</param>
+		/// <param name="value">The value to store</param>
+		/// <param name="flags">Special options for this operation, which may not include <see cref="MDBWriteFlags.Reserve"/></param>
+		/// <exception cref="MDBException">If a previous batch failed</exception>
+		public void Put<K, V>(MDBDatabase<K, V> db, in K key, in V value, MDBWriteFlags flags = 0) where K : unmanaged where V : unmanaged =>
+			Put(db.DBI, key, value, flags);
+
+		/// <summary>
+		/// Enqueues a delete of a key and all of its data.
+		/// </summary>
+		/// <param name="dbi">The database interface handle</param>
+		/// <param name="key">The key to delete</param>
+		/// <exception cref="MDBException">If a previous batch failed</exception>
+		public void Delete(MDBDBI dbi, ReadOnlySpan<byte> key) => Enqueue(WriteOp.Delete, dbi, key, ReadOnlySpan<byte>.Empty, 0);
+
+		/// <summary>
+		/// Similar to <see cref="Delete(MDBDBI, ReadOnlySpan{byte})"/>, but uses the byte representation of the key value.
+		/// </summary>
+		/// <typeparam name="K">Key type</typeparam>
+		/// <param name="dbi">The database interface handle</param>
+		/// <param name="key">The key to delete</param>
+		/// <exception cref="MDBException">If a previous batch failed</exception>
+		public void Delete<K>(MDBDBI dbi, in K key) where K : unmanaged => Delete(dbi, AsBytes(key));
+
+		/// <summary>
+		/// Enqueues a delete of a key from a typed database.
+		/// </summary>
+		/// <typeparam name="K">Key type</typeparam>
+		/// <typeparam name="V">Value type</typeparam>
+		/// <param name="db">The database to delete from</param>
+		/// <param name="key">The key to delete</param>
+		/// <exception cref="MDBException">If a previous batch failed</exception>
+		public void Delete<K, V>(MDBDatabase<K, V> db, in K key) where K : unmanaged where V : unmanaged => Delete(db.DBI, key);
+
+		private static ReadOnlySpan<byte> AsBytes<T>(in T value) where T : unmanaged =>
+			MemoryMarshal.AsBytes(MemoryMarshal.CreateReadOnlySpan(ref Unsafe.AsRef(value), 1));
+
+		/// <summary>
+		/// Blocks until every write enqueued before this call has been committed.
+		/// </summary>
+		/// <exception cref="MDBException">If a batch failed</exception>
+		/// <exception cref="ObjectDisposedException">If the writer stopped before committing the writes</exception>
+		public void Flush() {
+			lock (sync) {
+				long target = enqueuedWrites;
+				// Wake the writer early if it is waiting out the commit delay
+				Monitor.PulseAll(sync);
+				while (committedWrites < target) {
+					ThrowIfFailed();
+					// The writer commits everything enqueued before it stops, so this only happens if it exited abnormally
+					if (writerExited) throw new ObjectDisposedException(nameof(MDBWriteQueue));
+					Monitor.Wait(sync);
+				}
+				ThrowIfFailed();
+			}
+		}
+
+		private void WriterLoop() {
+			try {
+				WriteBatches();
+			} finally {
+				// Wake any flushes, which can no longer complete
+				lock (sync) {
+					writerExited = true;
+					Monitor.PulseAll(sync);
+				}
+			}
+		}
+
+		private void WriteBatches() {
+			while (true) {
+				int length;
+				long target;
+				lock (sync) {
+					while (pendingLength == 0 && !stopping) Monitor.Wait(sync);
+					if (pendingLength == 0) return;
+
+					// Let more writes accumulate, ending early if flushed or disposed
+					if (CommitDelay > TimeSpan.Zero && !stopping) Monitor.Wait(sync, CommitDelay);
+
+					(pending, committing) = (committing, pending);
+					length = pendingLength;
+					target = enqueuedWrites;
+					pendingLength = 0;
+					// Release any producers blocked by backpressure
+					Monitor.PulseAll(sync);
+				}
+
+				try {
+					Commit(committing.AsSpan(0, length));
+				} catch (Exception e) {
+					lock (sync) error = e;
+					return;
+				}
+
+				lock (sync) {
+					committedWrites = target;
+					committedBatches++;
+					Monitor.PulseAll(sync);
+				}
+			}
+		}
+
+		// Applies every write in a batch buffer in a single write transaction
+		private void Commit(ReadOnlySpan<byte> batch) {
+			using MDBTxn txn = Env.Begin();
+			unsafe {
+				fixed (byte* pBatch = batch) {
+					int offset = 0;
+					while (offset < batch.Length) {
+						WriteHeader header = Unsafe.ReadUnaligned<WriteHeader>(pBatch + offset);
+						offset += sizeof(WriteHeader);
+						MDBVal key = new() {
+							Size = (nuint)header.KeySize,
+							Data = (IntPtr)(pBatch + offset)
+						};
+						offset += header.KeySize;
+						MDBVal data = new() {
+							Size = (nuint)header.ValueSize,
+							Data = (IntPtr)(pBatch + offset)
+						};
+						offset += header.ValueSize;
+
+						MDBResult err;
+						switch (header.Op) {
+							case WriteOp.Put:
+								err = MDB.Functions.mdb_put(txn.Txn, header.DBI, key, ref data, header.Flags);
+								if (err != MDBResult.Success && err != MDBResult.KeyExist) throw new MDBException("Failed to put database entry", err);
+								break;
+							case WriteOp.Delete:
+								err = MDB.Functions.mdb_del(txn.Txn, header.DBI, key, (MDBVal*)0);
+								if (err != MDBResult.Success && err != MDBResult.NotFound) throw new MDBException("Failed to delete database entry", err);
+								break;
+						}
+					}
+				}
+			}
+			txn.Commit();
+		}
+
+		/// <summary>
+		/// Commits any pending writes and stops the writer thread. Errors from the final batch are not rethrown, call
+		/// <see cref="Flush"/> first to observe them.
+		/// </summary>
+		public void Dispose() {
+			GC.SuppressFinalize(this);
+			lock (sync) {
+				if (stopping) return;
+				stopping = true;
+				Monitor.PulseAll(sync);
+			}
+			writer.Join();
+		}
+
+	}
+
+}
@@ -82,12 +82,18 @@ namespace Tesseract.LuaJIT {
 			if (hook != null) {
 				// Create a wrapper to manually marshal the values and save it in the array for its respective event
 				var wrapper = (IntPtr pState, IntPtr pDebug) => {
+					// The hook may run on any thread of this state, so errors must be raised on the thread that invoked it
+					LuaBase lua = Get(pState);
+					Exception ex;
 					try {
-						hook(Get(pState).RootState, MemoryUtil.ReadUnmanaged<LuaDebug>(pDebug));
-					} catch (Exception ex) {
-						CaptureManagedException(ex);
-						Error("C# exception: " + ex.Message);
+						hook(lua.RootState, MemoryUtil.ReadUnmanaged<LuaDebug>(pDebug));
+						return;
+					} catch (Exception e) {
+						CaptureManagedException(e);
+						ex = e;
 					}
+					lua.PushString("C# exception: " + ex.Message);
+					unsafe { Lua.Functions.lua_error(pState); }
 				};
 				hooks[(int)evt] = wrapper;
 				// Get the corresponding function pointer and use that to set the Lua hook
@@ -0,0 +1,343 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+
+namespace Tesseract.LuaJIT.Utilities {
+
+	/// <summary>
+	/// Occupancy statistics for a single size class of a <see cref="LuaArena"/>.
+	/// </summary>
+	public readonly record struct LuaArenaClassStatistics {
+
+		/// <summary>
+		/// The size in bytes of blocks in this class.
+		/// </summary>
+		public int BlockSize { get; init; }
+
+		/// <summary>
+		/// The number of blocks currently allocated.
+		/// </summary>
+		public int UsedBlocks { get; init; }
+
+		/// <summary>
+		/// The number of blocks which have been carved from slabs, either allocated or free.
+		/// </summary>
+		public int TotalBlocks { get; init; }
+
+		/// <summary>
+		/// The number of slabs reserved for this class.
+		/// </summary>
+		public int Slabs { get; init; }
+
+		/// <summary>
+		/// The fraction of carved blocks which are allocated, between 0 and 1.
+		/// </summary>
+		public double Occupancy => TotalBlocks == 0 ? 0 : (double)UsedBlocks / TotalBlocks;
+
+	}
+
+	/// <summary>
+	/// A snapshot of the memory usage of a <see cref="LuaArena"/>.
+	/// </summary>
+	public readonly record struct LuaArenaStatistics {
+
+		/// <summary>
+		/// Statistics for each size class, in order of increasing block size.
+		/// </summary>
+		public IReadOnlyList<LuaArenaClassStatistics> Classes { get; init; }
+
+		/// <summary>
+		/// The number of allocations too large for any size class.
+		/// </summary>
+		public int LargeObjects { get; init; }
+
+		/// <summary>
+		/// The total size of allocations too large for any size class.
+		/// </summary>
+		public nuint LargeObjectBytes { get; init; }
+
+		/// <summary>
+		/// The total amount of memory reserved from the system, including free blocks in slabs.
+		/// </summary>
+		public nuint ReservedBytes { get; init; }
+
+	}
+
+	/// <summary>
+	/// <para>
+	/// An arena allocator for Lua states. Small allocations are served from segregated size classes, each carving fixed-size
+	/// blocks out of shared slabs and recycling freed blocks through an intrusive free list, so allocating or freeing a small
+	/// object is a handful of pointer operations. Allocations larger than <see cref="MaxSmallSize"/> are allocated individually
+	/// and linked together so they can be released with the arena.
+	/// </para>
+	/// <para>
+	/// The arena relies on the Lua allocator contract that frees and reallocations pass the original size of the block, so
+	/// small blocks need no header. All memory is released at once when the arena is disposed, and <see cref="DeferFrees"/>
+	/// can be used before closing a Lua state so that the individual frees issued while closing it are skipped entirely.
+	/// </para>
+	/// <para>
+	/// The arena is not thread-safe, and must be disposed by its owner only after the Lua state using it has been closed.
+	/// </para>
+	/// </summary>
+	public sealed unsafe class LuaArena : IDisposable {
+
+		/// <summary>
+		/// The size of the slabs blocks are carved from.
+		/// </summary>
+		public const int SlabSize = 64 * 1024;
+
+		/// <summary>
+		/// The largest allocation served from a size class.
+		/// </summary>
+		public const int MaxSmallSize = 2048;
+
+		// Alignment of all returned memory
+		private const int Alignment = 16;
+
+		// Block sizes of each class, spaced to keep internal fragmentation to at most 25% above 128 bytes
+		private static readonly int[] classSizes = {
+			16, 32, 48, 64, 80, 96, 112, 128,
+			160, 192, 224, 256, 320, 384, 448, 512,
+			640, 768, 896, 1024, 1280, 1536, 1792, 2048
+		};
+
+		// Maps allocation sizes in units of the alignment to their size class
+		private static readonly byte[] classLookup = CreateClassLookup();
+
+		private static byte[] CreateClassLookup() {
+			byte[] lookup = new byte[MaxSmallSize / Alignment + 1];
+			int cls = 0;
+			for (int i = 0; i < lookup.Length; i++) {
+				while (classSizes[cls] < i * Alignment) cls++;
+				lookup[i] = (byte)cls;
+			}
+			return lookup;
+		}
+
+		// State of a single size class
+		private struct SizeClass {
+
+			// Head of the list of freed blocks, each storing a pointer to the next free block
+			public byte* Free;
+			// The unused region at the end of the current slab
+			public byte* Bump, BumpEnd;
+
+			public int Used, Total, Slabs;
+
+		}
+
+		// Header prepended to large allocations, keeping the payload aligned
+		[StructLayout(LayoutKind.Sequential, Size = 32)]
+		private struct LargeHeader {
+
+			public LargeHeader* Prev, Next;
+
+			public nuint Size;
+
+		}
+
+		private readonly SizeClass[] classes = new SizeClass[classSizes.Length];
+		private readonly List<IntPtr> slabs = new();
+
+		private LargeHeader* largeHead = null;
+		private int largeCount = 0;
+		private nuint largeBytes = 0;
+
+		private bool freesDeferred = false;
+		private bool disposed = false;
+
+		// Gets the size class for an allocation size, or -1 if it is a large allocation
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static int ClassOf(nuint size) => size <= MaxSmallSize ? classLookup[(int)(size + Alignment - 1) / Alignment] : -1;
+
+		/// <summary>
+		/// Allocates, reallocates, or frees memory following the semantics of a Lua allocator function. A new size of zero frees
+		/// the block, a null pointer allocates a new block, and otherwise the block is resized, keeping its contents.
+		/// </summary>
+		/// <param name="ptr">The existing block, or null</param>
+		/// <param name="osize">The original size of the existing block</param>
+		/// <param name="nsize">The new size of the block</param>
+		/// <returns>The new block, or null if the block was freed or the allocation failed</returns>
+		public IntPtr Alloc(IntPtr ptr, nuint osize, nuint nsize) {
+			if (nsize == 0) {
+				if (ptr != IntPtr.Zero) Free((byte*)ptr, osize);
+				return IntPtr.Zero;
+			}
+			if (ptr == IntPtr.Zero) return (IntPtr)Allocate(nsize);
+
+			int oldClass = ClassOf(osize), newClass = ClassOf(nsize);
+			// Blocks can be resized in place if they stay within the same class
+			if (oldClass >= 0 && oldClass == newClass) return ptr;
+			if (oldClass < 0 && newClass < 0) {
+				byte* large = ReallocateLarge((byte*)ptr, nsize);
+				// Large blocks are freed by their recorded size, so a failed shrink can keep the original block
+				if (large == null && nsize <= osize) return ptr;
+				return (IntPtr)large;
+			}
+
+			byte* block = Allocate(nsize);
+			if (block == null) {
+				// Lua expects shrinking to succeed, so keep the original block. It will later be freed into the smaller size class,
+				// which it is large enough to serve. Large blocks carry a header and cannot join a size class, so they still fail.
+				if (nsize <= osize && oldClass >= 0) {
+					// The block now belongs to the smaller class, so move it between the class counters to match
+					classes[oldClass].Used--;
+					classes[oldClass].Total--;
+					classes[newClass].Used++;
+					classes[newClass].Total++;
+					return ptr;
+				}
+				return IntPtr.Zero;
+			}
+			Buffer.MemoryCopy((void*)ptr, block, nsize, Math.Min(osize, nsize));
+			Free((byte*)ptr, osize);
+			return (IntPtr)block;
+		}
+
+		/// <summary>
+		/// Stops freeing individual blocks, which will instead be released when the arena is disposed. This should be called
+		/// before closing the Lua state using the arena, so closing the state does not need to return each object to the arena.
+		/// </summary>
+		public void DeferFrees() => freesDeferred = true;
+
+		private byte* Allocate(nuint size) {
+			if (disposed) return null;
+			int cls = ClassOf(size);
+			if (cls < 0) return AllocateLarge(size);
+
+			ref SizeClass sc = ref classes[cls];
+			byte* block = sc.Free;
+			if (block != null) {
+				sc.Free = *(byte**)block;
+			} else {
+				if (sc.Bump == sc.BumpEnd && !AddSlab(ref sc, classSizes[cls])) return null;
+				block = sc.Bump;
+				sc.Bump += classSizes[cls];
+				sc.Total++;
+			}
+			sc.Used++;
+			return block;
+		}
+
+		private void Free(byte* block, nuint size) {
+			if (freesDeferred || disposed) return;
+			int cls = ClassOf(size);
+			if (cls < 0) {
+				FreeLarge(block);
+				return;
+			}
+
+			ref SizeClass sc = ref classes[cls];
+			*(byte**)block = sc.Free;
+			sc.Free = block;
+			sc.Used--;
+		}
+
+		// Reserves a new slab for a size class, returning false if no memory is available
+		private bool AddSlab(ref SizeClass sc, int blockSize) {
+			byte* slab;
+			try {
+				slab = (byte*)NativeMemory.AlignedAlloc(SlabSize, Alignment);
+			} catch (OutOfMemoryException) {
+				// Exceptions cannot propagate through the Lua runtime, so report failure as a null allocation
+				return false;
+			}
+			slabs.Add((IntPtr)slab);
+			sc.Bump = slab;
+			sc.BumpEnd = slab + (SlabSize / blockSize) * blockSize;
+			sc.Slabs++;
+			return true;
+		}
+
+		//===============//
+		// Large Objects //
+		//===============//
+
+		private byte* AllocateLarge(nuint size) {
+			LargeHeader* header;
+			try {
+				header = (LargeHeader*)NativeMemory.AlignedAlloc((nuint)sizeof(LargeHeader) + size, Alignment);
+			} catch (OutOfMemoryException) {
+				return null;
+			}
+			header->Prev = null;
+			header->Next = largeHead;
+			header->Size = size;
+			if (largeHead != null) largeHead->Prev = header;
+			largeHead = header;
+			largeCount++;
+			largeBytes += size;
+			return (byte*)(header + 1);
+		}
+
+		private byte* ReallocateLarge(byte* block, nuint size) {
+			LargeHeader* header = (LargeHeader*)block - 1;
+			nuint oldSize = header->Size;
+			try {
+				header = (LargeHeader*)NativeMemory.AlignedRealloc(header, (nuint)sizeof(LargeHeader) + size, Alignment);
+			} catch (OutOfMemoryException) {
+				return null;
+			}
+			// The header may have moved, so relink its neighbours
+			if (header->Prev != null) header->Prev->Next = header;
+			else largeHead = header;
+			if (header->Next != null) header->Next->Prev = header;
+			header->Size = size;
+			largeBytes = largeBytes - oldSize + size;
+			return (byte*)(header + 1);
+		}
+
+		private void FreeLarge(byte* block) {
+			LargeHeader* header = (LargeHeader*)block - 1;
+			if (header->Prev != null) header->Prev->Next = header->Next;
+			else largeHead = header->Next;
+			if (header->Next != null) header->Next->Prev = header->Prev;
+			largeCount--;
+			largeBytes -= header->Size;
+			NativeMemory.AlignedFree(header);
+		}
+
+		/// <summary>
+		/// Gets a snapshot of the current memory usage of the arena.
+		/// </summary>
+		/// <returns>Arena statistics</returns>
+		public LuaArenaStatistics GetStatistics() {
+			var stats = new LuaArenaClassStatistics[classes.Length];
+			for (int i = 0; i < classes.Length; i++) {
+				ref SizeClass sc = ref classes[i];
+				stats[i] = new LuaArenaClassStatistics() {
+					BlockSize = classSizes[i],
+					UsedBlocks = sc.Used,
+					TotalBlocks = sc.Total,
+					Slabs = sc.Slabs
+				};
+			}
+			return new LuaArenaStatistics() {
+				Classes = stats,
+				LargeObjects = largeCount,
+				LargeObjectBytes = largeBytes,
+				ReservedBytes = (nuint)slabs.Count * SlabSize + largeBytes
+			};
+		}
+
+		public void Dispose() {
+			if (disposed) return;
+			disposed = true;
+
+			foreach (IntPtr slab in slabs) NativeMemory.AlignedFree((void*)slab);
+			slabs.Clear();
+			Array.Clear(classes);
+
+			while (largeHead != null) {
+				LargeHeader* next = largeHead->Next;
+				NativeMemory.AlignedFree(largeHead);
+				largeHead = next;
+			}
+			largeCount = 0;
+			largeBytes = 0;
+		}
+
+	}
+
+}
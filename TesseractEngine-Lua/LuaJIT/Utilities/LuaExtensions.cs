@@ -1,10 +1,13 @@
 ﻿using System;
+using System.Buffers;
 using System.Buffers.Binary;
+using System.Buffers.Text;
 using System.Collections.Generic;
 using System.Diagnostics.CodeAnalysis;
 using System.Linq;
 using System.Numerics;
 using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
 using System.Text;
 using System.Text.Json;
 using System.Text.Json.Nodes;
@@ -38,13 +41,13 @@ namespace Tesseract.LuaJIT.Utilities {
 			lua.PushNil();
 			while(lua.Next(index)) {
 				// All keys must be numbers
-				if (!lua.IsNumber(-2)) {
+				if (lua.Type(-2) != LuaType.Number) {
 					lua.Pop(2);
 					return false;
 				}
 				double nd = lua.ToNumber(-2);
 				// All keys must be integers
-				if (nd % 1 < double.Epsilon) {
+				if (!double.IsInteger(nd)) {
 					lua.Pop(2);
 					return false;
 				}
@@ -156,43 +159,59 @@ namespace Tesseract.LuaJIT.Utilities {
 			lua.Pop(1);
 		}
 
-		private static int JsonDecode(LuaBase lua, JsonElement element) {
-			switch (element.ValueKind) {
-				case JsonValueKind.Object: {
-						lua.CreateTable();
-						foreach(var elem in element.EnumerateObject()) {
-							lua.PushString(elem.Name);
-							JsonDecode(lua, elem.Value);
-							lua.RawSet(-3);
-						}
-					}
-					break;
-				case JsonValueKind.Array: {
-						lua.CreateTable(narr: element.GetArrayLength());
-						int index = 1;
-						foreach(var elem in element.EnumerateArray()) {
-							JsonDecode(lua, element);
-							lua.RawSet(-1, index++);
-						}
-					}
-					break;
-				case JsonValueKind.String:
-					lua.PushString(element.GetString());
-					break;
-				case JsonValueKind.Number:
-					lua.PushNumber(element.GetDouble());
-					break;
-				case JsonValueKind.True:
-					lua.PushBoolean(true);
-					break;
-				case JsonValueKind.False:
-					lua.PushBoolean(false);
-					break;
-				case JsonValueKind.Undefined:
-				case JsonValueKind.Null:
-					break;
+		/// <summary>
+		/// Decodes a JSON value from UTF-8 text, pushing it onto the stack. Objects and arrays are decoded as tables and
+		/// <c>null</c> is decoded as <c>nil</c>.
+		/// </summary>
+		/// <param name="lua">The Lua interface</param>
+		/// <param name="json">The JSON text</param>
+		/// <param name="options">The JSON reader options</param>
+		/// <exception cref="LuaException">If the JSON text is invalid</exception>
+		public static void DecodeJson(this LuaBase lua, ReadOnlySpan<byte> json, JsonReaderOptions options = default) {
+			using LuaJsonDecoder decoder = new(lua, options);
+			decoder.Decode(json, true);
+		}
+
+		/// <summary>
+		/// Decodes a JSON value from a stream of UTF-8 text, pushing it onto the stack. The stream is read incrementally,
+		/// so large documents are decoded without buffering the entire text.
+		/// </summary>
+		/// <param name="lua">The Lua interface</param>
+		/// <param name="stream">The stream to read JSON text from</param>
+		/// <param name="options">The JSON reader options</param>
+		/// <exception cref="LuaException">If the JSON text is invalid</exception>
+		public static void DecodeJson(this LuaBase lua, Stream stream, JsonReaderOptions options = default) {
+			using LuaJsonDecoder decoder = new(lua, options);
+			byte[] buffer = ArrayPool<byte>.Shared.Rent(64 * 1024);
+			try {
+				int nread;
+				do {
+					nread = stream.Read(buffer);
+				} while (!decoder.Decode(buffer.AsSpan(0, nread), nread == 0));
+			} finally {
+				ArrayPool<byte>.Shared.Return(buffer);
+			}
+		}
+
+		/// <summary>
+		/// Encodes the Lua value at the given stack index as JSON. Strings are written directly from their bytes, which must be
+		/// valid UTF-8. Tables are encoded as arrays if they are proper arrays (see <see cref="IsArray(LuaBase, int)"/>), and
+		/// as objects otherwise, in which case their keys must be strings or numbers.
+		/// </summary>
+		/// <param name="lua">The Lua interface</param>
+		/// <param name="writer">The JSON writer</param>
+		/// <param name="index">The stack index of the value to encode</param>
+		/// <exception cref="LuaException">If the value cannot be encoded as JSON</exception>
+		public static void EncodeJson(this LuaBase lua, Utf8JsonWriter writer, int index) {
+			try {
+				JsonEncode(lua, lua.ToAbsoluteIndex(index), writer);
+			} catch (ArgumentException e) {
+				// Thrown for invalid UTF-8 strings or non-finite numbers
+				throw new LuaException($"Cannot encode value as JSON: {e.Message}", e);
+			} catch (InvalidOperationException e) {
+				// Thrown when exceeding the maximum depth, ie. for cyclic tables
+				throw new LuaException($"Cannot encode value as JSON: {e.Message}", e);
 			}
-			return 1;
 		}
 
 		private static void JsonEncode(LuaBase lua, int value, Utf8JsonWriter writer) {
@@ -209,14 +228,16 @@ namespace Tesseract.LuaJIT.Utilities {
 					writer.WriteNumberValue(lua.ToNumber(value));
 					break;
 				case LuaType.String:
-					writer.WriteStringValue(lua.ToString(value));
+					writer.WriteStringValue(lua.ToStringBytes(value));
 					break;
 				case LuaType.Table:
 					value = lua.ToAbsoluteIndex(value);
+					if (!lua.CheckStack(3)) throw new LuaException("Table is nested too deeply to encode");
 					if (lua.IsArray(value)) {
 						writer.WriteStartArray();
-						lua.PushNil();
-						while (lua.Next(value)) {
+						int length = (int)lua.ObjLen(value);
+						for (int i = 1; i <= length; i++) {
+							lua.RawGet(value, i);
 							JsonEncode(lua, -1, writer);
 							lua.Pop(1);
 						}
@@ -225,8 +246,20 @@ namespace Tesseract.LuaJIT.Utilities {
 						writer.WriteStartObject();
 						lua.PushNil();
 						while(lua.Next(value)) {
-							if (!lua.IsString(-2)) throw new LuaException("Cannot encode object with non-string key");
-							writer.WritePropertyName(lua.ToString(-2)!);
+							switch (lua.Type(-2)) {
+								case LuaType.String:
+									writer.WritePropertyName(lua.ToStringBytes(-2));
+									break;
+								case LuaType.Number: {
+										// Format numeric keys without converting them in place, which would break iteration
+										Span<byte> key = stackalloc byte[32];
+										Utf8Formatter.TryFormat(lua.ToNumber(-2), key, out int written);
+										writer.WritePropertyName(key[..written]);
+									}
+									break;
+								default:
+									throw new LuaException("Cannot encode object with non-string key");
+							}
 							JsonEncode(lua, -1, writer);
 							lua.Pop(1);
 						}
@@ -269,31 +302,24 @@ namespace Tesseract.LuaJIT.Utilities {
 			Register(lua, "json"u8, "encode"u8, state => {
 				JsonWriterOptions opts = default;
 				int argc = state.Top;
-				for(int i = 2; i < argc; i++) {
-					string opt = lua.CheckString(i);
-					switch (opt) {
-						case "pretty":
-							opts = opts with { Indented = true };
-							break;
-						default:
-							throw new LuaException($"Unrecognized encoding option \"{opt}\"");
-					}
+				for(int i = 2; i <= argc; i++) {
+					ReadOnlySpan<byte> opt = state.CheckStringBytes(i);
+					if (opt.SequenceEqual("pretty"u8)) opts = opts with { Indented = true };
+					else throw new LuaException($"Unrecognized encoding option \"{Encoding.UTF8.GetString(opt)}\"");
 				}
 
-				using MemoryStream ms = new();
-				Utf8JsonWriter writer = new(ms, opts);
-
-				state.PushString(ms.ToArray());
+				using PooledBufferWriter buffer = new();
+				using (Utf8JsonWriter writer = new(buffer, opts)) {
+					EncodeJson(state, writer, 1);
+				}
+				state.PushString(buffer.WrittenSpan);
 				return 1;
 			});
 
 			Register(lua, "json"u8, "decode"u8, state => {
-				ReadOnlySpan<byte> jsonString = state.CheckStringBytes(1);
-				Utf8JsonReader reader = new(jsonString);
-				if (JsonElement.TryParseValue(ref reader, out JsonElement? json) && json != null) {
-					JsonDecode(state, json.Value);
-					return 1;
-				} else throw new LuaException("Unexpected end of JSON");
+				// The string stays on the stack, so its bytes can be decoded in place
+				DecodeJson(state, state.CheckStringBytes(1));
+				return 1;
 			});
 		}
 
@@ -336,7 +362,15 @@ namespace Tesseract.LuaJIT.Utilities {
 			/// <summary>
 			/// Custom value token.
 			/// </summary>
-			Custom =    (byte)'C'
+			Custom =    (byte)'C',
+			/// <summary>
+			/// Token for a reference to a previously serialized string.
+			/// </summary>
+			StringRef = (byte)'S',
+			/// <summary>
+			/// Token for a reference to a previously serialized table.
+			/// </summary>
+			TableRef =  (byte)'R'
 		}
 
 		/// <summary>
@@ -347,14 +381,127 @@ namespace Tesseract.LuaJIT.Utilities {
 		public static int MaxDataSize { get; set; } = int.MaxValue;
 
 		/// <summary>
-		/// Serializes the Lua value at the given stack index into binary data using a <see cref="BinaryWriter"/>.
+		/// The version of the binary format written by <see cref="Serialize(LuaBase, IBufferWriter{byte}, int)"/>, stored as
+		/// the first byte of the serialized data.
 		/// </summary>
-		/// <param name="lua">The Lua interface</param>
-		/// <param name="bw">The writer to serialize data to</param>
-		/// <param name="index">The stack index of the value to serialize</param>
-		/// <exception cref="LuaException">If there was an error during serialization</exception>
-		public static void Serialize(this LuaBase lua, BinaryWriter bw, int index) {
-			bool TrySerializeCustom(int index) {
+		public const byte SerialVersion = 1;
+
+		// Strings shorter than this are always written inline instead of being deduplicated
+		private const int MinDedupStringLength = 4;
+
+		// The maximum nesting depth of serialized tables
+		private const int MaxSerialDepth = 256;
+
+		// A buffer writer over memory rented from the shared array pool
+		private sealed class PooledBufferWriter : IBufferWriter<byte>, IDisposable {
+
+			private byte[] buffer = ArrayPool<byte>.Shared.Rent(256);
+			private int written = 0;
+
+			public ReadOnlySpan<byte> WrittenSpan => buffer.AsSpan(0, written);
+
+			public void Advance(int count) => written += count;
+
+			public Memory<byte> GetMemory(int sizeHint = 0) {
+				Ensure(sizeHint);
+				return buffer.AsMemory(written);
+			}
+
+			public Span<byte> GetSpan(int sizeHint = 0) {
+				Ensure(sizeHint);
+				return buffer.AsSpan(written);
+			}
+
+			private void Ensure(int sizeHint) {
+				if (buffer.Length - written >= Math.Max(sizeHint, 1)) return;
+				byte[] newBuffer = ArrayPool<byte>.Shared.Rent(Math.Max(buffer.Length * 2, written + sizeHint));
+				buffer.AsSpan(0, written).CopyTo(newBuffer);
+				ArrayPool<byte>.Shared.Return(buffer);
+				buffer = newBuffer;
+			}
+
+			public void Dispose() {
+				if (buffer.Length > 0) {
+					ArrayPool<byte>.Shared.Return(buffer);
+					buffer = Array.Empty<byte>();
+				}
+				written = 0;
+			}
+
+		}
+
+		// State for a single serialization, tracking the strings and tables already written so repeats are written by reference
+		private sealed class SerialEncoder {
+
+			// Cached encoder for the current thread, taken while in use so nested serialization gets its own
+			[ThreadStatic]
+			private static SerialEncoder? cached;
+
+			private LuaBase lua = null!;
+			private IBufferWriter<byte> writer = null!;
+			// Maps interned Lua string pointers to string IDs (strings are anchored by the value being serialized)
+			private readonly Dictionary<IntPtr, int> strings = new();
+			// Maps table pointers to table IDs
+			private readonly Dictionary<IntPtr, int> tables = new();
+			private int stringCount = 0;
+
+			public static SerialEncoder Rent(LuaBase lua, IBufferWriter<byte> writer) {
+				SerialEncoder encoder = cached ?? new();
+				cached = null;
+				encoder.lua = lua;
+				encoder.writer = writer;
+				return encoder;
+			}
+
+			public void Return() {
+				strings.Clear();
+				tables.Clear();
+				stringCount = 0;
+				lua = null!;
+				writer = null!;
+				cached = this;
+			}
+
+			[MethodImpl(MethodImplOptions.AggressiveInlining)]
+			public void WriteByte(byte value) {
+				writer.GetSpan(1)[0] = value;
+				writer.Advance(1);
+			}
+
+			// Writes a token followed by a 7-bit encoded unsigned integer
+			public void WriteToken(SerialToken token, uint value) {
+				Span<byte> span = writer.GetSpan(6);
+				span[0] = (byte)token;
+				int n = 1;
+				while (value >= 0x80) {
+					span[n++] = (byte)(value | 0x80);
+					value >>= 7;
+				}
+				span[n++] = (byte)value;
+				writer.Advance(n);
+			}
+
+			// Writes a length-prefixed piece of binary data
+			public void WriteData(SerialToken token, ReadOnlySpan<byte> data) {
+				WriteToken(token, (uint)data.Length);
+				writer.Write(data);
+			}
+
+			private void WriteLength(ReadOnlySpan<byte> data, string what) {
+				if (data.Length > MaxDataSize) throw new LuaException($"{what} too large");
+				Span<byte> span = writer.GetSpan(5);
+				uint value = (uint)data.Length;
+				int n = 0;
+				while (value >= 0x80) {
+					span[n++] = (byte)(value | 0x80);
+					value >>= 7;
+				}
+				span[n++] = (byte)value;
+				writer.Advance(n);
+				writer.Write(data);
+			}
+
+			private bool TryWriteCustom(int index) {
 				bool isCustom = false;
 				if (lua.GetMetatable(index)) {
 					lua.GetField(-1, "__serialize"u8);
@@ -367,185 +514,350 @@ namespace Tesseract.LuaJIT.Utilities {
 					lua.Call(1, 2);
 					if (!(lua.IsString(-2) && lua.IsString(-1)))
 						throw new LuaException("Custom serialization function must return key and data as strings");
-					// Write data to the stream
-					bw.Write((byte)SerialToken.Custom);
-					ReadOnlySpan<byte> key = lua.ToStringBytes(-2);
-					if (key.Length > MaxDataSize) throw new LuaException("Custom value key too large");
-					bw.Write7BitEncodedInt(key.Length);
-					bw.Write(key);
-					ReadOnlySpan<byte> data = lua.ToStringBytes(-1);
-					if (data.Length > MaxDataSize) throw new LuaException("Custom value data too large");
-					bw.Write7BitEncodedInt(data.Length);
-					bw.Write(data);
+					// <Token:B> <KeyLength:7bI> <Key:nB> <DataLength:7bI> <Data:nB>
+					WriteByte((byte)SerialToken.Custom);
+					WriteLength(lua.ToStringBytes(-2), "Custom value key");
+					WriteLength(lua.ToStringBytes(-1), "Custom value data");
 					return true;
 				} else return false;
 			}
 
-			switch (lua.Type(index)) {
-				case LuaType.Nil:
-					bw.Write((byte)SerialToken.Nil);
-					break;
-				case LuaType.Boolean:
-					if (lua.ToBoolean(index)) bw.Write((byte)SerialToken.True);
-					else bw.Write((byte)SerialToken.False);
-					break;
-				case LuaType.Number: {
-						double num = lua.ToNumber(index);
-						if (double.IsInteger(num) && num >= int.MinValue && num <= int.MaxValue) {
-							bw.Write((byte)SerialToken.PackedInt);
-							bw.Write7BitEncodedInt((int)num);
-						} else {
-							bw.Write((byte)SerialToken.Double);
-							bw.Write(num);
+			public unsafe void WriteValue(int index, int depth) {
+				switch (lua.Type(index)) {
+					case LuaType.Nil:
+						WriteByte((byte)SerialToken.Nil);
+						break;
+					case LuaType.Boolean:
+						WriteByte((byte)(lua.ToBoolean(index) ? SerialToken.True : SerialToken.False));
+						break;
+					case LuaType.Number: {
+							double num = lua.ToNumber(index);
+							if (double.IsInteger(num) && num >= int.MinValue && num <= int.MaxValue && !(num == 0 && double.IsNegative(num))) {
+								// <Token:B> <ZigZagValue:7bI>
+								int inum = (int)num;
+								WriteToken(SerialToken.PackedInt, (uint)((inum << 1) ^ (inum >> 31)));
+							} else {
+								// <Token:B> <Value:8B>
+								Span<byte> span = writer.GetSpan(9);
+								span[0] = (byte)SerialToken.Double;
+								BinaryPrimitives.WriteDoubleLittleEndian(span[1..], num);
+								writer.Advance(9);
+							}
 						}
-					}
-					break;
-				case LuaType.String: {
-						ReadOnlySpan<byte> strBytes = lua.ToStringBytes(index);
-						if (strBytes.Length > MaxDataSize) throw new LuaException("String too large");
-						// <Token:B> <Length:7bI> <Data:nB>
-						bw.Write((byte)SerialToken.String);
-						bw.Write7BitEncodedInt(strBytes.Length);
-						bw.Write(strBytes);
-					}
-					break;
-				case LuaType.Table: {
-						index = lua.ToAbsoluteIndex(index);
-						int top = lua.Top;
-						try {
-							// Try to use the custom serialization function, else fall back to default
-							// method for serializing tables
-							if (!TrySerializeCustom(index)) {
-								// <Token:B> [<Key:?> <Value:?]... <End:B>
-								bw.Write((byte)SerialToken.Table);
-								lua.PushNil();
-								while (lua.Next(index)) {
-									Serialize(lua, bw, -2);
-									Serialize(lua, bw, -1);
-									lua.Pop();
+						break;
+					case LuaType.String: {
+							ReadOnlySpan<byte> str = lua.ToStringBytes(index);
+							if (str.Length > MaxDataSize) throw new LuaException("String too large");
+							if (str.Length >= MinDedupStringLength) {
+								// Lua interns strings, so equal strings share the same pointer
+								IntPtr ptr = (IntPtr)Unsafe.AsPointer(ref MemoryMarshal.GetReference(str));
+								if (strings.TryGetValue(ptr, out int id)) {
+									// <Token:B> <ID:7bI>
+									WriteToken(SerialToken.StringRef, (uint)id);
+									break;
 								}
-								bw.Write((byte)SerialToken.End);
+								strings.Add(ptr, stringCount);
 							}
-						} finally {
-							lua.Top = top;
+							// <Token:B> <Length:7bI> <Data:nB>
+							WriteData(SerialToken.String, str);
+							stringCount++;
 						}
-					}
-					break;
-				case LuaType.UserData: {
-						index = lua.ToAbsoluteIndex(index);
-						int top = lua.Top;
-						try {
-							if (!TrySerializeCustom(index))
-								throw new LuaException("Cannot serialize userdata without a custom serialization function");
-						} finally {
-							lua.Top = top;
+						break;
+					case LuaType.Table: {
+							index = lua.ToAbsoluteIndex(index);
+							IntPtr ptr = lua.ToPointer(index);
+							if (tables.TryGetValue(ptr, out int id)) {
+								// <Token:B> <ID:7bI>
+								WriteToken(SerialToken.TableRef, (uint)id);
+								break;
+							}
+							if (depth >= MaxSerialDepth || !lua.CheckStack(4)) throw new LuaException("Tables are nested too deeply to serialize");
+
+							int top = lua.Top;
+							try {
+								// Try to use the custom serialization function, else fall back to default
+								// method for serializing tables
+								if (!TryWriteCustom(index)) {
+									// Tables are numbered in the order they are started so cyclic references can be resolved
+									tables.Add(ptr, tables.Count);
+									// <Token:B> [<Key:?> <Value:?>]... <End:B>
+									WriteByte((byte)SerialToken.Table);
+									lua.PushNil();
+									while (lua.Next(index)) {
+										WriteValue(-2, depth + 1);
+										WriteValue(-1, depth + 1);
+										lua.Pop();
+									}
+									WriteByte((byte)SerialToken.End);
+								}
+							} finally {
+								lua.Top = top;
+							}
 						}
-					} 
-					break;
-				case LuaType.None:
-				case LuaType.LightUserData:
-				case LuaType.Function:
-				case LuaType.Thread:
-				default:
-					throw new LuaException("Encountered unserializable value");
+						break;
+					case LuaType.UserData: {
+							index = lua.ToAbsoluteIndex(index);
+							int top = lua.Top;
+							try {
+								if (!TryWriteCustom(index))
+									throw new LuaException("Cannot serialize userdata without a custom serialization function");
+							} finally {
+								lua.Top = top;
+							}
+						}
+						break;
+					case LuaType.None:
+					case LuaType.LightUserData:
+					case LuaType.Function:
+					case LuaType.Thread:
+					default:
+						throw new LuaException("Encountered unserializable value");
+				}
 			}
-			// Write a trailing end token just in case
-			bw.Write((byte)SerialToken.End);
+
 		}
 
-		/// <summary>
-		/// Deserializes a value from serialized binary data, pushing it onto the stack And
-		/// returning true. If the end of data is reached, nothing is pushed and false is returned.
-		/// </summary>
-		/// <param name="lua">The Lua interface</param>
-		/// <param name="br">The reader for serialized data</param>
-		/// <returns>If a value was deserialized and pushed</returns>
-		/// <exception cref="IOException">If there is an error reading the serialized data</exception>
-		/// <exception cref="LuaException">If there is an error decoding the serialized data</exception>
-		public static bool Deserialize(this LuaBase lua, BinaryReader br) {
-			void ReadFully(Span<byte> span) {
-				int offset = 0;
-				do {
-					int nread = br.Read(span[offset..]);
-					if (nread == 0) throw new IOException("Unexpected end of serialized data");
-					offset += nread;
-				} while (offset < span.Length);
+		// State for a single deserialization, reading directly from the serialized data
+		private ref struct SerialDecoder {
+
+			private readonly LuaBase lua;
+			private readonly ReadOnlySpan<byte> data;
+			// Stack index of the table holding previously decoded tables by ID
+			private readonly int tableRefs;
+			// Locations of previously decoded strings by ID
+			private readonly List<Range> strings;
+			private int tableCount;
+
+			public int Position;
+
+			public SerialDecoder(LuaBase lua, ReadOnlySpan<byte> data, int tableRefs, List<Range> strings) {
+				this.lua = lua;
+				this.data = data;
+				this.tableRefs = tableRefs;
+				this.strings = strings;
+				tableCount = 0;
+				Position = 0;
 			}
 
-			switch ((SerialToken)br.ReadByte()) {
-				case SerialToken.Nil:
-					lua.PushNil();
-					break;
-				case SerialToken.True:
-					lua.PushBoolean(true);
-					break;
-				case SerialToken.False:
-					lua.PushBoolean(false);
-					break;
-				case SerialToken.PackedInt:
-					lua.PushInteger(br.Read7BitEncodedInt());
-					break;
-				case SerialToken.Double:
-					lua.PushNumber(br.ReadDouble());
-					break;
-				case SerialToken.String: {
-						int length = br.Read7BitEncodedInt();
-						if (length > MaxDataSize) throw new LuaException("String has excessively large size");
-						Span<byte> buffer = length > 4096 ? new byte[length] : stackalloc byte[length];
-						ReadFully(buffer);
-						lua.PushString(buffer);
-					}
-					break;
-				case SerialToken.Table: {
-						int top = lua.Top;
-						try {
+			public byte ReadByte() {
+				if (Position >= data.Length) throw new LuaException("Unexpected end of serialized data");
+				return data[Position++];
+			}
+
+			public uint ReadVarUInt() {
+				uint value = 0;
+				for (int shift = 0; shift < 35; shift += 7) {
+					byte b = ReadByte();
+					value |= (uint)(b & 0x7F) << shift;
+					if (b < 0x80) return value;
+				}
+				throw new LuaException("Malformed integer in serialized data");
+			}
+
+			private Range ReadData(string what) {
+				uint length = ReadVarUInt();
+				if (length > (uint)MaxDataSize) throw new LuaException($"{what} has excessively large size");
+				if (length > (uint)(data.Length - Position)) throw new LuaException("Unexpected end of serialized data");
+				Range range = Position..(Position + (int)length);
+				Position += (int)length;
+				return range;
+			}
+
+			public void ReadValue(int depth) {
+				switch ((SerialToken)ReadByte()) {
+					case SerialToken.Nil:
+						lua.PushNil();
+						break;
+					case SerialToken.True:
+						lua.PushBoolean(true);
+						break;
+					case SerialToken.False:
+						lua.PushBoolean(false);
+						break;
+					case SerialToken.PackedInt: {
+							uint zigzag = ReadVarUInt();
+							lua.PushNumber((int)(zigzag >> 1) ^ -(int)(zigzag & 1));
+						}
+						break;
+					case SerialToken.Double:
+						if (data.Length - Position < 8) throw new LuaException("Unexpected end of serialized data");
+						lua.PushNumber(BinaryPrimitives.ReadDoubleLittleEndian(data[Position..]));
+						Position += 8;
+						break;
+					case SerialToken.String: {
+							Range range = ReadData("String");
+							strings.Add(range);
+							lua.PushString(data[range]);
+						}
+						break;
+					case SerialToken.StringRef: {
+							uint id = ReadVarUInt();
+							if (id >= (uint)strings.Count) throw new LuaException("Invalid string reference in serialized data");
+							lua.PushString(data[strings[(int)id]]);
+						}
+						break;
+					case SerialToken.Table: {
+							if (depth >= MaxSerialDepth || !lua.CheckStack(4)) throw new LuaException("Serialized tables are nested too deeply");
 							lua.CreateTable();
-							while (Deserialize(lua, br)) {
-								if (!Deserialize(lua, br)) throw new IOException("Table ends prematurely");
+							lua.PushValue(-1);
+							lua.RawSet(tableRefs, ++tableCount);
+							while (true) {
+								if (Position < data.Length && data[Position] == (byte)SerialToken.End) {
+									Position++;
+									break;
+								}
+								ReadValue(depth + 1);
+								if (lua.IsNil(-1) || (lua.IsNumber(-1) && double.IsNaN(lua.ToNumber(-1))))
+									throw new LuaException("Invalid table key in serialized data");
+								ReadValue(depth + 1);
 								lua.RawSet(-3);
 							}
-							top++;
-						} finally {
-							lua.Top = top;
 						}
-					}
-					break;
-				case SerialToken.Custom: {
-						int top = lua.Top;
-						try {
-							int keyLen = br.Read7BitEncodedInt();
-							if (keyLen > MaxDataSize) throw new LuaException("Custom data has excessively large key");
-							Span<byte> key = keyLen > 4096 ? new byte[keyLen] : stackalloc byte[keyLen];
-							ReadFully(key);
-
-							bool hasDeserial = false;
-
+						break;
+					case SerialToken.TableRef: {
+							uint id = ReadVarUInt();
+							if (id >= (uint)tableCount) throw new LuaException("Invalid table reference in serialized data");
+							lua.RawGet(tableRefs, (int)id + 1);
+						}
+						break;
+					case SerialToken.Custom: {
+							ReadOnlySpan<byte> key = data[ReadData("Custom data key")];
 							lua.GetField(Lua.RegistryIndex, "__deserial"u8);
+							bool hasDeserial = false;
 							if (lua.IsTable(-1)) {
 								lua.PushString(key);
 								lua.RawGet(-2);
 								hasDeserial = lua.IsFunction(-1);
 							}
-
 							if (!hasDeserial) throw new LuaException($"Missing deserializer for custom key \"{Encoding.UTF8.GetString(key)}\"");
-
-							int dataLen = br.Read7BitEncodedInt();
-							if (dataLen > MaxDataSize) throw new LuaException("Custom data is excessively large");
-							Span<byte> data = dataLen > 4096 ? new byte[dataLen] : stackalloc byte[dataLen];
-							ReadFully(data);
-
 							lua.Remove(-2);
-							lua.PushString(data);
+
+							lua.PushString(data[ReadData("Custom data")]);
 							lua.Call(1, 1);
-						} finally {
-							lua.Top = top;
 						}
-					}
-					break;
-				case SerialToken.End:
-				default:
-					return false;
+						break;
+					case SerialToken.End:
+					default:
+						throw new LuaException("Invalid token in serialized data");
+				}
+			}
+
+		}
+
+		// Cached list of string locations for deserialization on the current thread
+		[ThreadStatic]
+		private static List<Range>? cachedSerialStrings;
+
+		/// <summary>
+		/// <para>
+		/// Serializes the Lua value at the given stack index into binary data. The data starts with a version byte
+		/// (<see cref="SerialVersion"/>) followed by the encoded value.
+		/// </para>
+		/// <para>
+		/// Repeated strings and tables are written once and referenced afterwards, so shared tables (including
+		/// cyclic references) are preserved when deserialized.
+		/// </para>
+		/// </summary>
+		/// <param name="lua">The Lua interface</param>
+		/// <param name="writer">The writer to serialize data to</param>
+		/// <param name="index">The stack index of the value to serialize</param>
+		/// <exception cref="LuaException">If there was an error during serialization</exception>
+		public static void Serialize(this LuaBase lua, IBufferWriter<byte> writer, int index) {
+			index = lua.ToAbsoluteIndex(index);
+			SerialEncoder encoder = SerialEncoder.Rent(lua, writer);
+			try {
+				encoder.WriteByte(SerialVersion);
+				encoder.WriteValue(index, 0);
+			} finally {
+				encoder.Return();
+			}
+		}
+
+		/// <summary>
+		/// Deserializes a value from binary data created by <see cref="Serialize(LuaBase, IBufferWriter{byte}, int)"/>,
+		/// pushing it onto the stack. Strings are pushed directly from the given data without any intermediate copies.
+		/// </summary>
+		/// <param name="lua">The Lua interface</param>
+		/// <param name="data">The serialized data</param>
+		/// <returns>The number of bytes of data which were read</returns>
+		/// <exception cref="LuaException">If there is an error decoding the serialized data</exception>
+		public static int Deserialize(this LuaBase lua, ReadOnlySpan<byte> data) {
+			if (data.Length == 0) throw new LuaException("Unexpected end of serialized data");
+			if (data[0] != SerialVersion) throw new LuaException($"Unsupported serialized data version {data[0]}");
+
+			List<Range> strings = cachedSerialStrings ?? new();
+			cachedSerialStrings = null;
+			int top = lua.Top;
+			try {
+				lua.CreateTable();
+				SerialDecoder decoder = new(lua, data, lua.Top, strings) { Position = 1 };
+				decoder.ReadValue(0);
+				// Remove the table reference table from beneath the value
+				lua.Remove(-2);
+				top++;
+				return decoder.Position;
+			} finally {
+				lua.Top = top;
+				strings.Clear();
+				cachedSerialStrings = strings;
 			}
+		}
+
+		/// <summary>
+		/// Serializes the Lua value at the given stack index as a frame, consisting of the serialized data prefixed by its
+		/// length as a 7-bit encoded integer. Frames can be written back-to-back to a stream and read with
+		/// <see cref="TryDeserializeFrame(LuaBase, ReadOnlySpan{byte}, out int)"/>.
+		/// </summary>
+		/// <param name="lua">The Lua interface</param>
+		/// <param name="writer">The writer to serialize data to</param>
+		/// <param name="index">The stack index of the value to serialize</param>
+		/// <exception cref="LuaException">If there was an error during serialization</exception>
+		public static void SerializeFrame(this LuaBase lua, IBufferWriter<byte> writer, int index) {
+			using PooledBufferWriter payload = new();
+			Serialize(lua, payload, index);
+			ReadOnlySpan<byte> data = payload.WrittenSpan;
+
+			Span<byte> prefix = writer.GetSpan(5);
+			uint length = (uint)data.Length;
+			int n = 0;
+			while (length >= 0x80) {
+				prefix[n++] = (byte)(length | 0x80);
+				length >>= 7;
+			}
+			prefix[n++] = (byte)length;
+			writer.Advance(n);
+			writer.Write(data);
+		}
+
+		/// <summary>
+		/// Attempts to deserialize a frame written by <see cref="SerializeFrame(LuaBase, IBufferWriter{byte}, int)"/> from
+		/// the start of the given data, pushing its value onto the stack. If the data does not contain a complete frame
+		/// nothing is pushed and false is returned, so more data can be buffered before trying again.
+		/// </summary>
+		/// <param name="lua">The Lua interface</param>
+		/// <param name="data">The data to read a frame from</param>
+		/// <param name="bytesConsumed">The total size of the frame if one was read</param>
+		/// <returns>If a complete frame was read</returns>
+		/// <exception cref="LuaException">If there is an error decoding the serialized data</exception>
+		public static bool TryDeserializeFrame(this LuaBase lua, ReadOnlySpan<byte> data, out int bytesConsumed) {
+			bytesConsumed = 0;
+			uint length = 0;
+			int n = 0;
+			while (true) {
+				if (n >= data.Length) return false;
+				if (n >= 5) throw new LuaException("Malformed serialized frame length");
+				byte b = data[n];
+				length |= (uint)(b & 0x7F) << (7 * n++);
+				if (b < 0x80) break;
+			}
+			if (length > (uint)(data.Length - n)) return false;
+
+			int read = Deserialize(lua, data.Slice(n, (int)length));
+			if (read != length) {
+				lua.Pop();
+				throw new LuaException("Serialized frame has trailing data");
+			}
+			bytesConsumed = n + (int)length;
 			return true;
 		}
 
@@ -582,7 +894,7 @@ namespace Tesseract.LuaJIT.Utilities {
 		/// 
 		/// <item>
 		/// <term><c>serialize.decode(data: string) -> any</c></term>
-		/// <description>Decodes a string of JSON text into a corresponding Lua value.</description>
+		/// <description>Decodes serialized binary data into a corresponding Lua value.</description>
 		/// </item>
 		/// 
 		/// <item>
@@ -597,29 +909,30 @@ namespace Tesseract.LuaJIT.Utilities {
 		/// <param name="lua">This Lua state</param>
 		public static void OpenSerialize(this LuaBase lua) {
 			Register(lua, "serialize"u8, "encode"u8, state => {
-				using MemoryStream ms = new();
-				Serialize(state, new BinaryWriter(ms), 1);
-				state.PushString(ms.GetBuffer());
+				using PooledBufferWriter writer = new();
+				Serialize(state, writer, 1);
+				state.PushString(writer.WrittenSpan);
 				return 1;
 			});
 			Register(lua, "serialize"u8, "decode"u8, state => {
+				// The string stays on the stack, so its bytes can be decoded in place
 				ReadOnlySpan<byte> data = state.CheckStringBytes(1);
-				using MemoryStream ms = new(data.ToArray());
-				if (!Deserialize(lua, new BinaryReader(ms))) state.PushNil();
+				Deserialize(state, data);
 				return 1;
 			});
 			Register(lua, "serialize"u8, "newdecoder"u8, state => {
 				state.CheckStringBytes(1);
-				if (state.IsFunction(2)) state.TypeError(2, "function");
+				if (!state.IsFunction(2)) state.TypeError(2, "function");
 				state.GetField(Lua.RegistryIndex, "__deserial"u8);
-				if (lua.IsNil(-1)) {
-					lua.CreateTable();
-					lua.Dup();
-					lua.SetField(Lua.RegistryIndex, "__deserial"u8);
+				if (state.IsNil(-1)) {
+					state.Pop();
+					state.CreateTable();
+					state.Dup();
+					state.SetField(Lua.RegistryIndex, "__deserial"u8);
 				}
-				lua.PushValue(1);
-				lua.PushValue(2);
-				lua.RawSet(-3);
+				state.PushValue(1);
+				state.PushValue(2);
+				state.RawSet(-3);
 				return 0;
 			});
 		}
@@ -0,0 +1,222 @@
+﻿using System;
+using System.Buffers;
+using System.Collections.Generic;
+using System.Runtime.InteropServices;
+using System.Text.Json;
+
+namespace Tesseract.LuaJIT.Utilities {
+
+	/// <summary>
+	/// <para>
+	/// An incremental JSON decoder which builds Lua values directly on the stack of a Lua state as JSON tokens are read,
+	/// without an intermediate document model or managed strings. Objects and arrays are decoded as tables, strings are
+	/// pushed from their UTF-8 bytes, and <c>null</c> is decoded as <c>nil</c>.
+	/// </para>
+	/// <para>
+	/// Data may be supplied in arbitrarily sized blocks with <see cref="Decode(ReadOnlySpan{byte}, bool)"/>; any partial token
+	/// at the end of a block is buffered until the next block is supplied. Partially decoded tables are kept on the Lua stack
+	/// in the meantime, so the stack must not be modified until decoding is complete.
+	/// </para>
+	/// </summary>
+	public sealed class LuaJsonDecoder : IDisposable {
+
+		// An open object or array being decoded
+		private struct Container {
+
+			public bool IsArray;
+
+			public int NextIndex;
+
+		}
+
+		private readonly LuaBase lua;
+		private JsonReaderState state;
+		private readonly List<Container> containers = new();
+		// The stack top before decoding began, or -1 if decoding has not begun
+		private int baseTop = -1;
+
+		// Unconsumed data from the end of the previous block
+		private byte[] pending = Array.Empty<byte>();
+		private int pendingLength = 0;
+
+		/// <summary>
+		/// If a complete value has been decoded and pushed onto the stack.
+		/// </summary>
+		public bool IsComplete { get; private set; } = false;
+
+		/// <summary>
+		/// Creates a new JSON decoder for the given Lua state.
+		/// </summary>
+		/// <param name="lua">The Lua state to decode values into</param>
+		/// <param name="options">The JSON reader options</param>
+		public LuaJsonDecoder(LuaBase lua, JsonReaderOptions options = default) {
+			this.lua = lua;
+			state = new JsonReaderState(options);
+		}
+
+		/// <summary>
+		/// Decodes the next block of JSON data. Once the end of the value has been reached it is left on the stack and this
+		/// returns true, after which any further data is ignored. If the value ends in the final block, only whitespace and
+		/// comments may follow it in that block.
+		/// </summary>
+		/// <param name="data">The next block of JSON data</param>
+		/// <param name="isFinalBlock">If this is the final block of data</param>
+		/// <returns>If a complete value has been decoded</returns>
+		/// <exception cref="LuaException">If the JSON data is invalid or incomplete</exception>
+		public bool Decode(ReadOnlySpan<byte> data, bool isFinalBlock) {
+			if (IsComplete) return true;
+			if (baseTop < 0) baseTop = lua.Top;
+
+			if (pendingLength > 0) {
+				// Prepend the leftover partial token to the new data
+				if (pending.Length - pendingLength < data.Length) {
+					byte[] newPending = ArrayPool<byte>.Shared.Rent(pendingLength + data.Length);
+					pending.AsSpan(0, pendingLength).CopyTo(newPending);
+					ReturnPending();
+					pending = newPending;
+				}
+				data.CopyTo(pending.AsSpan(pendingLength));
+				pendingLength += data.Length;
+				data = pending.AsSpan(0, pendingLength);
+			}
+
+			int consumed;
+			try {
+				Utf8JsonReader reader = new(data, isFinalBlock, state);
+				while (!IsComplete && reader.Read()) ReadToken(ref reader);
+				// Only whitespace and comments may follow the value in the final block, the reader throws for anything else
+				if (IsComplete && isFinalBlock) {
+					while (reader.Read()) {
+						if (reader.TokenType != JsonTokenType.Comment) throw new JsonException("Unexpected data after the end of the JSON value");
+					}
+				}
+				consumed = (int)reader.BytesConsumed;
+				state = reader.CurrentState;
+			} catch (JsonException e) {
+				// Discard the value even if it was completed, as the data as a whole is invalid
+				IsComplete = false;
+				Reset();
+				throw new LuaException($"Invalid JSON: {e.Message}", e);
+			} catch {
+				IsComplete = false;
+				Reset();
+				throw;
+			}
+
+			if (IsComplete) {
+				ClearPending();
+				return true;
+			}
+			if (isFinalBlock) {
+				Reset();
+				throw new LuaException("Unexpected end of JSON");
+			}
+
+			// Keep the unconsumed tail for the next block
+			ReadOnlySpan<byte> rest = data[consumed..];
+			if (pending.Length < rest.Length) {
+				byte[] newPending = ArrayPool<byte>.Shared.Rent(rest.Length);
+				rest.CopyTo(newPending);
+				ReturnPending();
+				pending = newPending;
+			} else rest.CopyTo(pending);
+			pendingLength = rest.Length;
+			return false;
+		}
+
+		private void ReadToken(ref Utf8JsonReader reader) {
+			switch (reader.TokenType) {
+				case JsonTokenType.StartObject:
+				case JsonTokenType.StartArray:
+					if (!lua.CheckStack(3)) throw new LuaException("JSON is nested too deeply");
+					lua.CreateTable();
+					containers.Add(new Container() { IsArray = reader.TokenType == JsonTokenType.StartArray, NextIndex = 1 });
+					break;
+				case JsonTokenType.EndObject:
+				case JsonTokenType.EndArray:
+					containers.RemoveAt(containers.Count - 1);
+					StoreValue();
+					break;
+				case JsonTokenType.PropertyName:
+					PushString(ref reader);
+					break;
+				case JsonTokenType.String:
+					PushString(ref reader);
+					StoreValue();
+					break;
+				case JsonTokenType.Number:
+					lua.PushNumber(reader.GetDouble());
+					StoreValue();
+					break;
+				case JsonTokenType.True:
+					lua.PushBoolean(true);
+					StoreValue();
+					break;
+				case JsonTokenType.False:
+					lua.PushBoolean(false);
+					StoreValue();
+					break;
+				case JsonTokenType.Null:
+					lua.PushNil();
+					StoreValue();
+					break;
+			}
+		}
+
+		// Pushes the current string token, unescaping it if required
+		private void PushString(ref Utf8JsonReader reader) {
+			if (!reader.HasValueSequence && !reader.ValueIsEscaped) {
+				lua.PushString(reader.ValueSpan);
+				return;
+			}
+
+			// Unescaped strings are never longer than their escaped form
+			int length = reader.HasValueSequence ? checked((int)reader.ValueSequence.Length) : reader.ValueSpan.Length;
+			byte[]? rented = null;
+			Span<byte> buffer = length <= 1024 ? stackalloc byte[length] : (rented = ArrayPool<byte>.Shared.Rent(length));
+			try {
+				int written = reader.CopyString(buffer);
+				lua.PushString(buffer[..written]);
+			} finally {
+				if (rented != null) ArrayPool<byte>.Shared.Return(rented);
+			}
+		}
+
+		// Stores the value on top of the stack into its enclosing container, or completes decoding if it is the root value
+		private void StoreValue() {
+			if (containers.Count == 0) {
+				IsComplete = true;
+				return;
+			}
+			ref Container container = ref CollectionsMarshal.AsSpan(containers)[^1];
+			if (container.IsArray) lua.RawSet(-2, container.NextIndex++);
+			else lua.RawSet(-3);
+		}
+
+		private void ReturnPending() {
+			if (pending.Length > 0) ArrayPool<byte>.Shared.Return(pending);
+			pending = Array.Empty<byte>();
+		}
+
+		private void ClearPending() {
+			ReturnPending();
+			pendingLength = 0;
+		}
+
+		/// <summary>
+		/// Resets the decoder, removing any partially decoded value from the stack so it can decode a new value.
+		/// </summary>
+		public void Reset() {
+			if (baseTop >= 0 && !IsComplete) lua.Top = baseTop;
+			baseTop = -1;
+			IsComplete = false;
+			containers.Clear();
+			state = new JsonReaderState(state.Options);
+			ClearPending();
+		}
+
+		public void Dispose() => ClearPending();
+
+	}
+
+}
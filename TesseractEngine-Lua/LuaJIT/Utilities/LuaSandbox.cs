@@ -1,7 +1,7 @@
 ﻿using System;
 using System.Collections.Generic;
+using System.Diagnostics;
 using System.Linq;
-using System.Runtime.InteropServices;
 using System.Text;
 using System.Threading.Tasks;
 
@@ -11,9 +11,10 @@ namespace Tesseract.LuaJIT.Utilities {
 	/// <para>
 	/// Manages a sandboxed Lua environment that imposes memory limits and allows
 	/// asynchronous loading and execution of Lua code. The synchronous methods are
-	/// still available and work as normal, but the sandbox additional has its own
-	/// internal thread used for asynchronous execution. This does not make the class
-	/// thread-safe, and calls to the sandbox still need to be externally synchronized.
+	/// still available and work as normal, but asynchronous operations are run on the
+	/// worker threads of a <see cref="LuaSandboxScheduler"/> shared between sandboxes.
+	/// This does not make the class thread-safe, and calls to the sandbox still need to
+	/// be externally synchronized.
 	/// </para>
 	/// 
 	/// <para>
@@ -43,6 +44,14 @@ namespace Tesseract.LuaJIT.Utilities {
 		/// </summary>
 		public nuint CurrentMemory { get; private set; }
 
+		/// <summary>
+		/// A snapshot of the sandbox's memory usage broken down by allocation size class.
+		/// </summary>
+		public LuaArenaStatistics MemoryStatistics => arena.GetStatistics();
+
+		// The arena all of the sandbox's memory is allocated from (initialized before the base constructor creates the state)
+		private readonly LuaArena arena = new();
+
 		// Custom allocator which enforces memory limits
 
 		private static IntPtr Alloc(LuaState lua, IntPtr ptr, nuint osize, nuint nsize) {
@@ -53,20 +62,16 @@ namespace Tesseract.LuaJIT.Utilities {
 			if (maxMemory == default) maxMemory = nuint.MaxValue;
 
 			if (nsize == 0) {
-				Marshal.FreeHGlobal(ptr);
-				return IntPtr.Zero;
+				if (ptr != IntPtr.Zero) sandbox.CurrentMemory -= osize;
+				return sandbox.arena.Alloc(ptr, osize, nsize);
 			} else {
 				nuint avail = maxMemory - sandbox.CurrentMemory;
-				if (osize == 0) {
-					if (nsize > avail) return IntPtr.Zero;
-					sandbox.CurrentMemory += nsize;
-					return Marshal.AllocHGlobal((nint)nsize);
-				} else {
-					nint diff = (nint)(nsize - osize);
-					if (diff > (nint)avail) return IntPtr.Zero;
-					sandbox.CurrentMemory += nsize - osize;
-					return Marshal.ReAllocHGlobal(ptr, (nint)nsize);
-				}
+				// The old size is only meaningful for existing blocks
+				if (ptr == IntPtr.Zero) osize = 0;
+				if (nsize > osize && nsize - osize > avail) return IntPtr.Zero;
+				IntPtr block = sandbox.arena.Alloc(ptr, osize, nsize);
+				if (block != IntPtr.Zero) sandbox.CurrentMemory = sandbox.CurrentMemory - osize + nsize;
+				return block;
 			}
 		}
 
@@ -76,25 +81,50 @@ namespace Tesseract.LuaJIT.Utilities {
 
 		private const int StateExiting = -1;
 
+		// The scheduler given to the sandbox, or null to use the shared scheduler
+		private readonly LuaSandboxScheduler? scheduler;
+
+		/// <summary>
+		/// The scheduler which runs the sandbox's asynchronous operations. If no scheduler was given to the sandbox the
+		/// shared scheduler is used, which is only created once it is first needed.
+		/// </summary>
+		public LuaSandboxScheduler Scheduler => scheduler ?? LuaSandboxScheduler.Shared;
+
 		private bool alive = true;
-		// Loop variable to keep the sandbox thread alive
+		// The state of the current async operation
 		private int asyncState = StateWaiting;
-		// The sandbox thread for async execution
-		private readonly Thread thread;
+		// Lock held while the sandbox is running an async operation, so it cannot be closed underneath it
+		private readonly object asyncLock = new();
 
 		private Func<LuaStatus>? asyncOperation;
+		// Arguments for an async call, which runs as a coroutine so it can be preempted
+		private bool asyncIsCall;
+		private int asyncArgs, asyncResults;
+		// The coroutine running the current async call, or null if not started or not running a call
+		private IntPtr asyncThread = IntPtr.Zero;
+		// If the count hook is yielding the current async call
+		private bool asyncPreempting = false;
+		// The timestamp at which the current time slice ends
+		private long sliceDeadline = long.MaxValue;
 
 		private TaskCompletionSource<LuaStatus>? asyncTaskCompletion;
 
 		private CancellationToken asyncCancellation = CancellationToken.None;
 
-		private readonly SemaphoreSlim signalSemaphore = new(1, 1);
-
 		private LuaSandboxException? terminatingException;
 
-		public LuaSandbox(uint maxMem = 1 << 20) : base(Alloc) {
+		// The timestamp when the sandbox was last queued with its scheduler
+		internal long EnqueueTimestamp;
+
+		/// <summary>
+		/// Creates a new Lua sandbox.
+		/// </summary>
+		/// <param name="maxMem">The maximum amount of memory the sandbox may use</param>
+		/// <param name="scheduler">The scheduler to run asynchronous operations on, defaulting to <see cref="LuaSandboxScheduler.Shared"/></param>
+		public LuaSandbox(uint maxMem = 1 << 20, LuaSandboxScheduler? scheduler = null) : base(Alloc) {
 			MaxMemory = maxMem;
-			thread = new Thread(RunSandbox) { IsBackground = true };
+			// The shared scheduler starts its workers when created, so sandboxes without async operations don't touch it
+			this.scheduler = scheduler;
 
 			// Open some safe packages
 			OpenBase();
@@ -165,20 +195,16 @@ namespace Tesseract.LuaJIT.Utilities {
 
 		public override void Dispose() {
 			System.GC.SuppressFinalize(this);
-			try {
-				// Make us not alive and make sure the thread is exiting
-				if (alive) {
-					alive = false;
-					asyncState = StateExiting;
-					// Signal the sandbox thread to run and exit, waiting a bit for it to finish
-					signalSemaphore.Release();
-					thread.Join(100);
-					// Dispose of the semaphore
-					signalSemaphore.Dispose();
-				}
-			} finally {
-				// Make sure the underlying state gets properly disposed
+			// Make us not alive and terminate any running operation, which will exit at the next count hook
+			alive = false;
+			asyncState = StateExiting;
+			// Wait for any slice in progress to finish before closing the state
+			lock (asyncLock) {
+				// Make sure the underlying state gets properly disposed, releasing its memory in bulk afterwards
+				arena.DeferFrees();
 				base.Dispose();
+				arena.Dispose();
+				CurrentMemory = 0;
 			}
 		}
 
@@ -202,37 +228,135 @@ namespace Tesseract.LuaJIT.Utilities {
 		// Sandbox Execution //
 		//===================//
 
-		private void RunSandbox() {
-			while(alive) {
-				// Wait for the next async task
-				signalSemaphore.Wait();
-				// If none is supplied we must exit
-				if (asyncTaskCompletion == null) break;
-
-				// Perform the specified protected call
-				try {
-					if (asyncOperation != null) {
-						var status = asyncOperation.Invoke();
+		// Runs a single time slice of the pending async operation, returning false if it was preempted
+		internal bool RunSlice(long deadline) {
+			lock (asyncLock) {
+				TaskCompletionSource<LuaStatus>? completion = asyncTaskCompletion;
+				if (completion == null) return true;
+
+				LuaStatus status = default;
+				Exception? exception = null;
+				bool canceled = false;
+				if (!alive || asyncCancellation.IsCancellationRequested) canceled = true;
+				else {
+					sliceDeadline = deadline;
+					try {
+						if (asyncIsCall) {
+							if (!ResumeCall(out status)) return false;
+						} else status = asyncOperation!.Invoke();
 						// Cancel if exiting, otherwise pass the result status
-						if (asyncState == StateExiting) asyncTaskCompletion.SetCanceled();
-						else asyncTaskCompletion.SetResult(status);
-					} else asyncTaskCompletion.SetCanceled();
-				} catch (LuaSandboxException) {
-					// Cancel if a sandbox exception propagates upwards
-					asyncTaskCompletion.SetCanceled();
-				} catch (Exception e) {
-					// Pass any propagated exception
-					asyncTaskCompletion.SetException(e);
+						if (asyncState == StateExiting || terminatingException != null) canceled = true;
+					} catch (LuaSandboxException) {
+						// Cancel if a sandbox exception propagates upwards
+						canceled = true;
+					} catch (Exception e) {
+						// Pass any propagated exception
+						exception = e;
+					} finally {
+						sliceDeadline = long.MaxValue;
+					}
 				}
 
-				// Cleanup after the async call
-				asyncTaskCompletion = null;
-				asyncState = StateWaiting;
-				terminatingException = null;
+				// Cleanup after the async call before completing it, so continuations can start another
+				if (canceled) DiscardCall();
+				ResetAsync();
+				if (canceled) completion.SetCanceled();
+				else if (exception != null) completion.SetException(exception);
+				else completion.SetResult(status);
+				return true;
+			}
+		}
+
+		// Cancels the pending async operation without running it
+		internal void CancelAsync() {
+			lock (asyncLock) {
+				TaskCompletionSource<LuaStatus>? completion = asyncTaskCompletion;
+				if (completion == null) return;
+				DiscardCall();
+				ResetAsync();
+				completion.SetCanceled();
 			}
 		}
 
-		private void CountHook(LuaState state, LuaDebug info) => CheckTerminating();
+		// Discards the coroutine of a preempted call, leaving the stack as an error would
+		private void DiscardCall() {
+			if (asyncThread == IntPtr.Zero || !alive) return;
+			PushString("Operation cancelled"u8);
+			FinishCall(1);
+		}
+
+		private void ResetAsync() {
+			asyncOperation = null;
+			asyncTaskCompletion = null;
+			asyncThread = IntPtr.Zero;
+			terminatingException = null;
+			if (alive) asyncState = StateWaiting;
+		}
+
+		// Starts or resumes the coroutine for an async call, returning false if it was preempted
+		private unsafe bool ResumeCall(out LuaStatus status) {
+			var lua = Lua.Functions;
+			int nargs = 0;
+			if (asyncThread == IntPtr.Zero) {
+				// Create a coroutine and move the function and its arguments to it, leaving the coroutine in their place
+				asyncThread = lua.lua_newthread(L);
+				Insert(-(asyncArgs + 2));
+				lua.lua_xmove(L, asyncThread, asyncArgs + 1);
+				nargs = asyncArgs;
+			}
+
+			asyncPreempting = false;
+			status = (LuaStatus)lua.lua_resume(asyncThread, nargs);
+			if (status == LuaStatus.Yield) {
+				if (asyncPreempting) return false;
+				// The script yielded by itself, which is an error outside of a coroutine as with a normal call
+				lua.lua_settop(asyncThread, 0);
+				fixed (byte* pMsg = "attempt to yield from outside a coroutine"u8) {
+					lua.lua_pushlstring(asyncThread, (IntPtr)pMsg, (nuint)"attempt to yield from outside a coroutine"u8.Length);
+				}
+				status = LuaStatus.ErrRun;
+			}
+
+			int nresults;
+			if (status == LuaStatus.Ok) {
+				if (asyncResults != Lua.MultRet) lua.lua_settop(asyncThread, asyncResults);
+				nresults = lua.lua_gettop(asyncThread);
+			} else {
+				// Only keep the error value
+				nresults = 1;
+			}
+			lua.lua_xmove(asyncThread, L, nresults);
+			FinishCall(nresults);
+			return true;
+		}
+
+		// Removes the coroutine for an async call from beneath the given number of values on the stack
+		private void FinishCall(int nvalues) {
+			Remove(-(nvalues + 1));
+			asyncThread = IntPtr.Zero;
+		}
+
+		// Tests if the coroutine for the current async call can be yielded, which is only possible if it has no C frames
+		private unsafe bool CanPreempt() {
+			var lua = Lua.Functions;
+			LuaDebug info;
+			fixed (byte* pWhat = "S"u8) {
+				for (int level = 0; lua.lua_getstack(asyncThread, level, (IntPtr)(&info)) != 0; level++) {
+					lua.lua_getinfo(asyncThread, (IntPtr)pWhat, (IntPtr)(&info));
+					if (info.What == "C") return false;
+				}
+			}
+			return true;
+		}
+
+		private void CountHook(LuaState state, LuaDebug info) {
+			CheckTerminating();
+			// Yield the current async call if its time slice has expired and other sandboxes are waiting
+			if (asyncThread != IntPtr.Zero && Stopwatch.GetTimestamp() >= sliceDeadline && Scheduler.QueueDepth > 0 && CanPreempt()) {
+				asyncPreempting = true;
+				unsafe { Lua.Functions.lua_yield(asyncThread, 0); }
+			}
+		}
 
 		/// <summary>
 		/// Checks if the sandbox is terminating the current call, generating an exception if so.
@@ -270,22 +394,36 @@ namespace Tesseract.LuaJIT.Utilities {
 			if (Interlocked.CompareExchange(ref asyncState, StateRunning, StateWaiting) != StateWaiting) throw new InvalidOperationException("Cannot perform async Lua call while one is currently in progress");
 			// Load the async call operands
 			asyncOperation = func;
-			asyncTaskCompletion = new TaskCompletionSource<LuaStatus>();
+			asyncIsCall = false;
+			return StartAsync(ct);
+		}
+
+		// Starts the loaded async operation on the scheduler
+		private Task<LuaStatus> StartAsync(CancellationToken? ct) {
+			asyncTaskCompletion = new TaskCompletionSource<LuaStatus>(TaskCreationOptions.RunContinuationsAsynchronously);
 			asyncCancellation = ct ?? CancellationToken.None;
 			var task = asyncTaskCompletion.Task;
-			// Signal the sandbox thread to start
-			signalSemaphore.Release();
+			Scheduler.Enqueue(this);
 			return task;
 		}
 
 		/// <summary>
-		/// Performs an asynchronous call similar to <see cref="LuaBase.Call(int, int)"/>.
+		/// Performs an asynchronous call similar to <see cref="LuaBase.Call(int, int)"/>. The call runs as a coroutine on
+		/// the sandbox's scheduler, and may be preempted and resumed later if it runs for longer than a time slice.
 		/// </summary>
 		/// <param name="nargs">The number of arguments to the function</param>
 		/// <param name="nresults">The number of result values</param>
 		/// <param name="ct">An optional cancellation token for the operation</param>
 		/// <returns>Task for the Lua function call</returns>
-		public Task<LuaStatus> CallAsync(int nargs = 0, int nresults = Lua.MultRet, CancellationToken? ct = null) => InvokeAsync(() => ProtectedCall(nargs, nresults), ct);
+		/// <exception cref="InvalidOperationException">If there is already a Lua call being performed</exception>
+		public Task<LuaStatus> CallAsync(int nargs = 0, int nresults = Lua.MultRet, CancellationToken? ct = null) {
+			if (Interlocked.CompareExchange(ref asyncState, StateRunning, StateWaiting) != StateWaiting) throw new InvalidOperationException("Cannot perform async Lua call while one is currently in progress");
+			asyncOperation = null;
+			asyncIsCall = true;
+			asyncArgs = nargs;
+			asyncResults = nresults;
+			return StartAsync(ct);
+		}
 
 		/// <summary>
 		/// Performs an asynchronous load similar to <see cref="LuaBase.Load(LuaReader, ReadOnlySpan{byte})"/>.
@@ -0,0 +1,170 @@
+﻿using System;
+using System.Collections.Concurrent;
+using System.Diagnostics;
+using System.Threading;
+
+namespace Tesseract.LuaJIT.Utilities {
+
+	/// <summary>
+	/// A snapshot of the activity of a <see cref="LuaSandboxScheduler"/>.
+	/// </summary>
+	public readonly record struct LuaSandboxSchedulerStatistics {
+
+		/// <summary>
+		/// The number of sandboxes currently waiting for a worker.
+		/// </summary>
+		public int QueueDepth { get; init; }
+
+		/// <summary>
+		/// The number of asynchronous operations which have finished.
+		/// </summary>
+		public long CompletedOperations { get; init; }
+
+		/// <summary>
+		/// The number of time slices which have been run.
+		/// </summary>
+		public long Slices { get; init; }
+
+		/// <summary>
+		/// The number of time slices which ended by preempting a running script.
+		/// </summary>
+		public long Preemptions { get; init; }
+
+		/// <summary>
+		/// The average time sandboxes spent queued before a worker ran them.
+		/// </summary>
+		public TimeSpan AverageQueueLatency { get; init; }
+
+		/// <summary>
+		/// The longest time a sandbox spent queued before a worker ran it.
+		/// </summary>
+		public TimeSpan MaxQueueLatency { get; init; }
+
+	}
+
+	/// <summary>
+	/// <para>
+	/// Runs the asynchronous operations of many <see cref="LuaSandbox"/> instances on a fixed pool of worker threads. Each
+	/// sandbox with pending work is queued, and workers run queued sandboxes in order for a single time slice each.
+	/// </para>
+	/// <para>
+	/// Asynchronous calls run as Lua coroutines so they can be preempted; when a call exceeds its time slice while other
+	/// sandboxes are waiting, the instruction count hook yields it and the sandbox is moved to the back of the queue.
+	/// Calls are only preempted while no C or managed functions are on their stack, so a call made through a managed function
+	/// (including <c>pcall</c> within a sandbox) runs until it returns to Lua code.
+	/// </para>
+	/// </summary>
+	public sealed class LuaSandboxScheduler : IDisposable {
+
+		private static readonly Lazy<LuaSandboxScheduler> shared = new(() => new LuaSandboxScheduler());
+
+		/// <summary>
+		/// The scheduler shared by sandboxes which are not given one explicitly, with one worker per processor.
+		/// </summary>
+		public static LuaSandboxScheduler Shared => shared.Value;
+
+		/// <summary>
+		/// The number of worker threads.
+		/// </summary>
+		public int WorkerCount => workers.Length;
+
+		/// <summary>
+		/// The maximum time a sandbox will run for before yielding to other waiting sandboxes.
+		/// </summary>
+		public TimeSpan TimeSlice { get; }
+
+		/// <summary>
+		/// The number of sandboxes currently waiting for a worker.
+		/// </summary>
+		public int QueueDepth => queue.Count;
+
+		private readonly Thread[] workers;
+		private readonly ConcurrentQueue<LuaSandbox> queue = new();
+		private readonly SemaphoreSlim signal = new(0);
+		private readonly long timeSliceTicks;
+		private volatile bool disposed = false;
+
+		private long completed = 0, slices = 0, preemptions = 0;
+		private long totalLatencyTicks = 0, maxLatencyTicks = 0;
+
+		/// <summary>
+		/// Creates a new sandbox scheduler.
+		/// </summary>
+		/// <param name="workerCount">The number of worker threads, or 0 to use one per processor</param>
+		/// <param name="timeSlice">The time slice given to each sandbox, defaulting to 5 milliseconds</param>
+		public LuaSandboxScheduler(int workerCount = 0, TimeSpan? timeSlice = null) {
+			if (workerCount < 0) throw new ArgumentOutOfRangeException(nameof(workerCount), "Worker count cannot be negative");
+			if (workerCount == 0) workerCount = Environment.ProcessorCount;
+			TimeSlice = timeSlice ?? TimeSpan.FromMilliseconds(5);
+			timeSliceTicks = (long)(TimeSlice.TotalSeconds * Stopwatch.Frequency);
+
+			workers = new Thread[workerCount];
+			for (int i = 0; i < workerCount; i++) {
+				workers[i] = new Thread(RunWorker) { IsBackground = true, Name = $"Lua Sandbox Worker {i}" };
+				workers[i].Start();
+			}
+		}
+
+		// Queues a sandbox to run its pending operation
+		internal void Enqueue(LuaSandbox sandbox) {
+			if (disposed) {
+				sandbox.CancelAsync();
+				return;
+			}
+			sandbox.EnqueueTimestamp = Stopwatch.GetTimestamp();
+			queue.Enqueue(sandbox);
+			signal.Release();
+		}
+
+		private void RunWorker() {
+			while (true) {
+				signal.Wait();
+				if (disposed) break;
+				if (!queue.TryDequeue(out LuaSandbox? sandbox)) continue;
+
+				long start = Stopwatch.GetTimestamp();
+				long latency = start - sandbox.EnqueueTimestamp;
+				Interlocked.Add(ref totalLatencyTicks, latency);
+				long max;
+				while (latency > (max = Interlocked.Read(ref maxLatencyTicks)) && Interlocked.CompareExchange(ref maxLatencyTicks, latency, max) != max) { }
+
+				Interlocked.Increment(ref slices);
+				if (sandbox.RunSlice(start + timeSliceTicks)) {
+					Interlocked.Increment(ref completed);
+				} else {
+					Interlocked.Increment(ref preemptions);
+					Enqueue(sandbox);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Gets a snapshot of the scheduler's activity.
+		/// </summary>
+		/// <returns>Scheduler statistics</returns>
+		public LuaSandboxSchedulerStatistics GetStatistics() {
+			long sliceCount = Interlocked.Read(ref slices);
+			return new LuaSandboxSchedulerStatistics() {
+				QueueDepth = queue.Count,
+				CompletedOperations = Interlocked.Read(ref completed),
+				Slices = sliceCount,
+				Preemptions = Interlocked.Read(ref preemptions),
+				AverageQueueLatency = sliceCount == 0 ? TimeSpan.Zero : Stopwatch.GetElapsedTime(0, Interlocked.Read(ref totalLatencyTicks) / sliceCount),
+				MaxQueueLatency = Stopwatch.GetElapsedTime(0, Interlocked.Read(ref maxLatencyTicks))
+			};
+		}
+
+		public void Dispose() {
+			if (disposed) return;
+			disposed = true;
+			// Wake every worker so they observe the disposal and exit, waiting for any running slices to finish
+			signal.Release(workers.Length);
+			foreach (Thread worker in workers) worker.Join();
+			// Cancel anything left in the queue
+			while (queue.TryDequeue(out LuaSandbox? sandbox)) sandbox.CancelAsync();
+			signal.Dispose();
+		}
+
+	}
+
+}
@@ -6,6 +6,8 @@
 // Enable the use of dynamic function loading instead of linking against a DLL
 #define VMA_DYNAMIC_VULKAN_FUNCTIONS 1
 #define VMA_STATIC_VULKAN_FUNCTIONS 0
+// Statistics strings are exposed as JSON dumps through VMAAllocator.BuildStatsString
+#define VMA_STATS_STRING_ENABLED 1
 #ifdef _WIN32
 #define VMA_CALL_PRE __declspec(dllexport)
 #else
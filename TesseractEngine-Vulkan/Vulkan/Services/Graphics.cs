@@ -284,47 +284,19 @@ namespace Tesseract.Vulkan.Services {
 		public ICommandBuffer CreateCommandBuffer(CommandBufferCreateInfo createInfo) => Commands.Alloc(createInfo);
 
 		public void RunCommands(Action<ICommandSink> cmdSink, CommandBufferUsage usage, in IGraphics.CommandBufferSubmitInfo submitInfo) {
-			// Allocate and record command buffer
-			usage |= CommandBufferUsage.OneTimeSubmit;
-			VulkanCommandBuffer cmdbuf = Commands.Alloc(new CommandBufferCreateInfo() {
-				Type = CommandBufferType.Primary,
-				Usage = usage
-			});
+			// Record into a transient command buffer, which is recycled with its pool once the submission completes
+			VulkanCommandBuffer cmdbuf = Commands.AllocTransient(usage | CommandBufferUsage.OneTimeSubmit);
 			cmdSink(cmdbuf.BeginRecording());
 			cmdbuf.EndRecording();
-			
-			// Determine if a fence already exists
-			VulkanFenceSync? fence = null;
-			foreach(ISync sig in submitInfo.SignalSync) {
-				if (sig is VulkanFenceSync fenceSync) {
-					if (fence != null) throw new VulkanException("Can only signal a single fence during command submission");
-					else fence = fenceSync;
-				}
-			}
-
-			// If no fence, create a new one and add to the list of signal syncs
-			ISync[] signalSyncs = submitInfo.SignalSync.ToArray();
 
-			bool disposeFence = fence == null;
-			if (disposeFence) {
-				fence = new VulkanFenceSync(Device.Device.CreateFence(new VKFenceCreateInfo() {
-					Type = VKStructureType.FenceCreateInfo
-				}));
-				Array.Resize(ref signalSyncs, signalSyncs.Length + 1);
-				signalSyncs[^1] = fence;
+			// Make sure any fence the caller is waiting on is reset
+			foreach (ISync sig in submitInfo.SignalSync) {
+				if (sig is VulkanFenceSync fenceSync) fenceSync.HostReset();
 			}
 
-			// Make sure the fence is reset and submit the commands
-			fence!.HostReset();
-			var submitInfo2 = new IGraphics.CommandBufferSubmitInfo() {
-				CommandBuffer = new ICommandBuffer[] { cmdbuf },
-				SignalSync = signalSyncs,
-				WaitSync = submitInfo.WaitSync
-			};
-			SubmitCommands(submitInfo2);
-
-			// Schedule the command buffer to be disposed when the fence indicates it is free
-			Commands.DisposeWhenFree(cmdbuf, fence, disposeFence);
+			// Submit the commands, tracking their completion with the command bank instead of a dedicated fence
+			Span<IntPtr> cmds = stackalloc IntPtr[] { cmdbuf.CommandBuffer.CommandBuffer };
+			Submit(cmdbuf.CommandPool.Bank, cmds, submitInfo, true);
 		}
 
 		public void SubmitCommands(in IGraphics.CommandBufferSubmitInfo submitInfo) {
@@ -341,6 +313,11 @@ namespace Tesseract.Vulkan.Services {
 			}
 			if (cmdbank == null) return;
 
+			Submit(cmdbank, cmds, submitInfo, false);
+		}
+
+		// Submits command buffers to a command bank with the synchronization from the submit information
+		private ulong Submit(VulkanCommands.CommandBank cmdbank, ReadOnlySpan<IntPtr> cmds, in IGraphics.CommandBufferSubmitInfo submitInfo, bool track) {
 			VulkanFenceSync? fence = null;
 			int sigcount = 0, waitcount = 0;
 			Span<ulong> sigs = stackalloc ulong[submitInfo.SignalSync.Count];
@@ -365,7 +342,7 @@ namespace Tesseract.Vulkan.Services {
 				} else throw new VulkanException("Unsupported command submit sync object in waiting list");
 			}
 
-			Commands.Submit(cmdbank, cmds, waits, waitStages, sigs[..sigcount], fence?.Fence);
+			return Commands.Submit(cmdbank, cmds, waits, waitStages, sigs[..sigcount], fence?.Fence, track);
 		}
 
 		public void TrimCommandBufferMemory() => Commands.Trim();
@@ -79,6 +79,8 @@ namespace Tesseract.Vulkan.Services {
 
 		public ThreadSafetyLevel APIThreadSafety => ThreadSafetyLevel.Concurrent;
 
+		public string PipelineCacheIdentifier { get; }
+
 		public readonly IVulkanMemory Memory;
 
 		public ulong TotalVideoMemory => Memory.TotalVideoMemory;
@@ -101,6 +103,8 @@ namespace Tesseract.Vulkan.Services {
 			var props = device.PhysicalDevice.Properties;
 			RendererName = props.DeviceName;
 			VendorName = props.VendorID.ToString();
+			// The driver's cache UUID alone should identify compatible data, but some drivers do not change it between versions
+			PipelineCacheIdentifier = $"Vulkan:{props.PipelineCacheUUID}:{(uint)props.VendorID:X}:{props.DeviceID:X}:{props.DriverVersion:X}";
 			this.Memory = memory ?? new VulkanDeviceMemory(device);
 		}
 
@@ -109,14 +109,23 @@ namespace Tesseract.Vulkan.Services.Objects {
 			/// </summary>
 			public VulkanDeviceQueueInfo QueueInfo { get; }
 
+			/// <summary>
+			/// The tracker for the completion of transient submissions to this bank.
+			/// </summary>
+			public VulkanCompletionTracker Tracker { get; }
+
+			private readonly VulkanDevice device;
+
 			// All of the command pools in this bank
 			private readonly CommandPool[] commandPools;
 
 			// Counter for the next command pool
 			private uint nextCommandPool = 0;
 
-			internal CommandBank(int parallelism, VulkanDevice device, VulkanDeviceQueueInfo queueInfo) {
+			internal CommandBank(int parallelism, VulkanDevice device, VulkanDeviceQueueInfo queueInfo, VulkanFencePool fencePool, int gcThreshold) {
+				this.device = device;
 				QueueInfo = queueInfo;
+				Tracker = new VulkanCompletionTracker(device, fencePool, gcThreshold);
 				commandPools = new CommandPool[parallelism];
 				VKCommandPoolCreateInfo createInfo = new() {
 					Type = VKStructureType.CommandPoolCreateInfo,
@@ -129,6 +138,7 @@ namespace Tesseract.Vulkan.Services.Objects {
 			public void Dispose() {
 				GC.SuppressFinalize(this);
 				foreach (CommandPool pool in commandPools) pool.Dispose();
+				Tracker.Dispose();
 			}
 
 			/// <summary>
@@ -137,6 +147,13 @@ namespace Tesseract.Vulkan.Services.Objects {
 			/// <returns>Next command pool</returns>
 			public CommandPool Acquire() => commandPools[Interlocked.Increment(ref nextCommandPool) % commandPools.Length];
 
+			// Creates a command pool for short-lived command buffers which are recycled by resetting the whole pool
+			internal CommandPool CreateTransientPool() => new(this, device.Device.CreateCommandPool(new VKCommandPoolCreateInfo() {
+				Type = VKStructureType.CommandPoolCreateInfo,
+				Flags = VKCommandPoolCreateFlagBits.Transient | VKCommandPoolCreateFlagBits.ResetCommandBuffer,
+				QueueFamilyIndex = QueueInfo.QueueFamily
+			}));
+
 			/// <summary>
 			/// Trims the command pools in this bank.
 			/// </summary>
@@ -188,8 +205,92 @@ namespace Tesseract.Vulkan.Services.Objects {
 		/// </summary>
 		public CommandBank CommandBankCompute { get; }
 
+		/// <summary>
+		/// The pool of fences used to track submissions if timeline semaphores are not available.
+		/// </summary>
+		public VulkanFencePool FencePool { get; }
+
 		// If command banks can be trimmed (ie. VK >= 1.2 or VK_KHR_maintenance)
 		private readonly bool canTrim = false;
+
+		// The number of command buffers in each transient command pool
+		private const int TransientPoolSize = 32;
+
+		// A transient command pool whose command buffers are recycled together once their submissions have completed
+		private class TransientPool {
+
+			public readonly CommandPool Pool;
+
+			// Command buffers allocated from the pool, the first of which are in use
+			public readonly List<VulkanCommandBuffer> CommandBuffers = new();
+			public int Used = 0;
+
+			// The tracker value when the pool was retired, which is at least that of any submission using the pool
+			public ulong RetiredValue = 0;
+
+			public TransientPool(CommandPool pool) {
+				Pool = pool;
+			}
+
+		}
+
+		// The transient command pools used by a single thread for a command bank
+		private class TransientPoolSet : IDisposable {
+
+			private readonly CommandBank bank;
+			private TransientPool current;
+			// Pools waiting for their submissions to complete, in order of retirement
+			private readonly Queue<TransientPool> retired = new();
+			// Pools which have been reset and are ready for reuse
+			private readonly Stack<TransientPool> free = new();
+
+			public TransientPoolSet(CommandBank bank) {
+				this.bank = bank;
+				current = new TransientPool(bank.CreateTransientPool());
+			}
+
+			public VulkanCommandBuffer Acquire() {
+				if (current.Used == TransientPoolSize) {
+					current.RetiredValue = bank.Tracker.SubmittedValue;
+					retired.Enqueue(current);
+					current = NextPool();
+				}
+
+				VulkanCommandBuffer cmdbuf;
+				if (current.Used < current.CommandBuffers.Count) {
+					cmdbuf = current.CommandBuffers[current.Used];
+				} else {
+					cmdbuf = new VulkanCommandBuffer(current.Pool, current.Pool.Allocate(new CommandBufferCreateInfo() {
+						Type = CommandBufferType.Primary,
+						Usage = CommandBufferUsage.OneTimeSubmit
+					}), CommandBufferType.Primary);
+					current.CommandBuffers.Add(cmdbuf);
+				}
+				current.Used++;
+				return cmdbuf;
+			}
+
+			private TransientPool NextPool() {
+				// Reset every retired pool whose submissions have completed, freeing all of its command buffers at once
+				while (retired.TryPeek(out TransientPool? pool) && bank.Tracker.IsComplete(pool.RetiredValue)) {
+					retired.Dequeue();
+					pool.Pool.Pool.Reset(0);
+					pool.Used = 0;
+					free.Push(pool);
+				}
+				return free.TryPop(out TransientPool? next) ? next : new TransientPool(bank.CreateTransientPool());
+			}
+
+			public void Dispose() {
+				current.Pool.Dispose();
+				foreach (TransientPool pool in retired) pool.Pool.Dispose();
+				foreach (TransientPool pool in free) pool.Pool.Dispose();
+			}
+
+		}
+
+		// Per-thread transient pools for each command bank, indexed as graphics, transfer, then compute
+		private readonly ThreadLocal<TransientPoolSet[]> transientPools;
 		
 		// Orphaned command buffer holder
 		private struct OrphanedCommmandBuffer : IDisposable {
@@ -227,9 +328,15 @@ namespace Tesseract.Vulkan.Services.Objects {
 		/// <param name="poolParallelism">The degree of parallelism for command pools (number of concurrent pools per bank)</param>
 		/// <param name="gcThreshold">The threshold of command buffers above which garbage should be collected</param>
 		public VulkanCommands(VulkanDevice device, int poolParallelism, int gcThreshold) {
-			CommandBankGraphics = new(poolParallelism, device, device.QueueGraphics);
-			CommandBankTransfer = new(poolParallelism, device, device.QueueTransfer);
-			CommandBankCompute = new(poolParallelism, device, device.QueueCompute);
+			FencePool = new VulkanFencePool(device.Device);
+			CommandBankGraphics = new(poolParallelism, device, device.QueueGraphics, FencePool, gcThreshold);
+			CommandBankTransfer = new(poolParallelism, device, device.QueueTransfer, FencePool, gcThreshold);
+			CommandBankCompute = new(poolParallelism, device, device.QueueCompute, FencePool, gcThreshold);
+			transientPools = new(() => new TransientPoolSet[] {
+				new(CommandBankGraphics),
+				new(CommandBankTransfer),
+				new(CommandBankCompute)
+			}, true);
 			canTrim = device.Device.APIVersion >= VK12.ApiVersion || device.EnabledExtensions.Contains(KHRMaintenance1.ExtensionName);
 			this.gcThreshold = gcThreshold;
 		}
@@ -268,15 +375,11 @@ namespace Tesseract.Vulkan.Services.Objects {
 			(requested.Y == 0 || min.Y <= requested.Y) &&
 			(requested.Z == 0 || min.Z <= requested.Z);
 
-		/// <summary>
-		/// Allocates a command buffer.
-		/// </summary>
-		/// <param name="createInfo">Command buffer creation informaiton</param>
-		/// <returns>Allocated command buffer</returns>
-		public VulkanCommandBuffer Alloc(CommandBufferCreateInfo createInfo) {
-			bool graphics = (createInfo.Usage & CommandBufferUsage.Graphics) != 0;
-			bool transfer = (createInfo.Usage & CommandBufferUsage.Transfer) != 0;
-			bool compute = (createInfo.Usage & CommandBufferUsage.Compute) != 0;
+		// Selects the command bank to allocate command buffers with the given usage from
+		private CommandBank SelectBank(CommandBufferUsage usage, Vector3ui requiredTransferGranularity) {
+			bool graphics = (usage & CommandBufferUsage.Graphics) != 0;
+			bool transfer = (usage & CommandBufferUsage.Transfer) != 0;
+			bool compute = (usage & CommandBufferUsage.Compute) != 0;
 
 			// Need to decide the command bank to use
 			CommandBank? cmdbank = null;
@@ -287,7 +390,7 @@ namespace Tesseract.Vulkan.Services.Objects {
 				// If compute requested but not available drop the bank
 				if (compute && (cmdbank.QueueInfo.QueueFlags & VKQueueFlagBits.Compute) == 0) cmdbank = null;
 				// Else if granularity not supported drop the bank
-				else if (!CheckGranularity(cmdbank.QueueInfo.MinImageTransferGranularity, createInfo.RequiredTransferGranularity)) cmdbank = null;
+				else if (!CheckGranularity(cmdbank.QueueInfo.MinImageTransferGranularity, requiredTransferGranularity)) cmdbank = null;
 			}
 			// If compute commands requested and not filled
 			if (compute && cmdbank == null) {
@@ -295,7 +398,7 @@ namespace Tesseract.Vulkan.Services.Objects {
 				// If graphics requested but not available drop the bank
 				if (graphics && (cmdbank.QueueInfo.QueueFlags & VKQueueFlagBits.Graphics) == 0) cmdbank = null;
 				// Else if granularity not supported drop the bank
-				else if (!CheckGranularity(cmdbank.QueueInfo.MinImageTransferGranularity, createInfo.RequiredTransferGranularity)) cmdbank = null;
+				else if (!CheckGranularity(cmdbank.QueueInfo.MinImageTransferGranularity, requiredTransferGranularity)) cmdbank = null;
 			}
 			// If transfer commands requested and not filled
 			if (transfer && cmdbank == null) {
@@ -305,17 +408,39 @@ namespace Tesseract.Vulkan.Services.Objects {
 				// If compute requested but not available drop the bank
 				else if (compute && (cmdbank.QueueInfo.QueueFlags & VKQueueFlagBits.Compute) == 0) cmdbank = null;
 				// Else if granularity not supported switch to the graphics queue bank
-				else if (!CheckGranularity(cmdbank.QueueInfo.MinImageTransferGranularity, createInfo.RequiredTransferGranularity)) cmdbank = CommandBankGraphics;
+				else if (!CheckGranularity(cmdbank.QueueInfo.MinImageTransferGranularity, requiredTransferGranularity)) cmdbank = CommandBankGraphics;
 				// If granularity not supported drop the bank
-				if (cmdbank != null && !CheckGranularity(cmdbank.QueueInfo.MinImageTransferGranularity, createInfo.RequiredTransferGranularity)) cmdbank = null;
+				if (cmdbank != null && !CheckGranularity(cmdbank.QueueInfo.MinImageTransferGranularity, requiredTransferGranularity)) cmdbank = null;
 			}
 
 			if (cmdbank == null) throw new VulkanException("Could not find suitable command bank to allocate command buffer from");
+			return cmdbank;
+		}
 
-			CommandPool cmdpool = cmdbank.Acquire();
+		/// <summary>
+		/// Allocates a command buffer.
+		/// </summary>
+		/// <param name="createInfo">Command buffer creation informaiton</param>
+		/// <returns>Allocated command buffer</returns>
+		public VulkanCommandBuffer Alloc(CommandBufferCreateInfo createInfo) {
+			CommandPool cmdpool = SelectBank(createInfo.Usage, createInfo.RequiredTransferGranularity).Acquire();
 			return new VulkanCommandBuffer(cmdpool, cmdpool.Allocate(createInfo), createInfo.Type);
 		}
 
+		/// <summary>
+		/// Acquires a primary command buffer from the calling thread's transient command pools. The command buffer must be
+		/// submitted once with tracking enabled, after which it is recycled automatically once the submission has completed.
+		/// </summary>
+		/// <param name="usage">Command buffer usage</param>
+		/// <returns>Transient command buffer</returns>
+		public VulkanCommandBuffer AllocTransient(CommandBufferUsage usage) {
+			CommandBank cmdbank = SelectBank(usage, Vector3ui.Zero);
+			TransientPoolSet[] pools = transientPools.Value!;
+			if (cmdbank == CommandBankGraphics) return pools[0].Acquire();
+			else if (cmdbank == CommandBankTransfer) return pools[1].Acquire();
+			else return pools[2].Acquire();
+		}
+
 		/// <summary>
 		/// Schedules the given command buffer to be disposed of when it is no longer in use.
 		/// </summary>
@@ -335,13 +460,13 @@ namespace Tesseract.Vulkan.Services.Objects {
 			}
 		}
 
-		internal void Submit(CommandBank cmdBank, in ReadOnlySpan<IntPtr> commandBuffers, in ReadOnlySpan<ulong> waitSem, in ReadOnlySpan<VKPipelineStageFlagBits> waitStages, in ReadOnlySpan<ulong> signalSem, VKFence? fence) {
+		internal ulong Submit(CommandBank cmdBank, in ReadOnlySpan<IntPtr> commandBuffers, in ReadOnlySpan<ulong> waitSem, in ReadOnlySpan<VKPipelineStageFlagBits> waitStages, in ReadOnlySpan<ulong> signalSem, VKFence? fence, bool track = false) {
 			using MemoryStack sp = MemoryStack.Push();
+			ulong value = 0;
 			// Acquire concurrent lock
 			rwQueuesLock.EnterReadLock();
 			try {
-				// Submit commands via command bank
-				cmdBank.Submit(new VKSubmitInfo() {
+				VKSubmitInfo submitInfo = new() {
 					Type = VKStructureType.SubmitInfo,
 					CommandBufferCount = (uint)commandBuffers.Length,
 					CommandBuffers = sp.Values(commandBuffers),
@@ -350,7 +475,10 @@ namespace Tesseract.Vulkan.Services.Objects {
 					WaitSemaphoreCount = (uint)Math.Min(waitSem.Length, waitStages.Length),
 					WaitSemaphores = sp.Values(waitSem),
 					WaitDstStageMask = sp.Values(waitStages)
-				}, fence);
+				};
+				// Submit commands via command bank, signaling its completion tracker if requested
+				if (track) value = cmdBank.Tracker.Submit(cmdBank, sp, submitInfo, fence);
+				else cmdBank.Submit(submitInfo, fence);
 			} finally {
 				rwQueuesLock.ExitReadLock();
 			}
@@ -358,6 +486,7 @@ namespace Tesseract.Vulkan.Services.Objects {
 			lock (orphanedCommmandBuffers) {
 				TryGCOrphanedBuffers();
 			}
+			return value;
 		}
 
 		/// <summary>
@@ -375,6 +504,10 @@ namespace Tesseract.Vulkan.Services.Objects {
 				lock (orphanedCommmandBuffers) {
 					GCOrphanedBuffers();
 				}
+				// Release any resources waiting on tracked submissions
+				CommandBankGraphics.Tracker.CollectCompleted();
+				CommandBankTransfer.Tracker.CollectCompleted();
+				CommandBankCompute.Tracker.CollectCompleted();
 			} finally {
 				rwQueuesLock.ExitWriteLock();
 			}
@@ -386,12 +519,19 @@ namespace Tesseract.Vulkan.Services.Objects {
 			WaitIdle();
 			// Destroy any orphaned buffers
 			foreach (var orphanedBuf in orphanedCommmandBuffers) orphanedBuf.CommandBuffer.Dispose();
+			// Destroy transient pools from every thread
+			foreach (var pools in transientPools.Values) {
+				foreach (var pool in pools) pool.Dispose();
+			}
+			transientPools.Dispose();
 			// Destroy command banks
 			CommandBankGraphics.Dispose();
 			CommandBankTransfer.Dispose();
 			CommandBankCompute.Dispose();
 			// Destroy queue lock
 			rwQueuesLock.Dispose();
+			// Destroy recycled fences once the trackers have returned theirs
+			FencePool.Dispose();
 		}
 
 	}
@@ -477,7 +617,7 @@ namespace Tesseract.Vulkan.Services.Objects {
 		public void BindPipelineWithState(IPipelineSet set, PipelineDynamicCreateInfo state) {
 			// Bind the pipeline from the set
 			VulkanPipelineSet vkpipelineset = (VulkanPipelineSet)set;
-			CommandBuffer.BindPipeline(vkpipelineset.BindPoint, vkpipelineset.Pipelines[state]);
+			CommandBuffer.BindPipeline(vkpipelineset.BindPoint, vkpipelineset.GetPipeline(state));
 			if (vkpipelineset.BindPoint == VKPipelineBindPoint.Graphics) {
 				// Set any dynamic state on the bound pipeline
 				foreach (PipelineDynamicState dyn in vkpipelineset.BaseInfo.GraphicsInfo!.DynamicState) {
@@ -0,0 +1,226 @@
+﻿using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using Tesseract.Core.Native;
+
+namespace Tesseract.Vulkan.Services.Objects {
+
+	/// <summary>
+	/// A pool of recycled fences, so fences used to track command completion are not recreated for every submission.
+	/// </summary>
+	public class VulkanFencePool : IDisposable {
+
+		/// <summary>
+		/// The device fences are created from.
+		/// </summary>
+		public VKDevice Device { get; }
+
+		// Unsignaled fences ready for use
+		private readonly ConcurrentBag<VKFence> freeFences = new();
+
+		public VulkanFencePool(VKDevice device) {
+			Device = device;
+		}
+
+		/// <summary>
+		/// Acquires an unsignaled fence from the pool, creating a new one if none are free.
+		/// </summary>
+		/// <returns>Unsignaled fence</returns>
+		public VKFence Acquire() {
+			if (freeFences.TryTake(out VKFence? fence)) return fence;
+			return Device.CreateFence(new VKFenceCreateInfo() { Type = VKStructureType.FenceCreateInfo });
+		}
+
+		/// <summary>
+		/// Returns a fence to the pool. The fence must not be in use by any pending submission.
+		/// </summary>
+		/// <param name="fence">The fence to return</param>
+		public void Release(VKFence fence) {
+			fence.Reset();
+			freeFences.Add(fence);
+		}
+
+		public void Dispose() {
+			GC.SuppressFinalize(this);
+			while (freeFences.TryTake(out VKFence? fence)) fence.Dispose();
+		}
+
+	}
+
+	/// <summary>
+	/// <para>
+	/// Tracks the completion of submissions to a command bank using a monotonically increasing value for each tracked
+	/// submission. If timeline semaphores are enabled each submission signals the value on a timeline semaphore, so the
+	/// completion of every prior submission can be determined by reading a single counter. Otherwise each submission is
+	/// followed by a fence from a <see cref="VulkanFencePool"/>, and fences are polled in submission order.
+	/// </para>
+	/// <para>
+	/// Resources scheduled with <see cref="DisposeWhenComplete(ulong, IDisposable)"/> are released in batches once the
+	/// submission they depend on has completed, instead of each resource being polled individually.
+	/// </para>
+	/// </summary>
+	public class VulkanCompletionTracker : IDisposable {
+
+		/// <summary>
+		/// The timeline semaphore signaled by tracked submissions, or null if timeline semaphores are not enabled.
+		/// </summary>
+		public VKSemaphore? Timeline { get; }
+
+		private readonly VulkanFencePool fencePool;
+		// Fences following tracked submissions if there is no timeline semaphore, in submission order
+		private readonly Queue<(ulong Value, VKFence Fence)> pendingFences = new();
+		// Resources waiting for submissions to complete, in the order they were scheduled
+		private readonly Queue<(ulong Value, IDisposable Resource)> deferred = new();
+		// The number of deferred resources above which resources are collected on submission
+		private readonly int collectThreshold;
+
+		private ulong submittedValue = 0;
+		private ulong completedValue = 0;
+
+		/// <summary>
+		/// The value of the last tracked submission.
+		/// </summary>
+		public ulong SubmittedValue {
+			get {
+				lock (this) return submittedValue;
+			}
+		}
+
+		/// <summary>
+		/// The value of the last tracked submission known to have completed. All submissions with a lower value have also completed.
+		/// </summary>
+		public ulong CompletedValue {
+			get {
+				lock (this) return Poll();
+			}
+		}
+
+		internal VulkanCompletionTracker(VulkanDevice device, VulkanFencePool fencePool, int collectThreshold) {
+			this.fencePool = fencePool;
+			this.collectThreshold = collectThreshold;
+			if (device.TimelineSemaphores) {
+				using MemoryStack sp = MemoryStack.Push();
+				Timeline = device.Device.CreateSemaphore(new VKSemaphoreCreateInfo() {
+					Type = VKStructureType.SemaphoreCreateInfo,
+					Next = sp.Values(new VKSemaphoreTypeCreateInfo() {
+						Type = VKStructureType.SemaphoreTypeCreateInfo,
+						SemaphoreType = VKSemaphoreType.Timeline,
+						InitialValue = 0
+					})
+				});
+			}
+		}
+
+		// Updates and returns the completed value, must be called while locked
+		private ulong Poll() {
+			if (Timeline != null) {
+				completedValue = Timeline.CounterValue;
+			} else {
+				while (pendingFences.TryPeek(out var pending) && pending.Fence.Status) {
+					pendingFences.Dequeue();
+					fencePool.Release(pending.Fence);
+					completedValue = pending.Value;
+				}
+			}
+			return completedValue;
+		}
+
+		/// <summary>
+		/// Tests if the submission with the given value has completed.
+		/// </summary>
+		/// <param name="value">Submission value</param>
+		/// <returns>If the submission has completed</returns>
+		public bool IsComplete(ulong value) {
+			lock (this) return value <= completedValue || value <= Poll();
+		}
+
+		internal ulong Submit(VulkanCommands.CommandBank cmdBank, MemoryStack sp, VKSubmitInfo info, VKFence? fence) {
+			lock (this) {
+				ulong value = submittedValue + 1;
+				if (Timeline != null) {
+					// Append the timeline semaphore to the signaled semaphores, binary semaphores ignore their values
+					int count = (int)info.SignalSemaphoreCount;
+					UnmanagedPointer<ulong> pSemaphores = sp.Alloc<ulong>(count + 1);
+					UnmanagedPointer<ulong> pValues = sp.Alloc<ulong>(count + 1);
+					UnmanagedPointer<ulong> pOldSemaphores = new(info.SignalSemaphores, count);
+					for (int i = 0; i < count; i++) {
+						pSemaphores[i] = pOldSemaphores[i];
+						pValues[i] = 0;
+					}
+					pSemaphores[count] = Timeline.Semaphore;
+					pValues[count] = value;
+
+					info.Next = sp.Values(new VKTimelineSemaphoreSubmitInfo() {
+						Type = VKStructureType.TimelineSemaphoreSubmitInfo,
+						Next = info.Next,
+						SignalSemaphoreValueCount = (uint)(count + 1),
+						SignalSemaphoreValues = pValues
+					});
+					info.SignalSemaphoreCount = (uint)(count + 1);
+					info.SignalSemaphores = pSemaphores;
+					cmdBank.Submit(info, fence);
+				} else {
+					VKFence trackFence = fencePool.Acquire();
+					try {
+						if (fence == null) {
+							cmdBank.Submit(info, trackFence);
+						} else {
+							// Only one fence may be signaled per submission, so signal the tracking fence with an empty submission after it
+							cmdBank.Submit(info, fence);
+							cmdBank.Submit(new VKSubmitInfo() { Type = VKStructureType.SubmitInfo }, trackFence);
+						}
+					} catch {
+						fencePool.Release(trackFence);
+						throw;
+					}
+					pendingFences.Enqueue((value, trackFence));
+				}
+				submittedValue = value;
+
+				if (deferred.Count > collectThreshold) Collect();
+				return value;
+			}
+		}
+
+		/// <summary>
+		/// Schedules a resource to be disposed once the submission with the given value has completed.
+		/// </summary>
+		/// <param name="value">The value of the submission the resource is used by</param>
+		/// <param name="resource">The resource to dispose</param>
+		public void DisposeWhenComplete(ulong value, IDisposable resource) {
+			lock (this) {
+				if (value <= completedValue) resource.Dispose();
+				else deferred.Enqueue((value, resource));
+			}
+		}
+
+		// Disposes deferred resources whose submissions have completed, must be called while locked
+		private void Collect() {
+			if (deferred.Count == 0) return;
+			ulong completed = Poll();
+			while (deferred.TryPeek(out var item) && item.Value <= completed) {
+				deferred.Dequeue();
+				item.Resource.Dispose();
+			}
+		}
+
+		/// <summary>
+		/// Disposes any deferred resources whose submissions have completed.
+		/// </summary>
+		public void CollectCompleted() {
+			lock (this) Collect();
+		}
+
+		public void Dispose() {
+			GC.SuppressFinalize(this);
+			lock (this) {
+				// The owner must ensure all submissions have completed before disposing
+				while (deferred.TryDequeue(out var item)) item.Resource.Dispose();
+				while (pendingFences.TryDequeue(out var pending)) pending.Fence.Dispose();
+				Timeline?.Dispose();
+			}
+		}
+
+	}
+
+}
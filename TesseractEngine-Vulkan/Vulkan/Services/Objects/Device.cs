@@ -101,6 +101,18 @@ namespace Tesseract.Vulkan.Services.Objects {
 		/// </summary>
 		public VKPhysicalDeviceExtendedDynamicState2FeaturesEXT? ExtendedDynamicState2FeaturesEXT { get; } = null;
 
+		// VK 1.2 / KHR_timeline_semaphore
+
+		/// <summary>
+		/// The timeline semaphore features of the device, or null if unsupported.
+		/// </summary>
+		public VKPhysicalDeviceTimelineSemaphoreFeatures? TimelineSemaphoreFeatures { get; } = null;
+
+		/// <summary>
+		/// If timeline semaphores are provided by the core API instead of <c>VK_KHR_timeline_semaphore</c>.
+		/// </summary>
+		public bool IsTimelineSemaphoreCore { get; }
+
 		/*
 		public float Score { get; } = UnsupportedDeviceScore;
 
@@ -133,6 +145,9 @@ namespace Tesseract.Vulkan.Services.Objects {
 				bool extLineRasterization = Extensions.Contains(EXTLineRasterization.ExtensionName);
 				bool extExtendedDynamicState = Extensions.Contains(EXTExtendedDynamicState.ExtensionName);
 				bool extExtendedDynamicState2 = Extensions.Contains(EXTExtendedDynamicState2.ExtensionName);
+				// Core timeline semaphores need both the instance and device to be at least VK 1.2, otherwise fall back to the extension
+				IsTimelineSemaphoreCore = physicalDevice.Instance.APIVersion >= VK12.ApiVersion && Properties.APIVersion >= VK12.ApiVersion;
+				bool timelineSemaphore = IsTimelineSemaphoreCore || (physicalDevice.Instance.APIVersion < VK12.ApiVersion && Extensions.Contains(KHRTimelineSemaphore.ExtensionName));
 
 				{
 					IntPtr next = IntPtr.Zero;
@@ -176,6 +191,15 @@ namespace Tesseract.Vulkan.Services.Objects {
 						next = pExtendedDynamicState2Features;
 					}
 
+					UnmanagedPointer<VKPhysicalDeviceTimelineSemaphoreFeatures> pTimelineSemaphoreFeatures = default;
+					if (timelineSemaphore) {
+						pTimelineSemaphoreFeatures = sp.Values(new VKPhysicalDeviceTimelineSemaphoreFeatures() {
+							Type = VKStructureType.PhysicalDeviceTimelineSemaphoreFeatures,
+							Next = next
+						});
+						next = pTimelineSemaphoreFeatures;
+					}
+
 					VKPhysicalDeviceFeatures2 features2 = new() { Type = VKStructureType.PhysicalDeviceFeatures2, Next = next };
 
 					physicalDevice.GetFeatures2(ref features2);
@@ -187,6 +211,7 @@ namespace Tesseract.Vulkan.Services.Objects {
 					if (pLineRasterizationFeatures) LineRasterizationFeaturesEXT = pLineRasterizationFeatures.Value;
 					if (pExtendedDynamicStateFeatures) ExtendedDynamicStateFeaturesEXT = pExtendedDynamicStateFeatures.Value;
 					if (pExtendedDynamicState2Features) ExtendedDynamicState2FeaturesEXT = pExtendedDynamicState2Features.Value;
+					if (pTimelineSemaphoreFeatures) TimelineSemaphoreFeatures = pTimelineSemaphoreFeatures.Value;
 				}
 				sp.Pointer = bp;
 				{
@@ -420,6 +445,11 @@ namespace Tesseract.Vulkan.Services.Objects {
 		/// </summary>
 		public VKDevice Device { get; }
 
+		/// <summary>
+		/// If timeline semaphores are enabled on the device.
+		/// </summary>
+		public bool TimelineSemaphores { get; }
+
 		/*
 		private static VulkanPhysicalDeviceInfo SelectPhysicalDevice(VulkanGraphicsContext context) {
 			// If a preferred device is given use that
@@ -459,6 +489,17 @@ namespace Tesseract.Vulkan.Services.Objects {
 			HashSet<string> enabledExts = new();
 			if (provider.Enumerator.NeedsSwapchain) enabledExts.Add(KHRSwapchain.ExtensionName);
 
+			// Enable timeline semaphores if supported, which are used to track command completion
+			IntPtr next = IntPtr.Zero;
+			if (PhysicalDevice.TimelineSemaphoreFeatures is VKPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures && timelineFeatures.TimelineSemaphore) {
+				TimelineSemaphores = true;
+				if (!PhysicalDevice.IsTimelineSemaphoreCore) enabledExts.Add(KHRTimelineSemaphore.ExtensionName);
+				next = sp.Values(new VKPhysicalDeviceTimelineSemaphoreFeatures() {
+					Type = VKStructureType.PhysicalDeviceTimelineSemaphoreFeatures,
+					TimelineSemaphore = true
+				});
+			}
+
 			EnabledExtensions = enabledExts;
 
 			EnabledLayers = new HashSet<string>();
@@ -571,6 +612,7 @@ namespace Tesseract.Vulkan.Services.Objects {
 			// Create device
 			Device = PhysicalDevice.PhysicalDevice.CreateDevice(new VKDeviceCreateInfo() {
 				Type = VKStructureType.DeviceCreateInfo,
+				Next = next,
 				EnabledExtensionCount = (uint)enabledExts.Count,
 				EnabledExtensionNames = sp.UTF8Array(enabledExts),
 				QueueCreateInfoCount = (uint)queueInfos.Count,
@@ -116,7 +116,16 @@ namespace Tesseract.Vulkan.Services.Objects {
 
 		public ulong TotalVideoMemory { get; }
 
-		public ulong TotalCommittedMemory => allocator.Statistics.Total.Statistics.AllocationBytes;
+		public ulong TotalCommittedMemory {
+			get {
+				// Heap budgets are cheap to query compared to the full statistics
+				Span<VMABudget> budgets = stackalloc VMABudget[VK10.MaxMemoryHeaps];
+				int count = allocator.GetHeapBudgets(budgets);
+				ulong total = 0;
+				for (int i = 0; i < count; i++) total += budgets[i].Statistics.AllocationBytes;
+				return total;
+			}
+		}
 
 		/// <summary>
 		/// The device this memory manager will allocate from.
@@ -151,6 +160,34 @@ namespace Tesseract.Vulkan.Services.Objects {
 			allocator.Dispose();
 		}
 
+		/// <summary>
+		/// Gets the current usage and budget of every memory heap, suitable for recording every frame.
+		/// </summary>
+		/// <param name="budgets">Span to write budgets to</param>
+		/// <returns>The number of budgets written</returns>
+		public int GetHeapBudgets(Span<VMABudget> budgets) => allocator.GetHeapBudgets(budgets);
+
+		/// <summary>
+		/// Calculates detailed statistics about all allocated memory. This is slow and should only be used for debugging.
+		/// </summary>
+		/// <returns>Detailed memory statistics</returns>
+		public VMATotalStatistics CalculateStatistics() => allocator.Statistics;
+
+		/// <summary>
+		/// Dumps the state of the allocator as a JSON document.
+		/// </summary>
+		/// <param name="detailedMap">If every allocation should be included</param>
+		/// <returns>JSON statistics string</returns>
+		public string BuildStatsString(bool detailedMap = false) => allocator.BuildStatsString(detailedMap);
+
+		/// <summary>
+		/// Begins incremental defragmentation of the allocated memory. The returned defragmenter should be stepped once per frame
+		/// with a time budget until it completes.
+		/// </summary>
+		/// <param name="info">Defragmentation parameters</param>
+		/// <returns>Incremental defragmenter</returns>
+		public VMAIncrementalDefragmenter BeginDefragmentation(in VMADefragmentationInfo info) => new(allocator, info);
+
 		/// <summary>
 		/// Allocates a memory binding for a buffer.
 		/// </summary>
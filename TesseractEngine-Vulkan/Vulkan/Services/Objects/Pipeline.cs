@@ -1,11 +1,14 @@
 ﻿using System;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.Linq;
 using System.Text;
+using System.Threading;
 using System.Threading.Tasks;
 using Tesseract.Core.Collections;
 using Tesseract.Core.Graphics.Accelerated;
 using Tesseract.Core.Native;
+using Tesseract.Core.Numerics;
 using Tesseract.Core.Utilities;
 
 namespace Tesseract.Vulkan.Services.Objects {
@@ -82,257 +85,367 @@ namespace Tesseract.Vulkan.Services.Objects {
 	}
 
 	/// <summary>
+	/// <para>
 	/// Vulkan implementation for a pipeline set.
+	/// </para>
+	/// <para>
+	/// Derived pipelines are looked up by a compact key packing only the set's variable states, stored in a concurrent
+	/// map so recording on multiple threads never contends once pipelines exist. List and vertex format states are interned
+	/// to small IDs before packing. When a state is first encountered its pipeline is created on a worker thread (if
+	/// <see cref="CreateAsynchronously"/> is set) and the base pipeline is used until it is ready.
+	/// </para>
 	/// </summary>
 	public class VulkanPipelineSet : IPipelineSet {
 
-		// The threshold for variables above which 
-		private const int HashingThreshold = 5;
+		// The maximum number of words in a packed state key, enough for every variable state
+		private const int MaxKeyWords = 16;
 
-		// A dynamic field is a variable used 
-		private struct DynamicField {
+		// A pipeline state reduced to the values of a set's variable states packed into consecutive bits
+		private unsafe struct StateKey : IEquatable<StateKey> {
 
-			// A comparator function which determines if this field is the same between two dynamic infos
-			public Func<PipelineDynamicCreateInfo, PipelineDynamicCreateInfo, bool> Comparator;
+			public fixed ulong Words[MaxKeyWords];
 
-			// A merger function which merges just this field's value into a dynamic info
-			public Func<PipelineDynamicCreateInfo, PipelineDynamicCreateInfo, PipelineDynamicCreateInfo> Merger;
+			public int Length;
+
+			public void Put(ref int bit, ulong value, int bits) {
+				if (bits < 64) value &= (1UL << bits) - 1;
+				int word = bit >> 6, shift = bit & 63;
+				Words[word] |= value << shift;
+				if (shift + bits > 64) Words[word + 1] |= value >> (64 - shift);
+				bit += bits;
+			}
+
+			public bool Equals(StateKey other) {
+				if (Length != other.Length) return false;
+				for (int i = 0; i < Length; i++) if (Words[i] != other.Words[i]) return false;
+				return true;
+			}
+
+			public override bool Equals(object? obj) => obj is StateKey key && Equals(key);
+
+			public override int GetHashCode() {
+				HashCode hash = new();
+				for (int i = 0; i < Length; i++) hash.Add(Words[i]);
+				return hash.ToHashCode();
+			}
 
 		}
 
-		// Converts a dynamic state to a dynamic field.
-		private static DynamicField MakeField(PipelineDynamicState state) => state switch {
-			PipelineDynamicState.Viewport => new() {
-				Comparator = (p1, p2) => p1.Viewports == p2.Viewports,
-				Merger = (pbase, pnew) => pbase with { Viewports = pnew.Viewports }
-			},
-			PipelineDynamicState.Scissor => new() {
-				Comparator = (p1, p2) => p1.Scissors == p2.Scissors,
-				Merger = (pbase, pnew) => pbase with { Scissors = pnew.Scissors }
-			},
-			PipelineDynamicState.LineWidth => new() {
-				Comparator = (p1, p2) => p1.LineWidth == p2.LineWidth,
-				Merger = (pbase, pnew) => pbase with { LineWidth = pnew.LineWidth }
-			},
-			PipelineDynamicState.DepthBias => new() {
-				Comparator = (p1, p2) =>
-					p1.DepthBiasClamp == p2.DepthBiasClamp &&
-					p1.DepthBiasConstantFactor == p2.DepthBiasConstantFactor &&
-					p1.DepthBiasSlopeFactor == p2.DepthBiasSlopeFactor,
-				Merger = (pbase, pnew) => pbase with {
-					DepthBiasClamp = pnew.DepthBiasClamp,
-					DepthBiasConstantFactor = pnew.DepthBiasConstantFactor,
-					DepthBiasSlopeFactor = pnew.DepthBiasSlopeFactor
+		// Compares lists by their elements, as their own hash codes are by reference
+		private class ListComparer<T> : IEqualityComparer<EquatableList<T>> {
+
+			public static readonly ListComparer<T> Instance = new();
+
+			public bool Equals(EquatableList<T> x, EquatableList<T> y) => x.Equals(y);
+
+			public int GetHashCode(EquatableList<T> obj) {
+				HashCode hash = new();
+				for (int i = 0; i < obj.Count; i++) hash.Add(obj[i]);
+				return hash.ToHashCode();
+			}
+
+		}
+
+		// Compares vertex formats by their attributes and bindings
+		private class VertexFormatComparer : IEqualityComparer<VertexFormat> {
+
+			public static readonly VertexFormatComparer Instance = new();
+
+			public bool Equals(VertexFormat? x, VertexFormat? y) {
+				if (ReferenceEquals(x, y)) return true;
+				if (x == null || y == null) return false;
+				return x.Attributes.SequenceEqual(y.Attributes) && x.Bindings.SequenceEqual(y.Bindings);
+			}
+
+			public int GetHashCode(VertexFormat obj) {
+				HashCode hash = new();
+				foreach (VertexAttrib attrib in obj.Attributes) hash.Add(attrib);
+				foreach (VertexBinding binding in obj.Bindings) hash.Add(binding);
+				return hash.ToHashCode();
+			}
+
+		}
+
+		// A derived pipeline, which may still be being created
+		private class DerivedPipeline {
+
+			// The created pipeline, or null if not yet available
+			public volatile VKPipeline? Pipeline;
+
+			// The task creating the pipeline
+			public required Task Creation { get; init; }
+
+			// If the pipeline is owned by this entry, rather than being the base pipeline
+			public bool Owned { get; init; } = true;
+
+		}
+
+		// The variable states which are not dynamic on the base pipeline, in packing order
+		private readonly PipelineDynamicState[] variableStates;
+		// Map of packed state keys to derived pipelines
+		private readonly ConcurrentDictionary<StateKey, DerivedPipeline> pipelines = new();
+
+		// Interned IDs for states which are not plain values
+		private readonly ConcurrentDictionary<EquatableList<Viewport>, int> viewportIDs = new(ListComparer<Viewport>.Instance);
+		private readonly ConcurrentDictionary<EquatableList<Recti>, int> scissorIDs = new(ListComparer<Recti>.Instance);
+		private readonly ConcurrentDictionary<EquatableList<bool>, int> colorWriteIDs = new(ListComparer<bool>.Instance);
+		private readonly ConcurrentDictionary<VertexFormat, int> vertexFormatIDs = new(VertexFormatComparer.Instance);
+		private int nextID = 0;
+
+		private volatile bool disposed = false;
+
+		private int Intern<T>(ConcurrentDictionary<T, int> ids, T value) where T : notnull {
+			if (ids.TryGetValue(value, out int id)) return id;
+			return ids.GetOrAdd(value, _ => Interlocked.Increment(ref nextID));
+		}
+
+		// Packs the variable states of the given dynamic info into a key
+		private StateKey Pack(PipelineDynamicCreateInfo info) {
+			StateKey key = new();
+			int bit = 0;
+			foreach (PipelineDynamicState state in variableStates) {
+				switch (state) {
+					case PipelineDynamicState.Viewport:
+					case PipelineDynamicState.ViewportCount:
+						key.Put(ref bit, (uint)Intern(viewportIDs, info.Viewports), 32);
+						break;
+					case PipelineDynamicState.Scissor:
+					case PipelineDynamicState.ScissorCount:
+						key.Put(ref bit, (uint)Intern(scissorIDs, info.Scissors), 32);
+						break;
+					case PipelineDynamicState.LineWidth:
+						key.Put(ref bit, BitConverter.SingleToUInt32Bits(info.LineWidth), 32);
+						break;
+					case PipelineDynamicState.DepthBias:
+						key.Put(ref bit, BitConverter.SingleToUInt32Bits(info.DepthBiasConstantFactor), 32);
+						key.Put(ref bit, BitConverter.SingleToUInt32Bits(info.DepthBiasClamp), 32);
+						key.Put(ref bit, BitConverter.SingleToUInt32Bits(info.DepthBiasSlopeFactor), 32);
+						break;
+					case PipelineDynamicState.BlendConstants:
+						key.Put(ref bit, BitConverter.SingleToUInt32Bits(info.BlendConstant.X), 32);
+						key.Put(ref bit, BitConverter.SingleToUInt32Bits(info.BlendConstant.Y), 32);
+						key.Put(ref bit, BitConverter.SingleToUInt32Bits(info.BlendConstant.Z), 32);
+						key.Put(ref bit, BitConverter.SingleToUInt32Bits(info.BlendConstant.W), 32);
+						break;
+					case PipelineDynamicState.DepthBounds:
+						key.Put(ref bit, BitConverter.SingleToUInt32Bits(info.DepthBounds.Min), 32);
+						key.Put(ref bit, BitConverter.SingleToUInt32Bits(info.DepthBounds.Max), 32);
+						break;
+					case PipelineDynamicState.StencilCompareMask:
+						key.Put(ref bit, info.FrontStencilState.CompareMask, 32);
+						key.Put(ref bit, info.BackStencilState.CompareMask, 32);
+						break;
+					case PipelineDynamicState.StencilWriteMask:
+						key.Put(ref bit, info.FrontStencilState.WriteMask, 32);
+						key.Put(ref bit, info.BackStencilState.WriteMask, 32);
+						break;
+					case PipelineDynamicState.StencilReference:
+						key.Put(ref bit, info.FrontStencilState.Reference, 32);
+						key.Put(ref bit, info.BackStencilState.Reference, 32);
+						break;
+					case PipelineDynamicState.CullMode:
+						key.Put(ref bit, (ulong)info.CullMode, 16);
+						break;
+					case PipelineDynamicState.FrontFace:
+						key.Put(ref bit, (ulong)info.FrontFace, 16);
+						break;
+					case PipelineDynamicState.DrawMode:
+						key.Put(ref bit, (ulong)info.DrawMode, 16);
+						break;
+					case PipelineDynamicState.DepthTestEnable:
+						key.Put(ref bit, info.DepthTestEnable ? 1UL : 0, 1);
+						break;
+					case PipelineDynamicState.DepthWriteEnable:
+						key.Put(ref bit, info.DepthWriteEnable ? 1UL : 0, 1);
+						break;
+					case PipelineDynamicState.DepthCompareOp:
+						key.Put(ref bit, (ulong)info.DepthCompareOp, 16);
+						break;
+					case PipelineDynamicState.DepthBoundsTestEnable:
+						key.Put(ref bit, info.DepthBoundsTestEnable ? 1UL : 0, 1);
+						break;
+					case PipelineDynamicState.StencilTestEnable:
+						key.Put(ref bit, info.StencilTestEnable ? 1UL : 0, 1);
+						break;
+					case PipelineDynamicState.StencilOp:
+						foreach (PipelineStencilState stencil in stackalloc[] { info.FrontStencilState, info.BackStencilState }) {
+							key.Put(ref bit, (ulong)stencil.FailOp, 8);
+							key.Put(ref bit, (ulong)stencil.PassOp, 8);
+							key.Put(ref bit, (ulong)stencil.DepthFailOp, 8);
+							key.Put(ref bit, (ulong)stencil.CompareOp, 8);
+						}
+						break;
+					case PipelineDynamicState.PatchControlPoints:
+						key.Put(ref bit, info.PatchControlPoints, 32);
+						break;
+					case PipelineDynamicState.RasterizerDiscardEnable:
+						key.Put(ref bit, info.RasterizerDiscardEnable ? 1UL : 0, 1);
+						break;
+					case PipelineDynamicState.DepthBiasEnable:
+						key.Put(ref bit, info.DepthBiasEnable ? 1UL : 0, 1);
+						break;
+					case PipelineDynamicState.LogicOp:
+						key.Put(ref bit, (ulong)info.LogicOp, 16);
+						break;
+					case PipelineDynamicState.PrimitiveRestartEnable:
+						key.Put(ref bit, info.PrimitiveRestartEnable ? 1UL : 0, 1);
+						break;
+					case PipelineDynamicState.VertexFormat:
+						key.Put(ref bit, (uint)Intern(vertexFormatIDs, info.VertexFormat), 32);
+						break;
+					case PipelineDynamicState.ColorWrite:
+						key.Put(ref bit, (uint)Intern(colorWriteIDs, info.ColorWriteEnable), 32);
+						break;
 				}
+			}
+			key.Length = (bit + 63) >> 6;
+			return key;
+		}
+
+		// Merges the value of a variable state into a dynamic info
+		private static PipelineDynamicCreateInfo Merge(PipelineDynamicState state, PipelineDynamicCreateInfo pbase, PipelineDynamicCreateInfo pnew) => state switch {
+			PipelineDynamicState.Viewport or PipelineDynamicState.ViewportCount => pbase with { Viewports = pnew.Viewports },
+			PipelineDynamicState.Scissor or PipelineDynamicState.ScissorCount => pbase with { Scissors = pnew.Scissors },
+			PipelineDynamicState.LineWidth => pbase with { LineWidth = pnew.LineWidth },
+			PipelineDynamicState.DepthBias => pbase with {
+				DepthBiasClamp = pnew.DepthBiasClamp,
+				DepthBiasConstantFactor = pnew.DepthBiasConstantFactor,
+				DepthBiasSlopeFactor = pnew.DepthBiasSlopeFactor
 			},
-			PipelineDynamicState.BlendConstants => new() {
-				Comparator = (p1, p2) => p1.BlendConstant == p2.BlendConstant,
-				Merger = (pbase, pnew) => pbase with { BlendConstant = pnew.BlendConstant }
+			PipelineDynamicState.BlendConstants => pbase with { BlendConstant = pnew.BlendConstant },
+			PipelineDynamicState.DepthBounds => pbase with { DepthBounds = pnew.DepthBounds },
+			PipelineDynamicState.StencilCompareMask => pbase with {
+				FrontStencilState = pbase.FrontStencilState with { CompareMask = pnew.FrontStencilState.CompareMask },
+				BackStencilState = pbase.BackStencilState with { CompareMask = pnew.BackStencilState.CompareMask }
 			},
-			PipelineDynamicState.DepthBounds => new() {
-				Comparator = (p1, p2) => p1.Scissors == p2.Scissors,
-				Merger = (pbase, pnew) => pbase with { Scissors = pnew.Scissors }
+			PipelineDynamicState.StencilWriteMask => pbase with {
+				FrontStencilState = pbase.FrontStencilState with { WriteMask = pnew.FrontStencilState.WriteMask },
+				BackStencilState = pbase.BackStencilState with { WriteMask = pnew.BackStencilState.WriteMask }
 			},
-			PipelineDynamicState.StencilCompareMask => new() {
-				Comparator = (p1, p2) =>
-					p1.FrontStencilState.CompareMask == p2.FrontStencilState.CompareMask &&
-					p1.BackStencilState.CompareMask == p2.BackStencilState.CompareMask,
-				Merger = (pbase, pnew) => pbase with {
-					FrontStencilState = pbase.FrontStencilState with { CompareMask = pnew.FrontStencilState.CompareMask },
-					BackStencilState = pbase.BackStencilState with { CompareMask = pnew.BackStencilState.CompareMask }
-				}
+			PipelineDynamicState.StencilReference => pbase with {
+				FrontStencilState = pbase.FrontStencilState with { Reference = pnew.FrontStencilState.Reference },
+				BackStencilState = pbase.BackStencilState with { Reference = pnew.BackStencilState.Reference }
 			},
-			PipelineDynamicState.StencilWriteMask => new() {
-				Comparator = (p1, p2) =>
-					p1.FrontStencilState.WriteMask == p2.FrontStencilState.WriteMask &&
-					p1.BackStencilState.WriteMask == p2.BackStencilState.WriteMask,
-				Merger = (pbase, pnew) => pbase with {
-					FrontStencilState = pbase.FrontStencilState with { WriteMask = pnew.FrontStencilState.WriteMask },
-					BackStencilState = pbase.BackStencilState with { WriteMask = pnew.BackStencilState.WriteMask }
-				}
-			},
-			PipelineDynamicState.StencilReference => new() {
-				Comparator = (p1, p2) =>
-					p1.FrontStencilState.Reference == p2.FrontStencilState.Reference &&
-					p1.BackStencilState.Reference == p2.BackStencilState.Reference,
-				Merger = (pbase, pnew) => pbase with {
-					FrontStencilState = pbase.FrontStencilState with { Reference = pnew.FrontStencilState.Reference },
-					BackStencilState = pbase.BackStencilState with { Reference = pnew.BackStencilState.Reference }
+			PipelineDynamicState.CullMode => pbase with { CullMode = pnew.CullMode },
+			PipelineDynamicState.FrontFace => pbase with { FrontFace = pnew.FrontFace },
+			PipelineDynamicState.DrawMode => pbase with { DrawMode = pnew.DrawMode },
+			PipelineDynamicState.DepthTestEnable => pbase with { DepthTestEnable = pnew.DepthTestEnable },
+			PipelineDynamicState.DepthWriteEnable => pbase with { DepthWriteEnable = pnew.DepthWriteEnable },
+			PipelineDynamicState.DepthCompareOp => pbase with { DepthCompareOp = pnew.DepthCompareOp },
+			PipelineDynamicState.DepthBoundsTestEnable => pbase with { DepthBoundsTestEnable = pnew.DepthBoundsTestEnable },
+			PipelineDynamicState.StencilTestEnable => pbase with { StencilTestEnable = pnew.StencilTestEnable },
+			PipelineDynamicState.StencilOp => pbase with {
+				FrontStencilState = pbase.FrontStencilState with {
+					FailOp = pnew.FrontStencilState.FailOp,
+					PassOp = pnew.FrontStencilState.PassOp,
+					DepthFailOp = pnew.FrontStencilState.DepthFailOp,
+					CompareOp = pnew.FrontStencilState.CompareOp
+				},
+				BackStencilState = pbase.BackStencilState with {
+					FailOp = pnew.BackStencilState.FailOp,
+					PassOp = pnew.BackStencilState.PassOp,
+					DepthFailOp = pnew.BackStencilState.DepthFailOp,
+					CompareOp = pnew.BackStencilState.CompareOp
 				}
 			},
-			PipelineDynamicState.CullMode => new() {
-				Comparator = (p1, p2) => p1.CullMode == p2.CullMode,
-				Merger = (pbase, pnew) => pbase with { CullMode = pnew.CullMode }
-			},
-			PipelineDynamicState.FrontFace => new() {
-				Comparator = (p1, p2) => p1.FrontFace == p2.FrontFace,
-				Merger = (pbase, pnew) => pbase with { FrontFace = pnew.FrontFace }
-			},
-			PipelineDynamicState.DrawMode => new() {
-				Comparator = (p1, p2) => p1.DrawMode == p2.DrawMode,
-				Merger = (pbase, pnew) => pbase with { DrawMode = pnew.DrawMode }
-			},
-			PipelineDynamicState.DepthTestEnable => new() {
-				Comparator = (p1, p2) => p1.Scissors == p2.Scissors,
-				Merger = (pbase, pnew) => pbase with { Scissors = pnew.Scissors }
-			},
-			PipelineDynamicState.DepthWriteEnable => new() {
-				Comparator = (p1, p2) => p1.DepthWriteEnable == p2.DepthWriteEnable,
-				Merger = (pbase, pnew) => pbase with { DepthWriteEnable = pnew.DepthWriteEnable }
-			},
-			PipelineDynamicState.DepthCompareOp => new() {
-				Comparator = (p1, p2) => p1.DepthCompareOp == p2.DepthCompareOp,
-				Merger = (pbase, pnew) => pbase with { DepthCompareOp = pnew.DepthCompareOp }
-			},
-			PipelineDynamicState.DepthBoundsTestEnable => new() {
-				Comparator = (p1, p2) => p1.DepthBoundsTestEnable == p2.DepthBoundsTestEnable,
-				Merger = (pbase, pnew) => pbase with { DepthBoundsTestEnable = pnew.DepthBoundsTestEnable }
-			},
-			PipelineDynamicState.StencilTestEnable => new() {
-				Comparator = (p1, p2) => p1.Scissors == p2.Scissors,
-				Merger = (pbase, pnew) => pbase with { Scissors = pnew.Scissors }
-			},
-			PipelineDynamicState.StencilOp => new() {
-				Comparator = (p1, p2) =>
-					p1.FrontStencilState.CompareOp == p2.FrontStencilState.CompareOp &&
-					p1.FrontStencilState.PassOp == p2.FrontStencilState.PassOp &&
-					p1.FrontStencilState.FailOp == p2.FrontStencilState.FailOp &&
-					p1.FrontStencilState.DepthFailOp == p2.FrontStencilState.DepthFailOp &&
-					p1.BackStencilState.CompareOp == p2.BackStencilState.CompareOp &&
-					p1.BackStencilState.PassOp == p2.BackStencilState.PassOp &&
-					p1.BackStencilState.FailOp == p2.BackStencilState.FailOp &&
-					p1.BackStencilState.DepthFailOp == p2.BackStencilState.DepthFailOp,
-				Merger = (pbase, pnew) => pbase with { Scissors = pnew.Scissors }
-			},
-			PipelineDynamicState.PatchControlPoints => new() {
-				Comparator = (p1, p2) => p1.PatchControlPoints == p2.PatchControlPoints,
-				Merger = (pbase, pnew) => pbase with { PatchControlPoints = pnew.PatchControlPoints }
-			},
-			PipelineDynamicState.RasterizerDiscardEnable => new() {
-				Comparator = (p1, p2) => p1.RasterizerDiscardEnable == p2.RasterizerDiscardEnable,
-				Merger = (pbase, pnew) => pbase with { RasterizerDiscardEnable = pnew.RasterizerDiscardEnable }
-			},
-			PipelineDynamicState.DepthBiasEnable => new() {
-				Comparator = (p1, p2) => p1.DepthBiasEnable == p2.DepthBiasEnable,
-				Merger = (pbase, pnew) => pbase with { DepthBiasEnable = pnew.DepthBiasEnable }
-			},
-			PipelineDynamicState.LogicOp => new() {
-				Comparator = (p1, p2) => p1.LogicOp == p2.LogicOp,
-				Merger = (pbase, pnew) => pbase with { LogicOp = pnew.LogicOp }
-			},
-			PipelineDynamicState.PrimitiveRestartEnable => new() {
-				Comparator = (p1, p2) => p1.PrimitiveRestartEnable == p2.PrimitiveRestartEnable,
-				Merger = (pbase, pnew) => pbase with { PrimitiveRestartEnable = pnew.PrimitiveRestartEnable }
-			},
-			PipelineDynamicState.VertexFormat => new() {
-				Comparator = (p1, p2) => p1.VertexFormat == p2.VertexFormat,
-				Merger = (pbase, pnew) => pbase with { VertexFormat = pnew.VertexFormat }
-			},
-			PipelineDynamicState.ColorWrite => new() {
-				Comparator = (p1, p2) => p1.ColorWriteEnable == p2.ColorWriteEnable,
-				Merger = (pbase, pnew) => pbase with { ColorWriteEnable = pnew.ColorWriteEnable }
-			},
-			PipelineDynamicState.ViewportCount => new() {
-				Comparator = (p1, p2) => p1.Viewports == p2.Viewports,
-				Merger = (pbase, pnew) => pbase with { Viewports = pnew.Viewports }
-			},
-			PipelineDynamicState.ScissorCount => new() {
-				Comparator = (p1, p2) => p1.Scissors == p2.Scissors,
-				Merger = (pbase, pnew) => pbase with { Scissors = pnew.Scissors }
-			},
-			_ => default
+			PipelineDynamicState.PatchControlPoints => pbase with { PatchControlPoints = pnew.PatchControlPoints },
+			PipelineDynamicState.RasterizerDiscardEnable => pbase with { RasterizerDiscardEnable = pnew.RasterizerDiscardEnable },
+			PipelineDynamicState.DepthBiasEnable => pbase with { DepthBiasEnable = pnew.DepthBiasEnable },
+			PipelineDynamicState.LogicOp => pbase with { LogicOp = pnew.LogicOp },
+			PipelineDynamicState.PrimitiveRestartEnable => pbase with { PrimitiveRestartEnable = pnew.PrimitiveRestartEnable },
+			PipelineDynamicState.VertexFormat => pbase with { VertexFormat = pnew.VertexFormat },
+			PipelineDynamicState.ColorWrite => pbase with { ColorWriteEnable = pnew.ColorWriteEnable },
+			_ => pbase
 		};
 
-		// The list of pipeline fields to use
-		private readonly List<DynamicField> fields = new();
-
 		// Creates a new derived pipeline using the given dynamic info
-		private (PipelineDynamicCreateInfo, VKPipeline) CreateDerivedPipeline(PipelineDynamicCreateInfo key) {
+		private VKPipeline CreateDerivedPipeline(PipelineDynamicCreateInfo key) {
 			PipelineDynamicCreateInfo newDynInfo = BaseInfo.GraphicsInfo!.DynamicInfo;
-			foreach (var field in fields) newDynInfo = field.Merger(newDynInfo, key);
+			foreach (var state in variableStates) newDynInfo = Merge(state, newDynInfo, key);
 			PipelineCreateInfo createInfo = BaseInfo with {
 				GraphicsInfo = BaseInfo.GraphicsInfo with {
 					DynamicInfo = newDynInfo
 				},
 				BasePipeline = BasePipeline
 			};
-			return (newDynInfo, ((VulkanPipeline)Graphics.CreatePipeline(createInfo)).Pipeline);
+			return ((VulkanPipeline)Graphics.CreatePipeline(createInfo)).Pipeline;
 		}
 
-		// A pipeline set implementation that seeks to match pipelines from a list by their dynamic info
-		private class MatchedPipelineSet : IReadOnlyIndexer<PipelineDynamicCreateInfo, VKPipeline>, IDisposable {
-
-			// The pipeline set using this implementation
-			private readonly VulkanPipelineSet pipelineSet;
-			// The list of all created pipelines 
-			private readonly List<(PipelineDynamicCreateInfo, VKPipeline)> pipelines = new();
-
-			public MatchedPipelineSet(VulkanPipelineSet set) {
-				pipelineSet = set;
-				pipelines.Add((set.BaseInfo.GraphicsInfo!.DynamicInfo, set.BasePipeline.Pipeline));
-			}
-
-			private bool MatchPipelines(PipelineDynamicCreateInfo c1, PipelineDynamicCreateInfo c2) {
-				// All dynamic fields must match
-				foreach (DynamicField field in pipelineSet.fields) if (!field.Comparator(c1, c2)) return false;
-				return true;
-			}
-
-			public VKPipeline this[PipelineDynamicCreateInfo key] {
-				get {
-					lock(pipelines) {
-						// Try to find an existing matching pipeline
-						foreach(var pipeline in pipelines) if (MatchPipelines(key, pipeline.Item1)) return pipeline.Item2;
-						// Else create a new derived pipeline
-						var vkpipeline = pipelineSet.CreateDerivedPipeline(key);
-						pipelines.Add(vkpipeline);
-						return vkpipeline.Item2;
+		// Adds an entry for a state which has no pipeline yet, creating the pipeline
+		private DerivedPipeline AddPipeline(in StateKey key, PipelineDynamicCreateInfo state) {
+			StateKey entryKey = key;
+			bool async = CreateAsynchronously;
+			DerivedPipeline? derived = null;
+			derived = new DerivedPipeline() {
+				Creation = new Task(() => {
+					VKPipeline pipeline;
+					try {
+						pipeline = CreateDerivedPipeline(state);
+					} catch (Exception e) {
+						// Remove the failed entry so a later lookup retries creation instead of using the base pipeline forever
+						pipelines.TryRemove(new KeyValuePair<StateKey, DerivedPipeline>(entryKey, derived!));
+						// Asynchronous failures have no caller to propagate to
+						if (async) OnCreationFailed?.Invoke(state, e);
+						throw;
 					}
-				}
-			}
+					// The set may have been disposed while the pipeline was being created
+					if (disposed) pipeline.Dispose();
+					else derived!.Pipeline = pipeline;
+				})
+			};
 
-			public void Dispose() {
-				GC.SuppressFinalize(this);
-				foreach (var pipeline in pipelines) pipeline.Item2.Dispose();
+			DerivedPipeline existing = pipelines.GetOrAdd(key, derived);
+			if (existing == derived) {
+				if (async) derived.Creation.Start();
+				else derived.Creation.RunSynchronously();
 			}
+			// Synchronous lookups must wait for the pipeline, rethrowing any error creating it
+			if (!CreateAsynchronously) existing.Creation.GetAwaiter().GetResult();
+			return existing;
+		}
 
+		/// <summary>
+		/// Gets the pipeline to bind for the given dynamic state. If pipelines are created asynchronously the base pipeline
+		/// is returned until the derived pipeline for the state is ready.
+		/// </summary>
+		/// <param name="state">The dynamic state</param>
+		/// <returns>The pipeline for the state</returns>
+		public VKPipeline GetPipeline(PipelineDynamicCreateInfo state) {
+			if (variableStates.Length == 0) return BasePipeline.Pipeline;
+			StateKey key = Pack(state);
+			if (!pipelines.TryGetValue(key, out DerivedPipeline? derived)) derived = AddPipeline(key, state);
+			return derived.Pipeline ?? BasePipeline.Pipeline;
 		}
 
-		// A pipeline set implementation that seeks to map pipelines by their dynamic info's hash
-		private class HashedPipelineSet : IReadOnlyIndexer<PipelineDynamicCreateInfo, VKPipeline>, IDisposable {
+		// Indexer adapter for the pipelines of a set
+		private class PipelineIndexer : IReadOnlyIndexer<PipelineDynamicCreateInfo, VKPipeline> {
 
 			private readonly VulkanPipelineSet pipelineSet;
-			private readonly Dictionary<HashedValue<PipelineDynamicCreateInfo>, VKPipeline> pipelines = new();
 
-			public HashedPipelineSet(VulkanPipelineSet set) {
+			public PipelineIndexer(VulkanPipelineSet set) {
 				pipelineSet = set;
-				pipelines[set.BaseInfo.GraphicsInfo!.DynamicInfo] = set.BasePipeline.Pipeline;
 			}
 
-			public VKPipeline this[PipelineDynamicCreateInfo key] {
-				get {
-					lock(pipelines) {
-						// Try to find an existing matching pipeline
-						if (pipelines.TryGetValue(key, out VKPipeline? pipeline)) return pipeline;
-						// Else create a new derived pipeline
-						var vkpipeline = pipelineSet.CreateDerivedPipeline(key);
-						pipelines[vkpipeline.Item1] = vkpipeline.Item2;
-						return vkpipeline.Item2;
-					}
-				}
-			}
-
-			public void Dispose() {
-				GC.SuppressFinalize(this);
-				foreach (VKPipeline pipeline in pipelines.Values) pipeline.Dispose();
-			}
+			public VKPipeline this[PipelineDynamicCreateInfo key] => pipelineSet.GetPipeline(key);
 
 		}
 
 		/// <summary>
 		/// Indexer function from dynamic pipeline information to corresponding pipelines.
 		/// </summary>
-		public IReadOnlyIndexer<PipelineDynamicCreateInfo, VKPipeline> Pipelines;
+		public IReadOnlyIndexer<PipelineDynamicCreateInfo, VKPipeline> Pipelines { get; }
+
+		/// <summary>
+		/// If derived pipelines are created asynchronously on a worker thread, using the base pipeline in the meantime.
+		/// Otherwise they are created when first looked up, blocking until they are ready.
+		/// </summary>
+		public bool CreateAsynchronously { get; set; } = true;
+
+		/// <summary>
+		/// Event fired when a derived pipeline fails to be created asynchronously, passing the dynamic state it was created
+		/// for and the exception thrown. The failed pipeline will be created again the next time its state is looked up.
+		/// </summary>
+		public event Action<PipelineDynamicCreateInfo, Exception>? OnCreationFailed;
 
 		/// <summary>
 		/// The graphics context this set was created from.
@@ -359,24 +472,34 @@ namespace Tesseract.Vulkan.Services.Objects {
 			BasePipeline = (VulkanPipeline)graphics.CreatePipeline(createInfo.CreateInfo);
 			BaseInfo = createInfo.CreateInfo;
 			BindPoint = BaseInfo.GraphicsInfo != null ? VKPipelineBindPoint.Graphics : VKPipelineBindPoint.Compute;
+			Pipelines = new PipelineIndexer(this);
 
 			var dynStates = createInfo.CreateInfo.GraphicsInfo!.DynamicState;
 			HashSet<PipelineDynamicState> varStates = new(createInfo.VariableStates);
 			varStates.RemoveWhere(state => dynStates.Contains(state));
-			foreach (var state in varStates) fields.Add(MakeField(state));
-
-			if (varStates.Count > HashingThreshold) {
-				Pipelines = new HashedPipelineSet(this);
-			} else {
-				Pipelines = new MatchedPipelineSet(this);
+			variableStates = varStates.ToArray();
+
+			// The base pipeline is used directly for its own state
+			if (variableStates.Length > 0) {
+				pipelines[Pack(BaseInfo.GraphicsInfo.DynamicInfo)] = new DerivedPipeline() {
+					Pipeline = BasePipeline.Pipeline,
+					Creation = Task.CompletedTask,
+					Owned = false
+				};
 			}
 		}
 
 		public void Dispose() {
 			GC.SuppressFinalize(this);
+			disposed = true;
+			foreach (DerivedPipeline derived in pipelines.Values) {
+				// Wait for any pipelines still being created, which will be disposed once created
+				if (derived.Creation.Status != TaskStatus.Created) ((IAsyncResult)derived.Creation).AsyncWaitHandle.WaitOne();
+				if (derived.Owned) derived.Pipeline?.Dispose();
+			}
 			BasePipeline.Dispose();
-			if (Pipelines is IDisposable d) d.Dispose();
 		}
 
 	}
+
 }
\ No newline at end of file
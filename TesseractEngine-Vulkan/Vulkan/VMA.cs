@@ -402,6 +402,14 @@ namespace Tesseract.Vulkan {
 		[NativeType("VmaDefragmentationMove*")]
 		public IntPtr Moves;
 
+		public Span<VMADefragmentationMove> MovesSpan {
+			get {
+				unsafe {
+					return new Span<VMADefragmentationMove>((void*)Moves, (int)MoveCount);
+				}
+			}
+		}
+
 	}
 
 	[StructLayout(LayoutKind.Sequential)]
@@ -545,11 +553,11 @@ namespace Tesseract.Vulkan {
 
 		[NativeType("VkResult vmaBeginDefragmentation(VmaAllocator allocator, const VmaDefragmentationInfo* pInfo, VmaDefragmentationContext* pContext)")]
 		public delegate* unmanaged<IntPtr, VMADefragmentationInfo*, out IntPtr, VKResult> vmaBeginDefragmentation;
-		[NativeType("VkResult vmaEndDefragmentation(VmaAllocator allocator, VmaDefragmentationContext* pContext, VmaDefragmentationStats* pStats)")]
-		public delegate* unmanaged<IntPtr, IntPtr, out VMADefragmentationStats, VKResult> vmaEndDefragmentation;
-		[NativeType("VkResult vmaBeginDefragmentationPass(VmaAllocator allocator, VmaDefragmentationContext* pContext, VmaDefragmentationPassMoveInfo* pPassInfo)")]
+		[NativeType("void vmaEndDefragmentation(VmaAllocator allocator, VmaDefragmentationContext context, VmaDefragmentationStats* pStats)")]
+		public delegate* unmanaged<IntPtr, IntPtr, out VMADefragmentationStats, void> vmaEndDefragmentation;
+		[NativeType("VkResult vmaBeginDefragmentationPass(VmaAllocator allocator, VmaDefragmentationContext context, VmaDefragmentationPassMoveInfo* pPassInfo)")]
 		public delegate* unmanaged<IntPtr, IntPtr, out VMADefragmentationPassMoveInfo, VKResult> vmaBeginDefragmentationPass;
-		[NativeType("VkResult vmaEndDefragmentationPass(VmaAllocator allocator, VmaDefragmentationContext* pContext, VmaDefragmentationPassMoveInfo* pPassInfo)")]
+		[NativeType("VkResult vmaEndDefragmentationPass(VmaAllocator allocator, VmaDefragmentationContext context, VmaDefragmentationPassMoveInfo* pPassInfo)")]
 		public delegate* unmanaged<IntPtr, IntPtr, VMADefragmentationPassMoveInfo*, VKResult> vmaEndDefragmentationPass;
 		[NativeType("VkResult vmaBindBufferMemory(VmaAllocator allocator, VmaAllocation allocation, VkBuffer buffer)")]
 		public delegate* unmanaged<IntPtr, IntPtr, ulong, VKResult> vmaBindBufferMemory;
@@ -714,10 +722,54 @@ namespace Tesseract.Vulkan {
 			}
 		}
 
+		/// <summary>
+		/// The number of memory heaps the allocator manages, which is the number of entries returned by <see cref="GetHeapBudgets(Span{VMABudget})"/>.
+		/// </summary>
+		public int HeapCount {
+			get {
+				unsafe {
+					VMA.Functions.vmaGetMemoryProperties(Allocator, out VKPhysicalDeviceMemoryProperties* pProperties);
+					return (int)pProperties->MemoryHeapCount;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Gets the current usage and budget of every memory heap. Unlike <see cref="Statistics"/> this is cheap enough to be called every frame.
+		/// </summary>
+		/// <param name="budgets">Span to write budgets to, which must hold at least <see cref="HeapCount"/> elements</param>
+		/// <returns>The number of budgets written</returns>
+		public int GetHeapBudgets(Span<VMABudget> budgets) {
+			int count = HeapCount;
+			if (budgets.Length < count) throw new ArgumentException($"Budget span must hold at least {count} elements", nameof(budgets));
+			unsafe {
+				fixed(VMABudget* pBudgets = budgets) {
+					VMA.Functions.vmaGetHeapBudgets(Allocator, pBudgets);
+				}
+			}
+			return count;
+		}
+
+		/// <summary>
+		/// The current usage and budget of every memory heap.
+		/// </summary>
+		public VMABudget[] HeapBudgets {
+			get {
+				VMABudget[] budgets = new VMABudget[HeapCount];
+				GetHeapBudgets(budgets);
+				return budgets;
+			}
+		}
+
+		/// <summary>
+		/// Builds a JSON document describing the current state of the allocator.
+		/// </summary>
+		/// <param name="detailedMap">If a detailed map of every allocation should be included</param>
+		/// <returns>JSON statistics string</returns>
 		public string BuildStatsString(bool detailedMap) {
 			unsafe {
 				VMA.Functions.vmaBuildStatsString(Allocator, out IntPtr pString, detailedMap);
-				string str = MemoryUtil.GetASCII(pString)!;
+				string str = MemoryUtil.GetUTF8(pString)!;
 				VMA.Functions.vmaFreeStatsString(Allocator, pString);
 				return str;
 			}
@@ -1110,22 +1162,128 @@ namespace Tesseract.Vulkan {
 
 		public void End(out VMADefragmentationStats stats) {
 			unsafe {
-				VK.CheckError(VMA.Functions.vmaEndDefragmentation(Allocator, Context, out stats));
+				VMA.Functions.vmaEndDefragmentation(Allocator, Context, out stats);
 			}
 		}
 
-		public void BeginPass(out VMADefragmentationPassMoveInfo passInfo) {
+		/// <summary>
+		/// Begins a defragmentation pass.
+		/// </summary>
+		/// <param name="passInfo">The moves computed for this pass</param>
+		/// <returns>If there are moves which must be performed before calling <see cref="EndPass(in VMADefragmentationPassMoveInfo)"/></returns>
+		public bool BeginPass(out VMADefragmentationPassMoveInfo passInfo) {
 			unsafe {
-				VK.CheckError(VMA.Functions.vmaBeginDefragmentationPass(Allocator, Context, out passInfo));
+				VKResult result = VMA.Functions.vmaBeginDefragmentationPass(Allocator, Context, out passInfo);
+				if (result == VKResult.Incomplete) return true;
+				VK.CheckError(result, "Failed to begin defragmentation pass");
+				return false;
 			}
 		}
 
-		public void EndPass(in VMADefragmentationPassMoveInfo passInfo) {
+		/// <summary>
+		/// Ends a defragmentation pass, committing the moves it contained.
+		/// </summary>
+		/// <param name="passInfo">The (possibly modified) moves from <see cref="BeginPass(out VMADefragmentationPassMoveInfo)"/></param>
+		/// <returns>If more passes may be performed</returns>
+		public bool EndPass(in VMADefragmentationPassMoveInfo passInfo) {
 			unsafe {
 				fixed (VMADefragmentationPassMoveInfo* pPassInfo = &passInfo) {
-					VK.CheckError(VMA.Functions.vmaEndDefragmentationPass(Allocator, Context, pPassInfo));
+					VKResult result = VMA.Functions.vmaEndDefragmentationPass(Allocator, Context, pPassInfo);
+					if (result == VKResult.Incomplete) return true;
+					VK.CheckError(result, "Failed to end defragmentation pass");
+					return false;
+				}
+			}
+		}
+
+	}
+
+	/// <summary>
+	/// Callback which performs the moves of a defragmentation pass. For every move with an operation of <see cref="VMADefragmentationMoveOperation.Copy"/>
+	/// the resource bound to the source allocation must be recreated and bound to the destination allocation, and its contents copied, before
+	/// the callback returns. Moves may instead be changed to <see cref="VMADefragmentationMoveOperation.Ignore"/> or <see cref="VMADefragmentationMoveOperation.Destroy"/>.
+	/// </summary>
+	/// <param name="moves">The moves for the current pass</param>
+	public delegate void VMADefragmentationPassHandler(Span<VMADefragmentationMove> moves);
+
+	/// <summary>
+	/// Incremental defragmenter which spreads defragmentation passes over several frames, limited by a time budget per frame.
+	/// </summary>
+	public class VMAIncrementalDefragmenter : IDisposable {
+
+		/// <summary>
+		/// The allocator being defragmented.
+		/// </summary>
+		public VMAAllocator Allocator { get; }
+
+		/// <summary>
+		/// If defragmentation has finished, either because no more moves are possible or the defragmenter was disposed.
+		/// </summary>
+		public bool IsComplete { get; private set; }
+
+		/// <summary>
+		/// The number of passes performed so far.
+		/// </summary>
+		public int PassCount { get; private set; }
+
+		/// <summary>
+		/// The statistics of the defragmentation, valid once <see cref="IsComplete"/> is true.
+		/// </summary>
+		public VMADefragmentationStats Stats => stats;
+
+		private VMADefragmentationContext context;
+		private VMADefragmentationStats stats;
+
+		public VMAIncrementalDefragmenter(VMAAllocator allocator, in VMADefragmentationInfo info) {
+			Allocator = allocator;
+			context = allocator.BeginDefragmentation(info);
+		}
+
+		/// <summary>
+		/// Performs as many defragmentation passes as fit into the given time budget. At least one pass is performed
+		/// if defragmentation is not complete, so the budget should be sized using <see cref="VMADefragmentationInfo.MaxBytesPerPass"/>
+		/// and <see cref="VMADefragmentationInfo.MaxAllocationsPerPass"/> to keep a single pass short.
+		/// </summary>
+		/// <param name="budget">The time budget for this step</param>
+		/// <param name="handler">The handler performing the moves of each pass</param>
+		/// <returns>If defragmentation is complete</returns>
+		public bool Step(TimeSpan budget, VMADefragmentationPassHandler handler) {
+			long start = System.Diagnostics.Stopwatch.GetTimestamp();
+			while (!IsComplete) {
+				if (!context.BeginPass(out VMADefragmentationPassMoveInfo passInfo)) {
+					Finish();
+					break;
+				}
+				bool more;
+				bool handled = false;
+				try {
+					handler(passInfo.MovesSpan);
+					handled = true;
+				} finally {
+					// If the handler failed the moves were not performed, so they must not be committed
+					if (!handled) {
+						foreach (ref VMADefragmentationMove move in passInfo.MovesSpan) move.Operation = VMADefragmentationMoveOperation.Ignore;
+					}
+					more = context.EndPass(passInfo);
 				}
+				PassCount++;
+				if (!more) {
+					Finish();
+					break;
+				}
+				if (System.Diagnostics.Stopwatch.GetElapsedTime(start) >= budget) break;
 			}
+			return IsComplete;
+		}
+
+		private void Finish() {
+			if (IsComplete) return;
+			context.End(out stats);
+			IsComplete = true;
+		}
+
+		public void Dispose() {
+			Finish();
 		}
 
 	}